@@ -0,0 +1,286 @@
+/**
+ * @file Bench_main.cpp
+ * @brief Diagnostics - On-target microbenchmarks of the SRV hot paths (implementation)
+ *
+ * Each case is split into prepare(i), which sets up the inputs for
+ * iteration i outside the timed window, and run(), which is the one call
+ * being measured. Results go to volatile sinks so the optimiser cannot
+ * drop the call.
+ */
+
+#include "Bench_main.h"
+#include "../Lab3/SignalConditioning.h"
+#include "../Lab3_2/SignalConditioning32.h"
+#include "../Lab4_2/lib_sig_cond.h"
+#include "../Lab5_2/ctrl_pid.h"
+#include "../Lab5_2/srv_temp_sensor.h"
+#include "../sensor/NtcAdcDriver.h"
+#include <avr/io.h>
+#include <stdio.h>
+
+#define BENCH_PAINT_BYTE    0xA5u
+
+typedef struct
+{
+    const char* name;
+    void (*prepare)(uint16_t i);
+    void (*run)(void);
+} BenchCase;
+
+typedef struct
+{
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t sumCycles;
+    uint16_t stackBytes;
+} BenchStats;
+
+// ============================================================================
+// Inputs, state and sinks
+// ============================================================================
+
+static float    s_inFloat;
+static uint16_t s_inRaw;
+static unsigned long s_inMs;
+
+static volatile float s_sinkFloat;
+static volatile int   s_sinkInt;
+static volatile bool  s_sinkBool;
+
+static SignalConditioner      s_cond3;
+static Lab32SignalConditioner s_cond32;
+static PidController52        s_pid;
+static NtcAdcDriver           s_ntc(A0);
+static SigCond42State         s_sig42;
+
+static int s_fifo[LAB5_2_MEDIAN_WINDOW];
+static int s_scratch[LAB5_2_MEDIAN_WINDOW];
+
+/** Triangle wave 0..31..0 so filters and hysteresis see rising and falling input. */
+static uint8_t tri(uint16_t i)
+{
+    const uint8_t k = (uint8_t)(i & 63u);
+    return (k < 32u) ? k : (uint8_t)(63u - k);
+}
+
+// ============================================================================
+// Cases
+// ============================================================================
+
+static void prepareNone(uint16_t i) { (void)i; }
+static void runEmpty(void) {}
+
+static void prepareTemp(uint16_t i)
+{
+    s_inFloat = 20.0f + 0.25f * (float)tri(i);     /* 20..27.75 C, crosses the 25 C threshold */
+}
+
+static void runCond3(void)
+{
+    const ConditioningResult r = s_cond3.Process(s_inFloat);
+    s_sinkFloat = r.filteredTempC;
+    s_sinkBool  = r.debouncedAlert;
+}
+
+static void prepareRaw32(uint16_t i)
+{
+    s_inFloat = (float)(400u + 7u * tri(i));
+}
+
+static void runCond32(void)
+{
+    s_sinkFloat = s_cond32.Process(s_inFloat).filteredValue;
+}
+
+static void preparePct(uint16_t i)
+{
+    s_inFloat = 3.5f * (float)tri(i) - 4.0f;       /* -4..104.5 %, hits both clamps */
+    s_inMs    = 50ul * i;
+}
+
+static void runSig42(void)
+{
+    float clamped, median, weighted, ramped;
+    bool clampAlert, limitAlert;
+    sig42_step(&s_sig42, s_inFloat, s_inMs, 0.35f, 120.0f,
+               &clamped, &median, &weighted, &ramped, &clampAlert, &limitAlert);
+    s_sinkFloat = ramped;
+    s_sinkBool  = limitAlert;
+}
+
+static void prepareError(uint16_t i)
+{
+    s_inFloat = 0.1f * (float)tri(i) - 1.5f;       /* -1.5..+1.6 C around the set-point */
+}
+
+static void runPid(void)
+{
+    s_sinkFloat = s_pid.Step(s_inFloat, 0.5f);
+}
+
+static void prepareAdc(uint16_t i)
+{
+    s_inRaw = (uint16_t)(i * 4u) & 1023u;          /* whole ADC range, including 0 */
+}
+
+static void runNtc(void)
+{
+    s_sinkFloat = s_ntc.RawToTemperatureC(s_inRaw);
+}
+
+static void prepareFifo(uint16_t i)
+{
+    uint16_t x = (uint16_t)(i * 40503u + 1u);      /* cheap scramble: a new order every call */
+    for (uint8_t k = 0; k < LAB5_2_MEDIAN_WINDOW; k++)
+    {
+        x = (uint16_t)(x * 25173u + 13849u);
+        s_fifo[k] = 2000 + (int)(x >> 8);
+    }
+}
+
+static void runMedian(void)
+{
+    s_sinkInt = TempSensor52_MedianFromFifo(s_fifo, s_scratch, LAB5_2_MEDIAN_WINDOW);
+}
+
+static const BenchCase kCases[] =
+{
+    { "sig42_step",                       preparePct,   runSig42  },
+    { "SignalConditioner::Process",       prepareTemp,  runCond3  },
+    { "Lab32SignalConditioner::Process",  prepareRaw32, runCond32 },
+    { "PidController52::Step",            prepareError, runPid    },
+    { "NtcAdcDriver::RawToTemperatureC",  prepareAdc,   runNtc    },
+    { "TempSensor52_MedianFromFifo",      prepareFifo,  runMedian },
+};
+
+static void resetState(void)
+{
+    ConditioningConfig c3;
+    c3.thresholdC = 25.0f;
+    c3.hysteresisC = 1.0f;
+    c3.alpha = 0.25f;
+    c3.minTempC = -40.0f;
+    c3.maxTempC = 125.0f;
+    c3.persistenceSamples = 2u;
+    s_cond3.Configure(c3);
+
+    Lab32ConditioningConfig c32;
+    c32.alpha = 0.25f;
+    c32.minValue = 0.0f;
+    c32.maxValue = 1023.0f;
+    s_cond32.Configure(c32);
+
+    s_pid.Init(LAB5_2_DEFAULT_KP, LAB5_2_DEFAULT_KI, LAB5_2_DEFAULT_KD, 100.0f, 0.0f);
+    sig42_init(&s_sig42, 0.0f, 0ul);
+}
+
+// ============================================================================
+// Runner (interrupts off, Timer1 at clk/1)
+// ============================================================================
+
+/** One timed call; TCNT1 starts from 0 so a single overflow is recoverable. */
+static uint32_t timeOnce(void (*run)(void))
+{
+    TCNT1 = 0u;
+    TIFR1 = (1 << TOV1);
+    run();
+    const uint16_t t = TCNT1;
+    return ((TIFR1 & (1 << TOV1)) != 0u) ? (uint32_t)t + 65536ul : (uint32_t)t;
+}
+
+/**
+ * Kept out of line so its frame is the reference point: everything the
+ * case touches below `top` is stack the case used.
+ */
+static void __attribute__((noinline)) measure(const BenchCase* c, uint32_t overhead, BenchStats* out)
+{
+    uint8_t* const top    = (uint8_t*)SP - 8;        /* leave the bytes just below SP alone */
+    uint8_t* const bottom = top - BENCH_STACK_PAINT;
+    for (uint8_t* p = bottom; p < top; p++)
+    {
+        *p = BENCH_PAINT_BYTE;
+    }
+
+    out->minCycles = 0xFFFFFFFFul;
+    out->maxCycles = 0ul;
+    out->sumCycles = 0ul;
+
+    for (uint16_t i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        c->prepare(i);
+        uint32_t cycles = timeOnce(c->run);
+        cycles = (cycles > overhead) ? cycles - overhead : 0ul;
+        if (cycles < out->minCycles) out->minCycles = cycles;
+        if (cycles > out->maxCycles) out->maxCycles = cycles;
+        out->sumCycles += cycles;
+    }
+
+    const uint8_t* p = bottom;
+    while (p < top && *p == BENCH_PAINT_BYTE)
+    {
+        p++;
+    }
+    /* Includes the call through c->run itself; runAll() reports it net
+       of the empty case. */
+    out->stackBytes = (uint16_t)(top - p);
+}
+
+static void runAll(void)
+{
+    const uint8_t count = (uint8_t)(sizeof(kCases) / sizeof(kCases[0]));
+    static const BenchCase emptyCase = { "empty", prepareNone, runEmpty };
+    BenchStats stats[sizeof(kCases) / sizeof(kCases[0])];
+    BenchStats empty;
+
+    resetState();
+
+    const uint8_t sreg = SREG;
+    cli();
+
+    const uint8_t  savedA   = TCCR1A;
+    const uint8_t  savedB   = TCCR1B;
+    const uint16_t savedCnt = TCNT1;
+    TCCR1A = 0u;
+    TCCR1B = (1 << CS10);                           /* normal mode, clk / 1 */
+
+    measure(&emptyCase, 0ul, &empty);
+    const uint32_t overhead = empty.minCycles;
+    for (uint8_t k = 0; k < count; k++)
+    {
+        measure(&kCases[k], overhead, &stats[k]);
+    }
+
+    TCCR1B = 0u;
+    TCNT1  = savedCnt;
+    TIFR1  = (1 << TOV1);
+    TCCR1A = savedA;
+    TCCR1B = savedB;
+    SREG   = sreg;
+
+    printf("BENCH_BEGIN,v1,f_cpu=%lu,overhead=%lu,n=%u\n",
+           (unsigned long)F_CPU, (unsigned long)overhead, (unsigned)BENCH_ITERATIONS);
+    for (uint8_t k = 0; k < count; k++)
+    {
+        printf("BENCH,%s,%u,%lu,%lu,%lu,%u\n",
+               kCases[k].name, (unsigned)BENCH_ITERATIONS,
+               (unsigned long)stats[k].minCycles,
+               (unsigned long)(stats[k].sumCycles / BENCH_ITERATIONS),
+               (unsigned long)stats[k].maxCycles,
+               (unsigned)(stats[k].stackBytes > empty.stackBytes
+                              ? stats[k].stackBytes - empty.stackBytes : 0u));
+    }
+    printf("BENCH_END\n");
+}
+
+// ============================================================================
+// Lab entry points
+// ============================================================================
+
+void bench_setup(void)
+{
+    runAll();
+}
+
+void bench_loop(void)
+{
+}
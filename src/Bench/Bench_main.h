@@ -0,0 +1,36 @@
+/**
+ * @file Bench_main.h
+ * @brief Diagnostics - On-target microbenchmarks of the SRV hot paths
+ *
+ * Runs every routine in the case table BENCH_ITERATIONS times with
+ * interrupts off and Timer1 at clk/1 (one count = one CPU cycle), then
+ * prints one CSV line per case over Serial:
+ *
+ *   BENCH_BEGIN,v1,f_cpu=16000000,overhead=<cycles>,n=<iterations>
+ *   BENCH,<name>,<n>,<min>,<mean>,<max>,<stack>
+ *   ...
+ *   BENCH_END
+ *
+ * Cycle counts are net of the empty-call overhead printed in the header.
+ * <stack> is the deepest stack use (bytes) seen across all iterations,
+ * measured by painting the area below the runner's frame, also net of
+ * the empty call. The line format is versioned ("v1"): add columns at
+ * the end only, and bump the version if a column changes meaning.
+ *
+ * Runs once from setup(), before the FreeRTOS scheduler starts, on the
+ * main stack. Reset the board to run it again.
+ */
+
+#ifndef BENCH_MAIN_H
+#define BENCH_MAIN_H
+
+/** Calls per routine; inputs cycle through a fixed pattern per index. */
+#define BENCH_ITERATIONS    256u
+
+/** Bytes painted below the runner's frame for the stack high-water mark. */
+#define BENCH_STACK_PAINT   256u
+
+void bench_setup(void);
+void bench_loop(void);
+
+#endif
@@ -7,6 +7,7 @@
  * Uses:
  * - LedDriver (ECAL): Abstracts LED control
  * - SerialStdioDriver (ECAL): Abstracts serial communication
+ * - CommandLine (SRV): Shared non-blocking command parser
  * 
  * The lab processes user commands from serial terminal to control an LED.
  */
@@ -17,41 +18,54 @@
 
 #include "../led/LedDriver.h"
 #include "../drivers/SerialStdioDriver.h"
+#include "../cli/CommandLine.h"
 #include "Lab1.h"
 
 // Hardware pin definitions
 #define LedPin 13       // LED on digital pin 13
-#define BufferSize 64   // Serial buffer size
 
 // Module-level LED driver instance (static = file scope)
 static LedDriver StatusLed(LedPin);
 
 /**
- * @brief Process user command from serial input
- * 
- * Parses the command string and executes corresponding LED action.
- * Supports: "led on", "led off"
- * 
- * @param command String containing the user command
+ * @brief `led <off|on>` handler
+ *
+ * Keyword index 0 = off, 1 = on (order of the choice list below).
+ *
+ * @param arg Validated argument from the CLI
+ * @return No deferred effects
  */
-static void ProcessCommand(char *command)
+static uint8_t CmdLed(const CliArg *arg)
 {
-    if (strcmp(command, "led on") == 0)
+    if (arg->choice == 1u)
     {
         StatusLed.On();  // Turn LED on via ECAL driver
         printf("LED turned ON\n");
     }
-    else if (strcmp(command, "led off") == 0)
+    else
     {
         StatusLed.Off();  // Turn LED off via ECAL driver
         printf("LED turned OFF\n");
     }
-    else
-    {
-        printf("Invalid command. Use: led on | led off\n");
-    }
+    return 0u;
 }
 
+// Command table for the shared CLI (sorted by name, stored in flash)
+static const CliCommand Lab1Commands[] PROGMEM = {
+    { "led", CLI_ARG_WORD, 0.0f, 0.0f, "off|on", CmdLed, "switch the LED on pin 13" }
+};
+
+static const CliConfig Lab1Cli = {
+    Lab1Commands,
+    sizeof(Lab1Commands) / sizeof(Lab1Commands[0]),
+    0u,                 // no echo: replies are enough on a bare Serial Monitor
+    NULL,               // no bare-number shortcut
+    NULL, NULL,         // single-threaded: no state lock
+    NULL, NULL,         // single-threaded: no I/O lock
+    NULL,               // no deferred effects
+    NULL
+};
+
 /**
  * @brief Initialize Lab 1 resources
  * 
@@ -64,6 +78,7 @@ void Lab1_Setup()
 {
     SerialStdioInit(9600);  // Initialize serial at 9600 baud (ECAL), redirects printf/scanf
     StatusLed.Init();       // Initialize LED pin (ECAL)
+    Cli_Register(&Lab1Cli); // Route Serial lines to the command table
 
     // Display welcome message
     printf("=== Lab 1.1 - Serial STDIO LED Control ===\n");
@@ -75,17 +90,11 @@ void Lab1_Setup()
 
 /**
  * @brief Main loop for Lab 1
- * 
- * Continuously waits for serial input and processes commands.
- * Uses SerialReadLine to read a full command line from the serial monitor.
+ *
+ * Feeds pending Serial bytes to the shared CLI. Never blocks: a command
+ * runs as soon as its line terminator has arrived.
  */
 void Lab1_Loop()
 {
-    char command[BufferSize];
-
-    // Read a full line from the serial monitor (blocks until \n received)
-    scanf(" %63[^\n]", command);
-
-    // Parse and execute the complete command
-    ProcessCommand(command);
+    Cli_Poll();
 }
@@ -28,8 +28,8 @@ void Lab1_Setup();
 /**
  * @brief Main loop for Lab 1
  * 
- * Continuously listens for serial commands and processes them.
- * Blocks waiting for user input (serial read is blocking).
+ * Polls the shared CLI for complete serial commands and processes them.
+ * Non-blocking: returns immediately when no full line has arrived.
  */
 void Lab1_Loop();
 
@@ -3,7 +3,12 @@
  * @brief Main application for advanced menu lock system (Lab 1.2)
  *
  * Integrates FSM, keypad, LCD, and LED drivers for interactive menu-driven lock.
- * Uses printf for LCD output and scanf for keypad input.
+ * Uses printf for LCD output. Keypad events (PCINT-driven, see KeypadDriver)
+ * go straight into LockFSM; between events the loop sleeps in IDLE and only
+ * wakes for interrupts (keypad, Timer0 tick for the LED feedback timeout).
+ *
+ * Wiring: keypad rows on A8..A11 (pin-change group 2; A0..A3 on PORTF have
+ * no pin-change interrupt), columns on D6..D9.
  */
 
 #include <Arduino.h>
@@ -18,7 +23,7 @@
 static const uint8_t LCD_RS = 12, LCD_EN = 11, LCD_D4 = 5, LCD_D5 = 4, LCD_D6 = 3, LCD_D7 = 2;
 static const uint8_t LED_GREEN_PIN = 10, LED_RED_PIN = 13;
 static const byte ROWS = 4, COLS = 4;
-static const byte rowPins[ROWS] = {A0, A1, A2, A3};
+static const byte rowPins[ROWS] = {A8, A9, A10, A11};
 static const byte colPins[COLS] = {6, 7, 8, 9};
 static char keys[ROWS][COLS] = {
   {'1','2','3','A'},
@@ -89,32 +94,28 @@ void updateLEDs() {
     }
 }
 
-void lab1_2_loop() {
-    // Menu mode: show menu and read command via scanf (blocks until user presses #)
+static void showMenu() {
+    // Single printf, no middle \n, so both lines display (16 chars each)
+    printf("*0:Lock *1:Open*2:ChgPass *3:St\n");
+}
+
+/** One keypad event into the FSM. */
+static void handleKey(char key) {
+    // Menu mode: the next key selects the operation
     if (inMenu) {
-        // Single printf, no middle \n, so both lines display (16 chars each)
-        printf("*0:Lock *1:Open*2:ChgPass *3:St\n");
-        if (scanf("%31s", inputBuffer) >= 1 && inputBuffer[0] != '\0') {
-            LockFSM_SelectOperation(inputBuffer[0]);
-            printf("Cmd: %s\n%s\n", inputBuffer, LockFSM_GetMessage());
-            if (inputBuffer[0] == '1' || inputBuffer[0] == '2') {
-                ;  // FSM needs password; will scanf in next branch
-            } else {
+        if (key >= '0' && key <= '3') {
+            LockFSM_SelectOperation(key);
+            printf("Cmd: %c\n%s\n", key, LockFSM_GetMessage());
+            if (key != '1' && key != '2') {
                 triggerFeedback();
             }
+            // '1' / '2': FSM now needs a password, collected below
+            inMenu = false;
         }
-        inMenu = false;
     }
-    // FSM needs password input: prompt, then echo each key as pressed until #
+    // FSM needs password input: echo each digit until #
     else if (LockFSM_GetCurrentState() >= STATE_INPUT_UNLOCK &&
              LockFSM_GetCurrentState() <= STATE_INPUT_CHANGE_NEW) {
-        if (!passwordPromptShown) {
-            printf("%s\n", LockFSM_GetMessage());
-            passwordPromptShown = true;
-            inputIndex = 0;
-            memset(inputBuffer, 0, sizeof(inputBuffer));
-        }
-        char key = keypad.GetKey();
         if (key == '#') {
             if (inputIndex > 0) {
                 inputBuffer[inputIndex] = '\0';
@@ -123,19 +124,35 @@ void lab1_2_loop() {
                 triggerFeedback();
             }
             passwordPromptShown = false;
-        } else if (key && key >= '0' && key <= '9' && inputIndex < (int)sizeof(inputBuffer) - 1) {
+        } else if (key >= '0' && key <= '9' && inputIndex < (int)sizeof(inputBuffer) - 1) {
             inputBuffer[inputIndex++] = key;
             inputBuffer[inputIndex] = '\0';
             printf("%s\n%s\n", LockFSM_GetMessage(), inputBuffer);
         }
     }
-    // Idle: detect '*' to enter menu (non-blocking)
-    else {
-        char key = keypad.GetKey();
-        if (key == '*') {
-            inMenu = true;
-        }
+    // Idle: '*' enters the menu
+    else if (key == '*') {
+        inMenu = true;
+        showMenu();
+    }
+}
+
+void lab1_2_loop() {
+    // Prompt once when the FSM starts waiting for a password
+    if (!inMenu && !passwordPromptShown &&
+        LockFSM_GetCurrentState() >= STATE_INPUT_UNLOCK &&
+        LockFSM_GetCurrentState() <= STATE_INPUT_CHANGE_NEW) {
+        printf("%s\n", LockFSM_GetMessage());
+        passwordPromptShown = true;
+        inputIndex = 0;
+        memset(inputBuffer, 0, sizeof(inputBuffer));
+    }
+
+    char key;
+    while ((key = keypad.GetKey()) != 0) {
+        handleKey(key);
     }
 
     updateLEDs();
+    keypad.Sleep();
 }
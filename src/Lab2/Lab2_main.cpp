@@ -7,6 +7,9 @@
  * =============================================================================
  *
  * Task 1 – Button Detection & Duration Measurement (every 20 ms, offset 0 ms)
+ *   • Only scheduled when the button pin has no INTn line. Normally the
+ *     driver runs in edge-capture mode (INT4 on D2, micros() timestamps)
+ *     and Task 2 collects the release events instead; no polling task.
  *   • Calls ButtonDriver::Update() for non-blocking debounce.
  *   • On button release: measures press duration, classifies short/long.
  *   • Publishes press event and duration to shared variables (provider role).
@@ -58,6 +61,7 @@
 #include <stdio.h>
 
 #include "led/LedDriver.h"
+#include "led/LedEffects.h"
 #include "button/ButtonDriver.h"
 #include "drivers/SerialStdioDriver.h"
 
@@ -67,7 +71,7 @@ static const uint8_t LED_RED_PIN    = 12;  ///< Red   LED  – long  press indic
 static const uint8_t LED_YELLOW_PIN = 11;  ///< Yellow LED – press-active + blink
 
 #define REC_BUTTON  20       ///< Task 1: 20 ms
-#define REC_STATS   50       ///< Task 2: 50 ms – one blink-toggle per call
+#define REC_STATS   50       ///< Task 2: 50 ms – also the yellow blink half-period
 #define REC_REPORT  10000    ///< Task 3: 10 s
 
 #define OFFS_BUTTON 0        ///< Task 1: no offset
@@ -116,8 +120,11 @@ static volatile uint16_t g_shortPresses  = 0;  ///< Presses shorter than 500 ms
 static volatile uint16_t g_longPresses   = 0;  ///< Presses 500 ms or longer
 static volatile uint32_t g_totalDuration = 0;  ///< Accumulated press duration (ms)
 
-/** Remaining yellow LED toggle steps (2 toggles = 1 blink) */
-static uint8_t s_yellowTogglesLeft = 0;
+/** true: button in edge-capture mode, Task 1 not scheduled */
+static bool s_edgeCapture = false;
+
+/** Yellow LED handed to the LedEffects timer (blinks play without Task 2) */
+static LedFxHandle s_yellowFx = LEDFX_NONE;
 static bool    s_prevPressed       = false;
 static uint32_t s_pressStartMs     = 0;
 
@@ -149,7 +156,8 @@ static void os_seq_scheduler_task_init(Task_t* task,
 
 static void os_seq_scheduler_setup(void)
 {
-    os_seq_scheduler_task_init(&tasks[TASK_BUTTON_ID], Task1_ButtonMonitor,
+    os_seq_scheduler_task_init(&tasks[TASK_BUTTON_ID],
+                               s_edgeCapture ? NULL : Task1_ButtonMonitor,
                                REC_BUTTON, OFFS_BUTTON);
 
     os_seq_scheduler_task_init(&tasks[TASK_STATS_ID],  Task2_StatsAndLeds,
@@ -163,6 +171,10 @@ static void os_seq_scheduler_loop(void)
 {
     for (int i = 0; i < MAX_OF_TASKS; i++)
     {
+        if (tasks[i].task_func == NULL)
+        {
+            continue;                        // slot disabled at setup
+        }
         if (--tasks[i].rec_cnt <= 0)
         {
             tasks[i].rec_cnt = tasks[i].rec; // reload period
@@ -196,12 +208,11 @@ static void Timer1_Init(void)
  *          • Publishes press data to shared variables for Task2 to consume.
  *          • Prints a one-line press notification via printf.
  */
-static void Task1_ButtonMonitor(void)
+static void publishRelease(void)
 {
-    button.Update();
-
     if (button.WasJustReleased())
     {
+        uint32_t us      = button.GetLastPressDurationUs();
         uint32_t dur     = button.GetLastPressDuration();
         bool     isShort = (dur < SHORT_PRESS_THRESHOLD_MS);
 
@@ -209,10 +220,17 @@ static void Task1_ButtonMonitor(void)
         g_pressIsShort  = isShort;
         g_pressEvent    = true;
 
-        printf("[T1] Press: %lu ms (%s)\n", dur, isShort ? "SHORT" : "LONG");
+        printf("[T1] Press: %lu.%03lu ms (%s)\n",
+               us / 1000UL, us % 1000UL, isShort ? "SHORT" : "LONG");
     }
 }
 
+static void Task1_ButtonMonitor(void)
+{
+    button.Update();
+    publishRelease();
+}
+
 /**
  * @brief Task 2 – Statistics & LED Signalling
  *        Period: 50 ms | Offset: 10 ms | Priority: MEDIUM
@@ -223,6 +241,11 @@ static void Task1_ButtonMonitor(void)
  */
 static void Task2_StatsAndLeds(void)
 {
+    if (s_edgeCapture)
+    {
+        publishRelease();               // edge mode: no Task 1 to do it
+    }
+
     bool pressedNow = button.IsPressed();
 
     // ---- Red/Green LEDs: active only during an ongoing press ----
@@ -262,31 +285,24 @@ static void Task2_StatsAndLeds(void)
         if (g_pressIsShort)
         {
             g_shortPresses++;
-            s_yellowTogglesLeft = 10; // 5 blinks x 2 toggles
         }
         else
         {
             g_longPresses++;
-            s_yellowTogglesLeft = 20; // 10 blinks x 2 toggles
         }
 
-        // Start blink sequence from a known state for consistent pulse count.
-        ledYellow.Off();
+        // Same cadence as the old one-toggle-per-call blink: REC_STATS on/off.
+        LedFx_Pulse(s_yellowFx, g_pressIsShort ? 5 : 10, REC_STATS, REC_STATS);
     }
 
-    // ---- Yellow LED: blink after release, or steady ON while held ----
-    if (s_yellowTogglesLeft > 0)
+    // ---- Yellow LED: steady ON while held, unless a blink sequence plays ----
+    if (s_yellowFx == LEDFX_NONE)
     {
-        ledYellow.Toggle();
-        s_yellowTogglesLeft--;
+        if (pressedNow) { ledYellow.On(); } else { ledYellow.Off(); }
     }
-    else if (pressedNow)
+    else if (!LedFx_IsPulsing(s_yellowFx))
     {
-        ledYellow.On();
-    }
-    else
-    {
-        ledYellow.Off();
+        if (pressedNow) { LedFx_On(s_yellowFx); } else { LedFx_Off(s_yellowFx); }
     }
 
     s_prevPressed = pressedNow;
@@ -334,11 +350,17 @@ void lab2_setup(void)
     ledGreen.Init();
     ledRed.Init();
     ledYellow.Init();
+    if (LedFx_Init())
+    {
+        s_yellowFx = LedFx_Attach(ledYellow);
+    }
     button.Init();
+    s_edgeCapture = button.BeginEdgeCapture();
 
     SerialStdioInit(9600);
     printf("[Lab2] Scheduler starting. BTN=D3 GREEN=D10 RED=D11 YELLOW=D12\n");
     printf("[Lab2] Short(<500ms)->GREEN+5blinks | Long(>=500ms)->RED+10blinks\n");
+    printf("[Lab2] Button: %s\n", s_edgeCapture ? "edge capture (INT, us)" : "polled every 20 ms");
 
     os_seq_scheduler_setup();
     Timer1_Init();
@@ -7,6 +7,7 @@
 #define LAB2_2_SHARED_H
 
 #include <stdint.h>
+#include "../led/LedEffects.h"
 #include <Arduino_FreeRTOS.h>
 #include <semphr.h>
 #include <queue.h>
@@ -19,9 +20,12 @@
 
 /* ── Thresholds ────────────────────────────────────────────────── */
 #define SHORT_THRESHOLD_MS  500
-#define DEBOUNCE_SAMPLES    2
 #define PRESS_EVENT_QUEUE_LEN  64
 
+/* ── LED feedback (led/LedEffects) ─────────────────────────────── */
+#define LED_MAX_BLINKS          20      /* merged blinks are capped here   */
+#define LED_BLINK_HALF_MS       100     /* yellow feedback: 100 on/100 off */
+
 /* ── Shared data types ─────────────────────────────────────────── */
 typedef struct {
     uint32_t durationMs;
@@ -42,6 +46,9 @@ typedef struct {
     SemaphoreHandle_t statsMutex;
     SemaphoreHandle_t ioMutex;
     PressStats        stats;
+    LedFxHandle       ledGreen;     /* LEDFX_NONE without Timer4 */
+    LedFxHandle       ledRed;
+    LedFxHandle       ledYellow;
 } SharedState;
 
 /* Defined in Lab2_2_main.c */
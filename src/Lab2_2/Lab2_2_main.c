@@ -67,6 +67,21 @@ void lab2_2_setup(void)
     }
     printf("[Lab2_2] Queue + mutexes OK\n");
 
+    /* --- LED feedback: patterns played by the Timer4 interrupt --- */
+    g_shared.ledGreen  = LEDFX_NONE;
+    g_shared.ledRed    = LEDFX_NONE;
+    g_shared.ledYellow = LEDFX_NONE;
+    if (LedFx_Init())
+    {
+        g_shared.ledGreen  = LedFx_AttachPin(LED_GREEN_PIN);
+        g_shared.ledRed    = LedFx_AttachPin(LED_RED_PIN);
+        g_shared.ledYellow = LedFx_AttachPin(LED_YELLOW_PIN);
+    }
+    else
+    {
+        printf("[Lab2_2] No Timer4: LED feedback off\n");
+    }
+
     /* --- Create FreeRTOS tasks --- */
     BaseType_t ok;
 
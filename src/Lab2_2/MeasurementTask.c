@@ -1,11 +1,15 @@
 /**
  * @file MeasurementTask.c
- * @brief Pure-C FreeRTOS task – polls button, debounces, signals press events
+ * @brief Pure-C FreeRTOS task – samples the button bank, signals press events
+ *
+ * Debouncing is ButtonBank's (BUTTON_BANK_SAMPLES ticks); this task only
+ * turns release events into statistics, LED feedback and a report.
  */
 
 #include "MeasurementTask.h"
 #include "Lab2_2_Shared.h"
 #include "avr_helpers.h"
+#include "../button/ButtonBank.h"
 
 #include <stdio.h>
 #include <Arduino_FreeRTOS.h>
@@ -16,90 +20,77 @@ void TaskMeasurement(void *pv)
 {
     (void)pv;
 
-    uint8_t  stablePressed = 0;
-    uint8_t  matchCount    = 0;
-    unsigned long pressStartMs = 0;
+    static const uint8_t s_btnPins[1] = { BTN_PIN };
+    static ButtonBank    s_buttons;
     unsigned long eventIndex = 0;
+    ButtonEvent   ev;
+
+    /* Active-low with the internal pull-up. Only the release matters
+       here (it carries the press duration), so no long-press events. */
+    ButtonBank_Init(&s_buttons, s_btnPins, 1, 1, 1, 0);
 
     for (;;)
     {
-        uint8_t rawVal     = hw_digital_read(BTN_PIN);
-        uint8_t rawPressed = (rawVal == PIN_LOW) ? 1 : 0;  /* active-low */
+        ButtonBank_Update(&s_buttons, (uint32_t)hw_millis());
 
-        /* ── Debounce state machine ─────────────────────────────── */
-        if (rawPressed != stablePressed)
+        while (ButtonBank_Pop(&s_buttons, &ev))
         {
-            matchCount++;
-            if (matchCount >= DEBOUNCE_SAMPLES)
+            if (ev.type != BUTTON_EV_RELEASE)
+            {
+                continue;
+            }
+
+            unsigned long dur = ev.heldMs;
+            uint8_t isS = (dur < SHORT_THRESHOLD_MS) ? 1 : 0;
+            eventIndex++;
+
+            /* Update statistics immediately when event is detected */
+            if (xSemaphoreTake(g_shared.statsMutex,
+                              portMAX_DELAY) == pdTRUE)
             {
-                matchCount    = 0;
-                stablePressed = rawPressed;
+                g_shared.stats.totalPresses++;
+                g_shared.stats.totalDurationMs += (uint32_t)dur;
 
-                if (stablePressed)
+                if (isS)
                 {
-                    /* Button just pressed */
-                    pressStartMs = hw_millis();
+                    g_shared.stats.shortPresses++;
+                    g_shared.stats.shortDurationMs += (uint32_t)dur;
                 }
                 else
                 {
-                    /* Button just released */
-                    unsigned long dur = hw_millis() - pressStartMs;
-                    uint8_t isS = (dur < SHORT_THRESHOLD_MS) ? 1 : 0;
-                    eventIndex++;
-
-                    /* Update statistics immediately when event is detected */
-                    if (xSemaphoreTake(g_shared.statsMutex,
-                                      portMAX_DELAY) == pdTRUE)
-                    {
-                        g_shared.stats.totalPresses++;
-                        g_shared.stats.totalDurationMs += (uint32_t)dur;
-
-                        if (isS)
-                        {
-                            g_shared.stats.shortPresses++;
-                            g_shared.stats.shortDurationMs += (uint32_t)dur;
-                        }
-                        else
-                        {
-                            g_shared.stats.longPresses++;
-                            g_shared.stats.longDurationMs += (uint32_t)dur;
-                        }
-
-                        xSemaphoreGive(g_shared.statsMutex);
-                    }
+                    g_shared.stats.longPresses++;
+                    g_shared.stats.longDurationMs += (uint32_t)dur;
+                }
 
-                    /* Queue one full event so bursts are not lost */
-                    {
-                        PressEventData eventData;
-                        eventData.durationMs = (uint32_t)dur;
-                        eventData.isShort    = isS;
+                xSemaphoreGive(g_shared.statsMutex);
+            }
 
-                        if (xQueueSend(g_shared.pressEventQueue, &eventData, 0) != pdPASS)
-                        {
-                            printf("[WARN] LED event queue full\r\n");
-                        }
-                    }
+            /* Queue one full event so bursts are not lost */
+            {
+                PressEventData eventData;
+                eventData.durationMs = (uint32_t)dur;
+                eventData.isShort    = isS;
 
-                    if (xSemaphoreTake(g_shared.ioMutex, portMAX_DELAY) == pdTRUE)
-                    {
-                        printf(
-                            "+---------------- Button Event ----------------+\r\n"
-                            "| Event ID : %-31lu |\r\n"
-                            "| Type     : %-31s |\r\n"
-                            "| Duration : %-27lu ms |\r\n"
-                            "+----------------------------------------------+\r\n\r\n",
-                            eventIndex,
-                            isS ? "SHORT" : "LONG",
-                            (unsigned long)dur
-                        );
-                        xSemaphoreGive(g_shared.ioMutex);
-                    }
+                if (xQueueSend(g_shared.pressEventQueue, &eventData, 0) != pdPASS)
+                {
+                    printf("[WARN] LED event queue full\r\n");
                 }
             }
-        }
-        else
-        {
-            matchCount = 0;
+
+            if (xSemaphoreTake(g_shared.ioMutex, portMAX_DELAY) == pdTRUE)
+            {
+                printf(
+                    "+---------------- Button Event ----------------+\r\n"
+                    "| Event ID : %-31lu |\r\n"
+                    "| Type     : %-31s |\r\n"
+                    "| Duration : %-27lu ms |\r\n"
+                    "+----------------------------------------------+\r\n\r\n",
+                    eventIndex,
+                    isS ? "SHORT" : "LONG",
+                    (unsigned long)dur
+                );
+                xSemaphoreGive(g_shared.ioMutex);
+            }
         }
 
         vTaskDelay(1);  /* yield for 1 tick */
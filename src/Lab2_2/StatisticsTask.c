@@ -1,6 +1,6 @@
 /**
  * @file StatisticsTask.c
- * @brief Pure-C FreeRTOS task – updates stats, drives indicator LEDs
+ * @brief Pure-C FreeRTOS task – turns press events into LED feedback patterns
  */
 
 #include "StatisticsTask.h"
@@ -31,44 +31,23 @@ void TaskStatistics(void *pv)
                           &eventData,
                           portMAX_DELAY) == pdTRUE)
         {
-            uint8_t  isS = eventData.isShort;
+            uint8_t isS = eventData.isShort;
 
-            uint8_t blinks = 0;
+            /* Yellow blinks: 5 for short, 10 for long. Merged into a
+             * sequence that is still playing, so a burst adds blinks
+             * instead of waiting for the previous sequence to finish. */
+            LedFx_PulseMore(g_shared.ledYellow, isS ? 5 : 10,
+                            LED_BLINK_HALF_MS, LED_BLINK_HALF_MS, LED_MAX_BLINKS);
 
-            if (isS)
-                blinks = 5;
-            else
-                blinks = 10;
-
-            /* LED feedback: green = short, red = long */
-            if (isS)
-            {
-                hw_digital_write(LED_GREEN_PIN, PIN_HIGH);
-                hw_digital_write(LED_RED_PIN,   PIN_LOW);
-            }
-            else
+            /* Green = short, red = long: the latest event wins and stays
+             * lit for as long as the yellow sequence runs. */
             {
-                hw_digital_write(LED_RED_PIN,   PIN_HIGH);
-                hw_digital_write(LED_GREEN_PIN, PIN_LOW);
+                uint32_t hold = LedFx_PulseMsLeft(g_shared.ledYellow);
+                if (hold > 0xFFFFu) { hold = 0xFFFFu; }
+                LedFx_Pulse(isS ? g_shared.ledGreen : g_shared.ledRed, 1, (uint16_t)hold, 1);
+                LedFx_Off(isS ? g_shared.ledRed : g_shared.ledGreen);
             }
 
-            /* Yellow blink feedback: each blink = 250 ms on + 250 ms off */
-            {
-                uint8_t i;
-                for (i = 0; i < blinks; i++)
-                {
-                    hw_digital_write(LED_YELLOW_PIN, PIN_HIGH);
-                    vTaskDelay(pdMS_TO_TICKS(100));
-                    hw_digital_write(LED_YELLOW_PIN, PIN_LOW);
-                    vTaskDelay(pdMS_TO_TICKS(100));
-                }
-            }
-
-            /* All LEDs off after feedback sequence */
-            hw_digital_write(LED_GREEN_PIN,  PIN_LOW);
-            hw_digital_write(LED_RED_PIN,    PIN_LOW);
-            hw_digital_write(LED_YELLOW_PIN, PIN_LOW);
-
             if (xSemaphoreTake(g_shared.ioMutex, portMAX_DELAY) == pdTRUE)
             {
                 printf("[Stats] Event processed: %s, queue pending=%u\r\n",
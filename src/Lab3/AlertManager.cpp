@@ -1,8 +1,10 @@
 #include "AlertManager.h"
 
-AlertManager::AlertManager(uint8_t ledPin)
+AlertManager::AlertManager(uint8_t ledPin, uint16_t blinkHalfPeriodMs)
     : led(ledPin),
-      active(false)
+      fx(LEDFX_NONE),
+      blinkMs(blinkHalfPeriodMs),
+      level(ALERT_LED_OFF)
 {
 }
 
@@ -10,21 +12,39 @@ void AlertManager::Init()
 {
     led.Init();
     led.Off();
-    active = false;
+    LedFx_Init();
+    fx = LedFx_Attach(led);
+    level = ALERT_LED_OFF;
 }
 
 bool AlertManager::ApplyState(bool nextState)
 {
-    const bool changed = (nextState != active);
-    active = nextState;
+    return ApplyLevel(nextState ? ALERT_LED_ON : ALERT_LED_OFF);
+}
+
+bool AlertManager::ApplyLevel(uint8_t nextLevel)
+{
+    const bool changed = (nextLevel != level);
+    level = nextLevel;
+
+    if (fx == LEDFX_NONE)
+    {
+        /* No effects service: a blink degrades to steady on. */
+        if (level == ALERT_LED_OFF) { led.Off(); } else { led.On(); }
+        return changed;
+    }
 
-    if (active)
+    if (level == ALERT_LED_BLINK)
     {
-        led.On();
+        LedFx_Blink(fx, blinkMs, blinkMs);
+    }
+    else if (level == ALERT_LED_ON)
+    {
+        LedFx_On(fx);
     }
     else
     {
-        led.Off();
+        LedFx_Off(fx);
     }
 
     return changed;
@@ -32,5 +52,10 @@ bool AlertManager::ApplyState(bool nextState)
 
 bool AlertManager::IsActive() const
 {
-    return active;
+    return level != ALERT_LED_OFF;
+}
+
+uint8_t AlertManager::Level() const
+{
+    return level;
 }
@@ -3,19 +3,36 @@
 
 #include <Arduino.h>
 #include "../led/LedDriver.h"
+#include "../led/LedEffects.h"
 
+typedef enum
+{
+    ALERT_LED_OFF = 0,
+    ALERT_LED_ON,
+    ALERT_LED_BLINK
+} AlertLedLevel;
+
+/*
+ * One alert LED. The blinking itself is played by the LedEffects timer,
+ * so callers only state the level; re-applying the current level costs
+ * nothing and does not disturb the blink phase.
+ */
 class AlertManager
 {
 private:
     LedDriver led;
-    bool active;
+    LedFxHandle fx;
+    uint16_t blinkMs;
+    uint8_t level;
 
 public:
-    explicit AlertManager(uint8_t ledPin);
+    explicit AlertManager(uint8_t ledPin, uint16_t blinkHalfPeriodMs = 300u);
 
     void Init();
     bool ApplyState(bool nextState);
+    bool ApplyLevel(uint8_t nextLevel);
     bool IsActive() const;
+    uint8_t Level() const;
 };
 
 #endif
@@ -21,8 +21,8 @@ Lab3Shared g_lab3;
 static NtcAdcDriver      s_ntc(LAB3_NTC_PIN);
 static DhtSensorDriver   s_dht(LAB3_DHT_PIN);
 static SignalConditioner s_conditioner;
-static AlertManager      s_alert(LAB3_ALERT_LED_PIN);
-static AlertManager      s_blueAlert(LAB3_BLUE_LED_PIN);
+static AlertManager      s_alert(LAB3_ALERT_LED_PIN, LAB3_LED_BLINK_MS);
+static AlertManager      s_blueAlert(LAB3_BLUE_LED_PIN, LAB3_LED_BLINK_MS);
 static LiquidCrystal_I2C s_lcd(LAB3_LCD_I2C_ADDR, 16, 2);
 static FILE s_lcdStream;
 static uint8_t s_lcdCol = 0u;
@@ -306,14 +306,20 @@ static void taskConditioning(void *pv)
     }
 }
 
+/* Steady from LAB3_LED_ON_C, blinking from LAB3_LED_BLINK_C; the blink is
+ * played by the LedEffects timer, this task only picks the level. */
+static uint8_t alertLevelFor(bool valid, float tempC)
+{
+    if (!valid) return ALERT_LED_OFF;
+    if (tempC >= LAB3_LED_BLINK_C) return ALERT_LED_BLINK;
+    if (tempC >= LAB3_LED_ON_C) return ALERT_LED_ON;
+    return ALERT_LED_OFF;
+}
+
 static void taskAlerting(void *pv)
 {
     (void)pv;
     TickType_t lastWake = xTaskGetTickCount();
-    static TickType_t redLastBlinkTick = 0;
-    static bool redBlinkState = false;
-    static TickType_t blueLastBlinkTick = 0;
-    static bool blueBlinkState = false;
 
     for (;;)
     {
@@ -331,66 +337,10 @@ static void taskAlerting(void *pv)
             xSemaphoreGive(g_lab3.stateMutex);
         }
 
-        bool desiredRedLedState = false;
-
-        if (!ntcValid)
-        {
-            redBlinkState = false;
-            desiredRedLedState = false;
-        }
-        else if (ntcTemp >= LAB3_LED_BLINK_C)
-        {
-            TickType_t now = xTaskGetTickCount();
-            if ((now - redLastBlinkTick) >= pdMS_TO_TICKS(LAB3_LED_BLINK_MS))
-            {
-                redBlinkState = !redBlinkState;
-                redLastBlinkTick = now;
-            }
-            desiredRedLedState = redBlinkState;
-        }
-        else if (ntcTemp >= LAB3_LED_ON_C)
-        {
-            redBlinkState = true;
-            desiredRedLedState = true;
-        }
-        else
-        {
-            redBlinkState = false;
-            desiredRedLedState = false;
-        }
-
-        s_alert.ApplyState(desiredRedLedState);
-
-        bool desiredLedState = false;
-
-        if (!dhtValid)
-        {
-            blueBlinkState = false;
-            desiredLedState = false;
-        }
-        else if (dhtTemp >= LAB3_LED_BLINK_C)
-        {
-            TickType_t now = xTaskGetTickCount();
-            if ((now - blueLastBlinkTick) >= pdMS_TO_TICKS(LAB3_LED_BLINK_MS))
-            {
-                blueBlinkState = !blueBlinkState;
-                blueLastBlinkTick = now;
-            }
-            desiredLedState = blueBlinkState;
-        }
-        else if (dhtTemp >= LAB3_LED_ON_C)
-        {
-            blueBlinkState = true;
-            desiredLedState = true;
-        }
-        else
-        {
-            blueBlinkState = false;
-            desiredLedState = false;
-        }
+        s_alert.ApplyLevel(alertLevelFor(ntcValid, ntcTemp));
 
         const bool prevLedState = s_blueAlert.IsActive();
-        s_blueAlert.ApplyState(desiredLedState);
+        s_blueAlert.ApplyLevel(alertLevelFor(dhtValid, dhtTemp));
 
         if (xSemaphoreTake(g_lab3.stateMutex, MUTEX_TIMEOUT_TICKS) == pdTRUE)
         {
@@ -0,0 +1,55 @@
+#include "AcqJitter32.h"
+
+#include <string.h>
+
+Lab32JitterStats::Lab32JitterStats()
+{
+    Reset();
+}
+
+void Lab32JitterStats::Reset()
+{
+    memset(&report, 0, sizeof(report));
+    lastWakeUs = 0u;
+    primed = 0u;
+}
+
+void Lab32JitterStats::Record(uint32_t nowUs, TickType_t lateTicks, bool overrun)
+{
+    if (lateTicks != 0u && report.lateWakes < 0xFFFFu) report.lateWakes++;
+    if (overrun && report.overruns < 0xFFFFu) report.overruns++;
+
+    const uint32_t periodUs = nowUs - lastWakeUs;
+    lastWakeUs = nowUs;
+
+    /* First wake has no previous one; the second seeds the mean. */
+    if (primed < 2u)
+    {
+        if (primed == 1u) report.periodUs = periodUs;
+        primed++;
+        return;
+    }
+
+    const int32_t deviation = (int32_t)(periodUs - report.periodUs);
+    report.periodUs = (uint32_t)((int32_t)report.periodUs + deviation / 16);
+
+    const uint32_t jitterUs = (uint32_t)((deviation < 0) ? -deviation : deviation);
+    if (jitterUs > report.maxJitterUs) report.maxJitterUs = jitterUs;
+
+    uint8_t bucket = 0u;
+    uint32_t limitUs = 1000u;
+    while ((bucket < (LAB32_JITTER_BUCKETS - 1u)) && (jitterUs >= limitUs))
+    {
+        bucket++;
+        limitUs <<= 1;
+    }
+    if (report.histogram[bucket] < 0xFFFFu) report.histogram[bucket]++;
+}
+
+void Lab32JitterStats::Snapshot(Lab32JitterReport* out) const
+{
+    /* Record() runs in a higher-priority acquisition task. */
+    taskENTER_CRITICAL();
+    *out = report;
+    taskEXIT_CRITICAL();
+}
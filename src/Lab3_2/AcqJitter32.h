@@ -0,0 +1,39 @@
+#ifndef LAB3_2_ACQ_JITTER32_H
+#define LAB3_2_ACQ_JITTER32_H
+
+#include <Arduino.h>
+#include <Arduino_FreeRTOS.h>
+
+/* Period-jitter buckets, log2 in ms: <1, <2, <4, <8, <16, >=16. */
+#define LAB32_JITTER_BUCKETS 6u
+
+struct Lab32JitterReport
+{
+    uint16_t histogram[LAB32_JITTER_BUCKETS];
+    uint32_t periodUs;      /* running mean of the measured period       */
+    uint32_t maxJitterUs;
+    uint16_t lateWakes;     /* woke one or more ticks after its release   */
+    uint16_t overruns;      /* previous activation ran past this release  */
+};
+
+/*
+ * Activation timing of one periodic acquisition task. Jitter is the
+ * distance of each measured period from the running mean, not from the
+ * configured period: the WDT tick source is only accurate to ~10 %, so a
+ * comparison against the nominal value would show a constant offset.
+ */
+class Lab32JitterStats
+{
+private:
+    Lab32JitterReport report;
+    uint32_t lastWakeUs;
+    uint8_t primed;
+
+public:
+    Lab32JitterStats();
+    void Reset();
+    void Record(uint32_t nowUs, TickType_t lateTicks, bool overrun);
+    void Snapshot(Lab32JitterReport* out) const;
+};
+
+#endif
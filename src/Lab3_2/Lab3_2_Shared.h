@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
 #include <semphr.h>
+#include <queue.h>
+#include <task.h>
 
 #define LAB32_NTC_PIN               A0
 #define LAB32_DHT_PIN               7
@@ -13,14 +15,14 @@
 #define LAB32_LED_NTC_PIN           13
 #define LAB32_LED_DHT_PIN           12
 #define LAB32_LED_US_PIN            11
+#define LAB32_LED_BLINK_MS          300u    /* half period of a critical-level blink */
 
 #define LAB32_LCD_I2C_ADDR          0x27
 
 #define LAB32_DEFAULT_SAMPLE_MS         50u
-#define LAB32_DEFAULT_CONDITION_MS      50u
 #define LAB32_DEFAULT_REPORT_MS         500u
 #define LAB32_DEFAULT_LCD_MS            500u
-#define LAB32_DEFAULT_DHT_MS            2000u
+#define LAB32_DEFAULT_DHT_MS            500u
 #define LAB32_DEFAULT_US_MS             100u
 
 #define LAB32_DEFAULT_ALPHA             0.30f
@@ -33,9 +35,32 @@
 #define LAB32_DEFAULT_US_ALERT_CM       40.0f
 #define LAB32_DEFAULT_US_HYST_CM        4.0f
 
+#define LAB32_JITTER_REPORT_EVERY       10u     /* serial reports per jitter dump */
+
 #define LAB32_MIN_SAMPLE_MS             20u
 #define LAB32_MAX_SAMPLE_MS             100u
 
+/* Raw-sample queue depths. Conditioning is woken per sample, so a queue
+ * only holds more than one item while higher-priority work or the display
+ * printf is hogging the CPU. */
+#define LAB32_NTC_QUEUE_LEN             4u
+#define LAB32_DHT_QUEUE_LEN             2u
+#define LAB32_US_QUEUE_LEN              2u
+
+/* Notification bit of a channel: acquisition -> conditioning, "this
+ * channel's queue has data". One bit per channel, so up to 32 channels. */
+#define LAB32_EVT(ch)                   (1ul << (ch))
+
+/* Channel index into every per-channel array below and into the registry
+ * table in Lab3_2_main.cpp. Adding a sensor = one enum entry + one row. */
+typedef enum
+{
+    LAB32_CH_NTC = 0,
+    LAB32_CH_DHT = 1,
+    LAB32_CH_US = 2,
+    LAB32_CHANNEL_COUNT
+} Lab32Channel;
+
 typedef enum
 {
     LAB32_STATUS_OK = 0,
@@ -46,58 +71,42 @@ typedef enum
 
 typedef struct
 {
-    uint16_t sampleMs;
-    uint16_t conditionMs;
     uint16_t reportMs;
     uint16_t lcdMs;
-    uint16_t dhtMs;
-    uint16_t usMs;
 
     float alpha;
     uint16_t persistenceSamples;
 
-    float ntcThrC;
-    float ntcHystC;
-    float dhtThrC;
-    float dhtHystC;
-    float usAlertCm;
-    float usHystCm;
+    uint16_t periodMs[LAB32_CHANNEL_COUNT];
+    float thr[LAB32_CHANNEL_COUNT];
+    float hyst[LAB32_CHANNEL_COUNT];
 } Lab32Config;
 
+/* Raw sample, one queue per channel (acquisition -> conditioning). `aux`
+ * is the channel's secondary reading (NTC ADC code, DHT humidity). */
+typedef struct
+{
+    float raw;
+    float aux;
+    bool valid;
+    uint8_t dropped;        /* queue-full drops so far (saturating) */
+} Lab32Sample;
+
+/* Struct-of-arrays: one array per quantity, indexed by Lab32Channel. The
+ * conditioning loop walks contiguous floats, and publishing the whole
+ * block is a single memcpy. */
 typedef struct
 {
-    uint32_t sampleIndex;
-    TickType_t timestamp;
-
-    uint16_t ntcRawAdc;
-    float ntcRawTempC;
-    float ntcRawVoltage;
-    bool ntcValid;
-    uint32_t ntcSeq;
-    float ntcClampedC;
-    float ntcMedianC;
-    float ntcFilteredC;
-    bool ntcAlert;
-    uint16_t ntcPending;
-
-    float dhtRawTempC;
-    float dhtRawHumidityPct;
-    bool dhtValid;
-    uint32_t dhtSeq;
-    float dhtClampedC;
-    float dhtMedianC;
-    float dhtFilteredC;
-    bool dhtAlert;
-    uint16_t dhtPending;
-
-    float usRawCm;
-    bool usValid;
-    uint32_t usSeq;
-    float usClampedCm;
-    float usMedianCm;
-    float usFilteredCm;
-    bool usAlert;
-    uint16_t usPending;
+    float raw[LAB32_CHANNEL_COUNT];
+    float aux[LAB32_CHANNEL_COUNT];
+    float clamped[LAB32_CHANNEL_COUNT];
+    float median[LAB32_CHANNEL_COUNT];
+    float filtered[LAB32_CHANNEL_COUNT];
+    uint32_t seq[LAB32_CHANNEL_COUNT];
+    uint16_t pending[LAB32_CHANNEL_COUNT];
+    uint8_t dropped[LAB32_CHANNEL_COUNT];
+    bool valid[LAB32_CHANNEL_COUNT];
+    bool alert[LAB32_CHANNEL_COUNT];
 
     Lab32SystemStatus status;
 } Lab32RuntimeState;
@@ -106,6 +115,8 @@ typedef struct
 {
     SemaphoreHandle_t stateMutex;
     SemaphoreHandle_t ioMutex;
+    QueueHandle_t queue[LAB32_CHANNEL_COUNT];
+    TaskHandle_t conditioningTask;
     Lab32Config config;
     Lab32RuntimeState state;
 } Lab32Shared;
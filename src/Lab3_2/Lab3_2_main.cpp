@@ -1,6 +1,7 @@
 #include "Lab3_2_main.h"
 #include "Lab3_2_Shared.h"
 #include "SignalConditioning32.h"
+#include "AcqJitter32.h"
 
 #include "../Lab3/AlertManager.h"
 #include "../sensor/NtcAdcDriver.h"
@@ -15,6 +16,7 @@
 #include <LiquidCrystal_I2C.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
 #ifndef portMAX_DELAY
 #define portMAX_DELAY ((TickType_t)0xffff)
@@ -26,37 +28,94 @@ static NtcAdcDriver s_ntc(LAB32_NTC_PIN);
 static DhtSensorDriver s_dht(LAB32_DHT_PIN);
 static UltrasonicDriver s_us(LAB32_US_TRIG_PIN, LAB32_US_ECHO_PIN);
 
-static Lab32SignalConditioner s_ntcConditioner;
-static Lab32SignalConditioner s_dhtConditioner;
-static Lab32SignalConditioner s_usConditioner;
-
-static AlertManager s_ntcLed(LAB32_LED_NTC_PIN);
-static AlertManager s_dhtLed(LAB32_LED_DHT_PIN);
-static AlertManager s_usLed(LAB32_LED_US_PIN);
+static bool sensor_read_ntc(float* outTempC, float* outAdc);
+static bool sensor_read_dht(float* outTempC, float* outHumidityPct);
+static bool sensor_read_ultrasonic(float* outDistanceCm, float* outUnused);
+
+/*
+ * Channel registry. One row per sensor, indexed by Lab32Channel; every
+ * task below is a loop over this table, so a new sensor needs a read
+ * function, a row here and its LED in s_leds.
+ *
+ * `alertBelow` flips every comparison: temperatures alert when they rise
+ * to a level, the ultrasonic when the distance drops to it.
+ */
+struct Lab32ChannelDesc
+{
+    const char* name;
+    const char* taskName;
+    bool (*read)(float* outRaw, float* outAux);
+
+    /* acquisition task */
+    uint8_t priority;
+    uint16_t stackWords;
+    uint8_t queueLen;
+    uint16_t defaultPeriodMs;
+    uint16_t minPeriodMs;
+    uint16_t maxPeriodMs;
+
+    /* conditioning + debounced alert */
+    float minValue;
+    float maxValue;
+    float defaultThr;
+    float defaultHyst;
+    float minHyst;
+    bool alertBelow;
+
+    /* LED: steady at ledOnLevel, blinking at critLevel; LCD alert at lcdLevel */
+    float ledOnLevel;
+    float critLevel;
+    float lcdLevel;
+
+    /* serial report */
+    const char* unit;
+    uint8_t decimals;
+    const char* auxLabel;       /* NULL: channel has no aux reading */
+    uint8_t auxDecimals;
+};
+
+/* NTC above everything; the ultrasonic busy-waits up to an echo timeout,
+ * the DHT for a whole transfer, so they sit lower. */
+static const Lab32ChannelDesc LAB32_CHANNELS[LAB32_CHANNEL_COUNT] = {
+    { "NTC", "L32_NTC", sensor_read_ntc,
+      3, 320, LAB32_NTC_QUEUE_LEN, LAB32_DEFAULT_SAMPLE_MS, LAB32_MIN_SAMPLE_MS, LAB32_MAX_SAMPLE_MS,
+      -40.0f, 125.0f, LAB32_DEFAULT_NTC_THR_C, LAB32_DEFAULT_NTC_HYST_C, 0.1f, false,
+      25.0f, 30.0f, 30.0f,
+      "C", 2, "adc", 0 },
+    { "DHT", "L32_DHT", sensor_read_dht,
+      1, 384, LAB32_DHT_QUEUE_LEN, LAB32_DEFAULT_DHT_MS, 400u, 0xFFFFu,
+      -40.0f, 85.0f, LAB32_DEFAULT_DHT_THR_C, LAB32_DEFAULT_DHT_HYST_C, 0.1f, false,
+      25.0f, 30.0f, 30.0f,
+      "C", 2, "hum", 1 },
+    { "US", "L32_US", sensor_read_ultrasonic,
+      2, 320, LAB32_US_QUEUE_LEN, LAB32_DEFAULT_US_MS, 50u, 0xFFFFu,
+      2.0f, 400.0f, LAB32_DEFAULT_US_ALERT_CM, LAB32_DEFAULT_US_HYST_CM, 1.0f, true,
+      50.0f, 10.0f, 50.0f,
+      "cm", 1, NULL, 0 },
+};
+
+/* Same order as LAB32_CHANNELS. */
+static AlertManager s_leds[LAB32_CHANNEL_COUNT] = {
+    AlertManager(LAB32_LED_NTC_PIN, LAB32_LED_BLINK_MS),
+    AlertManager(LAB32_LED_DHT_PIN, LAB32_LED_BLINK_MS),
+    AlertManager(LAB32_LED_US_PIN, LAB32_LED_BLINK_MS),
+};
+
+static Lab32SignalConditioner s_conditioner[LAB32_CHANNEL_COUNT];
+static Lab32JitterStats s_jitter[LAB32_CHANNEL_COUNT];
+static uint8_t s_drops[LAB32_CHANNEL_COUNT];
+
+/* Stage-private state: only taskConditioning touches it. The publish step
+ * copies it into g_lab32.state under the mutex. */
+static Lab32RuntimeState s_stage;
 
 static LiquidCrystal_I2C s_lcd(LAB32_LCD_I2C_ADDR, 16, 2);
 static FILE s_lcdStream;
 static uint8_t s_lcdCol = 0u;
 static uint8_t s_lcdRow = 0u;
 
-static TickType_t s_lastDhtReadTick = 0;
-static TickType_t s_lastUsReadTick = 0;
-static uint32_t s_lastNtcSeq = 0;
-static uint32_t s_lastDhtSeq = 0;
-static uint32_t s_lastUsSeq = 0;
-static bool s_ntcDebouncedAlert = false;
-static bool s_ntcCandidateAlert = false;
-static uint16_t s_ntcPending = 0u;
-static bool s_dhtDebouncedAlert = false;
-static bool s_dhtCandidateAlert = false;
-static uint16_t s_dhtPending = 0u;
-static bool s_usDebouncedAlert = false;
-static bool s_usCandidateAlert = false;
-static uint16_t s_usPending = 0u;
-
 static void taskAcquisition(void *pv);
 static void taskConditioning(void *pv);
-static void taskAlerting(void *pv);
 static void taskDisplay(void *pv);
 static void taskLcdDisplay(void *pv);
 
@@ -117,81 +176,81 @@ static void lcd_printf_lines(const char* line1, const char* line2)
 
 static void loadDefaultConfig(Lab32Config* cfg)
 {
-    cfg->sampleMs = LAB32_DEFAULT_SAMPLE_MS;
-    cfg->conditionMs = LAB32_DEFAULT_CONDITION_MS;
     cfg->reportMs = LAB32_DEFAULT_REPORT_MS;
     cfg->lcdMs = LAB32_DEFAULT_LCD_MS;
-    cfg->dhtMs = 500u;
-    cfg->usMs = LAB32_DEFAULT_US_MS;
     cfg->alpha = LAB32_DEFAULT_ALPHA;
     cfg->persistenceSamples = LAB32_DEFAULT_PERSIST_SAMPLES;
-    cfg->ntcThrC = LAB32_DEFAULT_NTC_THR_C;
-    cfg->ntcHystC = LAB32_DEFAULT_NTC_HYST_C;
-    cfg->dhtThrC = LAB32_DEFAULT_DHT_THR_C;
-    cfg->dhtHystC = LAB32_DEFAULT_DHT_HYST_C;
-    cfg->usAlertCm = LAB32_DEFAULT_US_ALERT_CM;
-    cfg->usHystCm = LAB32_DEFAULT_US_HYST_CM;
+
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
+    {
+        cfg->periodMs[ch] = LAB32_CHANNELS[ch].defaultPeriodMs;
+        cfg->thr[ch] = LAB32_CHANNELS[ch].defaultThr;
+        cfg->hyst[ch] = LAB32_CHANNELS[ch].defaultHyst;
+    }
 }
 
 static void readConfigFromStdio(Lab32Config* cfg)
 {
-    printf("\n[Lab3_2] Enter config:\n");
-    printf(" sampleMs reportMs dhtMs usMs alpha persist ntcThr ntcHyst dhtThr dhtHyst usAlertCm usHystCm\n");
-    printf(" Example: 50 500 500 100 0.30 2 27 1 30 1 40 4\n> ");
-
-    int sampleMs = cfg->sampleMs;
-    int reportMs = cfg->reportMs;
-    int dhtMs = cfg->dhtMs;
-    int usMs = cfg->usMs;
-    float alpha = cfg->alpha;
-    int persist = cfg->persistenceSamples;
-    float ntcThr = cfg->ntcThrC;
-    float ntcHyst = cfg->ntcHystC;
-    float dhtThr = cfg->dhtThrC;
-    float dhtHyst = cfg->dhtHystC;
-    float usAlert = cfg->usAlertCm;
-    float usHyst = cfg->usHystCm;
-
-    const int parsed = scanf("%d %d %d %d %f %d %f %f %f %f %f %f",
-                             &sampleMs, &reportMs, &dhtMs, &usMs,
-                             &alpha, &persist,
-                             &ntcThr, &ntcHyst, &dhtThr, &dhtHyst,
-                             &usAlert, &usHyst);
-
-    if (parsed == 12)
+    char a[12], b[12];
+
+    printf("\n[Lab3_2] Enter config:\n reportMs alpha persist");
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
     {
-        cfg->sampleMs = clampU16(static_cast<uint16_t>(sampleMs), LAB32_MIN_SAMPLE_MS, LAB32_MAX_SAMPLE_MS);
-        cfg->conditionMs = cfg->sampleMs;
-        cfg->reportMs = (reportMs < 200) ? 200u : static_cast<uint16_t>(reportMs);
-        cfg->lcdMs = (cfg->reportMs < 300u) ? 300u : cfg->reportMs;
-        cfg->dhtMs = (dhtMs < 400) ? 400u : static_cast<uint16_t>(dhtMs);
-        cfg->usMs = (usMs < 50) ? 50u : static_cast<uint16_t>(usMs);
-        cfg->alpha = (alpha < 0.01f) ? 0.01f : ((alpha > 1.0f) ? 1.0f : alpha);
-        cfg->persistenceSamples = (persist < 1) ? 1u : static_cast<uint16_t>(persist);
-        cfg->ntcThrC = ntcThr;
-        cfg->ntcHystC = (ntcHyst < 0.1f) ? 0.1f : ntcHyst;
-        cfg->dhtThrC = dhtThr;
-        cfg->dhtHystC = (dhtHyst < 0.1f) ? 0.1f : dhtHyst;
-        cfg->usAlertCm = (usAlert < 5.0f) ? 5.0f : usAlert;
-        cfg->usHystCm = (usHyst < 1.0f) ? 1.0f : usHyst;
-        printf("[Lab3_2] Custom config accepted.\n");
+        printf(" | %s: periodMs thr hyst", LAB32_CHANNELS[ch].name);
     }
-    else
+    printf("\n Example: %u %s %u", cfg->reportMs, fmtFloat(cfg->alpha, 0, 2, a), cfg->persistenceSamples);
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
+    {
+        printf("  %u %s %s", cfg->periodMs[ch],
+               fmtFloat(cfg->thr[ch], 0, 0, a), fmtFloat(cfg->hyst[ch], 0, 0, b));
+    }
+    printf("\n> ");
+
+    /* All or nothing, as before: one unparsable field keeps the defaults. */
+    float values[3u + (3u * LAB32_CHANNEL_COUNT)];
+    uint8_t parsed = 0u;
+    while ((parsed < (sizeof(values) / sizeof(values[0]))) && (scanf("%f", &values[parsed]) == 1))
+    {
+        parsed++;
+    }
+
+    if (parsed != (sizeof(values) / sizeof(values[0])))
     {
         printf("[Lab3_2] Using default config.\n");
+        return;
     }
+
+    const int reportMs = (int)values[0];
+    const float alpha = values[1];
+    const int persist = (int)values[2];
+    cfg->reportMs = (reportMs < 200) ? 200u : static_cast<uint16_t>(reportMs);
+    cfg->lcdMs = (cfg->reportMs < 300u) ? 300u : cfg->reportMs;
+    cfg->alpha = (alpha < 0.01f) ? 0.01f : ((alpha > 1.0f) ? 1.0f : alpha);
+    cfg->persistenceSamples = (persist < 1) ? 1u : static_cast<uint16_t>(persist);
+
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
+    {
+        const Lab32ChannelDesc& d = LAB32_CHANNELS[ch];
+        const float* v = &values[3u + (3u * ch)];
+        const float periodMs = (v[0] < 0.0f) ? 0.0f : ((v[0] > 65535.0f) ? 65535.0f : v[0]);
+
+        cfg->periodMs[ch] = clampU16(static_cast<uint16_t>(periodMs), d.minPeriodMs, d.maxPeriodMs);
+        cfg->thr[ch] = (v[1] < d.minValue) ? d.minValue : ((v[1] > d.maxValue) ? d.maxValue : v[1]);
+        cfg->hyst[ch] = (v[2] < d.minHyst) ? d.minHyst : v[2];
+    }
+    printf("[Lab3_2] Custom config accepted.\n");
 }
 
-static bool sensor_read_ntc(uint16_t* outAdc, float* outVoltage, float* outTempC)
+static bool sensor_read_ntc(float* outTempC, float* outAdc)
 {
-    if ((outAdc == NULL) || (outVoltage == NULL) || (outTempC == NULL))
+    if ((outTempC == NULL) || (outAdc == NULL))
     {
         return false;
     }
 
-    *outAdc = s_ntc.ReadRaw();
-    *outVoltage = s_ntc.RawToVoltage(*outAdc);
-    *outTempC = s_ntc.RawToTemperatureC(*outAdc);
+    const uint16_t adc = s_ntc.ReadRaw();
+    *outAdc = (float)adc;
+    *outTempC = s_ntc.RawToTemperatureC(adc);
     return true;
 }
 
@@ -200,11 +259,108 @@ static bool sensor_read_dht(float* outTempC, float* outHumidityPct)
     return s_dht.Read(outTempC, outHumidityPct);
 }
 
-static bool sensor_read_ultrasonic(float* outDistanceCm)
+static bool sensor_read_ultrasonic(float* outDistanceCm, float* outUnused)
 {
+    *outUnused = 0.0f;
     return s_us.ReadDistanceCm(outDistanceCm);
 }
 
+/* True when `value` is at or past `level` in the channel's alert direction. */
+static bool beyond(uint8_t ch, float value, float level)
+{
+    return LAB32_CHANNELS[ch].alertBelow ? (value <= level) : (value >= level);
+}
+
+/* Level at which a latched alert releases: the threshold moved back by the
+ * hysteresis, away from the alert direction. */
+static float releaseLevel(uint8_t ch)
+{
+    const float thr = g_lab32.config.thr[ch];
+    const float hyst = g_lab32.config.hyst[ch];
+    return LAB32_CHANNELS[ch].alertBelow ? (thr + hyst) : (thr - hyst);
+}
+
+/* Queue a raw sample for the conditioning stage and wake it. A full queue
+ * means conditioning fell behind; the sample is dropped and counted
+ * rather than blocking acquisition. */
+static void pushSample(uint8_t ch, Lab32Sample* sample)
+{
+    sample->dropped = s_drops[ch];
+    if (xQueueSend(g_lab32.queue[ch], sample, 0) != pdTRUE)
+    {
+        if (s_drops[ch] < 0xFFu) { s_drops[ch]++; }
+    }
+    xTaskNotify(g_lab32.conditioningTask, LAB32_EVT(ch), eSetBits);
+}
+
+static void conditionSample(uint8_t ch, const Lab32Sample* in)
+{
+    Lab32RuntimeState* st = &s_stage;
+
+    st->valid[ch] = in->valid;
+    st->dropped[ch] = in->dropped;
+    st->seq[ch]++;
+    if (!in->valid) return;
+
+    st->raw[ch] = in->raw;
+    st->aux[ch] = in->aux;
+
+    const Lab32ConditioningResult c = s_conditioner[ch].Process(in->raw);
+    st->clamped[ch] = c.clampedValue;
+    st->median[ch] = c.medianValue;
+    st->filtered[ch] = c.filteredValue;
+
+    /* Hysteresis, then persistence: the alert flips only after
+     * persistenceSamples consecutive samples agree on the new state. */
+    const bool candidate = st->alert[ch]
+        ? beyond(ch, st->filtered[ch], releaseLevel(ch))
+        : beyond(ch, st->filtered[ch], g_lab32.config.thr[ch]);
+
+    if (candidate != st->alert[ch])
+    {
+        st->pending[ch]++;
+        if (st->pending[ch] >= g_lab32.config.persistenceSamples)
+        {
+            st->alert[ch] = candidate;
+            st->pending[ch] = 0u;
+        }
+    }
+    else
+    {
+        st->pending[ch] = 0u;
+    }
+}
+
+/* LED level of a channel. The LedEffects timer plays the blink, so this
+ * is evaluated once per new sample instead of by a polling task. */
+static uint8_t ledLevelFor(uint8_t ch, const Lab32RuntimeState* st)
+{
+    const Lab32ChannelDesc& d = LAB32_CHANNELS[ch];
+    if (!st->valid[ch]) return ALERT_LED_OFF;
+    if (beyond(ch, st->filtered[ch], d.critLevel)) return ALERT_LED_BLINK;
+    if (beyond(ch, st->filtered[ch], d.ledOnLevel)) return ALERT_LED_ON;
+    return ALERT_LED_OFF;
+}
+
+static Lab32SystemStatus evaluateStatus(const Lab32RuntimeState* st)
+{
+    bool anyInvalid = false;
+    bool anyAlert = false;
+    bool anyWarn = false;
+
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
+    {
+        anyInvalid = anyInvalid || !st->valid[ch];
+        anyAlert = anyAlert || st->alert[ch];
+        anyWarn = anyWarn || beyond(ch, st->filtered[ch], releaseLevel(ch));
+    }
+
+    if (anyInvalid) return LAB32_STATUS_SENSOR_FAULT;
+    if (anyAlert) return LAB32_STATUS_ALERT;
+    if (anyWarn) return LAB32_STATUS_WARN;
+    return LAB32_STATUS_OK;
+}
+
 void lab3_2_setup()
 {
     loadDefaultConfig(&g_lab32.config);
@@ -213,12 +369,11 @@ void lab3_2_setup()
     s_ntc.Init();
     s_dht.Init();
     s_us.Init();
-    s_ntcLed.Init();
-    s_dhtLed.Init();
-    s_usLed.Init();
-    s_ntcLed.ApplyState(false);
-    s_dhtLed.ApplyState(false);
-    s_usLed.ApplyState(false);
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
+    {
+        s_leds[ch].Init();
+        s_leds[ch].ApplyState(false);
+    }
 
     Wire.begin();
     s_lcd.init();
@@ -228,48 +383,42 @@ void lab3_2_setup()
 
     g_lab32.stateMutex = xSemaphoreCreateMutex();
     g_lab32.ioMutex = xSemaphoreCreateMutex();
-    if ((g_lab32.stateMutex == NULL) || (g_lab32.ioMutex == NULL))
+    bool created = (g_lab32.stateMutex != NULL) && (g_lab32.ioMutex != NULL);
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
     {
-        printf("[Lab3_2] FATAL: mutex creation failed.\n");
+        g_lab32.queue[ch] = xQueueCreate(LAB32_CHANNELS[ch].queueLen, sizeof(Lab32Sample));
+        created = created && (g_lab32.queue[ch] != NULL);
+    }
+    if (!created)
+    {
+        printf("[Lab3_2] FATAL: RTOS object creation failed.\n");
         for (;;) {}
     }
 
-    g_lab32.state.sampleIndex = 0;
-    g_lab32.state.ntcValid = false;
-    g_lab32.state.dhtValid = false;
-    g_lab32.state.usValid = false;
-    g_lab32.state.status = LAB32_STATUS_SENSOR_FAULT;
-
-    s_lastDhtReadTick = xTaskGetTickCount() - pdMS_TO_TICKS(g_lab32.config.dhtMs);
-    s_lastUsReadTick = xTaskGetTickCount() - pdMS_TO_TICKS(g_lab32.config.usMs);
-
-    Lab32ConditioningConfig ntcCfg{};
-    ntcCfg.alpha = g_lab32.config.alpha;
-    ntcCfg.minValue = -40.0f;
-    ntcCfg.maxValue = 125.0f;
-    s_ntcConditioner.Configure(ntcCfg);
-
-    Lab32ConditioningConfig dhtCfg{};
-    dhtCfg.alpha = g_lab32.config.alpha;
-    dhtCfg.minValue = -40.0f;
-    dhtCfg.maxValue = 85.0f;
-    s_dhtConditioner.Configure(dhtCfg);
-
-    Lab32ConditioningConfig usCfg{};
-    usCfg.alpha = g_lab32.config.alpha;
-    usCfg.minValue = 2.0f;
-    usCfg.maxValue = 400.0f;
-    s_usConditioner.Configure(usCfg);
+    memset(&s_stage, 0, sizeof(s_stage));
+    s_stage.status = LAB32_STATUS_SENSOR_FAULT;
+    g_lab32.state = s_stage;
+
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
+    {
+        Lab32ConditioningConfig cfg{};
+        cfg.alpha = g_lab32.config.alpha;
+        cfg.minValue = LAB32_CHANNELS[ch].minValue;
+        cfg.maxValue = LAB32_CHANNELS[ch].maxValue;
+        s_conditioner[ch].Configure(cfg);
+    }
 
     printf("[Lab3_2] FreeRTOS monitoring start\n");
 
     BaseType_t ok;
-    ok = xTaskCreate(taskAcquisition, "L32_Acq", 768, (void*)0, 3, (TaskHandle_t*)0);
-    if (ok != pdPASS) { printf("[Lab3_2] FAIL taskAcquisition\n"); for (;;) {} }
-    ok = xTaskCreate(taskConditioning, "L32_Cond", 768, (void*)0, 2, (TaskHandle_t*)0);
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
+    {
+        const Lab32ChannelDesc& d = LAB32_CHANNELS[ch];
+        ok = xTaskCreate(taskAcquisition, d.taskName, d.stackWords, (void*)(uintptr_t)ch, d.priority, (TaskHandle_t*)0);
+        if (ok != pdPASS) { printf("[Lab3_2] FAIL taskAcquisition %s\n", d.name); for (;;) {} }
+    }
+    ok = xTaskCreate(taskConditioning, "L32_Cond", 768, (void*)0, 2, &g_lab32.conditioningTask);
     if (ok != pdPASS) { printf("[Lab3_2] FAIL taskConditioning\n"); for (;;) {} }
-    ok = xTaskCreate(taskAlerting, "L32_Alert", 320, (void*)0, 2, (TaskHandle_t*)0);
-    if (ok != pdPASS) { printf("[Lab3_2] FAIL taskAlerting\n"); for (;;) {} }
     ok = xTaskCreate(taskDisplay, "L32_Disp", 896, (void*)0, 1, (TaskHandle_t*)0);
     if (ok != pdPASS) { printf("[Lab3_2] FAIL taskDisplay\n"); for (;;) {} }
     ok = xTaskCreate(taskLcdDisplay, "L32_LCD", 512, (void*)0, 1, (TaskHandle_t*)0);
@@ -282,335 +431,72 @@ void lab3_2_loop()
 
 static void taskAcquisition(void *pv)
 {
-    (void)pv;
+    const uint8_t ch = (uint8_t)(uintptr_t)pv;
+    const TickType_t period = pdMS_TO_TICKS(g_lab32.config.periodMs[ch]);
     TickType_t lastWake = xTaskGetTickCount();
 
     for (;;)
     {
-        uint16_t adc = 0u;
-        float voltage = 0.0f;
-        float ntcTemp = 0.0f;
-        const bool ntcOk = sensor_read_ntc(&adc, &voltage, &ntcTemp);
-
-        float dhtTemp = 0.0f;
-        float dhtHum = 0.0f;
-        bool dhtUpdated = false;
-        bool dhtOk = false;
-
-        const TickType_t nowTick = xTaskGetTickCount();
-        if ((nowTick - s_lastDhtReadTick) >= pdMS_TO_TICKS(g_lab32.config.dhtMs))
-        {
-            dhtOk = sensor_read_dht(&dhtTemp, &dhtHum);
-            dhtUpdated = true;
-            s_lastDhtReadTick = nowTick;
-        }
-
-        float usCm = 0.0f;
-        bool usUpdated = false;
-        bool usOk = false;
-        if ((nowTick - s_lastUsReadTick) >= pdMS_TO_TICKS(g_lab32.config.usMs))
-        {
-            usOk = sensor_read_ultrasonic(&usCm);
-            usUpdated = true;
-            s_lastUsReadTick = nowTick;
-        }
-
-        if (xSemaphoreTake(g_lab32.stateMutex, pdMS_TO_TICKS(20)) == pdTRUE)
-        {
-            g_lab32.state.sampleIndex++;
-            g_lab32.state.timestamp = nowTick;
-
-            g_lab32.state.ntcRawAdc = adc;
-            g_lab32.state.ntcRawVoltage = voltage;
-            g_lab32.state.ntcRawTempC = ntcTemp;
-            g_lab32.state.ntcValid = ntcOk;
-            g_lab32.state.ntcSeq++;
-
-            if (dhtUpdated)
-            {
-                g_lab32.state.dhtValid = dhtOk;
-                if (dhtOk)
-                {
-                    g_lab32.state.dhtRawTempC = dhtTemp;
-                    g_lab32.state.dhtRawHumidityPct = dhtHum;
-                }
-                g_lab32.state.dhtSeq++;
-            }
-
-            if (usUpdated)
-            {
-                g_lab32.state.usValid = usOk;
-                if (usOk)
-                {
-                    g_lab32.state.usRawCm = usCm;
-                }
-                g_lab32.state.usSeq++;
-            }
-
-            xSemaphoreGive(g_lab32.stateMutex);
-        }
-
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab32.config.sampleMs));
+        Lab32Sample sample;
+        sample.valid = LAB32_CHANNELS[ch].read(&sample.raw, &sample.aux);
+        pushSample(ch, &sample);
+
+        /* pdFALSE: the release was already in the past, i.e. the previous
+         * activation overran its period. lastWake is the release tick, so
+         * any difference to "now" is scheduling lateness. */
+        const bool onTime = (xTaskDelayUntil(&lastWake, period) == pdTRUE);
+        s_jitter[ch].Record(micros(), xTaskGetTickCount() - lastWake, !onTime);
     }
 }
 
-static void taskConditioning(void *pv)
+static void printJitterReport(void)
 {
-    (void)pv;
-    TickType_t lastWake = xTaskGetTickCount();
-
-    for (;;)
+    for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
     {
-        if (xSemaphoreTake(g_lab32.stateMutex, pdMS_TO_TICKS(20)) == pdTRUE)
-        {
-            if ((g_lab32.state.ntcSeq != s_lastNtcSeq) && g_lab32.state.ntcValid)
-            {
-                const Lab32ConditioningResult c = s_ntcConditioner.Process(g_lab32.state.ntcRawTempC);
-                g_lab32.state.ntcClampedC = c.clampedValue;
-                g_lab32.state.ntcMedianC = c.medianValue;
-                g_lab32.state.ntcFilteredC = c.filteredValue;
-
-                if (s_ntcDebouncedAlert)
-                {
-                    s_ntcCandidateAlert = (g_lab32.state.ntcFilteredC >= (g_lab32.config.ntcThrC - g_lab32.config.ntcHystC));
-                }
-                else
-                {
-                    s_ntcCandidateAlert = (g_lab32.state.ntcFilteredC >= g_lab32.config.ntcThrC);
-                }
-
-                if (s_ntcCandidateAlert != s_ntcDebouncedAlert)
-                {
-                    s_ntcPending++;
-                    if (s_ntcPending >= g_lab32.config.persistenceSamples)
-                    {
-                        s_ntcDebouncedAlert = s_ntcCandidateAlert;
-                        s_ntcPending = 0u;
-                    }
-                }
-                else
-                {
-                    s_ntcPending = 0u;
-                }
-
-                g_lab32.state.ntcAlert = s_ntcDebouncedAlert;
-                g_lab32.state.ntcPending = s_ntcPending;
-                s_lastNtcSeq = g_lab32.state.ntcSeq;
-            }
-
-            if ((g_lab32.state.dhtSeq != s_lastDhtSeq) && g_lab32.state.dhtValid)
-            {
-                const Lab32ConditioningResult c = s_dhtConditioner.Process(g_lab32.state.dhtRawTempC);
-                g_lab32.state.dhtClampedC = c.clampedValue;
-                g_lab32.state.dhtMedianC = c.medianValue;
-                g_lab32.state.dhtFilteredC = c.filteredValue;
-
-                if (s_dhtDebouncedAlert)
-                {
-                    s_dhtCandidateAlert = (g_lab32.state.dhtFilteredC >= (g_lab32.config.dhtThrC - g_lab32.config.dhtHystC));
-                }
-                else
-                {
-                    s_dhtCandidateAlert = (g_lab32.state.dhtFilteredC >= g_lab32.config.dhtThrC);
-                }
-
-                if (s_dhtCandidateAlert != s_dhtDebouncedAlert)
-                {
-                    s_dhtPending++;
-                    if (s_dhtPending >= g_lab32.config.persistenceSamples)
-                    {
-                        s_dhtDebouncedAlert = s_dhtCandidateAlert;
-                        s_dhtPending = 0u;
-                    }
-                }
-                else
-                {
-                    s_dhtPending = 0u;
-                }
-
-                g_lab32.state.dhtAlert = s_dhtDebouncedAlert;
-                g_lab32.state.dhtPending = s_dhtPending;
-                s_lastDhtSeq = g_lab32.state.dhtSeq;
-            }
-
-            if ((g_lab32.state.usSeq != s_lastUsSeq) && g_lab32.state.usValid)
-            {
-                const Lab32ConditioningResult c = s_usConditioner.Process(g_lab32.state.usRawCm);
-                g_lab32.state.usClampedCm = c.clampedValue;
-                g_lab32.state.usMedianCm = c.medianValue;
-                g_lab32.state.usFilteredCm = c.filteredValue;
-
-                if (s_usDebouncedAlert)
-                {
-                    s_usCandidateAlert = (g_lab32.state.usFilteredCm <= (g_lab32.config.usAlertCm + g_lab32.config.usHystCm));
-                }
-                else
-                {
-                    s_usCandidateAlert = (g_lab32.state.usFilteredCm <= g_lab32.config.usAlertCm);
-                }
-
-                if (s_usCandidateAlert != s_usDebouncedAlert)
-                {
-                    s_usPending++;
-                    if (s_usPending >= g_lab32.config.persistenceSamples)
-                    {
-                        s_usDebouncedAlert = s_usCandidateAlert;
-                        s_usPending = 0u;
-                    }
-                }
-                else
-                {
-                    s_usPending = 0u;
-                }
-
-                g_lab32.state.usAlert = s_usDebouncedAlert;
-                g_lab32.state.usPending = s_usPending;
-                s_lastUsSeq = g_lab32.state.usSeq;
-            }
-
-            if (!g_lab32.state.ntcValid || !g_lab32.state.dhtValid || !g_lab32.state.usValid)
-            {
-                g_lab32.state.status = LAB32_STATUS_SENSOR_FAULT;
-            }
-            else if (g_lab32.state.ntcAlert || g_lab32.state.dhtAlert || g_lab32.state.usAlert)
-            {
-                g_lab32.state.status = LAB32_STATUS_ALERT;
-            }
-            else if ((g_lab32.state.ntcFilteredC >= (g_lab32.config.ntcThrC - g_lab32.config.ntcHystC))
-                     || (g_lab32.state.dhtFilteredC >= (g_lab32.config.dhtThrC - g_lab32.config.dhtHystC))
-                     || (g_lab32.state.usFilteredCm <= (g_lab32.config.usAlertCm + g_lab32.config.usHystCm)))
-            {
-                g_lab32.state.status = LAB32_STATUS_WARN;
-            }
-            else
-            {
-                g_lab32.state.status = LAB32_STATUS_OK;
-            }
-
-            xSemaphoreGive(g_lab32.stateMutex);
-        }
-
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab32.config.conditionMs));
+        Lab32JitterReport r;
+        s_jitter[ch].Snapshot(&r);
+        printf("[L3_2][JIT][%s] T=%luus |<1ms:%u <2:%u <4:%u <8:%u <16:%u >=16:%u| max=%luus late=%u ovr=%u\r\n",
+               LAB32_CHANNELS[ch].name,
+               (unsigned long)r.periodUs,
+               r.histogram[0], r.histogram[1], r.histogram[2],
+               r.histogram[3], r.histogram[4], r.histogram[5],
+               (unsigned long)r.maxJitterUs,
+               r.lateWakes,
+               r.overruns);
     }
 }
 
-static void taskAlerting(void *pv)
+static void taskConditioning(void *pv)
 {
     (void)pv;
-    TickType_t lastWake = xTaskGetTickCount();
-    static TickType_t redLastBlinkTick = 0;
-    static TickType_t blueLastBlinkTick = 0;
-    static TickType_t yellowLastBlinkTick = 0;
-    static bool redBlinkState = false;
-    static bool blueBlinkState = false;
-    static bool yellowBlinkState = false;
-    const TickType_t blinkPeriod = pdMS_TO_TICKS(300);
 
     for (;;)
     {
-        bool ntcValid = false;
-        bool dhtValid = false;
-        bool usValid = false;
-        float ntcTempC = 0.0f;
-        float dhtTempC = 0.0f;
-        float usDistanceCm = 0.0f;
+        /* Sleeps until acquisition queued something: no polling tick, and
+         * only channels that actually produced a sample are processed. */
+        uint32_t events = 0u;
+        xTaskNotifyWait(0u, 0xFFFFFFFFul, &events, portMAX_DELAY);
 
-        if (xSemaphoreTake(g_lab32.stateMutex, pdMS_TO_TICKS(20)) == pdTRUE)
+        for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
         {
-            ntcValid = g_lab32.state.ntcValid;
-            dhtValid = g_lab32.state.dhtValid;
-            usValid = g_lab32.state.usValid;
-            ntcTempC = g_lab32.state.ntcFilteredC;
-            dhtTempC = g_lab32.state.dhtFilteredC;
-            usDistanceCm = g_lab32.state.usFilteredCm;
-            xSemaphoreGive(g_lab32.stateMutex);
-        }
-
-        bool redDesired = false;
-        bool blueDesired = false;
-        bool yellowDesired = false;
-        const TickType_t now = xTaskGetTickCount();
+            if ((events & LAB32_EVT(ch)) == 0u) continue;
 
-        if (!ntcValid)
-        {
-            redBlinkState = false;
-            redDesired = false;
-        }
-        else if (ntcTempC >= 30.0f)
-        {
-            if ((now - redLastBlinkTick) >= blinkPeriod)
+            Lab32Sample sample;
+            while (xQueueReceive(g_lab32.queue[ch], &sample, 0) == pdTRUE)
             {
-                redBlinkState = !redBlinkState;
-                redLastBlinkTick = now;
+                conditionSample(ch, &sample);
             }
-            redDesired = redBlinkState;
-        }
-        else if (ntcTempC >= 25.0f)
-        {
-            redBlinkState = true;
-            redDesired = true;
-        }
-        else
-        {
-            redBlinkState = false;
-            redDesired = false;
+            s_leds[ch].ApplyLevel(ledLevelFor(ch, &s_stage));
         }
 
-        if (!dhtValid)
-        {
-            blueBlinkState = false;
-            blueDesired = false;
-        }
-        else if (dhtTempC >= 30.0f)
-        {
-            if ((now - blueLastBlinkTick) >= blinkPeriod)
-            {
-                blueBlinkState = !blueBlinkState;
-                blueLastBlinkTick = now;
-            }
-            blueDesired = blueBlinkState;
-        }
-        else if (dhtTempC >= 25.0f)
-        {
-            blueBlinkState = true;
-            blueDesired = true;
-        }
-        else
-        {
-            blueBlinkState = false;
-            blueDesired = false;
-        }
+        s_stage.status = evaluateStatus(&s_stage);
 
-        if (!usValid)
-        {
-            yellowBlinkState = false;
-            yellowDesired = false;
-        }
-        else if (usDistanceCm < 10.0f)
-        {
-            if ((now - yellowLastBlinkTick) >= blinkPeriod)
-            {
-                yellowBlinkState = !yellowBlinkState;
-                yellowLastBlinkTick = now;
-            }
-            yellowDesired = yellowBlinkState;
-        }
-        else if (usDistanceCm < 50.0f)
-        {
-            yellowBlinkState = true;
-            yellowDesired = true;
-        }
-        else
+        /* Publish: the only part that holds the state mutex. */
+        if (xSemaphoreTake(g_lab32.stateMutex, pdMS_TO_TICKS(20)) == pdTRUE)
         {
-            yellowBlinkState = false;
-            yellowDesired = false;
+            g_lab32.state = s_stage;
+            xSemaphoreGive(g_lab32.stateMutex);
         }
-
-        s_ntcLed.ApplyState(redDesired);
-        s_dhtLed.ApplyState(blueDesired);
-        s_usLed.ApplyState(yellowDesired);
-
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(50));
     }
 }
 
@@ -618,6 +504,7 @@ static void taskDisplay(void *pv)
 {
     (void)pv;
     TickType_t lastWake = xTaskGetTickCount();
+    uint8_t reportsSinceJitter = 0u;
 
     for (;;)
     {
@@ -635,33 +522,34 @@ static void taskDisplay(void *pv)
             else if (snap.status == LAB32_STATUS_ALERT) statusName = "ALERT";
             else if (snap.status == LAB32_STATUS_SENSOR_FAULT) statusName = "SENSOR_FAULT";
 
-            char ntcRaw[16], ntcM[16], ntcF[16], dhtRaw[16], dhtH[16], dhtF[16], usRaw[16], usF[16];
-
-            printf("[L3_2][NTC] i=%lu v=%s adc=%u raw=%sC med=%sC filt=%sC alert=%u p=%u\r\n",
-                   (unsigned long)snap.sampleIndex,
-                   snap.ntcValid ? "OK" : "WAIT",
-                   snap.ntcRawAdc,
-                   fmtFloat(snap.ntcRawTempC, 0, 2, ntcRaw),
-                   fmtFloat(snap.ntcMedianC, 0, 2, ntcM),
-                   fmtFloat(snap.ntcFilteredC, 0, 2, ntcF),
-                   snap.ntcAlert ? 1u : 0u,
-                   snap.ntcPending);
-
-            printf("[L3_2][DHT] v=%s raw=%sC hum=%s%% filt=%sC alert=%u p=%u\r\n",
-                   snap.dhtValid ? "OK" : "WAIT",
-                   fmtFloat(snap.dhtRawTempC, 0, 2, dhtRaw),
-                   fmtFloat(snap.dhtRawHumidityPct, 0, 1, dhtH),
-                   fmtFloat(snap.dhtFilteredC, 0, 2, dhtF),
-                   snap.dhtAlert ? 1u : 0u,
-                   snap.dhtPending);
-
-            printf("[L3_2][US ] v=%s raw=%scm filt=%scm alert=%u p=%u status=%s\r\n",
-                   snap.usValid ? "OK" : "WAIT",
-                   fmtFloat(snap.usRawCm, 0, 1, usRaw),
-                   fmtFloat(snap.usFilteredCm, 0, 1, usF),
-                   snap.usAlert ? 1u : 0u,
-                   snap.usPending,
-                   statusName);
+            for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
+            {
+                const Lab32ChannelDesc& d = LAB32_CHANNELS[ch];
+                char raw[16], med[16], filt[16], aux[16];
+
+                printf("[L3_2][%s] n=%lu v=%s raw=%s%s med=%s%s filt=%s%s alert=%u p=%u drop=%u",
+                       d.name,
+                       (unsigned long)snap.seq[ch],
+                       snap.valid[ch] ? "OK" : "WAIT",
+                       fmtFloat(snap.raw[ch], 0, d.decimals, raw), d.unit,
+                       fmtFloat(snap.median[ch], 0, d.decimals, med), d.unit,
+                       fmtFloat(snap.filtered[ch], 0, d.decimals, filt), d.unit,
+                       snap.alert[ch] ? 1u : 0u,
+                       snap.pending[ch],
+                       snap.dropped[ch]);
+                if (d.auxLabel != NULL)
+                {
+                    printf(" %s=%s", d.auxLabel, fmtFloat(snap.aux[ch], 0, d.auxDecimals, aux));
+                }
+                printf("\r\n");
+            }
+            printf("[L3_2] status=%s\r\n", statusName);
+
+            if (++reportsSinceJitter >= LAB32_JITTER_REPORT_EVERY)
+            {
+                reportsSinceJitter = 0u;
+                printJitterReport();
+            }
 
             xSemaphoreGive(g_lab32.ioMutex);
         }
@@ -674,9 +562,6 @@ static void taskLcdDisplay(void *pv)
 {
     (void)pv;
     TickType_t lastWake = xTaskGetTickCount();
-    const float lcdTempAlertC = 30.0f;
-    const float lcdUsAlertCm = 50.0f;
-    const float lcdUsCriticalCm = 10.0f;
 
     for (;;)
     {
@@ -689,50 +574,39 @@ static void taskLcdDisplay(void *pv)
 
         char line1[17] = {0};
         char line2[17] = {0};
+        int8_t firstAlert = -1;
+        int8_t firstCritical = -1;
 
-        const bool ntcHigh = snap.ntcValid && (snap.ntcFilteredC >= lcdTempAlertC);
-        const bool dhtHigh = snap.dhtValid && (snap.dhtFilteredC >= lcdTempAlertC);
-        const bool usCritical = snap.usValid && (snap.usFilteredCm < lcdUsCriticalCm);
-        const bool usNear = snap.usValid && (snap.usFilteredCm < lcdUsAlertCm);
-        const bool hasAlert = ntcHigh || dhtHigh || usNear;
-
-        if (hasAlert)
+        /* line 1 lists every channel past its LCD level ("ALERT NTC+DHT"),
+         * line 2 names the first critical one, else asks for a check. */
+        size_t len = (size_t)snprintf(line1, sizeof(line1), "ALERT");
+        for (uint8_t ch = 0u; ch < LAB32_CHANNEL_COUNT; ch++)
         {
-            if (ntcHigh && dhtHigh)
-            {
-                snprintf(line1, sizeof(line1), "ALERT NTC+DHT");
-            }
-            else if (ntcHigh)
-            {
-                snprintf(line1, sizeof(line1), "ALERT NTC >30C");
-            }
-            else if (dhtHigh)
-            {
-                snprintf(line1, sizeof(line1), "ALERT DHT >30C");
-            }
-            else
-            {
-                snprintf(line1, sizeof(line1), "ALERT ULTRASONIC");
-            }
+            const Lab32ChannelDesc& d = LAB32_CHANNELS[ch];
+            if (!snap.valid[ch] || !beyond(ch, snap.filtered[ch], d.lcdLevel)) continue;
 
-            if (usCritical)
-            {
-                snprintf(line2, sizeof(line2), "US CRITICAL <10cm");
-            }
-            else if (usNear)
+            if (len < (sizeof(line1) - 1u))
             {
-                snprintf(line2, sizeof(line2), "OBJECT NEARBY");
-            }
-            else
-            {
-                snprintf(line2, sizeof(line2), "CHECK TEMPERATURE");
+                len += (size_t)snprintf(&line1[len], sizeof(line1) - len, "%c%s",
+                                        (firstAlert < 0) ? ' ' : '+', d.name);
             }
+            if (firstAlert < 0) firstAlert = (int8_t)ch;
+            if ((firstCritical < 0) && beyond(ch, snap.filtered[ch], d.critLevel)) firstCritical = (int8_t)ch;
         }
-        else
+
+        if (firstAlert < 0)
         {
             snprintf(line1, sizeof(line1), "SYSTEM NORMAL");
             snprintf(line2, sizeof(line2), "NO ACTIVE ALERT");
         }
+        else if (firstCritical >= 0)
+        {
+            snprintf(line2, sizeof(line2), "%s CRITICAL", LAB32_CHANNELS[firstCritical].name);
+        }
+        else
+        {
+            snprintf(line2, sizeof(line2), "CHECK %s", LAB32_CHANNELS[firstAlert].name);
+        }
 
         lcd_printf_lines(line1, line2);
 
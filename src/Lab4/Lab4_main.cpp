@@ -4,6 +4,7 @@
 #include "srv_motor_control.h"
 
 #include "../drivers/SerialStdioDriver.h"
+#include "../cli/CommandLine.h"
 #include "../led/LedDriver.h"
 
 #include <Arduino.h>
@@ -62,6 +63,132 @@ static void lcd_print_state(const Lab4RuntimeState* state)
     s_lcd.print(line2);
 }
 
+// Serial commands (shared CLI). Handlers run under stateMutex; the replies
+// are printed afterwards from applyCommandEffects() under ioMutex.
+
+#define LAB4_FX_NONE        0x00u
+#define LAB4_FX_REPLY_ON    0x01u
+#define LAB4_FX_REPLY_OFF   0x02u
+#define LAB4_FX_REPLY_TIME  0x04u
+
+static unsigned long s_timeLastMs = 0;
+static unsigned long s_timeTotalMs = 0;
+static unsigned long s_timeCurrentMs = 0;
+
+static uint8_t cmdOff(const CliArg* arg)
+{
+    (void)arg;  // only target: relay
+    if ((g_lab4.state.cmdRelayState == HIGH) && g_lab4.state.fanIsOn)
+    {
+        const unsigned long nowMs = millis();
+        const unsigned long elapsedMs = nowMs - g_lab4.state.fanOnStartMs;
+        g_lab4.state.fanLastOnDurationMs = elapsedMs;
+        g_lab4.state.fanTotalOnMs += elapsedMs;
+        g_lab4.state.fanIsOn = false;
+    }
+    g_lab4.state.cmdRelayState = LOW;
+    g_lab4.state.cmdMotorPct = 0.0f;
+    g_lab4.state.lastCommandMs = millis();
+    g_lab4.state.cmdSeq++;
+    return LAB4_FX_REPLY_OFF;
+}
+
+static uint8_t cmdOn(const CliArg* arg)
+{
+    (void)arg;  // only target: relay
+    if (g_lab4.state.cmdRelayState == LOW)
+    {
+        g_lab4.state.fanOnStartMs = millis();
+        g_lab4.state.fanIsOn = true;
+    }
+    g_lab4.state.cmdRelayState = HIGH;
+    g_lab4.state.cmdMotorPct = 100.0f;
+    g_lab4.state.lastCommandMs = millis();
+    g_lab4.state.cmdSeq++;
+    return LAB4_FX_REPLY_ON;
+}
+
+static uint8_t cmdTime(const CliArg* arg)
+{
+    (void)arg;  // only target: fan
+    s_timeLastMs = g_lab4.state.fanLastOnDurationMs;
+    s_timeTotalMs = g_lab4.state.fanTotalOnMs;
+    s_timeCurrentMs = g_lab4.state.fanIsOn ? (millis() - g_lab4.state.fanOnStartMs) : 0UL;
+    return LAB4_FX_REPLY_TIME;
+}
+
+static const CliCommand LAB4_COMMANDS[] PROGMEM = {
+    { "off",  CLI_ARG_WORD, 0.0f, 0.0f, "relay", cmdOff,  "relay + fan off" },
+    { "on",   CLI_ARG_WORD, 0.0f, 0.0f, "relay", cmdOn,   "relay + fan on" },
+    { "time", CLI_ARG_WORD, 0.0f, 0.0f, "fan",   cmdTime, "fan on-time: last, current, total" }
+};
+
+static bool cliLockState(void)
+{
+    return xSemaphoreTake(g_lab4.stateMutex, pdMS_TO_TICKS(20)) == pdTRUE;
+}
+
+static void cliUnlockState(void)
+{
+    xSemaphoreGive(g_lab4.stateMutex);
+}
+
+static bool cliLockIo(void)
+{
+    return xSemaphoreTake(g_lab4.ioMutex, pdMS_TO_TICKS(20)) == pdTRUE;
+}
+
+static void cliUnlockIo(void)
+{
+    xSemaphoreGive(g_lab4.ioMutex);
+}
+
+static void applyCommandEffects(uint8_t fx, const CliArg* arg)
+{
+    (void)arg;
+    if (fx == LAB4_FX_NONE) { return; }
+    if (!cliLockIo()) { return; }
+
+    if (fx & LAB4_FX_REPLY_ON)
+    {
+        printf("on relay command detected. Response of the actuators: relay=ON, fan=ON\n");
+    }
+    if (fx & LAB4_FX_REPLY_OFF)
+    {
+        printf("off relay command detected. Response of the actuators: relay=OFF, fan=OFF\n");
+    }
+    if (fx & LAB4_FX_REPLY_TIME)
+    {
+        printf("time fan command detected. Response: last_on=%lu ms, current_on=%lu ms, total_on=%lu ms\n",
+               s_timeLastMs,
+               s_timeCurrentMs,
+               s_timeTotalMs + s_timeCurrentMs);
+    }
+    cliUnlockIo();
+}
+
+static void countInvalidCommand(void)
+{
+    if (cliLockState())
+    {
+        g_lab4.state.invalidCommandCount++;
+        cliUnlockState();
+    }
+}
+
+static const CliConfig LAB4_CLI = {
+    LAB4_COMMANDS,
+    sizeof(LAB4_COMMANDS) / sizeof(LAB4_COMMANDS[0]),
+    0u,
+    NULL,
+    cliLockState,
+    cliUnlockState,
+    cliLockIo,
+    cliUnlockIo,
+    applyCommandEffects,
+    countInvalidCommand
+};
+
 void lab4_setup()
 {
     SerialStdioInit(9600);
@@ -102,6 +229,8 @@ void lab4_setup()
     s_lcd.setCursor(0, 1);
     s_lcd.print("Init...");
 
+    Cli_Register(&LAB4_CLI);
+
     s_greenLed.Init();
     s_redLed.Init();
     s_greenLed.Off();
@@ -144,111 +273,7 @@ static void taskCommand(void* pv)
 
     for (;;)
     {
-        char line[48] = {0};
-        if (scanf(" %47[^\r\n]", line) == 1)
-        {
-            char action[20] = {0};
-            char target[20] = {0};
-            const int tokens = sscanf(line, "%19s %19s", action, target);
-
-            bool known = true;
-
-            if ((tokens >= 2) &&
-                ((strcmp(action, "on") == 0) || (strcmp(action, "ON") == 0)) &&
-                ((strcmp(target, "relay") == 0) || (strcmp(target, "RELAY") == 0)))
-            {
-                if (xSemaphoreTake(g_lab4.stateMutex, pdMS_TO_TICKS(20)) == pdTRUE)
-                {
-                    if (g_lab4.state.cmdRelayState == LOW)
-                    {
-                        g_lab4.state.fanOnStartMs = millis();
-                        g_lab4.state.fanIsOn = true;
-                    }
-                    g_lab4.state.cmdRelayState = HIGH;
-                    g_lab4.state.cmdMotorPct = 100.0f;
-                    g_lab4.state.lastCommandMs = millis();
-                    g_lab4.state.cmdSeq++;
-                    xSemaphoreGive(g_lab4.stateMutex);
-                }
-
-                if (xSemaphoreTake(g_lab4.ioMutex, pdMS_TO_TICKS(20)) == pdTRUE)
-                {
-                    printf("on relay command detected. Response of the actuators: relay=ON, fan=ON\n");
-                    xSemaphoreGive(g_lab4.ioMutex);
-                }
-            }
-            else if ((tokens >= 2) &&
-                     ((strcmp(action, "off") == 0) || (strcmp(action, "OFF") == 0)) &&
-                     ((strcmp(target, "relay") == 0) || (strcmp(target, "RELAY") == 0)))
-            {
-                if (xSemaphoreTake(g_lab4.stateMutex, pdMS_TO_TICKS(20)) == pdTRUE)
-                {
-                    if ((g_lab4.state.cmdRelayState == HIGH) && g_lab4.state.fanIsOn)
-                    {
-                        const unsigned long nowMs = millis();
-                        const unsigned long elapsedMs = nowMs - g_lab4.state.fanOnStartMs;
-                        g_lab4.state.fanLastOnDurationMs = elapsedMs;
-                        g_lab4.state.fanTotalOnMs += elapsedMs;
-                        g_lab4.state.fanIsOn = false;
-                    }
-                    g_lab4.state.cmdRelayState = LOW;
-                    g_lab4.state.cmdMotorPct = 0.0f;
-                    g_lab4.state.lastCommandMs = millis();
-                    g_lab4.state.cmdSeq++;
-                    xSemaphoreGive(g_lab4.stateMutex);
-                }
-
-                if (xSemaphoreTake(g_lab4.ioMutex, pdMS_TO_TICKS(20)) == pdTRUE)
-                {
-                    printf("off relay command detected. Response of the actuators: relay=OFF, fan=OFF\n");
-                    xSemaphoreGive(g_lab4.ioMutex);
-                }
-            }
-            else if ((tokens >= 2) &&
-                     ((strcmp(action, "time") == 0) || (strcmp(action, "TIME") == 0)) &&
-                     ((strcmp(target, "fan") == 0) || (strcmp(target, "FAN") == 0)))
-            {
-                unsigned long lastMs = 0;
-                unsigned long totalMs = 0;
-                unsigned long currentMs = 0;
-                bool isOn = false;
-
-                if (xSemaphoreTake(g_lab4.stateMutex, pdMS_TO_TICKS(20)) == pdTRUE)
-                {
-                    lastMs = g_lab4.state.fanLastOnDurationMs;
-                    totalMs = g_lab4.state.fanTotalOnMs;
-                    isOn = g_lab4.state.fanIsOn;
-                    if (isOn)
-                    {
-                        currentMs = millis() - g_lab4.state.fanOnStartMs;
-                    }
-                    xSemaphoreGive(g_lab4.stateMutex);
-                }
-
-                if (xSemaphoreTake(g_lab4.ioMutex, pdMS_TO_TICKS(20)) == pdTRUE)
-                {
-                    printf("time fan command detected. Response: last_on=%lu ms, current_on=%lu ms, total_on=%lu ms\n",
-                           lastMs,
-                           currentMs,
-                           totalMs + currentMs);
-                    xSemaphoreGive(g_lab4.ioMutex);
-                }
-            }
-            else
-            {
-                known = false;
-            }
-
-            if (!known)
-            {
-                if (xSemaphoreTake(g_lab4.stateMutex, pdMS_TO_TICKS(20)) == pdTRUE)
-                {
-                    g_lab4.state.invalidCommandCount++;
-                    xSemaphoreGive(g_lab4.stateMutex);
-                }
-            }
-        }
-
+        Cli_Poll();
         vTaskDelay(pdMS_TO_TICKS(LAB4_CMD_TASK_MS));
     }
 }
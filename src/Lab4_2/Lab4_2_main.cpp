@@ -5,6 +5,7 @@
 #include "srv_servo_control.h"
 
 #include "../drivers/SerialStdioDriver.h"
+#include "../cli/CommandLine.h"
 #include "../led/LedDriver.h"
 
 #include <Arduino.h>
@@ -13,7 +14,6 @@
 #include <semphr.h>
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
-#include <ctype.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -32,20 +32,111 @@ static void taskConditioning(void* pv);
 static void taskActuator(void* pv);
 static void taskDisplay(void* pv);
 
-static bool iequals(const char* a, const char* b)
+// Serial commands (shared CLI). Every handler runs under stateMutex and
+// bumps commandSeq from the unlock hook. The raw servo value is stored as
+// typed: out-of-range requests are left to sig42_step(), which clamps them
+// and raises clampAlert.
+
+#define LAB4_2_SERVO_CHOICE_MIN   0u
+#define LAB4_2_SERVO_CHOICE_MAX   1u
+#define LAB4_2_SERVO_CHOICE_POT   2u
+
+static void setServoManual(float pct)
+{
+    g_lab42.state.rawServoPct = pct;
+    g_lab42.state.servoManualMode = true;
+}
+
+static uint8_t cmdRelay(const CliArg* arg)
 {
-    while ((*a != '\0') && (*b != '\0'))
+    g_lab42.state.relayCommand = (arg->choice == 1u);   // "off|on"
+    return 0u;
+}
+
+static uint8_t cmdServo(const CliArg* arg)
+{
+    if (!arg->isChoice)
     {
-        if (tolower((unsigned char)*a) != tolower((unsigned char)*b))
-        {
-            return false;
-        }
-        ++a;
-        ++b;
+        setServoManual(arg->value);
+    }
+    else if (arg->choice == LAB4_2_SERVO_CHOICE_MIN)
+    {
+        setServoManual(0.0f);
+    }
+    else if (arg->choice == LAB4_2_SERVO_CHOICE_MAX)
+    {
+        setServoManual(100.0f);
     }
-    return (*a == '\0') && (*b == '\0');
+    else
+    {
+        g_lab42.state.servoManualMode = false;
+    }
+    return 0u;
+}
+
+static uint8_t cmdServoPct(const CliArg* arg)
+{
+    setServoManual(arg->value);
+    return 0u;
+}
+
+static uint8_t cmdStatus(const CliArg* arg)
+{
+    (void)arg;  // the periodic report carries the status; this only logs the request
+    return 0u;
+}
+
+static const CliCommand LAB4_2_COMMANDS[] PROGMEM = {
+    { "relay",     CLI_ARG_WORD, 0.0f,      0.0f,     "off|on",      cmdRelay,    "switch the relay" },
+    { "servo",     CLI_ARG_INT,  -32000.0f, 32000.0f, "min|max|pot", cmdServo,    "servo % (manual) or pot mode" },
+    { "servo_pct", CLI_ARG_INT,  -32000.0f, 32000.0f, "",            cmdServoPct, "servo % (manual)" },
+    { "status",    CLI_ARG_NONE, 0.0f,      0.0f,     "",            cmdStatus,   "log a status request" }
+};
+
+static bool cliLockState(void)
+{
+    return xSemaphoreTake(g_lab42.stateMutex, pdMS_TO_TICKS(30)) == pdTRUE;
+}
+
+static void cliUnlockState(void)
+{
+    g_lab42.state.commandSeq++;
+    g_lab42.state.lastCommandMs = millis();
+    xSemaphoreGive(g_lab42.stateMutex);
+}
+
+static bool cliLockIo(void)
+{
+    return xSemaphoreTake(g_lab42.ioMutex, pdMS_TO_TICKS(30)) == pdTRUE;
+}
+
+static void cliUnlockIo(void)
+{
+    xSemaphoreGive(g_lab42.ioMutex);
 }
 
+static void countInvalidCommand(void)
+{
+    if (xSemaphoreTake(g_lab42.stateMutex, pdMS_TO_TICKS(30)) == pdTRUE)
+    {
+        g_lab42.state.invalidCommandCount++;
+        xSemaphoreGive(g_lab42.stateMutex);
+    }
+}
+
+static const CliConfig LAB4_2_CLI = {
+    LAB4_2_COMMANDS,
+    sizeof(LAB4_2_COMMANDS) / sizeof(LAB4_2_COMMANDS[0]),
+    CLI_FLAG_ECHO_LINE,
+    NULL,
+    cliLockState,
+    cliUnlockState,
+    cliLockIo,
+    cliUnlockIo,
+    NULL,
+    countInvalidCommand
+};
+
 static void load_defaults(Lab42Config* cfg)
 {
     cfg->commandMs = LAB4_2_DEFAULT_CMD_MS;
@@ -93,6 +184,8 @@ void lab4_2_setup()
         for (;;) {}
     }
 
+    Cli_Register(&LAB4_2_CLI);
+
     g_lab42.state.relayCommand = false;
     g_lab42.state.rawServoPct = 0.0f;
     g_lab42.state.servoManualMode = false;
@@ -167,118 +260,7 @@ static void taskCommand(void* pv)
 
     for (;;)
     {
-        char line[48] = {0};
-        if (scanf(" %47[^\r\n]", line) == 1)
-        {
-            bool known = false;
-            bool relayChange = false;
-            bool relayValue = false;
-            bool servoChange = false;
-            float servoValue = 0.0f;
-            char arg1[20] = {0};
-            char arg2[20] = {0};
-            int number = 0;
-
-            if (sscanf(line, "%19s %19s", arg1, arg2) == 2)
-            {
-                if (iequals(arg1, "relay") && iequals(arg2, "on"))
-                {
-                    known = true;
-                    relayChange = true;
-                    relayValue = true;
-                }
-                else if (iequals(arg1, "relay") && iequals(arg2, "off"))
-                {
-                    known = true;
-                    relayChange = true;
-                    relayValue = false;
-                }
-            }
-
-            if (!known && (sscanf(line, "servo %d", &number) == 1))
-            {
-                known = true;
-                servoChange = true;
-                servoValue = (float)number;
-            }
-
-            if (!known && (sscanf(line, "servo_pct %d", &number) == 1))
-            {
-                known = true;
-                servoChange = true;
-                servoValue = (float)number;
-            }
-
-            if (!known && (sscanf(line, "%19s %19s", arg1, arg2) == 2) && iequals(arg1, "servo") && iequals(arg2, "min"))
-            {
-                known = true;
-                servoChange = true;
-                servoValue = 0.0f;
-            }
-
-            if (!known && (sscanf(line, "%19s %19s", arg1, arg2) == 2) && iequals(arg1, "servo") && iequals(arg2, "max"))
-            {
-                known = true;
-                servoChange = true;
-                servoValue = 100.0f;
-            }
-
-            bool servoPotMode = false;
-            if (!known && (sscanf(line, "%19s %19s", arg1, arg2) == 2) && iequals(arg1, "servo") && iequals(arg2, "pot"))
-            {
-                known = true;
-                servoPotMode = true;
-            }
-
-            if (!known && (sscanf(line, "%19s", arg1) == 1) && iequals(arg1, "status"))
-            {
-                known = true;
-            }
-
-            if (known)
-            {
-                if (xSemaphoreTake(g_lab42.stateMutex, pdMS_TO_TICKS(30)) == pdTRUE)
-                {
-                    if (relayChange)
-                    {
-                        g_lab42.state.relayCommand = relayValue;
-                    }
-                    if (servoChange)
-                    {
-                        g_lab42.state.rawServoPct = servoValue;
-                        g_lab42.state.servoManualMode = true;
-                    }
-                    if (servoPotMode)
-                    {
-                        g_lab42.state.servoManualMode = false;
-                    }
-                    g_lab42.state.commandSeq++;
-                    g_lab42.state.lastCommandMs = millis();
-                    xSemaphoreGive(g_lab42.stateMutex);
-                }
-
-                if (xSemaphoreTake(g_lab42.ioMutex, pdMS_TO_TICKS(30)) == pdTRUE)
-                {
-                    printf("%s\n", line);
-                    xSemaphoreGive(g_lab42.ioMutex);
-                }
-            }
-            else
-            {
-                if (xSemaphoreTake(g_lab42.stateMutex, pdMS_TO_TICKS(30)) == pdTRUE)
-                {
-                    g_lab42.state.invalidCommandCount++;
-                    xSemaphoreGive(g_lab42.stateMutex);
-                }
-
-                if (xSemaphoreTake(g_lab42.ioMutex, pdMS_TO_TICKS(30)) == pdTRUE)
-                {
-                    printf("%s\n", line);
-                    xSemaphoreGive(g_lab42.ioMutex);
-                }
-            }
-        }
-
+        Cli_Poll();
         vTaskDelay(pdMS_TO_TICKS(g_lab42.config.commandMs));
     }
 }
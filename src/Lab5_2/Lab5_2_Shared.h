@@ -3,9 +3,12 @@
 
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
-#include <queue.h>
 #include <semphr.h>
 
+#include "lib_snapshot.h"
+#include "ctrl_step_metrics.h"
+#include "ctrl_autotune.h"
+
 /*
  * Lab 5.2 — Closed-loop air-temperature control with a relay-driven motor/fan.
  *
@@ -28,7 +31,7 @@
  *     waveform would just buzz the coil — instead the PID task asks for a
  *     0..100% duty and the actuator implements TIME-PROPORTIONAL control:
  *     the duty is converted into ON / OFF slices across a window of
- *     LAB5_2_RELAY_WINDOW_MS (default 2000 ms).
+ *     LAB5_2_RELAY_WINDOW_MS (default 2000 ms), edges timed by Timer3.
  *   - I²C 16x2 LCD on the standard Mega lines (SDA = D20, SCL = D21).
  *
  * --- Why the relay (and not a PWM fan driver) ----------------------------
@@ -49,8 +52,14 @@
  *   APP   src/Lab5_2/Lab5_2_main.cpp            (this lab)
  *   APP   src/Lab5_2/ctrl_onoff_hyst.{h,cpp}    (control: ON-OFF + hyst)
  *   APP   src/Lab5_2/ctrl_pid.{h,cpp}           (control: discrete PID)
+ *   APP   src/Lab5_2/ctrl_autotune.{h,cpp}      (control: relay autotune)
  *   SRV   src/Lab5_2/srv_temp_sensor.{h,cpp}    (DS18B20 wrapper + cond.)
  *   SRV   src/Lab5_2/srv_fan.{h,cpp}            (relay + TPC actuator)
+ *   SRV   src/Lab5_2/srv_warm_start.{h,cpp}     (.noinit warm-start image)
+ *   SRV   src/Lab5_2/srv_blackbox.{h,cpp}       (.noinit post-mortem trace)
+ *   SRV   src/Lab5_2/srv_script.{h,cpp}         (timed command script)
+ *   SRV   src/history/SampleHistory.{h,cpp}     (compressed PV history)
+ *   LIB   src/Lab5_2/lib_snapshot.h             (lock-free state snapshots)
  *   ECAL  Arduino DallasTemperature/OneWire libs
  *   MCAL  Arduino core (digitalWrite, Wire, ...)
  */
@@ -93,7 +102,7 @@
 
 /*
  * Default PID gains tuned for a small relay-switched DC fan in still air
- * (Ts = 100 ms control loop, 2000 ms TPC window). Profile: BALANCED.
+ * (Ts = one DS18B20 sample ≈ 1000 ms, 2000 ms TPC window). Profile: BALANCED.
  * Tuning advice (manual ramp from 0):
  *   Soft / quiet            : Kp = 25, Ki = 0.20, Kd = 0
  *   Balanced (default)      : Kp = 50, Ki = 0.50, Kd = 0
@@ -108,8 +117,22 @@
  *  can only cool, so negative integral or P contribution is discarded. */
 #define LAB5_2_DEFAULT_OUTPUT_LIMIT  100.0f
 
-/** Anti-windup ceiling on the integral accumulator. Matches the reference. */
-#define LAB5_2_PID_INTEGRAL_LIMIT    100.0f
+/** Step-response metrics (`perf`). A set-point change of at least
+ *  MIN_STEP starts a new step; the PV counts as settled once it has stayed
+ *  within ±BAND of the set-point for SETTLE_HOLD. */
+#define LAB5_2_PERF_MIN_STEP_C       0.5f
+#define LAB5_2_PERF_BAND_C           0.5f
+#define LAB5_2_PERF_SETTLE_HOLD_MS   60000UL
+
+/** Relay autotune (`autotune`). The relay switches at SP ± EPS: the PV
+ *  moves in whole degrees, so 0.5 is the narrowest band that still keeps
+ *  one-LSB dither from toggling it. Cycles agree when their spread is
+ *  within TOLERANCE of the mean; a fan loop cycles in minutes, hence the
+ *  generous cycle budget and timeout. */
+#define LAB5_2_TUNE_EPS_C            0.5f
+#define LAB5_2_TUNE_TOLERANCE        0.2f
+#define LAB5_2_TUNE_MAX_CYCLES       10u
+#define LAB5_2_TUNE_TIMEOUT_MS       (90UL * 60UL * 1000UL)
 
 // ============================================================================
 // Relay actuator (time-proportional cycling)
@@ -129,6 +152,21 @@
 #define LAB5_2_RELAY_WINDOW_MIN_MS      500u
 #define LAB5_2_RELAY_WINDOW_MAX_MS      10000u
 
+/** Timer3 rate used by the TPC slicer: 16 MHz / 64 = 250 ticks per ms. */
+#define LAB5_2_FAN_TIMER_TICKS_PER_MS   250u
+
+/** Longest single compare step. Timer3 laps every 65536 / 250 ≈ 262 ms, so
+ *  longer ON / OFF phases are split into waypoints of at most this much. */
+#define LAB5_2_FAN_MAX_STEP_MS          250u
+
+/** Sigma-delta modulation (`modulation sd`): decision slot length. The
+ *  relay also has to dwell at least window / 2 in a state before it may
+ *  switch, which keeps the switch rate at or below the TPC one. */
+#define LAB5_2_SD_SLOT_MS               100u
+
+/** Demand full scale used by the slicer: 10000 = 100.00 %. */
+#define LAB5_2_SD_FULL_SCALE            10000u
+
 // ============================================================================
 // Task periods (ms) — matches Indrumar §2.4 timings
 // ============================================================================
@@ -137,22 +175,58 @@
  *  anything faster than 1000 ms is wasted on the bus. */
 #define LAB5_2_ACQ_TASK_MS           1000u
 
-/** PID loop recurrence. 100 ms is the value used in the reference Lab 6.2. */
-#define LAB5_2_CTRL_TASK_MS          100u
-
-/** Actuator recurrence. 100 ms is fine-grained enough to resolve the
- *  TPC window with ~20 slices at the default 2000 ms window. */
-#define LAB5_2_FAN_TASK_MS           100u
+/** Oldest PV the controller will act on. Staleness is judged from the
+ *  sample's age (millis() - sensor.lastSampleMs), not from how the control
+ *  task woke, since commands wake it too: past this, acquisition is
+ *  assumed stalled and the fan is commanded off. The task also wakes at
+ *  least this often, so the check runs even when nothing else happens. */
+#define LAB5_2_CTRL_TIMEOUT_MS       2500u
 
 /** LCD refresh period (slow; LCD is the bottleneck). */
 #define LAB5_2_DISP_TASK_MS          500u
 
-/** Serial command poll period. Short = snappy, but we still yield the CPU. */
-#define LAB5_2_CMD_TASK_MS           80u
+/** Serial command poll period. Cli_Poll() never blocks and costs almost
+ *  nothing when the RX ring is empty, so this can stay short (snappy). */
+#define LAB5_2_CMD_TASK_MS           20u
 
 /** Reporting / Plotter recurrence. */
 #define LAB5_2_REPORT_TASK_MS        1000u
 
+// ============================================================================
+// Black-box recorder
+// ============================================================================
+
+/** Records kept in the .noinit ring (10 B each). ACQ + CTRL + RPT log once
+ *  a second and DISP twice, so 32 records cover the last ~6 s before a
+ *  reset — more if the system was wedged and only some tasks still ran. */
+#define LAB5_2_BLACKBOX_DEPTH        32u
+
+// ============================================================================
+// Temperature history (src/history/SampleHistory)
+// ============================================================================
+
+/** 64-byte blocks in the history ring (16 = 1 KB of SRAM). A steady PV
+ *  costs ~1 byte per minute, a drifting one ~1 byte per sample, so this
+ *  holds from ~15 min of a noisy transient up to many hours of a settled
+ *  loop. */
+#define LAB5_2_HISTORY_BLOCKS        16u
+
+/** Samples are stored in DS18B20 LSBs (1/16 degC): finer steps would only
+ *  record filter noise and cost bytes. */
+#define LAB5_2_HISTORY_SCALE         16.0f
+
+/** Bucket length of `history sum`. */
+#define LAB5_2_HISTORY_SUMMARY_S     60u
+
+// ============================================================================
+// Command script (`at` / `run` / `script`)
+// ============================================================================
+
+/** Steps in a script and the longest command line a step can hold
+ *  (terminator included): 12 x 28 B of SRAM, plus the same in EEPROM. */
+#define LAB5_2_SCRIPT_STEPS          12u
+#define LAB5_2_SCRIPT_CMD_LEN        24u
+
 // ============================================================================
 // Conditioning pipeline parameters (signal conditioning, mirrors lib_cond)
 // ============================================================================
@@ -185,7 +259,8 @@
 typedef enum
 {
     LAB5_2_MODE_ONOFF = 0,
-    LAB5_2_MODE_PID   = 1
+    LAB5_2_MODE_PID   = 1,
+    LAB5_2_MODE_TUNE  = 2       /* relay autotune; back to PID when done    */
 } Lab52Mode;
 
 /** Manual override of the actuator, useful for hardware bring-up. */
@@ -200,16 +275,7 @@ typedef enum
  *  For a relay it just means "closed continuously". */
 #define LAB5_2_FORCE_ON_PCT          100
 
-/** A single sample of the process value, posted by the acquisition task. */
-typedef struct
-{
-    float tempC;            /* filtered air temperature, °C              */
-    float rawTempC;         /* unfiltered sample (kept for plotter)       */
-    bool  valid;            /* false ⇒ sensor failed; controller bails    */
-    unsigned long timestampMs;
-} Lab52Measurement;
-
-/** One iteration of the controller, passed to the actuator task. */
+/** One iteration of the controller (demand goes straight to Fan52). */
 typedef struct
 {
     float fanPctTarget;     /* 0..100 demand from controller              */
@@ -220,7 +286,19 @@ typedef struct
     unsigned long timestampMs;
 } Lab52ControlOutput;
 
-/** Persistent (mutex-guarded) configuration. Modified by the command task. */
+/*
+ * Shared data is split into groups that each have exactly ONE writing task
+ * and are published through a Snapshot52 (lib_snapshot.h): readers copy a
+ * consistent snapshot without a lock, writers never wait for readers.
+ *
+ *   group     writer            readers
+ *   config    taskCommand (CLI) ctrl, disp, report, cmd
+ *   sensor    taskAcquisition   ctrl, disp, report, cmd
+ *   control   taskControl       disp, report, cmd
+ *   ui        taskCommand (CLI) ctrl, disp, report
+ */
+
+/** Persistent configuration. Writer: the command task. */
 typedef struct
 {
     float setpointC;
@@ -231,8 +309,7 @@ typedef struct
     float outputLimit;
 
     uint16_t acqTaskMs;
-    uint16_t ctrlTaskMs;
-    uint16_t fanTaskMs;
+    uint16_t ctrlTimeoutMs;
     uint16_t dispTaskMs;
     uint16_t cmdTaskMs;
     uint16_t reportTaskMs;
@@ -240,9 +317,52 @@ typedef struct
     /* Relay actuator */
     uint16_t relayWindowMs;     /* TPC window length, ms                 */
     bool     relayActiveLow;    /* runtime polarity (default from macro) */
+    uint8_t  fanModulation;     /* Fan52Modulation: TPC or sigma-delta   */
 } Lab52Config;
 
-/** Live runtime state. Mutex-guarded; one snapshot read per task cycle. */
+/** Latest process value. Writer: the acquisition task. */
+typedef struct
+{
+    float tempC;            /* filtered                                   */
+    float tempRawC;         /* last raw sample                            */
+    bool  sensorValid;
+    unsigned long lastSampleMs;
+    unsigned long lastSampleUs;     /* micros() when the sample was posted   */
+} Lab52SensorState;
+
+/** Result of the last control cycle. Writer: the control task. */
+typedef struct
+{
+    float errorC;
+    float pidOutput;
+    float fanPctDemand;     /* what the controller asked for (0..100)     */
+    unsigned long controlCycles;
+    unsigned long ctrlLatencyUs;    /* sample posted → fan demand updated     */
+    StepMetrics52Result perf;       /* current set-point step                 */
+    Autotune52Result    tune;       /* current or last autotune run           */
+} Lab52ControlState;
+
+/** Operator-facing state. Writer: the command task. */
+typedef struct
+{
+    Lab52Mode mode;
+    uint8_t reportMode;     /* LAB5_2_REPORT_MODE_*                       */
+    Lab52ForceMode forceMode;
+    unsigned long commandCounter;
+
+    /* Controller resets requested by commands: the control task owns the
+     * controllers and resets one whenever its counter moves. */
+    uint8_t pidResetSeq;
+    uint8_t onoffResetSeq;
+
+    /* Temporary LCD banner (shown by `status` / `help`) */
+    char lcdBannerL1[17];
+    char lcdBannerL2[17];
+    unsigned long lcdBannerUntilMs;
+} Lab52UiState;
+
+/** Flat read-side view assembled from the groups above plus the Fan52
+ *  telemetry (see readRuntimeState in Lab5_2_main.cpp). Never published. */
 typedef struct
 {
     /* Sensor pipeline */
@@ -256,8 +376,10 @@ typedef struct
     float errorC;
     float pidOutput;
     float fanPctDemand;     /* what the controller asked for (0..100)     */
-    float fanPctActual;     /* what the actuator translated this cycle    */
+    float fanPctActual;     /* duty achieved over the last TPC window     */
     bool  relayOn;          /* instantaneous relay contact state          */
+    unsigned long relaySwitches; /* relay transitions since boot          */
+    uint8_t fanModulation;  /* Fan52Modulation                            */
     Lab52Mode mode;
 
     /* Reporting */
@@ -266,8 +388,11 @@ typedef struct
 
     /* Telemetry */
     unsigned long lastSampleMs;
+    unsigned long ctrlLatencyUs;
     unsigned long controlCycles;
     unsigned long commandCounter;
+    StepMetrics52Result perf;
+    Autotune52Result    tune;
 
     /* Temporary LCD banner (shown by `status` / `help`) */
     char lcdBannerL1[17];
@@ -278,12 +403,13 @@ typedef struct
 /** Bag of FreeRTOS handles + state shared by every task. */
 typedef struct
 {
-    Lab52Config       config;
-    Lab52RuntimeState state;
+    Snapshot52<Lab52Config>       config;   /* writer: taskCommand      */
+    Snapshot52<Lab52SensorState>  sensor;   /* writer: taskAcquisition  */
+    Snapshot52<Lab52ControlState> control;  /* writer: taskControl      */
+    Snapshot52<Lab52UiState>      ui;       /* writer: taskCommand      */
 
-    QueueHandle_t     qControl;     /* taskControl → taskFan              */
-    SemaphoreHandle_t stateMutex;   /* protects `config` + `state`        */
-    SemaphoreHandle_t ioMutex;      /* serialises printf / scanf streams  */
+    TaskHandle_t      ctrlTask;     /* notified: new sample / new command */
+    SemaphoreHandle_t ioMutex;      /* serialises printf streams          */
 } Lab52Shared;
 
 extern Lab52Shared g_lab52;
@@ -8,20 +8,35 @@
  *
  *   mode onoff   : ON-OFF with hysteresis (Indrumar §2.4.5 / §2.7.1)
  *   mode pid     : discrete PID with anti-windup (Indrumar §2.4.4 / §2.7.1)
+ *   autotune     : relay feedback around the set-point measures Ku / Pu,
+ *                  loads Ziegler–Nichols or Tyreus–Luyben gains (PID, else
+ *                  the rule's PI) if they fit unclamped, then PID
  *
  * Architecture: APP -> SRV(controllers + sensor + actuator) -> ECAL
  *               (Dallas / OneWire / Wire) -> MCAL (Arduino core) -> HW
  *
  * --- FreeRTOS tasks ------------------------------------------------------
- *   acq    1000 ms  : DS18B20 read + saturate → median → weighted average
- *   ctrl    100 ms  : compute duty (ON-OFF or PID), post to queue
- *   fan     100 ms  : time-proportional relay slicing (TPC) from duty
+ *   acq    1000 ms  : DS18B20 read + saturate → median → weighted average,
+ *                     then notify ctrl
+ *   ctrl   on event : compute duty (ON-OFF or PID) once per new sample and
+ *                     hand it to the fan; a command wake-up only
+ *                     re-applies force / limit to the last demand
+ *   (Timer3 ISR)    : time-proportional relay slicing (TPC), 1 ms edges
  *   disp    500 ms  : refresh I²C LCD with PV / SP / mode / duty / relay
- *   cmd      80 ms  : parse Serial commands, update config under mutex
- *   report 1000 ms  : human-readable status OR Serial Plotter CSV stream
+ *   cmd      20 ms  : poll the shared CLI, apply commands under the mutex;
+ *                     wakes early to run a script step on time
+ *   report 1000 ms  : human-readable status OR Serial Plotter CSV stream;
+ *                     a "[L5.2][PERF] settled:" line when a step settles
  *
  * --- Serial command grammar (each accepted line is echoed back) -----------
+ *   CMD_TABLE below is the source of truth (names, argument ranges, help);
+ *   this list is a summary of it.
  *   <number>            shortcut: bare integer = new set-point degC
+ *   at <ms> <command>   add a script step: <command> runs <ms> after `run`
+ *   autotune <zn|tl>    relay autotune, then PID with the computed gains
+ *                       (the rule's PI when its PID does not fit; neither
+ *                       fits: previous mode, gains unchanged)
+ *   autotune stop       abandon the autotune, gains unchanged
  *   mode pid            switch to PID controller (TPC duty modulation)
  *   mode onoff          switch to ON-OFF controller (binary relay)
  *   set <C>             set-point degC (saturated to 15..35)
@@ -30,26 +45,38 @@
  *   ki <v>              integral gain (0..50)
  *   kd <v>              derivative gain (0..50)
  *   preset <name>       soft | balanced | aggressive | p
+ *   run                 start the script; ends with a summary + `perf`
+ *   script <op>         list | clear | save | load (EEPROM) | stop
  *   window <ms>         TPC window length (500..10000 ms; default 2000)
+ *   modulation <tpc|sd> relay modulation: one pulse per window, or
+ *                       sigma-delta slots (min dwell = window / 2)
+ *   perf                step response since the last set-point change:
+ *                       rise, overshoot, settling, IAE, relay switches
  *   polarity <low|high> relay-board polarity (default: low — Wokwi default)
  *   force <on|off|auto> manual override (HW bring-up; bypasses controller)
  *   plotter <on|off>    enable Serial Plotter CSV stream
  *   status              snapshot on LCD for a few seconds
+ *   history <s|all>     dump the stored PV trend (last s seconds) as CSV
+ *   history sum         per-minute min / avg / max of the stored trend
+ *   history info        history fill level and compression
  *   help                print this list
  *
  * --- Style notes ----------------------------------------------------------
  *   - Set Serial Monitor to 115200 baud (matches SerialStdioInit in main.cpp).
  *   - LCD line layout: line 1 = "T:25C SP:25C", line 2 = "PID 067% R+ e+2".
  *     R+ = relay closed (motor on), R- = relay open (motor off).
- *   - All shared state lives behind g_lab52.stateMutex; tasks read a snapshot
- *     and write under the mutex.
+ *   - Shared state is split into single-writer groups (config/ui: command,
+ *     sensor: acquisition, control: control), each published through a
+ *     lock-free Snapshot52; readers copy, nobody blocks on state.
+ *   - Every task drops a 10-byte trace record into the .noinit black box
+ *     each cycle; after a WDT / BOR / EXT reset the last records are
+ *     printed as "[L5.2][BBOX]" lines before the tasks start.
  */
 
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
 #include <task.h>
 #include <semphr.h>
-#include <queue.h>
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
 #include <avr/io.h>
@@ -57,14 +84,20 @@
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
 
 #include "Lab5_2_main.h"
 #include "Lab5_2_Shared.h"
 #include "ctrl_onoff_hyst.h"
 #include "ctrl_pid.h"
+#include "ctrl_step_metrics.h"
+#include "ctrl_autotune.h"
 #include "srv_temp_sensor.h"
 #include "srv_fan.h"
+#include "srv_warm_start.h"
+#include "srv_blackbox.h"
+#include "srv_script.h"
+#include "../cli/CommandLine.h"
+#include "../history/SampleHistory.h"
 
 #if defined(__AVR_ATmega328P__)
 #error "Lab5_2 requires Arduino Mega 2560 (ATmega2560). Update board in platformio.ini and wiring."
@@ -78,8 +111,14 @@ Lab52Shared g_lab52;
 
 static PidController52              s_pid;
 static OnOffHysteresisController52  s_onoff;
+static StepMetrics52                s_perf;     /* control task only */
+static RelayAutotune52              s_tune;     /* control task only */
 static LiquidCrystal_I2C            s_lcd(LAB5_2_LCD_I2C_ADDR, 16, 2);
 
+/* Filtered PV, one sample per good acquisition; written by acq only. */
+static HistoryBlock   s_historyBlocks[LAB5_2_HISTORY_BLOCKS];
+static SampleHistory  s_history(s_historyBlocks, LAB5_2_HISTORY_BLOCKS, LAB5_2_ACQ_TASK_MS);
+
 /* --- Reset / boot diagnostics ------------------------------------------- *
  * If the MCU reset-loops (brownout, watchdog, USB DTR re-toggling) the
  * relay-style audible click of the previous build was indistinguishable
@@ -139,7 +178,6 @@ static void diagPrintBootBanner(void)
 // Forward decls
 static void taskAcquisition(void* pv);
 static void taskControl    (void* pv);
-static void taskFan        (void* pv);
 static void taskDisplay    (void* pv);
 static void taskCommand    (void* pv);
 static void taskReport     (void* pv);
@@ -155,26 +193,105 @@ static float clampf(float v, float lo, float hi)
     return v;
 }
 
-static int clampi(int v, int lo, int hi)
+/** Three letters for the LCD and the report line. */
+static const char* modeName(Lab52Mode mode)
 {
-    if (v < lo) { return lo; }
-    if (v > hi) { return hi; }
-    return v;
+    switch (mode)
+    {
+        case LAB5_2_MODE_PID:  return "PID";
+        case LAB5_2_MODE_TUNE: return "ATN";
+        default:               return "ONF";
+    }
 }
 
-/** Case-insensitive string equality (Arduino has no strcasecmp by default). */
-static bool iequals(const char* a, const char* b)
+/** Relay state, achieved duty and switch count come straight from the
+ *  ISR-driven actuator, so a snapshot is current even between control
+ *  cycles (which now run once per sample). */
+static void refreshFanTelemetry(Lab52RuntimeState* s)
 {
-    while ((*a != '\0') && (*b != '\0'))
-    {
-        if (tolower((unsigned char)*a) != tolower((unsigned char)*b))
-        {
-            return false;
-        }
-        ++a;
-        ++b;
-    }
-    return (*a == '\0') && (*b == '\0');
+    s->fanPctActual  = Fan52_GetAchievedPct();
+    s->relayOn       = Fan52_IsRelayOn();
+    s->relaySwitches = Fan52_GetSwitchCount();
+}
+
+/** Assemble the flat view for display / report from the four snapshots.
+ *  Each group is internally consistent; across groups the view may mix
+ *  publishes a few ms apart, which is fine for presentation. */
+static void readRuntimeState(Lab52RuntimeState* s)
+{
+    Lab52Config       cfg;
+    Lab52SensorState  sensor;
+    Lab52ControlState ctl;
+    Lab52UiState      ui;
+
+    g_lab52.config.Read(&cfg);
+    g_lab52.sensor.Read(&sensor);
+    g_lab52.control.Read(&ctl);
+    g_lab52.ui.Read(&ui);
+
+    s->tempC          = sensor.tempC;
+    s->tempRawC       = sensor.tempRawC;
+    s->sensorValid    = sensor.sensorValid;
+    s->lastSampleMs   = sensor.lastSampleMs;
+
+    s->setpointC      = cfg.setpointC;
+    s->hysteresisC    = cfg.hysteresisC;
+    s->fanModulation  = cfg.fanModulation;
+
+    s->errorC         = ctl.errorC;
+    s->pidOutput      = ctl.pidOutput;
+    s->fanPctDemand   = ctl.fanPctDemand;
+    s->controlCycles  = ctl.controlCycles;
+    s->ctrlLatencyUs  = ctl.ctrlLatencyUs;
+    s->perf           = ctl.perf;
+    s->tune           = ctl.tune;
+
+    s->mode           = ui.mode;
+    s->reportMode     = ui.reportMode;
+    s->forceMode      = ui.forceMode;
+    s->commandCounter = ui.commandCounter;
+    s->lcdBannerUntilMs = ui.lcdBannerUntilMs;
+    memcpy(s->lcdBannerL1, ui.lcdBannerL1, sizeof(s->lcdBannerL1));
+    memcpy(s->lcdBannerL2, ui.lcdBannerL2, sizeof(s->lcdBannerL2));
+
+    refreshFanTelemetry(s);
+}
+
+/* --- Black-box trace ----------------------------------------------------- */
+
+static uint8_t bbFlags(Lab52Mode mode, Lab52ForceMode force, bool sensorValid)
+{
+    uint8_t flags = 0u;
+    if (Fan52_IsRelayOn())           { flags |= BB52_F_RELAY_ON; }
+    if (sensorValid)                 { flags |= BB52_F_SENSOR_OK; }
+    if (mode == LAB5_2_MODE_PID)     { flags |= BB52_F_MODE_PID; }
+    if (mode == LAB5_2_MODE_TUNE)    { flags |= BB52_F_MODE_TUNE; }
+    if (force != LAB5_2_FORCE_AUTO)  { flags |= BB52_F_FORCED; }
+    return flags;
+}
+
+/** One trace record: PV / duty as the calling task sees them, plus the
+ *  RX backlog and the last command, which say what the CLI was up to. */
+static void bbLog(BlackBox52Task task, bool pvValid, float pvC, float dutyPct,
+                  uint8_t flags)
+{
+    BlackBox52Record rec;
+    rec.task    = (uint8_t)task;
+    rec.pvCenti = pvValid ? (int16_t)lroundf(clampf(pvC, -300.0f, 300.0f) * 100.0f)
+                          : (int16_t)BB52_PV_NONE;
+    rec.dutyPct = (dutyPct < 0.0f) ? (uint8_t)BB52_DUTY_NONE
+                                   : (uint8_t)(clampf(dutyPct, 0.0f, 100.0f) + 0.5f);
+    const int rx = Serial.available();
+    rec.rxDepth = (rx > 255) ? 255u : (uint8_t)rx;
+    rec.lastCmd = Cli_LastCommand();
+    rec.flags   = flags;
+    BlackBox52_Record(&rec);
+}
+
+static void bbLogState(BlackBox52Task task, const Lab52RuntimeState* s)
+{
+    bbLog(task, s->sensorValid, s->tempC, s->fanPctDemand,
+          bbFlags(s->mode, s->forceMode, s->sensorValid));
 }
 
 static void loadDefaults(Lab52Config* cfg)
@@ -187,14 +304,14 @@ static void loadDefaults(Lab52Config* cfg)
     cfg->outputLimit    = LAB5_2_DEFAULT_OUTPUT_LIMIT;
 
     cfg->acqTaskMs      = LAB5_2_ACQ_TASK_MS;
-    cfg->ctrlTaskMs     = LAB5_2_CTRL_TASK_MS;
-    cfg->fanTaskMs      = LAB5_2_FAN_TASK_MS;
+    cfg->ctrlTimeoutMs  = LAB5_2_CTRL_TIMEOUT_MS;
     cfg->dispTaskMs     = LAB5_2_DISP_TASK_MS;
     cfg->cmdTaskMs      = LAB5_2_CMD_TASK_MS;
     cfg->reportTaskMs   = LAB5_2_REPORT_TASK_MS;
 
     cfg->relayWindowMs  = LAB5_2_DEFAULT_RELAY_WINDOW_MS;
     cfg->relayActiveLow = (LAB5_2_RELAY_ACTIVE_LOW != 0);
+    cfg->fanModulation  = FAN52_MOD_TPC;
 }
 
 // ============================================================================
@@ -234,11 +351,12 @@ static void lcdRender(const Lab52RuntimeState* state)
                  (int)(state->setpointC + 0.5f));
     }
 
-    /* Line 2: "PID 067% R+ e+2" / "ONF ON  R+ e+1" / "FRC ON   R+ "
+    /* Line 2: "PID 067% R+ e+2" / "ONF ON  R+ e+1" / "ATN cyc2 R+ e+1" /
+     *         "FRC ON   R+ "
      * R+ ⇒ relay closed (motor running), R- ⇒ relay open (motor stopped).
      * R is what you should compare against the LED on the relay module. */
     const int  errInt   = (int)(state->errorC + (state->errorC >= 0 ? 0.5f : -0.5f));
-    const int  dutyInt  = (int)(state->fanPctActual + 0.5f);
+    const int  dutyInt  = (int)(state->fanPctDemand + 0.5f);
     const char relayCh  = state->relayOn ? '+' : '-';
 
     if (state->forceMode != LAB5_2_FORCE_AUTO)
@@ -248,6 +366,13 @@ static void lcdRender(const Lab52RuntimeState* state)
                  (state->forceMode == LAB5_2_FORCE_ON) ? "ON" : "OFF",
                  relayCh);
     }
+    else if (state->mode == LAB5_2_MODE_TUNE)
+    {
+        snprintf(line2, sizeof(line2),
+                 "ATN cyc%u R%c e%+1d",
+                 (unsigned)(state->tune.cycles % 10u), relayCh,
+                 (errInt > 9) ? 9 : ((errInt < -9) ? -9 : errInt));
+    }
     else if (state->mode == LAB5_2_MODE_PID)
     {
         snprintf(line2, sizeof(line2),
@@ -269,10 +394,399 @@ static void lcdRender(const Lab52RuntimeState* state)
 }
 
 // ============================================================================
-// Serial banner / help
+// PID presets (PROGMEM-stored, for cooling-fan plant)
 // ============================================================================
 
-/** Boot/help banner. Holds ioMutex to avoid interleaving with other tasks. */
+typedef struct
+{
+    float kp;
+    float ki;
+    float kd;
+} PidPreset;
+
+/* Order must match the `preset` choice list in CMD_TABLE below. */
+static const PidPreset PID_PRESETS[] PROGMEM = {
+    /* Tuning targets: small DC fan (~1 W) cooling a thermistor in still air. */
+    { 25.0f, 0.20f,  0.0f },    /* soft       */
+    { 50.0f, 0.50f,  0.0f },    /* balanced   */
+    { 80.0f, 1.50f,  5.0f },    /* aggressive */
+    { 50.0f, 0.0f,   0.0f }     /* p          */
+};
+static const uint8_t PID_PRESET_COUNT = sizeof(PID_PRESETS) / sizeof(PID_PRESETS[0]);
+
+// ============================================================================
+// Serial commands  (rows for the shared CLI in src/cli/CommandLine)
+// ============================================================================
+//
+// Handlers run in the command task and only touch its master copies of the
+// config / ui groups, published once per command; anything that reaches into another
+// module (PID reset, fan window, polarity, long printouts) is returned as
+// CMD_FX_* bits and applied by applyCommandEffects() after the mutex is
+// released. The same table renders the `help` listing.
+
+/* Deferred side effects returned by handlers: independent action bits,
+ * plus at most one printout, numbered in the top three bits. */
+#define CMD_FX_NONE           0x00u
+#define CMD_FX_RESET_PID      0x01u
+#define CMD_FX_RESET_ONOFF    0x02u
+#define CMD_FX_FAN_WINDOW     0x04u
+#define CMD_FX_FAN_POLARITY   0x08u
+#define CMD_FX_FAN_MODULATION 0x10u
+#define CMD_FX_PRINT_MASK     0xE0u
+#define CMD_FX_PRINT_HELP     0x20u
+#define CMD_FX_PRINT_STATS    0x40u
+#define CMD_FX_PRINT_HISTORY  0x60u
+#define CMD_FX_PRINT_PERF     0x80u
+#define CMD_FX_PRINT_SCRIPT   0xA0u
+#define CMD_FX_PRINT_TUNE     0xC0u
+
+/* What the last `at` / `run` / `script` asked for; carried out together
+ * with its printout, outside the handler (EEPROM writes are slow). The
+ * order after SCRIPT_OP_LIST matches the `script` choice list. */
+typedef enum
+{
+    SCRIPT_OP_AT    = 0,
+    SCRIPT_OP_RUN   = 1,
+    SCRIPT_OP_LIST  = 2,
+    SCRIPT_OP_CLEAR = 3,
+    SCRIPT_OP_SAVE  = 4,
+    SCRIPT_OP_LOAD  = 5,
+    SCRIPT_OP_STOP  = 6
+} ScriptOp;
+
+static uint8_t s_scriptOp;
+
+/* `autotune`: the rule to apply, the mode to fall back to if the run is
+ * abandoned, and the control group's runId before this run started (the
+ * result counts once control reports a newer, finished run). */
+static uint8_t   s_tuneRule;
+static Lab52Mode s_tuneReturnMode;
+static uint8_t   s_tuneRunBefore;
+
+/* The command task is the single writer of the config and ui groups:
+ * handlers edit these masters, cliPublishState() publishes them. */
+static Lab52Config  s_cmdConfig;
+static Lab52UiState s_cmdUi;
+
+/* --- Handlers (command task only) ---------------------------------------- */
+
+static uint8_t cmdAt(const CliArg* arg)
+{
+    /* "<ms> <command>" — parsed by scriptAdd() */
+    (void)arg;
+    s_scriptOp = SCRIPT_OP_AT;
+    return CMD_FX_PRINT_SCRIPT;
+}
+
+static uint8_t cmdAutotune(const CliArg* arg)
+{
+    /* choices: zn | tl | stop  →  zn / tl == Autotune52Rule */
+    if (arg->choice == 2u)
+    {
+        if (s_cmdUi.mode != LAB5_2_MODE_TUNE) { return CMD_FX_NONE; }
+        s_cmdUi.mode = s_tuneReturnMode;
+        return (s_cmdUi.mode == LAB5_2_MODE_PID) ? CMD_FX_RESET_PID : CMD_FX_RESET_ONOFF;
+    }
+
+    /* A forced fan would hold the relay test still; control aborts any
+     * run that finds itself forced. */
+    if (s_cmdUi.forceMode != LAB5_2_FORCE_AUTO) { return CMD_FX_PRINT_TUNE; }
+
+    s_tuneRule = arg->choice;
+    if (s_cmdUi.mode != LAB5_2_MODE_TUNE)
+    {
+        Lab52ControlState control;
+        g_lab52.control.Read(&control);
+        s_tuneRunBefore  = control.tune.runId;
+        s_tuneReturnMode = s_cmdUi.mode;
+        s_cmdUi.mode     = LAB5_2_MODE_TUNE;
+    }
+    return CMD_FX_NONE;
+}
+
+static uint8_t cmdForce(const CliArg* arg)
+{
+    /* choices: on | off | auto */
+    static const Lab52ForceMode MAP[] = {
+        LAB5_2_FORCE_ON, LAB5_2_FORCE_OFF, LAB5_2_FORCE_AUTO
+    };
+    s_cmdUi.forceMode = MAP[arg->choice];
+    return CMD_FX_NONE;
+}
+
+static uint8_t cmdHelp(const CliArg* arg)
+{
+    (void)arg;
+    strncpy(s_cmdUi.lcdBannerL1, "mode set hyst kp", sizeof(s_cmdUi.lcdBannerL1) - 1);
+    s_cmdUi.lcdBannerL1[sizeof(s_cmdUi.lcdBannerL1) - 1] = '\0';
+    strncpy(s_cmdUi.lcdBannerL2, "ki kd preset hlp", sizeof(s_cmdUi.lcdBannerL2) - 1);
+    s_cmdUi.lcdBannerL2[sizeof(s_cmdUi.lcdBannerL2) - 1] = '\0';
+    s_cmdUi.lcdBannerUntilMs = millis() + 8000UL;
+    return CMD_FX_PRINT_HELP;
+}
+
+static uint8_t cmdHistory(const CliArg* arg)
+{
+    /* seconds | all | sum | info — printed by printHistory() */
+    (void)arg;
+    return CMD_FX_PRINT_HISTORY;
+}
+
+static uint8_t cmdHyst(const CliArg* arg)
+{
+    s_cmdConfig.hysteresisC = arg->value;
+    return CMD_FX_NONE;
+}
+
+static uint8_t cmdKd(const CliArg* arg)
+{
+    s_cmdConfig.kd = arg->value;
+    return CMD_FX_NONE;
+}
+
+static uint8_t cmdKi(const CliArg* arg)
+{
+    s_cmdConfig.ki = arg->value;
+    return CMD_FX_NONE;
+}
+
+static uint8_t cmdKp(const CliArg* arg)
+{
+    s_cmdConfig.kp = arg->value;
+    return CMD_FX_NONE;
+}
+
+static uint8_t cmdMode(const CliArg* arg)
+{
+    /* choices: onoff | pid */
+    if (arg->choice == 0u)
+    {
+        s_cmdUi.mode = LAB5_2_MODE_ONOFF;
+        return CMD_FX_RESET_ONOFF;
+    }
+    s_cmdUi.mode = LAB5_2_MODE_PID;
+    return CMD_FX_RESET_PID;
+}
+
+static uint8_t cmdModulation(const CliArg* arg)
+{
+    /* choices: tpc | sd  →  index == Fan52Modulation */
+    s_cmdConfig.fanModulation = arg->choice;
+    return CMD_FX_FAN_MODULATION;
+}
+
+static uint8_t cmdPerf(const CliArg* arg)
+{
+    (void)arg;
+    return CMD_FX_PRINT_PERF;
+}
+
+static uint8_t cmdPlotter(const CliArg* arg)
+{
+    /* choices: off | on | 0 | 1  →  odd index = on */
+    s_cmdUi.reportMode = ((arg->choice & 1u) != 0u) ? LAB5_2_REPORT_MODE_PLOTTER
+                                                          : LAB5_2_REPORT_MODE_SERIAL;
+    return CMD_FX_NONE;
+}
+
+/* `polarity low` / `polarity high` — flip the relay-board polarity at
+ * runtime. Critical for hardware bring-up: if the motor runs when the
+ * firmware shows duty=0% / R-, you have an active-HIGH board on the
+ * default active-LOW build, or vice versa. */
+static uint8_t cmdPolarity(const CliArg* arg)
+{
+    /* choices: low | high | 0 | 1  →  even index = active-LOW */
+    s_cmdConfig.relayActiveLow = ((arg->choice & 1u) == 0u);
+    return CMD_FX_FAN_POLARITY;
+}
+
+static uint8_t cmdPreset(const CliArg* arg)
+{
+    if (arg->choice >= PID_PRESET_COUNT) { return CMD_FX_NONE; }
+    s_cmdConfig.kp = pgm_read_float(&PID_PRESETS[arg->choice].kp);
+    s_cmdConfig.ki = pgm_read_float(&PID_PRESETS[arg->choice].ki);
+    s_cmdConfig.kd = pgm_read_float(&PID_PRESETS[arg->choice].kd);
+    return CMD_FX_RESET_PID;
+}
+
+static uint8_t cmdRun(const CliArg* arg)
+{
+    (void)arg;
+    s_scriptOp = SCRIPT_OP_RUN;
+    return CMD_FX_PRINT_SCRIPT;
+}
+
+static uint8_t cmdScript(const CliArg* arg)
+{
+    /* choices: list | clear | save | load | stop */
+    s_scriptOp = (uint8_t)(SCRIPT_OP_LIST + arg->choice);
+    return CMD_FX_PRINT_SCRIPT;
+}
+
+/* Also reached through the bare-integer shortcut (`25` == `set 25`). */
+static uint8_t cmdSet(const CliArg* arg)
+{
+    s_cmdConfig.setpointC = arg->value;
+    return CMD_FX_RESET_PID;
+}
+
+static uint8_t cmdStatus(const CliArg* arg)
+{
+    (void)arg;
+    Lab52SensorState  sensor;
+    Lab52ControlState control;
+    g_lab52.sensor.Read(&sensor);
+    g_lab52.control.Read(&control);
+
+    snprintf(s_cmdUi.lcdBannerL1, sizeof(s_cmdUi.lcdBannerL1),
+             "T:%2dC SP:%2dC",
+             (int)(sensor.tempC + 0.5f),
+             (int)(s_cmdConfig.setpointC + 0.5f));
+    snprintf(s_cmdUi.lcdBannerL2, sizeof(s_cmdUi.lcdBannerL2),
+             "%-3s F:%3d%% kp%2d",
+             modeName(s_cmdUi.mode),
+             (int)(control.fanPctDemand + 0.5f),
+             (int)(s_cmdConfig.kp + 0.5f));
+    s_cmdUi.lcdBannerUntilMs = millis() + 6000UL;
+    return CMD_FX_PRINT_STATS;
+}
+
+static uint8_t cmdWindow(const CliArg* arg)
+{
+    s_cmdConfig.relayWindowMs = (uint16_t)arg->value;
+    return CMD_FX_FAN_WINDOW;
+}
+
+/* Sorted by name (strcasecmp order) — the CLI binary-searches it and
+ * re-checks the order when the table is registered. */
+static const CliCommand CMD_TABLE[] PROGMEM = {
+    { "at",       CLI_ARG_TEXT,  0.0f, 0.0f, "<ms> <command>",
+      cmdAt,       "script step, <ms> after `run`" },
+    { "autotune", CLI_ARG_WORD,  0.0f, 0.0f, "zn|tl|stop",
+      cmdAutotune, "relay test -> Ku/Pu -> PID gains" },
+    { "force",    CLI_ARG_WORD,  0.0f, 0.0f, "on|off|auto",
+      cmdForce,    "bypass controller for HW bring-up" },
+    { "help",     CLI_ARG_NONE,  0.0f, 0.0f, "",
+      cmdHelp,     "print this list" },
+    { "history",  CLI_ARG_INT,   1.0f, 86400.0f, "all|sum|info",
+      cmdHistory,  "stored PV trend: last <s> as CSV" },
+    { "hyst",     CLI_ARG_FLOAT, 0.5f, 5.0f, "",
+      cmdHyst,     "half-band degC, ON-OFF only" },
+    { "kd",       CLI_ARG_FLOAT, 0.0f, 50.0f, "",
+      cmdKd,       "derivative gain" },
+    { "ki",       CLI_ARG_FLOAT, 0.0f, 50.0f, "",
+      cmdKi,       "integral gain" },
+    { "kp",       CLI_ARG_FLOAT, 0.0f, 200.0f, "",
+      cmdKp,       "proportional gain" },
+    { "mode",     CLI_ARG_WORD,  0.0f, 0.0f, "onoff|pid",
+      cmdMode,     "bang-bang (6.1) or PID + TPC (6.2)" },
+    { "modulation", CLI_ARG_WORD, 0.0f, 0.0f, "tpc|sd",
+      cmdModulation, "relay: pulse/window or sigma-delta" },
+    { "perf",     CLI_ARG_NONE,  0.0f, 0.0f, "",
+      cmdPerf,     "step response: rise/overshoot/IAE" },
+    { "plotter",  CLI_ARG_WORD,  0.0f, 0.0f, "off|on|0|1",
+      cmdPlotter,  "toggle Serial Plotter CSV stream" },
+    { "polarity", CLI_ARG_WORD,  0.0f, 0.0f, "low|high|0|1",
+      cmdPolarity, "relay-board polarity (low = Wokwi)" },
+    { "preset",   CLI_ARG_WORD,  0.0f, 0.0f, "soft|balanced|aggressive|p",
+      cmdPreset,   "load a PID gain preset" },
+    { "run",      CLI_ARG_NONE,  0.0f, 0.0f, "",
+      cmdRun,      "run the script, then summarise" },
+    { "script",   CLI_ARG_WORD,  0.0f, 0.0f, "list|clear|save|load|stop",
+      cmdScript,   "show / edit / store the script" },
+    { "set",      CLI_ARG_FLOAT, LAB5_2_SETPOINT_MIN_C, LAB5_2_SETPOINT_MAX_C, "",
+      cmdSet,      "set-point degC" },
+    { "status",   CLI_ARG_NONE,  0.0f, 0.0f, "",
+      cmdStatus,   "LCD snapshot + snapshot retries" },
+    { "window",   CLI_ARG_INT,   (float)LAB5_2_RELAY_WINDOW_MIN_MS, (float)LAB5_2_RELAY_WINDOW_MAX_MS, "",
+      cmdWindow,   "TPC window length in ms" }
+};
+static const uint8_t CMD_COUNT = sizeof(CMD_TABLE) / sizeof(CMD_TABLE[0]);
+
+/* --- CLI hooks ------------------------------------------------------------ */
+
+static void printCommandsSerial(void);
+static void printSnapshotStats(void);
+static void printHistory(const CliArg* arg);
+static void printPerf(void);
+static void scriptApply(const CliArg* arg);
+static void printTuneRefused(void);
+
+/* No lock to take: publish both groups once the handler has run. */
+static void cliPublishState(void)
+{
+    s_cmdUi.commandCounter = s_cmdUi.commandCounter + 1UL;
+    g_lab52.config.Publish(s_cmdConfig);
+    g_lab52.ui.Publish(s_cmdUi);
+
+    Lab52SensorState sensor;
+    g_lab52.sensor.Read(&sensor);
+    bbLog(BB52_TASK_CMD, sensor.sensorValid, sensor.tempC, -1.0f,
+          bbFlags(s_cmdUi.mode, s_cmdUi.forceMode, sensor.sensorValid));
+}
+
+static bool cliLockIo(void)
+{
+    return xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) == pdTRUE;
+}
+
+static void cliUnlockIo(void)
+{
+    xSemaphoreGive(g_lab52.ioMutex);
+}
+
+static void applyCommandEffects(uint8_t fx, const CliArg* arg)
+{
+    /* The controllers belong to the control task: ask, don't touch. */
+    if (fx & (CMD_FX_RESET_PID | CMD_FX_RESET_ONOFF))
+    {
+        if (fx & CMD_FX_RESET_PID)   { s_cmdUi.pidResetSeq   = (uint8_t)(s_cmdUi.pidResetSeq + 1u); }
+        if (fx & CMD_FX_RESET_ONOFF) { s_cmdUi.onoffResetSeq = (uint8_t)(s_cmdUi.onoffResetSeq + 1u); }
+        g_lab52.ui.Publish(s_cmdUi);
+    }
+    if (fx & CMD_FX_FAN_WINDOW)   { Fan52_SetWindowMs((uint16_t)arg->value); }
+    if (fx & CMD_FX_FAN_POLARITY) { Fan52_SetPolarity((arg->choice & 1u) == 0u); }
+    if (fx & CMD_FX_FAN_MODULATION) { Fan52_SetModulation((Fan52Modulation)arg->choice); }
+
+    switch (fx & CMD_FX_PRINT_MASK)
+    {
+        case CMD_FX_PRINT_HELP:    printCommandsSerial(); break;
+        case CMD_FX_PRINT_STATS:   printSnapshotStats();  break;
+        case CMD_FX_PRINT_HISTORY: printHistory(arg);     break;
+        case CMD_FX_PRINT_PERF:    printPerf();           break;
+        case CMD_FX_PRINT_SCRIPT:  scriptApply(arg);      break;
+        case CMD_FX_PRINT_TUNE:    printTuneRefused();    break;
+        default:                                          break;
+    }
+
+    /* Force, limit and the resets take effect now, not at the next
+     * sample. A printout changes nothing the controller reads. */
+    const bool printOnly = ((fx & ~CMD_FX_PRINT_MASK) == 0u) && ((fx & CMD_FX_PRINT_MASK) != 0u);
+    if (!printOnly && g_lab52.ctrlTask != NULL) { xTaskNotifyGive(g_lab52.ctrlTask); }
+}
+
+/* Runs in the command task (CLI onError / setup), like the handlers. */
+static void showHelpOnLcd(void)
+{
+    (void)cmdHelp(NULL);
+    g_lab52.ui.Publish(s_cmdUi);
+}
+
+static const CliConfig LAB5_2_CLI = {
+    CMD_TABLE,
+    CMD_COUNT,
+    CLI_FLAG_ECHO_LINE | CLI_FLAG_ACK_VALUES,
+    "set",                  /* `25` == `set 25` (Indrumar Lab 6.1 shortcut) */
+    NULL,
+    cliPublishState,
+    cliLockIo,
+    cliUnlockIo,
+    applyCommandEffects,
+    showHelpOnLcd           /* unknown / rejected ⇒ flash the help banner  */
+};
+
+/** Boot/help banner. Holds ioMutex to avoid interleaving with other tasks.
+ *  The command list is rendered straight from CMD_TABLE. */
 static void printCommandsSerial(void)
 {
     if (g_lab52.ioMutex == NULL) { return; }
@@ -283,25 +797,13 @@ static void printCommandsSerial(void)
     printf("Plant: DS18B20 (D5, 4.7k pull-up) + 5V relay on D8 => DC motor / fan\n");
     printf("Modes: ON-OFF with hysteresis | discrete PID with anti-windup\n");
     printf("Actuation: BINARY (ON-OFF) or TIME-PROPORTIONAL (PID, default 2 s window)\n");
+    printf("           relay modulation: TPC pulse per window, or sigma-delta slots\n");
     printf("Polarity: relay assumed ACTIVE-LOW (Wokwi default). Use `polarity high` if your\n");
     printf("          board is wired the other way and the motor runs when it should not.\n");
     printf("\n");
-    printf("Commands (each accepted line is echoed back):\n");
-    printf("  <number>             shortcut: bare integer = new set-point degC\n");
-    printf("  mode pid             continuous PID via TPC (Indrumar Lab 6.2)\n");
-    printf("  mode onoff           bang-bang with hysteresis (Indrumar Lab 6.1)\n");
-    printf("  set <C>              set-point degC (15..35)\n");
-    printf("  hyst <C>             half-band 0.5..5, ON-OFF only\n");
-    printf("  kp <v>               proportional gain (0..200)\n");
-    printf("  ki <v>               integral gain (0..50)\n");
-    printf("  kd <v>               derivative gain (0..50)\n");
-    printf("  preset <name>        soft | balanced | aggressive | p\n");
-    printf("  window <ms>          TPC window length (500..10000, default 2000)\n");
-    printf("  polarity <low|high>  relay-board polarity (low = Wokwi default)\n");
-    printf("  force <on|off|auto>  bypass controller for HW bring-up\n");
-    printf("  plotter <on|off>     toggle Serial Plotter CSV stream\n");
-    printf("  status               snapshot on LCD for a few seconds\n");
-    printf("  help                 print this list\n");
+    printf("Commands (each accepted line is echoed back; numbers are clamped to range,\n");
+    printf("          arrow-up recalls the previous line):\n");
+    Cli_PrintCommands();
     printf("  HW pins: DS18B20=D5, relay IN=D8, LCD I2C=20/21\n");
     printf("  --- Set Serial Monitor to 115200 baud ---\n");
     printf("==========================================================\n");
@@ -309,378 +811,508 @@ static void printCommandsSerial(void)
     xSemaphoreGive(g_lab52.ioMutex);
 }
 
-static void showStatusOnLcd(void)
+/** `status`: how often a lock-free reader had to repeat its copy because
+ *  the writer published twice meanwhile (see lib_snapshot.h). */
+static void printSnapshotStats(void)
 {
-    if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-    {
-        snprintf(g_lab52.state.lcdBannerL1, sizeof(g_lab52.state.lcdBannerL1),
-                 "T:%2dC SP:%2dC",
-                 (int)(g_lab52.state.tempC + 0.5f),
-                 (int)(g_lab52.state.setpointC + 0.5f));
-        snprintf(g_lab52.state.lcdBannerL2, sizeof(g_lab52.state.lcdBannerL2),
-                 "%-3s F:%3d%% kp%2d",
-                 (g_lab52.state.mode == LAB5_2_MODE_PID) ? "PID" : "ONF",
-                 (int)(g_lab52.state.fanPctActual + 0.5f),
-                 (int)(g_lab52.config.kp + 0.5f));
-        g_lab52.state.lcdBannerUntilMs = millis() + 6000UL;
-        xSemaphoreGive(g_lab52.stateMutex);
-    }
+    if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) != pdTRUE) { return; }
+    printf("[L5.2] snapshot retries: config=%u sensor=%u control=%u ui=%u\n",
+           (unsigned)g_lab52.config.Retries(),
+           (unsigned)g_lab52.sensor.Retries(),
+           (unsigned)g_lab52.control.Retries(),
+           (unsigned)g_lab52.ui.Retries());
+    xSemaphoreGive(g_lab52.ioMutex);
 }
 
-static void showHelpOnLcd(void)
+/* --- `perf` ------------------------------------------------------------ */
+
+#define PERF_LINE_LEN   120u
+
+/** "41.3s", or "--" while the metric is not known yet. */
+static void perfSeconds(char* out, size_t outSize, bool known, uint32_t ms)
 {
-    if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+    if (!known)
     {
-        strncpy(g_lab52.state.lcdBannerL1, "mode set hyst kp", sizeof(g_lab52.state.lcdBannerL1) - 1);
-        g_lab52.state.lcdBannerL1[sizeof(g_lab52.state.lcdBannerL1) - 1] = '\0';
-        strncpy(g_lab52.state.lcdBannerL2, "ki kd preset hlp", sizeof(g_lab52.state.lcdBannerL2) - 1);
-        g_lab52.state.lcdBannerL2[sizeof(g_lab52.state.lcdBannerL2) - 1] = '\0';
-        g_lab52.state.lcdBannerUntilMs = millis() + 8000UL;
-        xSemaphoreGive(g_lab52.stateMutex);
+        snprintf(out, outSize, "--");
+        return;
     }
+    snprintf(out, outSize, "%lu.%lus",
+             (unsigned long)(ms / 1000UL), (unsigned long)((ms % 1000UL) / 100UL));
 }
 
-// ============================================================================
-// PID presets (PROGMEM-stored, for cooling-fan plant)
-// ============================================================================
+/** One line per step, shared by `perf` and the report stream. */
+static void perfFormat(char* out, size_t outSize, const StepMetrics52Result* p)
+{
+    char from[12], to[12], over[12], iae[14], rise[14], settle[14];
+    Cli_FormatValue(from, sizeof(from), p->fromC);
+    Cli_FormatValue(to,   sizeof(to),   p->toC);
+    Cli_FormatValue(over, sizeof(over), p->overshootC);
+    Cli_FormatValue(iae,  sizeof(iae),  p->iaeCs);
+    perfSeconds(rise,   sizeof(rise),   (p->flags & STEP52_F_RISEN) != 0u,   p->riseMs);
+    perfSeconds(settle, sizeof(settle), (p->flags & STEP52_F_SETTLED) != 0u, p->settleMs);
+
+    snprintf(out, outSize, "step %u %s->%sC t=%lus rise=%s over=%sC settle=%s iae=%s sw=%lu",
+             (unsigned)p->stepId, from, to, (unsigned long)(p->elapsedMs / 1000UL),
+             rise, over, settle, iae, (unsigned long)p->relaySwitches);
+}
 
-typedef struct
+static void printPerf(void)
 {
-    const char* name;
-    float kp;
-    float ki;
-    float kd;
-} PidPreset;
+    Lab52ControlState control;
+    g_lab52.control.Read(&control);
 
-static const PidPreset PID_PRESETS[] PROGMEM = {
-    /* Tuning targets: small DC fan (~1 W) cooling a thermistor in still air. */
-    { "soft",       25.0f, 0.20f,  0.0f },
-    { "balanced",   50.0f, 0.50f,  0.0f },
-    { "aggressive", 80.0f, 1.50f,  5.0f },
-    { "p",          50.0f, 0.0f,   0.0f }
-};
-static const uint8_t PID_PRESET_COUNT = sizeof(PID_PRESETS) / sizeof(PID_PRESETS[0]);
+    char line[PERF_LINE_LEN];
+    if (control.perf.stepId != 0u)
+    {
+        perfFormat(line, sizeof(line), &control.perf);
+    }
 
-static bool applyPreset(const char* name)
-{
-    for (uint8_t i = 0; i < PID_PRESET_COUNT; ++i)
+    char band[12];
+    Cli_FormatValue(band, sizeof(band), LAB5_2_PERF_BAND_C);
+
+    if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) != pdTRUE) { return; }
+    if (control.perf.stepId == 0u)
     {
-        const char* presetName = (const char*)pgm_read_ptr(&PID_PRESETS[i].name);
-        if (iequals(name, presetName))
-        {
-            const float kp = pgm_read_float(&PID_PRESETS[i].kp);
-            const float ki = pgm_read_float(&PID_PRESETS[i].ki);
-            const float kd = pgm_read_float(&PID_PRESETS[i].kd);
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                g_lab52.config.kp = kp;
-                g_lab52.config.ki = ki;
-                g_lab52.config.kd = kd;
-                xSemaphoreGive(g_lab52.stateMutex);
-            }
-            s_pid.Reset(0.0f);
-            return true;
-        }
+        printf("[L5.2][PERF] no sample yet\n");
     }
-    return false;
+    else
+    {
+        printf("[L5.2][PERF] %s\n", line);
+    }
+    printf("[L5.2][PERF] rise 10..90%%, settled = within +/-%sC for %lus, iae in C*s\n",
+           band, (unsigned long)(LAB5_2_PERF_SETTLE_HOLD_MS / 1000UL));
+    xSemaphoreGive(g_lab52.ioMutex);
 }
 
-// ============================================================================
-// Command processing  (sscanf-based, with input sanitisation in taskCommand)
-// ============================================================================
+/* --- `at` / `run` / `script` ------------------------------------------ */
 
-/** Apply a new set-point under the state mutex. Centralised so the bare-
- *  integer shortcut and the explicit `set <C>` form go through one path. */
-static bool applySetpoint(float requested, float* outClamped)
+static const char* scriptStatusText(Script52Status st)
 {
-    const float clamped = clampf(requested, LAB5_2_SETPOINT_MIN_C, LAB5_2_SETPOINT_MAX_C);
-    if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+    switch (st)
     {
-        g_lab52.config.setpointC = clamped;
-        g_lab52.state.setpointC  = clamped;
-        xSemaphoreGive(g_lab52.stateMutex);
+        case SCRIPT52_FULL:     return "script full";
+        case SCRIPT52_TOO_LONG: return "command too long";
+        case SCRIPT52_BUSY:     return "script running, `script stop` first";
+        case SCRIPT52_EMPTY:    return "script empty";
+        case SCRIPT52_NO_IMAGE: return "no script in EEPROM";
+        default:                return "ok";
     }
-    s_pid.Reset(0.0f);
-    if (outClamped != NULL) { *outClamped = clamped; }
-    return (requested >= LAB5_2_SETPOINT_MIN_C) && (requested <= LAB5_2_SETPOINT_MAX_C);
 }
 
-/** Strict bare-integer detection — matches `^[+-]?[0-9]+\s*$`.
- *  Mirrors the reference Indrumar Lab 6.1 `app_lab_6_1_i_ctrl_setpoint`
- *  behaviour where typing `25` is equivalent to `set 25`. */
-static bool isBareInteger(const char* text)
-{
-    if (text == NULL || *text == '\0') { return false; }
-    if (*text == '+' || *text == '-')  { ++text; }
-    if (!isdigit((unsigned char)*text)) { return false; }
-    while (isdigit((unsigned char)*text)) { ++text; }
-    while (*text == ' ' || *text == '\t') { ++text; }
-    return *text == '\0';
+/** Steps that would start, edit or stop a run are refused: a script
+ *  only drives the loop. */
+static bool scriptCommandAllowed(const char* cmd)
+{
+    static const char* const DENIED[] = { "at", "run", "script" };
+    const size_t len = strcspn(cmd, " \t");
+    for (uint8_t i = 0u; i < sizeof(DENIED) / sizeof(DENIED[0]); ++i)
+    {
+        if (len == strlen(DENIED[i]) && strncasecmp(cmd, DENIED[i], len) == 0) { return false; }
+    }
+    return true;
 }
 
-static void processCommand(const char* line)
+/** `at <ms> <command>`; replies under the I/O lock already held. */
+static void scriptAdd(const char* text)
 {
-    char  cmd[16] = {0};
-    char  arg[16] = {0};
-    float fvalue  = 0.0f;
+    char* end = NULL;
+    const unsigned long atMs = strtoul(text, &end, 10);
+    const char* cmd = end;
+    while (*cmd == ' ' || *cmd == '\t') { ++cmd; }
 
-    const int parsedTokens = sscanf(line, "%15s %15s", cmd, arg);
-    if (parsedTokens < 1)
+    if (end == text || cmd == end || *cmd == '\0')
     {
-        showHelpOnLcd();
+        printf("(at?) usage: at <ms> <command>\n");
+        return;
+    }
+    if (!scriptCommandAllowed(cmd))
+    {
+        printf("(at) `%s` cannot be a script step\n", cmd);
         return;
     }
 
-    /* Bare-integer setpoint shortcut: `25` is treated as `set 25`. */
-    if (parsedTokens == 1 && isBareInteger(line))
+    const Script52Status st = Script52_Add((uint32_t)atMs, cmd);
+    if (st != SCRIPT52_OK)
     {
-        const int requested = atoi(line);
-        float clamped = 0.0f;
-        const bool inRange = applySetpoint((float)requested, &clamped);
-        if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-        {
-            if (inRange)
-            {
-                printf("setpoint=%dC\n", (int)clamped);
-            }
-            else
-            {
-                printf("setpoint clamped to %dC (range %d..%d)\n",
-                       (int)clamped,
-                       (int)LAB5_2_SETPOINT_MIN_C,
-                       (int)LAB5_2_SETPOINT_MAX_C);
-            }
-            xSemaphoreGive(g_lab52.ioMutex);
-        }
+        printf("(at) %s\n", scriptStatusText(st));
         return;
     }
+    printf("(at) %lu ms: %s  [%u/%u]\n", atMs, cmd,
+           (unsigned)Script52_Count(), (unsigned)LAB5_2_SCRIPT_STEPS);
+}
 
-    /* String-arg commands first (mode, preset, force, plotter). */
-    if (parsedTokens == 2 && iequals(cmd, "mode"))
+static void scriptPrintList(void)
+{
+    const uint8_t count = Script52_Count();
+    printf("[L5.2][SCRIPT] %u/%u steps%s\n", (unsigned)count,
+           (unsigned)LAB5_2_SCRIPT_STEPS, Script52_Running() ? ", running" : "");
+    for (uint8_t i = 0u; i < count; ++i)
     {
-        if (iequals(arg, "onoff"))
-        {
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                g_lab52.state.mode = LAB5_2_MODE_ONOFF;
-                xSemaphoreGive(g_lab52.stateMutex);
-            }
-            s_onoff.Init(false);
-            return;
-        }
-        if (iequals(arg, "pid"))
-        {
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                g_lab52.state.mode = LAB5_2_MODE_PID;
-                xSemaphoreGive(g_lab52.stateMutex);
-            }
-            s_pid.Reset(0.0f);
-            return;
-        }
+        const Script52Step* step = Script52_Get(i);
+        printf("  at %8lu  %s\n", (unsigned long)step->atMs, step->cmd);
+    }
+}
+
+static void scriptPrintSummary(void)
+{
+    const Script52Summary* r = Script52_LastRun();
+    printf("[L5.2][SCRIPT] %s: %u/%u steps, %u rejected, %lu.%lus, max late %lu ms\n",
+           r->stopped ? "stopped" : "done",
+           (unsigned)r->run, (unsigned)r->steps, (unsigned)r->failed,
+           (unsigned long)(r->durationMs / 1000UL),
+           (unsigned long)((r->durationMs % 1000UL) / 100UL),
+           (unsigned long)r->maxLateMs);
+}
+
+/** Deferred half of `at` / `run` / `script` (see s_scriptOp). */
+static void scriptApply(const CliArg* arg)
+{
+    Script52Status st = SCRIPT52_OK;
+    bool ended = false;
+
+    /* Before the lock: EEPROM access can take a good fraction of a second. */
+    switch (s_scriptOp)
+    {
+        case SCRIPT_OP_RUN:   st = Script52_Start(millis()); break;
+        case SCRIPT_OP_CLEAR: st = Script52_Clear();         break;
+        case SCRIPT_OP_SAVE:  st = Script52_Save();          break;
+        case SCRIPT_OP_LOAD:  st = Script52_Load();          break;
+        case SCRIPT_OP_STOP:
+            ended = Script52_Running();
+            Script52_Stop(millis());
+            break;
+        default: break;
     }
 
-    if (parsedTokens == 2 && iequals(cmd, "preset"))
+    if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) != pdTRUE) { return; }
+    if (s_scriptOp == SCRIPT_OP_AT)
     {
-        if (applyPreset(arg)) { return; }
-        if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+        scriptAdd(arg->text);
+    }
+    else if (st != SCRIPT52_OK)
+    {
+        printf("[L5.2][SCRIPT] %s\n", scriptStatusText(st));
+    }
+    else if (s_scriptOp == SCRIPT_OP_RUN)
+    {
+        printf("[L5.2][SCRIPT] run: %u steps, last at %lu ms\n",
+               (unsigned)Script52_Count(),
+               (unsigned long)Script52_Get((uint8_t)(Script52_Count() - 1u))->atMs);
+    }
+    else if (s_scriptOp == SCRIPT_OP_STOP)
+    {
+        if (ended) { scriptPrintSummary(); }
+        else       { printf("[L5.2][SCRIPT] not running\n"); }
+    }
+    else
+    {
+        scriptPrintList();
+    }
+    xSemaphoreGive(g_lab52.ioMutex);
+}
+
+/** Command task: execute every step that is due, as if it had been typed.
+ *  The run's last step is followed by its summary and the `perf` line. */
+static void scriptService(void)
+{
+    char line[LAB5_2_SCRIPT_CMD_LEN];
+    uint32_t lateMs;
+
+    while (Script52_TakeDue(millis(), line, sizeof(line), &lateMs))
+    {
+        const Script52Summary* r = Script52_LastRun();
+        if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) == pdTRUE)
         {
-            printf("(preset?) try: soft | balanced | aggressive | p\n");
+            printf("[L5.2][SCRIPT] %u/%u +%lums> %s\n",
+                   (unsigned)(r->run + 1u), (unsigned)r->steps,
+                   (unsigned long)lateMs, line);
             xSemaphoreGive(g_lab52.ioMutex);
         }
-        return;
-    }
 
-    if (parsedTokens == 2 && iequals(cmd, "force"))
-    {
-        Lab52ForceMode m = LAB5_2_FORCE_AUTO;
-        bool known = true;
-        if      (iequals(arg, "on"))   { m = LAB5_2_FORCE_ON;  }
-        else if (iequals(arg, "off"))  { m = LAB5_2_FORCE_OFF; }
-        else if (iequals(arg, "auto")) { m = LAB5_2_FORCE_AUTO;}
-        else                           { known = false; }
-
-        if (known)
+        const bool accepted = Cli_Execute(line);
+        if (Script52_Complete(accepted, millis()))
         {
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+            if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) == pdTRUE)
             {
-                g_lab52.state.forceMode = m;
-                xSemaphoreGive(g_lab52.stateMutex);
+                scriptPrintSummary();
+                xSemaphoreGive(g_lab52.ioMutex);
             }
-            return;
+            printPerf();
         }
+    }
+}
 
-        if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-        {
-            printf("(force?) try: force on | force off | force auto\n");
-            xSemaphoreGive(g_lab52.ioMutex);
-        }
-        return;
+/* --- `autotune` -------------------------------------------------------- */
+
+static void printTuneRefused(void)
+{
+    if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) != pdTRUE) { return; }
+    printf("(autotune) refused while `force %s` is active, `force auto` first\n",
+           (s_cmdUi.forceMode == LAB5_2_FORCE_ON) ? "on" : "off");
+    xSemaphoreGive(g_lab52.ioMutex);
+}
+
+/** Gains are applied as the rule computed them or not at all: clamped, they
+ *  keep neither its ratios nor its margin. The bound is the kp / ki / kd
+ *  command ranges, nothing else. */
+static bool tuneGainsFit(float kp, float ki, float kd)
+{
+    return kp <= 200.0f && ki <= 50.0f && kd <= 50.0f;
+}
+
+/** Command task: once the control task reports the run finished, load the
+ *  rule's PID gains, or its PI gains when the PID set does not fit (on
+ *  this plant Kd always comes out in the hundreds). If neither fits, or
+ *  the run failed, fall back to the previous mode with the gains
+ *  unchanged. Say which, with the raw values. */
+static void autotuneService(void)
+{
+    if (s_cmdUi.mode != LAB5_2_MODE_TUNE) { return; }
+
+    Lab52ControlState control;
+    g_lab52.control.Read(&control);
+    const Autotune52Result* t = &control.tune;
+    if (t->runId == s_tuneRunBefore || t->state == AUTOTUNE52_RUNNING) { return; }
+
+    const Autotune52Rule rule = (Autotune52Rule)s_tuneRule;
+    const bool done = (t->state == AUTOTUNE52_DONE);
+    float pidKp = 0.0f, pidKi = 0.0f, pidKd = 0.0f;
+    float piKp  = 0.0f, piKi  = 0.0f, piKd  = 0.0f;
+    bool  pidFits = false;
+    bool  piFits  = false;
+    if (done)
+    {
+        Autotune52_Gains(rule, false, t->kuPerC, t->periodMs, &pidKp, &pidKi, &pidKd);
+        Autotune52_Gains(rule, true,  t->kuPerC, t->periodMs, &piKp,  &piKi,  &piKd);
+        pidFits = tuneGainsFit(pidKp, pidKi, pidKd);
+        piFits  = tuneGainsFit(piKp, piKi, piKd);
     }
 
-    if (parsedTokens == 2 && iequals(cmd, "plotter"))
+    if (pidFits || piFits)
+    {
+        s_cmdConfig.kp = pidFits ? pidKp : piKp;
+        s_cmdConfig.ki = pidFits ? pidKi : piKi;
+        s_cmdConfig.kd = pidFits ? pidKd : piKd;
+        s_cmdUi.mode   = LAB5_2_MODE_PID;
+    }
+    else
+    {
+        s_cmdUi.mode = s_tuneReturnMode;
+    }
+    cliPublishState();
+    applyCommandEffects((s_cmdUi.mode == LAB5_2_MODE_PID) ? CMD_FX_RESET_PID : CMD_FX_RESET_ONOFF,
+                        NULL);
+
+    char ku[12], amp[12], kp[12], ki[12], kd[12], pkp[12], pki[12];
+    Cli_FormatValue(ku,  sizeof(ku),  t->kuPerC);
+    Cli_FormatValue(amp, sizeof(amp), t->amplitudeC);
+    Cli_FormatValue(kp,  sizeof(kp),  pidKp);
+    Cli_FormatValue(ki,  sizeof(ki),  pidKi);
+    Cli_FormatValue(kd,  sizeof(kd),  pidKd);
+    Cli_FormatValue(pkp, sizeof(pkp), piKp);
+    Cli_FormatValue(pki, sizeof(pki), piKi);
+
+    if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) != pdTRUE) { return; }
+    if (done)
     {
-        const bool wantOn = iequals(arg, "on") || iequals(arg, "1");
-        const bool wantOff = iequals(arg, "off") || iequals(arg, "0");
-        if (wantOn || wantOff)
+        printf("[L5.2][TUNE] Ku=%s %%/C Pu=%lu.%lus a=%sC over %u cycles\n", ku,
+               (unsigned long)(t->periodMs / 1000UL),
+               (unsigned long)((t->periodMs % 1000UL) / 100UL), amp, (unsigned)t->cycles);
+        printf("[L5.2][TUNE] %s pid: kp=%s ki=%s kd=%s, %s\n",
+               (rule == AUTOTUNE52_RULE_TL) ? "tyreus-luyben" : "ziegler-nichols",
+               kp, ki, kd, pidFits ? "applied, mode pid" : "does not fit");
+        if (!pidFits)
         {
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                g_lab52.state.reportMode = wantOn ? LAB5_2_REPORT_MODE_PLOTTER
-                                                  : LAB5_2_REPORT_MODE_SERIAL;
-                xSemaphoreGive(g_lab52.stateMutex);
-            }
-            return;
+            printf("[L5.2][TUNE] pi: kp=%s ki=%s kd=0, %s\n", pkp, pki,
+                   piFits ? "applied, mode pid" : "does not fit; gains unchanged");
         }
-        if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+        if (!pidFits && !piFits)
         {
-            printf("(plotter?) try: plotter on | plotter off\n");
-            xSemaphoreGive(g_lab52.ioMutex);
+            printf("[L5.2][TUNE] fit: kp<=200 ki<=50 kd<=50\n");
         }
-        return;
     }
+    else
+    {
+        printf("[L5.2][TUNE] failed after %u cycles: %s; gains unchanged\n", (unsigned)t->cycles,
+               (t->state == AUTOTUNE52_TIMEOUT) ? "no steady oscillation in time" :
+               (t->state == AUTOTUNE52_ABORTED) ? "aborted by force on/off"
+                                                : "cycles never agreed");
+    }
+    xSemaphoreGive(g_lab52.ioMutex);
+}
+
+/* --- `history` --------------------------------------------------------- */
 
-    /* `polarity low` / `polarity high` — flip the relay-board polarity at
-     * runtime. Critical for hardware bring-up: if the motor runs when the
-     * firmware shows duty=0% / R-, you have an active-HIGH board on the
-     * default active-LOW build, or vice versa. */
-    if (parsedTokens == 2 && iequals(cmd, "polarity"))
+static void historyFormat(char* out, size_t outSize, int32_t value)
+{
+    Cli_FormatValue(out, outSize, (float)value / LAB5_2_HISTORY_SCALE);
+}
+
+static void printHistorySummaryRow(uint32_t bucketS, int16_t lo, int16_t hi,
+                                   int32_t sum, uint16_t n)
+{
+    char sMin[10];
+    char sAvg[10];
+    char sMax[10];
+    historyFormat(sMin, sizeof(sMin), lo);
+    historyFormat(sAvg, sizeof(sAvg), (sum + (int32_t)(n / 2u)) / (int32_t)n);
+    historyFormat(sMax, sizeof(sMax), hi);
+    printf("%lu,%s,%s,%s,%u\n", (unsigned long)bucketS, sMin, sAvg, sMax, (unsigned)n);
+}
+
+/** Stream the stored trend, oldest first. The I/O mutex is taken per
+ *  block (at most a few dozen rows), not for the whole dump, so the report
+ *  and other printers are held off for milliseconds rather than seconds;
+ *  their "[L5.2]" lines may fall between blocks and are easy to filter out
+ *  of the CSV. A block that acquisition opens meanwhile shifts the ages,
+ *  so rows not newer than the last one printed are skipped.
+ *  `history <s>` / `all`: one "t_s,tempC" row per sample; `sum`: one
+ *  "t_s,min,avg,max,n" row per LAB5_2_HISTORY_SUMMARY_S bucket; `info`:
+ *  fill level. Times are seconds since boot. */
+static void printHistory(const CliArg* arg)
+{
+    const bool all     = arg->isChoice && arg->choice == 0u;
+    const bool summary = arg->isChoice && arg->choice == 1u;
+    const bool info    = arg->isChoice && arg->choice == 2u;
+
+    if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(200)) != pdTRUE) { return; }
+
+    const uint32_t nowMs  = millis();
+    const uint8_t  blocks = s_history.BlockCount();
+
+    if (info)
     {
-        const bool wantLow  = iequals(arg, "low")  || iequals(arg, "0");
-        const bool wantHigh = iequals(arg, "high") || iequals(arg, "1");
-        if (wantLow || wantHigh)
+        const uint32_t samples = s_history.SampleCount();
+        const uint16_t bytes   = s_history.PayloadBytes();
+        uint32_t spanS = 0UL;
+        HistoryCursor c;
+        if (s_history.Open((uint8_t)(blocks - 1u), &c))
         {
-            const bool activeLow = wantLow;
-            Fan52_SetPolarity(activeLow);
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                g_lab52.config.relayActiveLow = activeLow;
-                xSemaphoreGive(g_lab52.stateMutex);
-            }
-            if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                printf("relay polarity = %s\n",
-                       activeLow ? "active-LOW (Wokwi/typical)"
-                                 : "active-HIGH (raw NPN driver)");
-                xSemaphoreGive(g_lab52.ioMutex);
-            }
-            return;
-        }
-        if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-        {
-            printf("(polarity?) try: polarity low | polarity high\n");
-            xSemaphoreGive(g_lab52.ioMutex);
+            spanS = (nowMs - c.block.startMs) / 1000UL;
         }
+        const uint32_t per100 = (samples > 0UL) ? ((uint32_t)bytes * 100UL) / samples : 0UL;
+        printf("[L5.2][HIST] %u/%u blocks, %lu samples over %lu s, %u B payload (%lu.%02lu B/sample)\n",
+               (unsigned)blocks, (unsigned)LAB5_2_HISTORY_BLOCKS,
+               (unsigned long)samples, (unsigned long)spanS, (unsigned)bytes,
+               (unsigned long)(per100 / 100UL), (unsigned long)(per100 % 100UL));
+        xSemaphoreGive(g_lab52.ioMutex);
         return;
     }
 
-    /* Numeric-arg commands. Re-parse from `line` since the first sscanf
-     * grabbed a string into `arg` which may have eaten the number. */
-    if (sscanf(line, "%15s %f", cmd, &fvalue) >= 2)
+    const uint32_t windowMs = (all || summary) ? 0xFFFFFFFFUL
+                                               : (uint32_t)arg->value * 1000UL;
+    printf(summary ? "[L5.2][HIST] t_s,min,avg,max,n\n" : "[L5.2][HIST] t_s,tempC\n");
+    xSemaphoreGive(g_lab52.ioMutex);
+
+    uint32_t rows   = 0UL;
+    uint32_t bucket = 0xFFFFFFFFUL;
+    int16_t  lo = 0;
+    int16_t  hi = 0;
+    int32_t  sum = 0L;
+    uint16_t n = 0u;
+    bool     any = false;
+    uint32_t lastMs = 0UL;
+
+    for (uint8_t age = blocks; age-- > 0u; )
     {
-        if (iequals(cmd, "set"))
-        {
-            float clamped = 0.0f;
-            (void)applySetpoint(fvalue, &clamped);
-            if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                /* avr-libc printf has no %f by default; format via integer + tenths. */
-                const int whole  = (int)clamped;
-                const int tenths = (int)((clamped - (float)whole) * 10.0f + (clamped >= 0.0f ? 0.5f : -0.5f));
-                printf("setpoint=%d.%dC\n", whole, tenths < 0 ? -tenths : tenths);
-                xSemaphoreGive(g_lab52.ioMutex);
-            }
-            return;
-        }
-        if (iequals(cmd, "hyst"))
-        {
-            fvalue = clampf(fvalue, 0.5f, 5.0f);
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                g_lab52.config.hysteresisC = fvalue;
-                g_lab52.state.hysteresisC  = fvalue;
-                xSemaphoreGive(g_lab52.stateMutex);
-            }
-            return;
-        }
-        if (iequals(cmd, "kp"))
-        {
-            fvalue = clampf(fvalue, 0.0f, 200.0f);
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                g_lab52.config.kp = fvalue;
-                xSemaphoreGive(g_lab52.stateMutex);
-            }
-            return;
-        }
-        if (iequals(cmd, "ki"))
-        {
-            fvalue = clampf(fvalue, 0.0f, 50.0f);
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                g_lab52.config.ki = fvalue;
-                xSemaphoreGive(g_lab52.stateMutex);
-            }
-            return;
-        }
-        if (iequals(cmd, "kd"))
-        {
-            fvalue = clampf(fvalue, 0.0f, 50.0f);
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                g_lab52.config.kd = fvalue;
-                xSemaphoreGive(g_lab52.stateMutex);
-            }
-            return;
-        }
-        if (iequals(cmd, "window"))
+        HistoryCursor c;
+        if (!s_history.Open(age, &c)) { continue; }
+        if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(200)) != pdTRUE) { return; }
+
+        uint32_t tMs;
+        int16_t  v;
+        while (SampleHistory::Next(&c, &tMs, &v))
         {
-            const long requested = (long)fvalue;
-            long w = requested;
-            if (w < (long)LAB5_2_RELAY_WINDOW_MIN_MS) { w = (long)LAB5_2_RELAY_WINDOW_MIN_MS; }
-            if (w > (long)LAB5_2_RELAY_WINDOW_MAX_MS) { w = (long)LAB5_2_RELAY_WINDOW_MAX_MS; }
-            Fan52_SetWindowMs((uint16_t)w);
-            if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+            if ((nowMs - tMs) > windowMs) { continue; }
+            if (any && (int32_t)(tMs - lastMs) <= 0) { continue; }
+            any    = true;
+            lastMs = tMs;
+
+            if (!summary)
             {
-                g_lab52.config.relayWindowMs = (uint16_t)w;
-                xSemaphoreGive(g_lab52.stateMutex);
+                char buf[10];
+                historyFormat(buf, sizeof(buf), v);
+                printf("%lu,%s\n", (unsigned long)(tMs / 1000UL), buf);
+                ++rows;
+                continue;
             }
-            if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+
+            const uint32_t b = tMs / (LAB5_2_HISTORY_SUMMARY_S * 1000UL);
+            if (b != bucket)
             {
-                printf("relay window = %ld ms\n", w);
-                xSemaphoreGive(g_lab52.ioMutex);
+                if (n > 0u)
+                {
+                    printHistorySummaryRow(bucket * LAB5_2_HISTORY_SUMMARY_S, lo, hi, sum, n);
+                    ++rows;
+                }
+                bucket = b;
+                lo = v;
+                hi = v;
+                sum = 0L;
+                n = 0u;
             }
-            return;
+            if (v < lo) { lo = v; }
+            if (v > hi) { hi = v; }
+            sum += v;
+            ++n;
         }
+        xSemaphoreGive(g_lab52.ioMutex);
     }
 
-    /* Argument-less commands. */
-    if (iequals(cmd, "status"))
-    {
-        showStatusOnLcd();
-        return;
-    }
-    if (iequals(cmd, "help"))
+    if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(200)) != pdTRUE) { return; }
+    if (summary && n > 0u)
     {
-        printCommandsSerial();
-        showHelpOnLcd();
-        return;
+        printHistorySummaryRow(bucket * LAB5_2_HISTORY_SUMMARY_S, lo, hi, sum, n);
+        ++rows;
     }
+    printf("[L5.2][HIST] end, %lu rows\n", (unsigned long)rows);
 
-    /* Unknown — flash help banner on LCD and tell the user exactly what we
-     * parsed, so rogue characters from arrow-key history are obvious. */
-    showHelpOnLcd();
-    if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) == pdTRUE)
+    xSemaphoreGive(g_lab52.ioMutex);
+}
+
+/** Print the ring left by the previous run, oldest record first. Runs in
+ *  setup before the scheduler, so plain printf without the I/O mutex. */
+static void bbPrintPostMortem(void)
+{
+    static const char TASK_NAMES[][5] = { "BOOT", "ACQ", "CTRL", "CMD", "DISP", "RPT" };
+
+    const uint8_t count = BlackBox52_Count();
+    printf("[L5.2][BBOX] last %u records before the reset (oldest first):\n",
+           (unsigned)count);
+
+    for (uint8_t age = count; age > 0u; --age)
     {
-        if (parsedTokens >= 2)
+        BlackBox52Record r;
+        if (!BlackBox52_Get((uint8_t)(age - 1u), &r)) { continue; }
+
+        char pv[10] = "--";
+        if (r.pvCenti != (int16_t)BB52_PV_NONE)
         {
-            printf("(unknown) cmd='%s' arg='%s' — type `help`\n", cmd, arg);
+            Cli_FormatValue(pv, sizeof(pv), (float)r.pvCenti / 100.0f);
         }
-        else
+        char duty[6] = "--";
+        if (r.dutyPct != BB52_DUTY_NONE)
         {
-            printf("(unknown) cmd='%s' — type `help`\n", cmd);
+            snprintf(duty, sizeof(duty), "%u%%", (unsigned)r.dutyPct);
         }
-        xSemaphoreGive(g_lab52.ioMutex);
+        char cmd[sizeof(CMD_TABLE[0].name)] = "-";
+        if (r.lastCmd < CMD_COUNT)
+        {
+            strncpy_P(cmd, CMD_TABLE[r.lastCmd].name, sizeof(cmd));
+            cmd[sizeof(cmd) - 1u] = '\0';
+        }
+        const char* task = (r.task < sizeof(TASK_NAMES) / sizeof(TASK_NAMES[0]))
+                         ? TASK_NAMES[r.task] : "?";
+
+        printf("[L5.2][BBOX] #%03u t=%u.%02us %-4s PV=%s duty=%s rx=%u cmd=%s %c%c%c%c%s\n",
+               (unsigned)r.seq,
+               (unsigned)(r.t10ms / 100u), (unsigned)(r.t10ms % 100u),
+               task, pv, duty, (unsigned)r.rxDepth, cmd,
+               (r.flags & BB52_F_RELAY_ON)  ? 'R' : '-',
+               (r.flags & BB52_F_SENSOR_OK) ? 'S' : '-',
+               (r.flags & BB52_F_MODE_PID)  ? 'P' : (r.flags & BB52_F_MODE_TUNE) ? 'T' : 'O',
+               (r.flags & BB52_F_FORCED)    ? 'F' : '-',
+               (r.flags & BB52_F_BOOT)      ? " boot" : "");
     }
 }
 
@@ -692,47 +1324,85 @@ void lab5_2_setup()
 {
     diagCaptureResetState();
     diagPrintBootBanner();
+    Warm52_Init(s_mcusrAtBoot);
+
+    /* Dump what the previous run was doing before this one overwrites it;
+     * then mark the boundary so the next dump shows where this run began. */
+    BlackBox52_Init(s_mcusrAtBoot);
+    if (BlackBox52_HasPostMortem())
+    {
+        bbPrintPostMortem();
+    }
+    bbLog(BB52_TASK_BOOT, false, 0.0f, -1.0f, BB52_F_BOOT);
 
-    loadDefaults(&g_lab52.config);
+    loadDefaults(&s_cmdConfig);
 
-    g_lab52.stateMutex = xSemaphoreCreateMutex();
-    g_lab52.ioMutex    = xSemaphoreCreateMutex();
-    g_lab52.qControl   = xQueueCreate(1, sizeof(Lab52ControlOutput));
+    /* A script saved with `script save` is ready to `run` after a reset. */
+    Script52_Init();
+    const bool scriptLoaded = (Script52_Load() == SCRIPT52_OK);
 
-    if ((g_lab52.stateMutex == NULL) ||
-        (g_lab52.ioMutex == NULL) ||
-        (g_lab52.qControl == NULL))
+    /* Soft reset: carry the last applied config, mode and controller state
+     * over instead of starting from the defaults. */
+    Warm52Control warmCtl;
+    const bool warmControl = Warm52_LoadControl(&warmCtl);
+    if (warmControl)
+    {
+        s_cmdConfig = warmCtl.config;
+    }
+
+    g_lab52.ioMutex = xSemaphoreCreateMutex();
+
+    if (g_lab52.ioMutex == NULL)
     {
         printf("[lab5_2][FATAL] FreeRTOS object allocation failed\n");
         for (;;) {}
     }
 
-    /* Initial runtime state */
-    g_lab52.state.tempC            = 0.0f;
-    g_lab52.state.tempRawC         = 0.0f;
-    g_lab52.state.sensorValid      = false;
-    g_lab52.state.setpointC        = g_lab52.config.setpointC;
-    g_lab52.state.hysteresisC      = g_lab52.config.hysteresisC;
-    g_lab52.state.errorC           = 0.0f;
-    g_lab52.state.pidOutput        = 0.0f;
-    g_lab52.state.fanPctDemand     = 0.0f;
-    g_lab52.state.fanPctActual     = 0.0f;
-    g_lab52.state.relayOn          = false;
-    g_lab52.state.mode             = LAB5_2_MODE_PID;
-    g_lab52.state.reportMode       = LAB5_2_REPORT_MODE_SERIAL;
-    g_lab52.state.forceMode        = LAB5_2_FORCE_AUTO;
-    g_lab52.state.lastSampleMs     = 0UL;
-    g_lab52.state.controlCycles    = 0UL;
-    g_lab52.state.commandCounter   = 0UL;
-    g_lab52.state.lcdBannerL1[0]   = '\0';
-    g_lab52.state.lcdBannerL2[0]   = '\0';
-    g_lab52.state.lcdBannerUntilMs = 0UL;
+    /* Seed every snapshot group before any task can read it. */
+    s_cmdUi.mode             = LAB5_2_MODE_PID;
+    s_cmdUi.reportMode       = LAB5_2_REPORT_MODE_SERIAL;
+    s_cmdUi.forceMode        = LAB5_2_FORCE_AUTO;
+    s_cmdUi.commandCounter   = 0UL;
+    s_cmdUi.lcdBannerL1[0]   = '\0';
+    s_cmdUi.lcdBannerL2[0]   = '\0';
+    s_cmdUi.lcdBannerUntilMs = 0UL;
+    s_cmdUi.pidResetSeq      = 0u;
+    s_cmdUi.onoffResetSeq    = 0u;
+    if (warmControl && warmCtl.mode == LAB5_2_MODE_ONOFF)
+    {
+        s_cmdUi.mode = LAB5_2_MODE_ONOFF;
+    }
+
+    Lab52SensorState sensor;
+    sensor.tempC        = 0.0f;
+    sensor.tempRawC     = 0.0f;
+    sensor.sensorValid  = false;
+    sensor.lastSampleMs = 0UL;
+    sensor.lastSampleUs = 0UL;
+
+    Lab52ControlState control;
+    control.errorC        = 0.0f;
+    control.pidOutput     = 0.0f;
+    control.fanPctDemand  = 0.0f;
+    control.controlCycles = 0UL;
+    control.ctrlLatencyUs = 0UL;
+    s_perf.Init(LAB5_2_PERF_BAND_C, LAB5_2_PERF_SETTLE_HOLD_MS);
+    control.perf          = s_perf.Result();
+    s_tune.Init();
+    control.tune          = s_tune.Result();
+
+    g_lab52.config.Init(s_cmdConfig);
+    g_lab52.ui.Init(s_cmdUi);
+    g_lab52.sensor.Init(sensor);
+    g_lab52.control.Init(control);
 
     /* Hardware bring-up: actuator off before the controller can swing it.
-     * Init also applies the boot-time polarity from LAB5_2_RELAY_ACTIVE_LOW. */
+     * Init also applies the boot-time polarity from LAB5_2_RELAY_ACTIVE_LOW
+     * and starts the Timer3 slicer. */
     Fan52_Init();
-    Fan52_SetWindowMs(g_lab52.config.relayWindowMs);
-    Fan52_SetPolarity(g_lab52.config.relayActiveLow);
+    Fan52_SetWindowMs(s_cmdConfig.relayWindowMs);
+    Fan52_SetPolarity(s_cmdConfig.relayActiveLow);
+    Fan52_SetModulation((Fan52Modulation)s_cmdConfig.fanModulation);
 
     /* I²C LCD */
     Wire.begin();
@@ -747,36 +1417,57 @@ void lab5_2_setup()
     /* Sensor + controllers */
     TempSensor52_Init();
     s_onoff.Init(false);
-    s_pid.Init(g_lab52.config.kp,
-               g_lab52.config.ki,
-               g_lab52.config.kd,
-               g_lab52.config.outputLimit,
+    s_pid.Init(s_cmdConfig.kp,
+               s_cmdConfig.ki,
+               s_cmdConfig.kd,
+               s_cmdConfig.outputLimit,
                0.0f);
 
+    TempSensor52Warm warmSensor;
+    const bool warmFilter = Warm52_LoadSensor(&warmSensor);
+    if (warmFilter)
+    {
+        TempSensor52_RestoreWarm(&warmSensor);
+    }
+    if (warmControl)
+    {
+        s_onoff.Init(warmCtl.onoffFanOn != 0u);
+        s_pid.SetState(warmCtl.pid);
+    }
+    printf("[L5.2][BOOT] warm start: filter %s, PID+config %s\n",
+           warmFilter  ? "restored" : "cold",
+           warmControl ? "restored" : "cold");
+    if (scriptLoaded)
+    {
+        printf("[L5.2][BOOT] script: %u steps from EEPROM\n", (unsigned)Script52_Count());
+    }
+
     /* Stack budget rationale: any task that calls printf needs ≥384 bytes on
      * the feilipu AVR FreeRTOS port (vprintf alone consumes ~150-200 B). All
-     * tasks below DO call printf except taskFan, so they get ≥512 B. taskFan
-     * touches only GPIO and the queue → 256 B is safe. taskCommand also runs
-     * scanf, which needs the same printf-class stack. */
+     * tasks below call printf, so they get ≥512 B; CTRL / DISP / RPT get
+     * 640 B because they now hold local snapshot copies (~150-250 B), RPT
+     * 768 B as it also formats the step-metrics line on the stack. The
+     * relay itself has no task any more — it is sliced in the Timer3 ISR. */
     BaseType_t ok;
-    ok = xTaskCreate(taskAcquisition, "L52_ACQ",   512, NULL, 3, NULL);
+    ok = xTaskCreate(taskAcquisition, "L52_ACQ",   512, NULL, 2, NULL);
     if (ok != pdPASS) { printf("[lab5_2][FATAL] ACQ task\n");  for (;;) {} }
 
-    ok = xTaskCreate(taskControl,     "L52_CTRL",  512, NULL, 3, NULL);
+    /* One above acquisition (the port has 4 levels, 0..3), so the sample
+     * notification switches to the controller at once. */
+    ok = xTaskCreate(taskControl,     "L52_CTRL",  640, NULL, 3, &g_lab52.ctrlTask);
     if (ok != pdPASS) { printf("[lab5_2][FATAL] CTRL task\n"); for (;;) {} }
 
-    ok = xTaskCreate(taskFan,         "L52_FAN",   256, NULL, 2, NULL);
-    if (ok != pdPASS) { printf("[lab5_2][FATAL] FAN task\n");  for (;;) {} }
-
-    ok = xTaskCreate(taskDisplay,     "L52_DISP",  512, NULL, 1, NULL);
+    ok = xTaskCreate(taskDisplay,     "L52_DISP",  640, NULL, 1, NULL);
     if (ok != pdPASS) { printf("[lab5_2][FATAL] DISP task\n"); for (;;) {} }
 
     ok = xTaskCreate(taskCommand,     "L52_CMD",   640, NULL, 1, NULL);
     if (ok != pdPASS) { printf("[lab5_2][FATAL] CMD task\n");  for (;;) {} }
 
-    ok = xTaskCreate(taskReport,      "L52_RPT",   512, NULL, 1, NULL);
+    ok = xTaskCreate(taskReport,      "L52_RPT",   768, NULL, 1, NULL);
     if (ok != pdPASS) { printf("[lab5_2][FATAL] RPT task\n");  for (;;) {} }
 
+    Cli_Register(&LAB5_2_CLI);
+
     printCommandsSerial();
     showHelpOnLcd();
 }
@@ -799,177 +1490,256 @@ static void taskAcquisition(void* pv)
      * staggered offset on each task. */
     vTaskDelay(pdMS_TO_TICKS(800));
 
+    Lab52Config cfg;
+    g_lab52.config.Read(&cfg);      /* task periods are fixed at boot */
+
     TickType_t lastWake = xTaskGetTickCount();
 
     for (;;)
     {
         const bool ok = TempSensor52_Loop();
-        const float tempC    = TempSensor52_GetTempC();
-        const float tempRaw  = TempSensor52_GetRawTempC();
-
-        if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+        if (ok)
         {
-            g_lab52.state.tempC        = tempC;
-            g_lab52.state.tempRawC     = tempRaw;
-            g_lab52.state.sensorValid  = ok;
-            g_lab52.state.lastSampleMs = millis();
-            xSemaphoreGive(g_lab52.stateMutex);
+            TempSensor52Warm warm;
+            TempSensor52_SaveWarm(&warm);
+            Warm52_SaveSensor(&warm);
+
+            s_history.Append(millis(),
+                             (int16_t)lroundf(TempSensor52_GetTempC() * LAB5_2_HISTORY_SCALE));
         }
 
+        /* Sole writer of the sensor group: publish, never wait. */
+        Lab52SensorState sample;
+        sample.tempC        = TempSensor52_GetTempC();
+        sample.tempRawC     = TempSensor52_GetRawTempC();
+        sample.sensorValid  = ok;
+        sample.lastSampleMs = millis();
+        sample.lastSampleUs = micros();
+        g_lab52.sensor.Publish(sample);
+
+        bbLog(BB52_TASK_ACQ, ok, sample.tempC, -1.0f, ok ? BB52_F_SENSOR_OK : 0u);
+
+        /* New PV (or a failed read, which the controller must see too). */
+        xTaskNotifyGive(g_lab52.ctrlTask);
+
         if (!ok && xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
         {
             printf("[L5.2][ACQ] DS18B20 read FAILED — check D5 wiring + 4.7k pull-up\n");
             xSemaphoreGive(g_lab52.ioMutex);
         }
 
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab52.config.acqTaskMs));
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(cfg.acqTaskMs));
     }
 }
 
 // ============================================================================
-// Control task — runs the active controller, posts to the fan queue
+// Control task — runs the active controller, drives the fan demand
 // ============================================================================
 
 static void taskControl(void* pv)
 {
     (void)pv;
 
-    /* Stagger after the acquisition task so the first control cycle has
-     * something real to work with. */
-    vTaskDelay(pdMS_TO_TICKS(1100));
+    /* No stagger or period: the loop runs when acquisition posts a sample
+     * (or a command changes limit / force), so the first cycle already has
+     * a real PV to work with. */
+    unsigned long lastPidMs    = 0UL;
+    unsigned long lastSampleUs = 0UL;
+    bool          tuneArmed    = true;     /* next autotune cycle starts a run */
+    bool          staleReported = false;    /* "no sample" printed once     */
 
-    TickType_t lastWake = xTaskGetTickCount();
+    /* What the active controller asked for at the last sample. */
+    float ctrlDemand    = 0.0f;
+    float ctrlPidOutput = 0.0f;
+
+    /* Sole writer of the control group; the counter carries over. */
+    Lab52ControlState result;
+    g_lab52.control.Read(&result);
+
+    Lab52Config cfg;
+    g_lab52.config.Read(&cfg);
+
+    /* Reset requests already served (see Lab52UiState). */
+    Lab52UiState uiAtStart;
+    g_lab52.ui.Read(&uiAtStart);
+    uint8_t pidResetSeq   = uiAtStart.pidResetSeq;
+    uint8_t onoffResetSeq = uiAtStart.onoffResetSeq;
 
     for (;;)
     {
-        Lab52Mode  mode;
-        Lab52ForceMode force;
-        float setpointC;
-        float hysteresisC;
-        float tempC;
-        float kp, ki, kd, limit;
-        bool  sensorValid;
-
-        if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(cfg.ctrlTimeoutMs));
+
+        /* Lock-free snapshots: never blocks, never skips a cycle. */
+        Lab52SensorState sensor;
+        Lab52UiState     ui;
+        g_lab52.config.Read(&cfg);
+        g_lab52.sensor.Read(&sensor);
+        g_lab52.ui.Read(&ui);
+
+        const Lab52Mode      mode        = ui.mode;
+        const Lab52ForceMode force       = ui.forceMode;
+        const float          setpointC   = cfg.setpointC;
+        const float          hysteresisC = cfg.hysteresisC;
+        const float          tempC       = sensor.tempC;
+        const float          limit       = cfg.outputLimit;
+        const unsigned long  sampleUs    = sensor.lastSampleUs;
+        const unsigned long  nowMs       = millis();
+        const bool           newSample   = (sampleUs != lastSampleUs);
+        bool                 sensorValid = sensor.sensorValid;
+
+        /* Acquisition went quiet: the PV we hold is stale. Judged by its
+         * age, not by how we woke — commands keep waking us either way.
+         * Same fail-safe as a failed read. */
+        const bool stale = (nowMs - sensor.lastSampleMs) > (unsigned long)cfg.ctrlTimeoutMs;
+        if (stale)
         {
-            mode        = g_lab52.state.mode;
-            force       = g_lab52.state.forceMode;
-            setpointC   = g_lab52.config.setpointC;
-            hysteresisC = g_lab52.config.hysteresisC;
-            tempC       = g_lab52.state.tempC;
-            kp          = g_lab52.config.kp;
-            ki          = g_lab52.config.ki;
-            kd          = g_lab52.config.kd;
-            limit       = g_lab52.config.outputLimit;
-            sensorValid = g_lab52.state.sensorValid;
-            xSemaphoreGive(g_lab52.stateMutex);
+            sensorValid = false;
+            if (!staleReported &&
+                xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+            {
+                printf("[L5.2][CTRL] no sample for %u ms — fan off\n",
+                       (unsigned)cfg.ctrlTimeoutMs);
+                xSemaphoreGive(g_lab52.ioMutex);
+                staleReported = true;
+            }
         }
         else
         {
-            vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab52.config.ctrlTaskMs));
-            continue;
+            staleReported = false;
+        }
+
+        /* Requested resets; the new state drives the next sample. */
+        if (ui.pidResetSeq != pidResetSeq)
+        {
+            pidResetSeq = ui.pidResetSeq;
+            s_pid.Reset(0.0f);
+        }
+        if (ui.onoffResetSeq != onoffResetSeq)
+        {
+            onoffResetSeq = ui.onoffResetSeq;
+            s_onoff.Init(false);
         }
 
         /* Re-arm gains every cycle (cheap; lets `kp 50` take effect on the
          * very next iteration without an explicit re-init from the parser). */
-        s_pid.Configure(kp, ki, kd, limit);
+        s_pid.Configure(cfg.kp, cfg.ki, cfg.kd, limit);
 
         Lab52ControlOutput out;
         out.mode        = mode;
         out.valid       = sensorValid;
-        out.timestampMs = millis();
+        out.timestampMs = nowMs;
         out.errorC      = sensorValid ? (tempC - setpointC) : 0.0f;
-        out.pidOutput   = 0.0f;
-        out.fanPctTarget = 0.0f;
 
-        if (force == LAB5_2_FORCE_ON)
+        /* The controllers step once per sample, on the sample's own time
+         * base: a command wake-up in between would otherwise feed them the
+         * same PV twice and shrink the PID's dt (and so blow up its D
+         * term). Such a wake only re-applies limit and force to the
+         * demand they left; a new mode or set-point takes over at the
+         * next sample. */
+        /* A run ends with its mode (`autotune stop`, `mode ...`) and cannot
+         * go on under force: it would time out on a relay it no longer
+         * drives. The command task sees the abort and restores the mode. */
+        if (mode != LAB5_2_MODE_TUNE || force != LAB5_2_FORCE_AUTO)
         {
-            out.fanPctTarget = (float)LAB5_2_FORCE_ON_PCT;
+            s_tune.Abort();
         }
-        else if (force == LAB5_2_FORCE_OFF)
+
+        bool pidStepped = false;
+        if (newSample && sensorValid && force == LAB5_2_FORCE_AUTO)
         {
-            out.fanPctTarget = 0.0f;
+            if (mode == LAB5_2_MODE_PID)
+            {
+                float dt = (float)cfg.acqTaskMs / 1000.0f;
+                if (lastPidMs != 0UL)
+                {
+                    dt = (float)(sensor.lastSampleMs - lastPidMs) / 1000.0f;
+                }
+                dt = clampf(dt, 0.01f, (float)cfg.ctrlTimeoutMs / 1000.0f);
+                lastPidMs  = sensor.lastSampleMs;
+                pidStepped = true;
+
+                ctrlPidOutput = s_pid.Step(out.errorC, dt);
+                ctrlDemand    = ctrlPidOutput;
+            }
+            else if (mode == LAB5_2_MODE_TUNE)
+            {
+                /* Each entry into the mode is a new run. */
+                if (tuneArmed)
+                {
+                    s_tune.Start(tempC, setpointC, limit, LAB5_2_TUNE_EPS_C, sensor.lastSampleMs);
+                    tuneArmed = false;
+                }
+                ctrlPidOutput = 0.0f;
+                ctrlDemand    = s_tune.Update(tempC, setpointC, sensor.lastSampleMs);
+            }
+            else /* LAB5_2_MODE_ONOFF */
+            {
+                ctrlPidOutput = 0.0f;
+                ctrlDemand    = s_onoff.Step(tempC, setpointC, hysteresisC) ? 100.0f : 0.0f;
+            }
         }
-        else if (!sensorValid)
+        if (!pidStepped && (newSample || !sensorValid))
         {
-            /* Fail-safe: no sensor ⇒ no control. Fan goes off. */
-            out.fanPctTarget = 0.0f;
+            lastPidMs = 0UL;    /* PID was not stepped: next dt restarts */
         }
-        else if (mode == LAB5_2_MODE_PID)
+        if (mode != LAB5_2_MODE_TUNE)
         {
-            const float dt  = (float)g_lab52.config.ctrlTaskMs / 1000.0f;
-            const float raw = s_pid.Step(out.errorC, dt);
-            out.pidOutput   = raw;
-
-            /* Cooling-only: discard negative pull (fan can't reverse-cool).
-             * Then clamp to [0, limit]. */
-            float demand = raw;
-            if (demand < 0.0f) { demand = 0.0f; }
-            if (demand > limit) { demand = limit; }
-            out.fanPctTarget = demand;
+            tuneArmed = true;
         }
-        else /* LAB5_2_MODE_ONOFF */
+
+        out.pidOutput = ctrlPidOutput;
+        if (force == LAB5_2_FORCE_ON)
         {
-            const bool fanOn = s_onoff.Step(tempC, setpointC, hysteresisC);
-            out.fanPctTarget = fanOn ? 100.0f : 0.0f;
+            out.fanPctTarget = (float)LAB5_2_FORCE_ON_PCT;
         }
-
-        /* Single-slot queue: overwrite is the right semantics — the fan
-         * task only cares about the most recent demand. */
-        xQueueOverwrite(g_lab52.qControl, &out);
-
-        if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+        else if (force == LAB5_2_FORCE_OFF || !sensorValid)
         {
-            g_lab52.state.errorC        = out.errorC;
-            g_lab52.state.pidOutput     = out.pidOutput;
-            g_lab52.state.fanPctDemand  = out.fanPctTarget;
-            g_lab52.state.controlCycles = g_lab52.state.controlCycles + 1UL;
-            xSemaphoreGive(g_lab52.stateMutex);
+            /* Fail-safe: no sensor ⇒ no control. Fan goes off. */
+            out.fanPctTarget = 0.0f;
         }
-
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab52.config.ctrlTaskMs));
-    }
-}
-
-// ============================================================================
-// Fan task — receive demand, run conditioning + actuation
-// ============================================================================
-
-static void taskFan(void* pv)
-{
-    (void)pv;
-
-    vTaskDelay(pdMS_TO_TICKS(1300));
-
-    TickType_t lastWake = xTaskGetTickCount();
-
-    Lab52ControlOutput out;
-    out.fanPctTarget = 0.0f;
-    out.valid        = false;
-
-    for (;;)
-    {
-        /* Drain the queue without blocking — `xQueueReceive` with timeout 0
-         * matches the "use latest known demand" semantics we want. */
-        Lab52ControlOutput latest;
-        if (xQueueReceive(g_lab52.qControl, &latest, 0) == pdTRUE)
+        else
         {
-            out = latest;
+            /* Cooling-only: discard negative pull (fan can't reverse-cool).
+             * Then clamp to [0, limit]. */
+            out.fanPctTarget = clampf(ctrlDemand, 0.0f, limit);
         }
 
-        const int demand = (int)(out.fanPctTarget + 0.5f);
-        Fan52_SetDemandPct(demand);
-        const int  actual   = Fan52_Loop();
-        const bool relayNow = Fan52_IsRelayOn();
+        /* Straight into the ISR-driven slicer, which moves the edge of the
+         * current window right away (0 % opens the relay on the spot). */
+        Fan52_SetDemandPct(out.fanPctTarget);
 
-        if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
+        /* Sample → relay latency, for cycles triggered by a new sample. */
+        unsigned long latencyUs = 0UL;
+        if (newSample)
         {
-            g_lab52.state.fanPctActual = (float)actual;
-            g_lab52.state.relayOn      = relayNow;
-            xSemaphoreGive(g_lab52.stateMutex);
+            latencyUs    = micros() - sampleUs;
+            lastSampleUs = sampleUs;
+
+            if (sensorValid)
+            {
+                s_perf.Update(tempC, setpointC, sensor.lastSampleMs, Fan52_GetSwitchCount());
+                result.perf = s_perf.Result();
+            }
         }
 
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab52.config.fanTaskMs));
+        result.tune          = s_tune.Result();
+        result.errorC        = out.errorC;
+        result.pidOutput     = out.pidOutput;
+        result.fanPctDemand  = out.fanPctTarget;
+        if (newSample) { result.ctrlLatencyUs = latencyUs; }
+        result.controlCycles = result.controlCycles + 1UL;
+        g_lab52.control.Publish(result);
+
+        bbLog(BB52_TASK_CTRL, sensorValid, tempC, out.fanPctTarget,
+              bbFlags(mode, force, sensorValid));
+
+        /* Everything the next boot needs to pick up from here. */
+        Warm52Control warm;
+        s_pid.GetState(&warm.pid);
+        warm.config     = cfg;
+        warm.mode       = (uint8_t)mode;
+        warm.onoffFanOn = s_onoff.IsFanOn() ? 1u : 0u;
+        Warm52_SaveControl(&warm);
     }
 }
 
@@ -983,74 +1753,27 @@ static void taskDisplay(void* pv)
 
     vTaskDelay(pdMS_TO_TICKS(2000));
 
+    Lab52Config cfg;
+    g_lab52.config.Read(&cfg);      /* task periods are fixed at boot */
+    const uint16_t periodMs = cfg.dispTaskMs;
+
     TickType_t lastWake = xTaskGetTickCount();
 
     for (;;)
     {
         Lab52RuntimeState snapshot;
-        if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-        {
-            snapshot = g_lab52.state;
-            xSemaphoreGive(g_lab52.stateMutex);
-            lcdRender(&snapshot);
-        }
+        readRuntimeState(&snapshot);
+        lcdRender(&snapshot);
+        bbLogState(BB52_TASK_DISP, &snapshot);
 
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab52.config.dispTaskMs));
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(periodMs));
     }
 }
 
 // ============================================================================
-// Command task — read Serial, sanitise, dispatch
+// Command task — feed the shared CLI
 // ============================================================================
 
-/** Sanitise a freshly-read line in place: strip ANSI escape sequences (e.g.
- *  the `\x1b[A` an arrow-key history sends), drop other non-printables,
- *  trim leading/trailing whitespace. Returns the new strlen. */
-static int sanitiseLine(char* buf)
-{
-    /* --- Pass 1: copy printable chars only, eat ANSI escapes --- */
-    int dst = 0;
-    for (int src = 0; buf[src] != '\0'; ++src)
-    {
-        const unsigned char c = (unsigned char)buf[src];
-
-        if (c == 0x1B) /* ESC: skip the whole CSI sequence (e.g. "[A") */
-        {
-            if (buf[src + 1] == '[')
-            {
-                src += 2;
-                while (buf[src] != '\0' && !(buf[src] >= 0x40 && buf[src] <= 0x7E))
-                {
-                    ++src;
-                }
-                if (buf[src] == '\0') { break; }
-            }
-            continue;
-        }
-        if (c < 0x20 || c > 0x7E) { continue; } /* drop other non-printables */
-
-        buf[dst++] = (char)c;
-    }
-    buf[dst] = '\0';
-
-    /* --- Pass 2: trim leading whitespace --- */
-    int start = 0;
-    while (buf[start] == ' ' || buf[start] == '\t') { ++start; }
-    if (start > 0)
-    {
-        memmove(buf, buf + start, (size_t)(dst - start + 1));
-        dst -= start;
-    }
-
-    /* --- Pass 3: trim trailing whitespace --- */
-    while (dst > 0 && (buf[dst - 1] == ' ' || buf[dst - 1] == '\t'))
-    {
-        buf[--dst] = '\0';
-    }
-
-    return dst;
-}
-
 static void taskCommand(void* pv)
 {
     (void)pv;
@@ -1059,47 +1782,31 @@ static void taskCommand(void* pv)
      * before the first command can interleave with it. */
     vTaskDelay(pdMS_TO_TICKS(1500));
 
-    char line[48];
+    Lab52Config cfg;
+    g_lab52.config.Read(&cfg);      /* task periods are fixed at boot */
+    const uint16_t periodMs = cfg.cmdTaskMs;
+
+    TickType_t lastWake = xTaskGetTickCount();
 
     for (;;)
     {
-        /* Read one line at a time via stdio. The conversion specifier
-         *   " %47[^\r\n]"
-         * skips leading whitespace, then captures up to 47 non-newline
-         * characters into `line`. Same pattern as Lab 4.2's command task.
-         *
-         * scanf() blocks until a complete line arrives, so we don't need
-         * a periodic vTaskDelay at the bottom of the loop — between
-         * commands the task is parked inside UartGetChar(). */
-        line[0] = '\0';
-        if (scanf(" %47[^\r\n]", line) != 1)
+        /* Non-blocking: drains whatever the UART RX interrupt has queued,
+         * dispatches complete lines, and returns. */
+        Cli_Poll();
+        scriptService();
+        autotuneService();
+
+        /* A script step due before the next period: sleep only until then
+         * (rounded up to whole ticks, so the step is never early). */
+        const uint32_t untilMs = Script52_MsUntilNext(millis());
+        if (untilMs < periodMs)
         {
-            /* No real line — yield and try again to avoid CPU monopoly
-             * if scanf returned EOF / mismatch on a stray byte. */
-            vTaskDelay(pdMS_TO_TICKS(g_lab52.config.cmdTaskMs));
+            TickType_t ticks = (TickType_t)((untilMs + portTICK_PERIOD_MS - 1u) / portTICK_PERIOD_MS);
+            vTaskDelay((ticks == 0u) ? 1u : ticks);
+            lastWake = xTaskGetTickCount();
             continue;
         }
-
-        /* sanitiseLine() still useful — arrow-key escapes (ESC [ A etc.)
-         * pass right through %[^\r\n]; we strip them after the fact. */
-        if (sanitiseLine(line) == 0)
-        {
-            continue;
-        }
-
-        if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-        {
-            printf("> %s\n", line);
-            xSemaphoreGive(g_lab52.ioMutex);
-        }
-
-        processCommand(line);
-
-        if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-        {
-            g_lab52.state.commandCounter = g_lab52.state.commandCounter + 1UL;
-            xSemaphoreGive(g_lab52.stateMutex);
-        }
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(periodMs));
     }
 }
 
@@ -1113,32 +1820,43 @@ static void taskReport(void* pv)
 
     vTaskDelay(pdMS_TO_TICKS(2500));
 
+    Lab52Config cfg;
+    g_lab52.config.Read(&cfg);      /* task periods are fixed at boot */
+    const uint16_t periodMs = cfg.reportTaskMs;
+
+    /* Step and settled state last seen, to announce each settling once. */
+    uint16_t perfStep    = 0u;
+    bool     perfSettled = false;
+
     TickType_t lastWake = xTaskGetTickCount();
 
     for (;;)
     {
         Lab52RuntimeState s;
-        if (xSemaphoreTake(g_lab52.stateMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-        {
-            s = g_lab52.state;
-            xSemaphoreGive(g_lab52.stateMutex);
-        }
-        else
+        readRuntimeState(&s);
+        bbLogState(BB52_TASK_RPT, &s);
+
+        const bool settled  = (s.perf.flags & STEP52_F_SETTLED) != 0u;
+        const bool announce = settled && !(s.perf.stepId == perfStep && perfSettled);
+        perfStep    = s.perf.stepId;
+        perfSettled = settled;
+        char perfLine[PERF_LINE_LEN];
+        if (announce)
         {
-            vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab52.config.reportTaskMs));
-            continue;
+            perfFormat(perfLine, sizeof(perfLine), &s.perf);
         }
 
         const int curTemp   = (int)(s.tempC + 0.5f);
         const int setpoint  = (int)(s.setpointC + 0.5f);
         const int errorInt  = (int)(s.errorC + (s.errorC >= 0 ? 0.5f : -0.5f));
-        const int duty      = (int)(s.fanPctActual + 0.5f);
+        const int duty      = (int)(s.fanPctDemand + 0.5f);
+        const int achieved  = (int)(s.fanPctActual + 0.5f);
         const int upper     = (int)(s.setpointC + s.hysteresisC + 0.5f);
         const int lower     = (int)(s.setpointC - s.hysteresisC + 0.5f);
 
         if (xSemaphoreTake(g_lab52.ioMutex, pdMS_TO_TICKS(80)) != pdTRUE)
         {
-            vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab52.config.reportTaskMs));
+            vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(periodMs));
             continue;
         }
 
@@ -1150,36 +1868,47 @@ static void taskReport(void* pv)
              * (and Arduino's built-in plotter) recognise. Mirrors the report
              * format used in the reference Lab 6.1 + 6.2. Relay is plotted
              * as 0/1 so you can correlate TPC slices with PV oscillations. */
-            printf(">Temp:%d,SetPoint:%d,Upper:%d,Lower:%d,Error:%d,Fan:%d,Relay:%d\n",
-                   curTemp, setpoint, upper, lower, errorInt, duty, relayBinary);
+            printf(">Temp:%d,SetPoint:%d,Upper:%d,Lower:%d,Error:%d,Fan:%d,FanAchieved:%d,Relay:%d,IAE:%ld\n",
+                   curTemp, setpoint, upper, lower, errorInt, duty, achieved, relayBinary,
+                   (long)(s.perf.iaeCs + 0.5f));
         }
         else if (s.reportMode == LAB5_2_REPORT_MODE_SERIAL)
         {
-            const char* modeStr   = (s.mode == LAB5_2_MODE_PID) ? "PID" : "ONF";
+            const char* modeStr   = modeName(s.mode);
             const char* relayStr  = s.relayOn ? "ON " : "off";
             const char* errSign   = (errorInt > 0) ? "+" : "";
 
             if (s.sensorValid)
             {
-                printf("[L5.2] T=%dC SP=%dC err=%s%dC duty=%d%% R=%s mode=%s",
-                       curTemp, setpoint, errSign, errorInt, duty, relayStr, modeStr);
+                printf("[L5.2] T=%dC SP=%dC err=%s%dC duty=%d%%(got %d%%) R=%s mode=%s",
+                       curTemp, setpoint, errSign, errorInt, duty, achieved, relayStr, modeStr);
             }
             else
             {
-                printf("[L5.2] T=??C SP=%dC err=%s%dC duty=%d%% R=%s mode=%s",
-                       setpoint, errSign, errorInt, duty, relayStr, modeStr);
+                printf("[L5.2] T=??C SP=%dC err=%s%dC duty=%d%%(got %d%%) R=%s mode=%s",
+                       setpoint, errSign, errorInt, duty, achieved, relayStr, modeStr);
             }
 
+            printf(" mod=%s sw=%lu lat=%luus",
+                   (s.fanModulation == FAN52_MOD_SIGMA_DELTA) ? "sd" : "tpc",
+                   s.relaySwitches,
+                   s.ctrlLatencyUs);
+
             if (s.forceMode != LAB5_2_FORCE_AUTO)
             {
                 printf(" force=%s",
                        (s.forceMode == LAB5_2_FORCE_ON) ? "on" : "off");
             }
             printf("\n");
+
+            if (announce)
+            {
+                printf("[L5.2][PERF] settled: %s\n", perfLine);
+            }
         }
         /* LAB5_2_REPORT_MODE_LCD ⇒ silent on Serial, LCD already updates. */
 
         xSemaphoreGive(g_lab52.ioMutex);
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(g_lab52.config.reportTaskMs));
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(periodMs));
     }
 }
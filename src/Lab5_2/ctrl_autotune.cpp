@@ -0,0 +1,167 @@
+#include "ctrl_autotune.h"
+
+#include <math.h>
+
+#include "Lab5_2_Shared.h"
+
+void RelayAutotune52::Init(void)
+{
+    r.runId      = 0u;
+    r.state      = AUTOTUNE52_IDLE;
+    r.cycles     = 0u;
+    r.amplitudeC = 0.0f;
+    r.periodMs   = 0UL;
+    r.kuPerC     = 0.0f;
+
+    fanOn = false;
+}
+
+void RelayAutotune52::Start(float pvC, float setpointC, float outputPctIn, float epsCIn,
+                            unsigned long nowMs)
+{
+    this->outputPct = outputPctIn;
+    this->epsC      = (epsCIn > 0.0f) ? epsCIn : -epsCIn;
+
+    r.runId      = (uint8_t)(r.runId + 1u);
+    r.state      = AUTOTUNE52_RUNNING;
+    r.cycles     = 0u;
+    r.amplitudeC = 0.0f;
+    r.periodMs   = 0UL;
+    r.kuPerC     = 0.0f;
+
+    /* Cooling: a PV above the set-point needs the fan. */
+    fanOn     = (pvC > setpointC);
+    cycleOpen = false;
+    startMs   = nowMs;
+    cycleMs   = nowMs;
+    maxC      = pvC;
+    minC      = pvC;
+    kept      = 0u;
+    head      = 0u;
+}
+
+void RelayAutotune52::finish(Autotune52State state)
+{
+    r.state = (uint8_t)state;
+    fanOn   = false;
+}
+
+/** A fan-on switch closes the cycle that the previous one opened. */
+void RelayAutotune52::endCycle(float pvC, unsigned long nowMs)
+{
+    if (!cycleOpen)
+    {
+        /* The approach to the first switch is not a cycle. */
+        cycleOpen = true;
+        cycleMs   = nowMs;
+        maxC      = minC = pvC;
+        return;
+    }
+
+    periods[head]    = (uint32_t)(nowMs - cycleMs);
+    amplitudes[head] = 0.5f * (maxC - minC);
+    head = (uint8_t)((head + 1u) % AUTOTUNE52_AGREE_CYCLES);
+    if (kept < AUTOTUNE52_AGREE_CYCLES) { kept = (uint8_t)(kept + 1u); }
+    r.cycles = (uint8_t)(r.cycles + 1u);
+
+    cycleMs = nowMs;
+    maxC    = minC = pvC;
+
+    if (kept < AUTOTUNE52_AGREE_CYCLES) { return; }
+
+    uint32_t pLo = periods[0], pHi = periods[0];
+    float    aLo = amplitudes[0], aHi = amplitudes[0];
+    float    pSum = 0.0f, aSum = 0.0f;
+    for (uint8_t i = 0u; i < AUTOTUNE52_AGREE_CYCLES; ++i)
+    {
+        if (periods[i] < pLo)    { pLo = periods[i]; }
+        if (periods[i] > pHi)    { pHi = periods[i]; }
+        if (amplitudes[i] < aLo) { aLo = amplitudes[i]; }
+        if (amplitudes[i] > aHi) { aHi = amplitudes[i]; }
+        pSum += (float)periods[i];
+        aSum += amplitudes[i];
+    }
+    const float pMean = pSum / (float)AUTOTUNE52_AGREE_CYCLES;
+    const float aMean = aSum / (float)AUTOTUNE52_AGREE_CYCLES;
+
+    const bool agree = ((float)(pHi - pLo) <= LAB5_2_TUNE_TOLERANCE * pMean) &&
+                       ((aHi - aLo)        <= LAB5_2_TUNE_TOLERANCE * aMean);
+    if (agree && aMean > epsC)
+    {
+        r.periodMs   = (uint32_t)(pMean + 0.5f);
+        r.amplitudeC = aMean;
+        r.kuPerC     = (4.0f * 0.5f * outputPct) /
+                       ((float)M_PI * sqrtf(aMean * aMean - epsC * epsC));
+        finish(AUTOTUNE52_DONE);
+        return;
+    }
+    if (r.cycles >= LAB5_2_TUNE_MAX_CYCLES)
+    {
+        finish(AUTOTUNE52_UNSTABLE);
+    }
+}
+
+float RelayAutotune52::Update(float pvC, float setpointC, unsigned long nowMs)
+{
+    if (r.state != AUTOTUNE52_RUNNING) { return 0.0f; }
+
+    if (nowMs - startMs > LAB5_2_TUNE_TIMEOUT_MS)
+    {
+        finish(AUTOTUNE52_TIMEOUT);
+        return 0.0f;
+    }
+
+    if (pvC > maxC) { maxC = pvC; }
+    if (pvC < minC) { minC = pvC; }
+
+    if (!fanOn && pvC > setpointC + epsC)
+    {
+        fanOn = true;
+        endCycle(pvC, nowMs);
+    }
+    else if (fanOn && pvC < setpointC - epsC)
+    {
+        fanOn = false;
+    }
+
+    return fanOn ? outputPct : 0.0f;
+}
+
+void RelayAutotune52::Abort(void)
+{
+    if (r.state == AUTOTUNE52_RUNNING) { finish(AUTOTUNE52_ABORTED); }
+}
+
+bool RelayAutotune52::Running(void) const
+{
+    return r.state == AUTOTUNE52_RUNNING;
+}
+
+const Autotune52Result& RelayAutotune52::Result() const
+{
+    return r;
+}
+
+void Autotune52_Gains(Autotune52Rule rule, bool piOnly, float kuPerC, uint32_t puMs,
+                      float* kp, float* ki, float* kd)
+{
+    const float puS = (float)puMs / 1000.0f;
+    float ti;
+    float td;
+
+    if (rule == AUTOTUNE52_RULE_TL)
+    {
+        *kp = piOnly ? kuPerC / 3.2f : kuPerC / 2.2f;
+        ti  = 2.2f * puS;
+        td  = piOnly ? 0.0f : puS / 6.3f;
+    }
+    else
+    {
+        *kp = piOnly ? 0.45f * kuPerC : 0.6f * kuPerC;
+        ti  = piOnly ? puS / 1.2f : 0.5f * puS;
+        td  = piOnly ? 0.0f : 0.125f * puS;
+    }
+
+    *ki = (ti > 0.0f) ? *kp / ti : 0.0f;
+    *kd = *kp * td;
+}
@@ -0,0 +1,121 @@
+#ifndef LAB5_2_CTRL_AUTOTUNE_H
+#define LAB5_2_CTRL_AUTOTUNE_H
+
+#include <stdint.h>
+
+/**
+ * Relay-feedback PID autotuner (Åström–Hägglund).
+ *
+ * While it runs, the controller is replaced by a relay with a small
+ * hysteresis ±ε around the set-point: fan at `outputPct` once the PV is
+ * above SP + ε, off once it is below SP − ε. Almost any thermal plant then
+ * settles into a limit cycle whose period is close to the ultimate period
+ * Pu, and whose amplitude a gives the ultimate gain through the
+ * describing function of a relay of amplitude d = outputPct / 2:
+ *
+ *     Ku = 4·d / (π·√(a² − ε²))        (% per °C)
+ *
+ * A cycle runs from one fan-on switch to the next; its amplitude is half
+ * the PV peak-to-peak within it. The oscillation counts as steady once the
+ * last AUTOTUNE52_AGREE_CYCLES cycles agree within LAB5_2_TUNE_TOLERANCE on
+ * both period and amplitude; the result is their mean. No agreement after
+ * LAB5_2_TUNE_MAX_CYCLES, or no result within LAB5_2_TUNE_TIMEOUT_MS,
+ * ends the run as a failure.
+ *
+ * The PV is what the controller sees (whole degrees after the sensor
+ * pipeline), so a is quantised to 0.5 °C: Ku is coarse, which the
+ * Tyreus–Luyben rule tolerates better than Ziegler–Nichols.
+ *
+ * Autotune52_Gains() turns Ku / Pu into gains in the units of
+ * PidController52 (Ki = Kp / Ti per second, Kd = Kp · Td in seconds),
+ * either the rule's PID row or its PI row. On a slow thermal plant the
+ * PID row's Kd comes out in the hundreds, which a whole-degree PV turns
+ * into full-scale kicks; the PI row is the rule's own answer for a loop
+ * that cannot use D.
+ */
+
+/** Consecutive cycles that must agree before Ku / Pu are taken. */
+#define AUTOTUNE52_AGREE_CYCLES  3u
+
+typedef enum
+{
+    AUTOTUNE52_IDLE     = 0,
+    AUTOTUNE52_RUNNING  = 1,
+    AUTOTUNE52_DONE     = 2,
+    AUTOTUNE52_TIMEOUT  = 3,    /* no steady oscillation in time            */
+    AUTOTUNE52_UNSTABLE = 4,    /* cycles never agreed                      */
+    AUTOTUNE52_ABORTED  = 5     /* Abort(): left the mode, or forced        */
+} Autotune52State;
+
+typedef enum
+{
+    AUTOTUNE52_RULE_ZN = 0,     /* Ziegler–Nichols: Kp 0.6 Ku, Ti Pu/2, Td Pu/8;
+                                   PI: Kp 0.45 Ku, Ti Pu/1.2                    */
+    AUTOTUNE52_RULE_TL = 1      /* Tyreus–Luyben: Kp Ku/2.2, Ti 2.2 Pu, Td Pu/6.3;
+                                   PI: Kp Ku/3.2, Ti 2.2 Pu                     */
+} Autotune52Rule;
+
+typedef struct
+{
+    uint8_t  runId;         /* +1 per Start()                               */
+    uint8_t  state;         /* Autotune52State                              */
+    uint8_t  cycles;        /* full relay cycles seen in this run           */
+    float    amplitudeC;    /* a, mean of the agreeing cycles               */
+    uint32_t periodMs;      /* Pu                                           */
+    float    kuPerC;        /* Ku                                           */
+} Autotune52Result;
+
+class RelayAutotune52
+{
+public:
+    /** Idle, runId 0. */
+    void Init(void);
+
+    /**
+     * Begin a run; the relay starts on the side the PV is on.
+     * @param outputPct  fan duty while the relay is on (d = outputPct / 2)
+     * @param epsC       relay hysteresis ε (°C)
+     */
+    void Start(float pvC, float setpointC, float outputPct, float epsC, unsigned long nowMs);
+
+    /**
+     * Account one PV sample and switch the relay.
+     * @return fan duty to apply (0 or outputPct); 0 once the run has ended
+     */
+    float Update(float pvC, float setpointC, unsigned long nowMs);
+
+    /** End a run that is in progress as AUTOTUNE52_ABORTED; no-op otherwise. */
+    void Abort(void);
+
+    bool Running(void) const;
+
+    const Autotune52Result& Result() const;
+
+private:
+    void endCycle(float pvC, unsigned long nowMs);
+    void finish(Autotune52State state);
+
+    float outputPct;
+    float epsC;
+
+    Autotune52Result r;
+
+    bool          fanOn;
+    bool          cycleOpen;        /* a fan-on switch has been seen        */
+    unsigned long startMs;
+    unsigned long cycleMs;          /* start of the current cycle           */
+    float         maxC;
+    float         minC;
+
+    uint8_t       kept;             /* entries in the rings below           */
+    uint8_t       head;
+    uint32_t      periods[AUTOTUNE52_AGREE_CYCLES];
+    float         amplitudes[AUTOTUNE52_AGREE_CYCLES];
+};
+
+/** Gains from Ku / Pu by `rule` (its PI row when `piOnly`, *kd = 0),
+ *  in PidController52 units. */
+void Autotune52_Gains(Autotune52Rule rule, bool piOnly, float kuPerC, uint32_t puMs,
+                      float* kp, float* ki, float* kd);
+
+#endif
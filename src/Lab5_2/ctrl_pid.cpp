@@ -27,6 +27,28 @@ void PidController52::Configure(float kpIn, float kiIn, float kdIn, float limitA
     this->limitAbs = (limitAbsIn > 1.0f) ? limitAbsIn : 1.0f;
 }
 
+void PidController52::GetState(PidState52* out) const
+{
+    out->integral    = integral;
+    out->prevError   = prevError;
+    out->initialized = initialized;
+}
+
+void PidController52::SetState(const PidState52& in)
+{
+    /* Same anti-windup bound Step() enforces. */
+    integral    = clamp(in.integral, integralLimit());
+    prevError   = in.prevError;
+    initialized = in.initialized;
+}
+
+/** Accumulator bound that lets the I term reach, but not pass, the output
+ *  limit. No Ki, no I term: nothing to accumulate. */
+float PidController52::integralLimit(void) const
+{
+    return (ki > 0.0f) ? limitAbs / ki : 0.0f;
+}
+
 float PidController52::clamp(float value, float limit) const
 {
     if (value >  limit) { return  limit; }
@@ -53,13 +75,11 @@ float PidController52::Step(float error, float dtSeconds)
     const float pTerm = kp * error;
 
     /* --- Integral term with anti-windup -------------------------------- */
-    /* Accumulate the running error*dt and hard-clamp the accumulator. The
-     * reference solution clamps at +100 only (cooling-only plant); we keep
-     * the same magnitude for behavioural parity but allow negative values
-     * so the integrator can also DIS-charge symmetrically.               */
-    integral += error * dtSeconds;
-    if (integral >  LAB5_2_PID_INTEGRAL_LIMIT) { integral =  LAB5_2_PID_INTEGRAL_LIMIT; }
-    if (integral < -LAB5_2_PID_INTEGRAL_LIMIT) { integral = -LAB5_2_PID_INTEGRAL_LIMIT; }
+    /* Accumulate the running error*dt and clamp it so that Ki·∫e stays
+     * within ±limitAbs: the I term can supply any duty the output can,
+     * whatever Ki is, and never more. Symmetric, so the integrator can
+     * also DIS-charge.                                                   */
+    integral = clamp(integral + error * dtSeconds, integralLimit());
     const float iTerm = ki * integral;
 
     /* --- Derivative term (on error) ------------------------------------ */
@@ -11,11 +11,12 @@
  * with two hardening tweaks borrowed from the reference solution
  * (`app_lab_6_2_i_ctrl_dc_motor`) and from textbook practice:
  *
- *   1. Anti-windup on the integral. The accumulator is clamped to
- *      ±LAB5_2_PID_INTEGRAL_LIMIT (default 100) so the I term cannot
- *      saturate and "wind up" while the actuator is already at full power.
- *      The reference does the simpler "clamp at +100" because its plant
- *      is unidirectional too — we replicate that for behavioural match.
+ *   1. Anti-windup on the integral, in output units: the accumulator is
+ *      clamped so that |Ki·∑e·Δt| ≤ limitAbs. The I term can then supply
+ *      any duty the actuator can (so a small Ki still removes the offset)
+ *      but cannot "wind up" beyond full power. The reference clamps the
+ *      accumulator at a fixed +100 °C·s, which caps the I term at Ki·100 %
+ *      and leaves a droop whenever Ki < 1.
  *
  *   2. Output clamp to ±limitAbs (default 100, in % fan power). The PID
  *      output is the abstract demand; the fan service interprets it as a
@@ -28,6 +29,15 @@
  * Reset()/Configure() let the command parser swap gains at runtime without
  * tearing the task down.
  */
+/** Dynamic state of the controller (everything Step() carries over from
+ *  one cycle to the next), for the warm-start image. */
+typedef struct
+{
+    float integral;
+    float prevError;
+    bool  initialized;
+} PidState52;
+
 class PidController52
 {
 public:
@@ -43,8 +53,13 @@ public:
      */
     float Step(float error, float dtSeconds);
 
+    /** Save / reload the integrator and derivative memory (warm start). */
+    void  GetState(PidState52* out) const;
+    void  SetState(const PidState52& in);
+
 private:
     float clamp(float value, float limitAbs) const;
+    float integralLimit(void) const;
 
     float kp;
     float ki;
@@ -0,0 +1,115 @@
+#include "ctrl_step_metrics.h"
+
+#include <math.h>
+
+#include "Lab5_2_Shared.h"
+
+void StepMetrics52::Init(float bandCIn, uint32_t holdMsIn)
+{
+    this->bandC  = (bandCIn > 0.0f) ? bandCIn : -bandCIn;
+    this->holdMs = holdMsIn;
+
+    r.stepId        = 0u;
+    r.flags         = 0u;
+    r.fromC         = 0.0f;
+    r.toC           = 0.0f;
+    r.elapsedMs     = 0UL;
+    r.riseMs        = 0UL;
+    r.settleMs      = 0UL;
+    r.overshootC    = 0.0f;
+    r.iaeCs         = 0.0f;
+    r.relaySwitches = 0UL;
+
+    primed = false;
+}
+
+void StepMetrics52::beginStep(float pvC, float setpointC, unsigned long nowMs, uint32_t relaySwitches)
+{
+    r.stepId        = (uint16_t)(r.stepId + 1u);
+    r.flags         = 0u;
+    r.fromC         = pvC;
+    r.toC           = setpointC;
+    r.elapsedMs     = 0UL;
+    r.riseMs        = 0UL;
+    r.settleMs      = 0UL;
+    r.overshootC    = 0.0f;
+    r.iaeCs         = 0.0f;
+    r.relaySwitches = 0UL;
+
+    stepMs         = nowMs;
+    switchesAtStep = relaySwitches;
+    reachedLow     = false;
+    inBand         = false;
+
+    /* A step smaller than the band has nothing to rise through. */
+    if (fabsf(setpointC - pvC) <= bandC)
+    {
+        r.flags   |= STEP52_F_RISEN;
+        reachedLow = true;
+    }
+}
+
+void StepMetrics52::Update(float pvC, float setpointC, unsigned long nowMs, uint32_t relaySwitches)
+{
+    if (!primed || fabsf(setpointC - lastSetpointC) >= LAB5_2_PERF_MIN_STEP_C)
+    {
+        beginStep(pvC, setpointC, nowMs, relaySwitches);
+        lastMs = nowMs;
+        primed = true;
+    }
+    lastSetpointC = setpointC;
+
+    const float errorC = pvC - setpointC;
+    r.iaeCs        += fabsf(errorC) * (float)(nowMs - lastMs) / 1000.0f;
+    lastMs          = nowMs;
+    r.elapsedMs     = nowMs - stepMs;
+    r.relaySwitches = relaySwitches - switchesAtStep;
+
+    /* Progress along the step: 0 at the start, 1 at the set-point. */
+    const float stepC = r.toC - r.fromC;
+    if ((r.flags & STEP52_F_RISEN) == 0u)
+    {
+        const float progress = (pvC - r.fromC) / stepC;
+        if (!reachedLow && progress >= 0.1f)
+        {
+            reachedLow = true;
+            lowMs      = nowMs;
+        }
+        if (reachedLow && progress >= 0.9f)
+        {
+            r.riseMs = nowMs - lowMs;
+            r.flags |= STEP52_F_RISEN;
+        }
+    }
+
+    /* Past the set-point means "further in the direction of the step". */
+    const float pastC = (stepC >= 0.0f) ? errorC : -errorC;
+    if (pastC > r.overshootC)
+    {
+        r.overshootC = pastC;
+    }
+
+    if (fabsf(errorC) <= bandC)
+    {
+        if (!inBand)
+        {
+            inBand        = true;
+            inBandSinceMs = nowMs;
+        }
+        if ((r.flags & STEP52_F_SETTLED) == 0u && nowMs - inBandSinceMs >= holdMs)
+        {
+            r.settleMs = inBandSinceMs - stepMs;
+            r.flags   |= STEP52_F_SETTLED;
+        }
+    }
+    else
+    {
+        inBand   = false;
+        r.flags &= (uint8_t)~STEP52_F_SETTLED;
+    }
+}
+
+const StepMetrics52Result& StepMetrics52::Result() const
+{
+    return r;
+}
@@ -0,0 +1,85 @@
+#ifndef LAB5_2_CTRL_STEP_METRICS_H
+#define LAB5_2_CTRL_STEP_METRICS_H
+
+#include <stdint.h>
+
+/**
+ * Online step-response metrics for the closed loop.
+ *
+ * Fed one filtered PV sample per acquisition by the control task. A change
+ * of the set-point by at least LAB5_2_PERF_MIN_STEP_C starts a new step
+ * (so does the first sample after boot: the loop is then pulling the PV
+ * from wherever it was to the set-point). From there, on every sample:
+ *
+ *   rise       time from 10 % to 90 % of the way from the starting PV to
+ *              the new set-point
+ *   overshoot  furthest the PV has carried on past the set-point in the
+ *              direction of the step (°C, ≥ 0)
+ *   settling   step → the last entry into |PV - SP| ≤ band, declared once
+ *              the PV has then stayed inside for holdMs. Leaving the band
+ *              again clears it until the PV settles anew.
+ *   IAE        ∑ |PV - SP| · Δt since the step (°C·s)
+ *   switches   relay transitions since the step
+ *
+ * Everything is incremental: no sample buffer, a few floats of state.
+ * Note the PV is what the controller sees — whole degrees after the
+ * sensor pipeline — so the band should not be narrower than 0.5 °C.
+ */
+
+#define STEP52_F_RISEN      0x01u   /* riseMs is valid                      */
+#define STEP52_F_SETTLED    0x02u   /* settleMs is valid                    */
+
+typedef struct
+{
+    uint16_t stepId;        /* 0 = no step yet; +1 per step                 */
+    uint8_t  flags;         /* STEP52_F_*                                   */
+    float    fromC;         /* PV when the step started                     */
+    float    toC;           /* set-point of the step                        */
+    uint32_t elapsedMs;     /* since the step, at the last sample           */
+    uint32_t riseMs;
+    uint32_t settleMs;
+    float    overshootC;
+    float    iaeCs;
+    uint32_t relaySwitches;
+} StepMetrics52Result;
+
+class StepMetrics52
+{
+public:
+    /**
+     * @param bandC   settling half-band around the set-point (°C)
+     * @param holdMs  time the PV must stay in the band to count as settled
+     */
+    void Init(float bandC, uint32_t holdMs);
+
+    /**
+     * Account one PV sample.
+     * @param pvC            filtered process value (°C)
+     * @param setpointC      set-point in force
+     * @param nowMs          sample timestamp
+     * @param relaySwitches  Fan52_GetSwitchCount() at the sample
+     */
+    void Update(float pvC, float setpointC, unsigned long nowMs, uint32_t relaySwitches);
+
+    const StepMetrics52Result& Result() const;
+
+private:
+    void beginStep(float pvC, float setpointC, unsigned long nowMs, uint32_t relaySwitches);
+
+    float    bandC;
+    uint32_t holdMs;
+
+    StepMetrics52Result r;
+
+    bool          primed;
+    bool          reachedLow;       /* passed 10 % of the step              */
+    bool          inBand;
+    float         lastSetpointC;
+    unsigned long stepMs;
+    unsigned long lastMs;
+    unsigned long lowMs;            /* when 10 % was passed                 */
+    unsigned long inBandSinceMs;
+    uint32_t      switchesAtStep;
+};
+
+#endif
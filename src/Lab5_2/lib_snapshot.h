@@ -0,0 +1,90 @@
+#ifndef LAB5_2_LIB_SNAPSHOT_H
+#define LAB5_2_LIB_SNAPSHOT_H
+
+#include <stdint.h>
+
+/**
+ * LIB layer — single-writer / multi-reader snapshot (double buffer + seq).
+ *
+ * Replaces "take the state mutex, copy, give" for data that has exactly one
+ * writing task. Neither side ever blocks:
+ *
+ *   Publish()  the writer fills the buffer readers are NOT using, then
+ *              flips to it by bumping the sequence counter.
+ *   Read()     a reader copies the current buffer and re-checks the counter;
+ *              if the writer has started to overwrite that very buffer in
+ *              the meantime (two publishes while the copy was in progress),
+ *              the copy is discarded and repeated.
+ *
+ * The sequence counter advances by 2 per publish and is odd while a write
+ * is in progress; publish k lives in buffer (k & 1). A reader that started
+ * at seq `s` read buffer ((s >> 1) & 1), which stays intact until the
+ * counter reaches (s & ~1) + 3 — so a retry is needed only when the reader
+ * was preempted long enough for the writer to publish twice.
+ *
+ * Why not a plain (single buffer) seqlock: on one core with preemptive
+ * priorities, a high-priority reader that interrupts a low-priority writer
+ * mid-write would spin forever waiting for a writer that cannot run. With
+ * two buffers that reader simply takes the other, complete one.
+ *
+ * Constraints:
+ *   - Exactly one task calls Publish() for a given instance.
+ *   - Not for ISRs (readers may retry; use ATOMIC_BLOCK there).
+ *   - uint8_t counter: a byte store is atomic on AVR; wrap-around is fine
+ *     because only differences are compared.
+ */
+template <typename T>
+class Snapshot52
+{
+public:
+    /** Seed both buffers before the scheduler starts (or the first Read). */
+    void Init(const T& value)
+    {
+        m_buf[0]  = value;
+        m_buf[1]  = value;
+        m_seq     = 0u;
+        m_retries = 0u;
+    }
+
+    /** Writer side. Never blocks, never fails. */
+    void Publish(const T& value)
+    {
+        const uint8_t seq = m_seq;                  /* even: stable         */
+        m_seq = (uint8_t)(seq + 1u);                /* odd: writing         */
+        barrier();
+        m_buf[((seq >> 1) + 1u) & 1u] = value;
+        barrier();
+        m_seq = (uint8_t)(seq + 2u);                /* readers switch here  */
+    }
+
+    /** Reader side. Returns a consistent copy; retries are counted. */
+    void Read(T* out) const
+    {
+        for (;;)
+        {
+            const uint8_t seq = m_seq;
+            barrier();
+            *out = m_buf[(seq >> 1) & 1u];
+            barrier();
+            const uint8_t seen = (uint8_t)(m_seq - (uint8_t)(seq & 0xFEu));
+            if (seen < 3u)
+            {
+                return;
+            }
+            m_retries = (uint16_t)(m_retries + 1u);
+        }
+    }
+
+    /** Reads that had to be repeated. Diagnostic only (unsynchronised
+     *  increment; a lost count under contention is acceptable). */
+    uint16_t Retries(void) const { return m_retries; }
+
+private:
+    static void barrier(void) { __asm__ __volatile__("" ::: "memory"); }
+
+    T                 m_buf[2];
+    volatile uint8_t  m_seq;
+    mutable volatile uint16_t m_retries;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "srv_blackbox.h"
+
+#include <avr/io.h>
+#include <util/atomic.h>
+
+/* ============================================================================
+ * Module statics — the ring lives in .noinit so a soft reset keeps it.
+ * ==========================================================================*/
+
+#define BB52_MAGIC  0xB1ACu
+
+typedef struct
+{
+    uint16_t         magic;
+    uint8_t          head;      /* next slot to write                       */
+    uint8_t          count;     /* valid records                            */
+    uint8_t          seq;       /* next record number                       */
+    BlackBox52Record rec[LAB5_2_BLACKBOX_DEPTH];
+} BlackBoxRing;
+
+static BlackBoxRing s_ring __attribute__((section(".noinit")));
+
+/* Decided once at boot, before this boot's own records land in the ring. */
+static bool s_postMortem = false;
+
+/* ============================================================================
+ * Public API
+ * ==========================================================================*/
+
+void BlackBox52_Init(uint8_t mcusrAtBoot)
+{
+    const bool intact = (s_ring.magic == BB52_MAGIC)
+                     && (s_ring.head  <  LAB5_2_BLACKBOX_DEPTH)
+                     && (s_ring.count <= LAB5_2_BLACKBOX_DEPTH);
+
+    /* After power-on the SRAM content is noise, however plausible. */
+    if (!intact || (mcusrAtBoot & (1 << PORF)) != 0u)
+    {
+        s_ring.head  = 0u;
+        s_ring.count = 0u;
+        s_ring.seq   = 0u;
+        s_ring.magic = BB52_MAGIC;
+    }
+
+    s_postMortem = (s_ring.count > 0u);
+}
+
+bool BlackBox52_HasPostMortem(void)
+{
+    return s_postMortem;
+}
+
+uint8_t BlackBox52_Count(void)
+{
+    uint8_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { count = s_ring.count; }
+    return count;
+}
+
+bool BlackBox52_Get(uint8_t age, BlackBox52Record* out)
+{
+    bool ok = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (age < s_ring.count)
+        {
+            const uint8_t idx = (uint8_t)((s_ring.head + LAB5_2_BLACKBOX_DEPTH - 1u - age)
+                                          % LAB5_2_BLACKBOX_DEPTH);
+            *out = s_ring.rec[idx];
+            ok = true;
+        }
+    }
+    return ok;
+}
+
+void BlackBox52_Record(BlackBox52Record* rec)
+{
+    rec->t10ms = (uint16_t)(millis() / 10UL);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        rec->seq = s_ring.seq;
+        s_ring.seq = (uint8_t)(s_ring.seq + 1u);
+
+        s_ring.rec[s_ring.head] = *rec;
+        s_ring.head = (uint8_t)((s_ring.head + 1u) % LAB5_2_BLACKBOX_DEPTH);
+        if (s_ring.count < LAB5_2_BLACKBOX_DEPTH)
+        {
+            s_ring.count = (uint8_t)(s_ring.count + 1u);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef LAB5_2_SRV_BLACKBOX_H
+#define LAB5_2_SRV_BLACKBOX_H
+
+#include <stdint.h>
+
+#include "Lab5_2_Shared.h"
+
+/**
+ * SRV layer — post-mortem black-box recorder.
+ *
+ * The boot banner tells *that* the board reset (WDT / BOR / EXT), never
+ * *what it was doing*. This service keeps a fixed ring of compact records
+ * in `.noinit` SRAM, written by the tasks as they run; after a soft reset
+ * the ring is still there and the next boot prints it before anything
+ * else overwrites it.
+ *
+ * A record is 10 bytes: time, which task wrote it, PV, fan duty, RX queue
+ * depth, last CLI command and a few state flags. Writing one is a struct
+ * copy under ATOMIC_BLOCK — no locks, no I/O — so it is safe from any task
+ * and cheap enough to call every cycle.
+ *
+ * A power-on reset, a bad magic word or out-of-range ring indices clear
+ * the recorder; there is no CRC, a torn last record is acceptable in a
+ * trace and is recognisable by its sequence number.
+ */
+
+/** Writer ids (BlackBox52Record::task). */
+typedef enum
+{
+    BB52_TASK_BOOT = 0,
+    BB52_TASK_ACQ  = 1,
+    BB52_TASK_CTRL = 2,
+    BB52_TASK_CMD  = 3,
+    BB52_TASK_DISP = 4,
+    BB52_TASK_RPT  = 5
+} BlackBox52Task;
+
+/** BlackBox52Record::flags */
+#define BB52_F_RELAY_ON   0x01u
+#define BB52_F_SENSOR_OK  0x02u
+#define BB52_F_MODE_PID   0x04u
+#define BB52_F_FORCED     0x08u     /* force on/off override active        */
+#define BB52_F_MODE_TUNE  0x10u     /* relay autotune (neither PID nor ON-OFF) */
+#define BB52_F_BOOT       0x80u     /* first record after a (re)boot       */
+
+/** pvCenti when the writer has no valid PV. */
+#define BB52_PV_NONE      INT16_MIN
+
+/** dutyPct when the writer does not know the duty. */
+#define BB52_DUTY_NONE    0xFFu
+
+typedef struct
+{
+    uint16_t t10ms;     /* millis() / 10, wraps every ~11 min  (stamped)    */
+    uint8_t  seq;       /* running record number              (stamped)    */
+    uint8_t  task;      /* BlackBox52Task                                   */
+    int16_t  pvCenti;   /* PV in 0.01 °C, or BB52_PV_NONE                   */
+    uint8_t  dutyPct;   /* demanded fan duty 0..100, or BB52_DUTY_NONE      */
+    uint8_t  rxDepth;   /* Serial RX bytes waiting (saturated at 255)       */
+    uint8_t  lastCmd;   /* CLI table row of the last command, 0xFF = none   */
+    uint8_t  flags;     /* BB52_F_*                                         */
+} BlackBox52Record;
+
+/**
+ * Call once at boot with the captured MCUSR, before any other call.
+ * Keeps the ring after a soft reset, clears it otherwise.
+ */
+void BlackBox52_Init(uint8_t mcusrAtBoot);
+
+/** @return true if the ring survived a soft reset and holds records. */
+bool BlackBox52_HasPostMortem(void);
+
+/** Records currently held (0..LAB5_2_BLACKBOX_DEPTH). */
+uint8_t BlackBox52_Count(void);
+
+/**
+ * Copy one record. age 0 is the newest, Count() - 1 the oldest.
+ * @return false if age is out of range
+ */
+bool BlackBox52_Get(uint8_t age, BlackBox52Record* out);
+
+/** Stamp t10ms / seq into *rec and append it, overwriting the oldest. */
+void BlackBox52_Record(BlackBox52Record* rec);
+
+#endif
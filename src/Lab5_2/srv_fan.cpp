@@ -1,8 +1,12 @@
 #include "srv_fan.h"
 
 #include <Arduino.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
 
 #include "Lab5_2_Shared.h"
+#include "../drivers/FastGpio.h"
 
 /* ============================================================================
  * SRV — Relay actuator with time-proportional control.
@@ -18,33 +22,222 @@
  * ON-OFF mode lands here too. The controller posts 0 % or 100 %, the
  * slicer sees full-OFF / full-ON, and the relay holds steady — exactly
  * what we want.
+ *
+ * --- Timing ----------------------------------------------------------------
+ * Timer3 free-runs in normal mode at clk/64 (4 µs per tick, 250 ticks per
+ * ms, wraps every ~262 ms). The slicer is an event machine on the
+ * compare-B interrupt: every ISR lands exactly on a scheduled position of
+ * the window (window start, the on→off edge, or an intermediate waypoint),
+ * drives the relay, and arms OCR3B for the next position. Waits longer
+ * than LAB5_2_FAN_MAX_STEP_MS are split into waypoints so the 16-bit
+ * compare never has to reach past a timer wrap.
+ *
+ *   |---- ON ----|---------- OFF -----------|
+ *   0          onMs                       window
+ *   ^ISR         ^ISR        ^ISR (waypoint) ^ISR = next window start
+ *
+ * The edge lands on the millisecond, whatever the control-task period.
+ *
+ * --- Sigma-delta mode (`modulation sd`) ------------------------------------
+ * Instead of one ON pulse per window, the ISR decides at every
+ * LAB5_2_SD_SLOT_MS slot whether the relay should be closed, by
+ * integrating the duty error (demand minus delivered, in 0.01 %·ms) and
+ * picking the state that keeps the running error smallest. The average
+ * duty is no longer quantised by the window, and low duties become
+ * several short pulses instead of one long gap. Relay wear is bounded by a
+ * minimum dwell of window / 2 in either state, i.e. at most two switches
+ * per window — the same budget as TPC. The window then only frames the
+ * achieved-duty measurement.
+ * Compare-A is left alone: the Servo library (linked for Lab 4.2) owns
+ * TIMER3_COMPA_vect. Timer3 is taken away from analogWrite() on D2/D3/D5
+ * while this lab runs; D5 is the 1-Wire line, which never uses PWM.
  * ==========================================================================*/
 
-static int      s_demandPct      = 0;     /* what the controller asked for */
-static bool     s_relayOn        = false; /* current contact state         */
-static bool     s_activeLow      = (LAB5_2_RELAY_ACTIVE_LOW != 0);
-static uint16_t s_windowMs       = LAB5_2_DEFAULT_RELAY_WINDOW_MS;
-static unsigned long s_windowStartMs = 0UL;
+#define FAN_TICKS_PER_MS    LAB5_2_FAN_TIMER_TICKS_PER_MS
+
+/* --- Owned by the task side; read by the ISR ------------------------------ */
+static volatile uint16_t s_demandCenti    = 0u;     /* 0..10000 = 0..100.00 %  */
+static volatile uint16_t s_pendingWindowMs = LAB5_2_DEFAULT_RELAY_WINDOW_MS;
+static volatile bool     s_activeLow       = (LAB5_2_RELAY_ACTIVE_LOW != 0);
+static volatile uint8_t  s_modulation      = FAN52_MOD_TPC;
+
+/* --- Owned by the ISR (task side only inside ATOMIC_BLOCK) --------------- */
+static volatile bool     s_relayOn        = false;  /* current contact state   */
+static volatile uint16_t s_windowMs       = LAB5_2_DEFAULT_RELAY_WINDOW_MS;
+static volatile uint16_t s_onMs           = 0u;     /* on-time of this window  */
+static volatile uint16_t s_nextPosMs      = 0u;     /* window position of OCR3B */
+static volatile uint16_t s_lastEventTicks = 0u;     /* TCNT3 of the last event */
+static volatile uint16_t s_lastEventPosMs = 0u;     /* its window position     */
+static volatile uint32_t s_onTicksAccum   = 0UL;    /* relay-closed time, this window */
+static volatile uint32_t s_switchCount    = 0UL;    /* relay transitions since boot */
+
+/* --- Sigma-delta state (ISR) ---------------------------------------------- */
+static volatile int32_t  s_sdError        = 0L;     /* demanded − delivered, 0.01 %·ms */
+static volatile uint16_t s_sdDemandCenti  = 0u;     /* demand in force since the last event */
+static volatile uint16_t s_dwellMs        = 0u;     /* time in the current relay state */
+
+/* --- Result of the last completed window ---------------------------------- */
+static volatile uint32_t s_lastOnTicks     = 0UL;
+static volatile uint32_t s_lastWindowTicks = 0UL;
+
+/* Relay GPIO, resolved at compile time so the ISR does not go through
+ * digitalWrite(). */
+typedef FastPin<LAB5_2_RELAY_PIN> RelayPin;
 
 /* ============================================================================
  * Internal helpers
  * ==========================================================================*/
 
-static int clampInt(int v, int lo, int hi)
+static uint16_t onMsFor(uint16_t demandCenti, uint16_t windowMs)
 {
-    if (v < lo) { return lo; }
-    if (v > hi) { return hi; }
-    return v;
+    return (uint16_t)(((uint32_t)demandCenti * (uint32_t)windowMs + 5000UL) / 10000UL);
 }
 
 /** Translate a logical "relay closed" intent into the right GPIO level for
- *  the configured polarity, and write it out. Updates s_relayOn. */
+ *  the configured polarity, and write it out. Updates s_relayOn. Call with
+ *  interrupts disabled (ISR context or inside ATOMIC_BLOCK). */
 static void writeRelay(bool wantClosed)
 {
+    if (wantClosed != s_relayOn)
+    {
+        s_switchCount++;
+        s_dwellMs = 0u;
+    }
     s_relayOn = wantClosed;
-    const int level = s_activeLow ? (wantClosed ? LOW : HIGH)
-                                  : (wantClosed ? HIGH : LOW);
-    digitalWrite(LAB5_2_RELAY_PIN, level);
+    const bool high = s_activeLow ? !wantClosed : wantClosed;
+    RelayPin::Write(high);
+}
+
+/** Sigma-delta bookkeeping for the `elapsedMs` that just played out with
+ *  the relay in its current state. Interrupts must be disabled. */
+static void sdIntegrate(uint16_t elapsedMs)
+{
+    const int32_t delivered = s_relayOn ? (int32_t)LAB5_2_SD_FULL_SCALE : 0L;
+    int32_t err = s_sdError + ((int32_t)s_sdDemandCenti - delivered) * (int32_t)elapsedMs;
+
+    /* The dwell constraint can hold the relay against the error for up to
+     * half a window plus the slot in progress; bound the integrator to that. */
+    const int32_t limit = (int32_t)LAB5_2_SD_FULL_SCALE *
+                          (int32_t)(s_windowMs / 2u + LAB5_2_SD_SLOT_MS);
+    if (err >  limit) { err =  limit; }
+    if (err < -limit) { err = -limit; }
+    s_sdError = err;
+
+    const uint16_t dwell = (uint16_t)(s_dwellMs + elapsedMs);
+    s_dwellMs = (dwell < s_dwellMs) ? 0xFFFFu : dwell;
+}
+
+/** Sigma-delta decision for the next `stepMs`: the state whose delivered
+ *  duty leaves the smaller error, unless the relay has not yet dwelt long
+ *  enough in its current state. 0 % and 100 % bypass the dwell. */
+static bool sdDecide(uint16_t stepMs)
+{
+    const uint16_t demand = s_demandCenti;
+    s_sdDemandCenti = demand;
+
+    if (demand == 0u)
+    {
+        s_sdError = 0L;
+        return false;
+    }
+    if (demand >= LAB5_2_SD_FULL_SCALE)
+    {
+        s_sdError = 0L;
+        return true;
+    }
+
+    const int32_t projected = s_sdError + (int32_t)demand * (int32_t)stepMs;
+    const bool want = projected > (int32_t)(LAB5_2_SD_FULL_SCALE / 2u) * (int32_t)stepMs;
+
+    if ((want != s_relayOn) && (s_dwellMs < (uint16_t)(s_windowMs / 2u)))
+    {
+        return s_relayOn;
+    }
+    return want;
+}
+
+/**
+ * Core of the slicer: the relay is at window position `posMs` at Timer3
+ * count `nowTicks`. Account the segment since the last event, roll the
+ * window if it ended, drive the relay and arm the next compare.
+ * Interrupts must be disabled.
+ */
+static void serviceAt(uint16_t posMs, uint16_t nowTicks)
+{
+    if (s_relayOn)
+    {
+        s_onTicksAccum += (uint16_t)(nowTicks - s_lastEventTicks);
+    }
+    if (s_modulation == FAN52_MOD_SIGMA_DELTA)
+    {
+        sdIntegrate((uint16_t)(posMs - s_lastEventPosMs));
+    }
+
+    if (posMs >= s_windowMs)
+    {
+        s_lastOnTicks     = s_onTicksAccum;
+        s_lastWindowTicks = (uint32_t)s_windowMs * FAN_TICKS_PER_MS;
+        s_onTicksAccum    = 0UL;
+
+        /* Window length and demand are latched here; a `window` command
+         * therefore never truncates a slice that is already playing. */
+        s_windowMs = s_pendingWindowMs;
+        s_onMs     = onMsFor(s_demandCenti, s_windowMs);
+        posMs      = 0u;
+    }
+
+    bool     closed;
+    uint16_t stepMs;
+    if (s_modulation == FAN52_MOD_SIGMA_DELTA)
+    {
+        /* Next slot, cut short at the window end so the measurement window
+         * still rolls on its exact boundary. */
+        stepMs = (uint16_t)(s_windowMs - posMs);
+        if (stepMs > LAB5_2_SD_SLOT_MS) { stepMs = LAB5_2_SD_SLOT_MS; }
+        closed = sdDecide(stepMs);
+    }
+    else
+    {
+        /* Next position of interest: the off edge while closed, else the
+         * end of the window. */
+        closed = (posMs < s_onMs);
+        stepMs = (uint16_t)((closed ? s_onMs : s_windowMs) - posMs);
+    }
+    writeRelay(closed);
+
+    /* Chunked so the compare stays within one timer lap. */
+    if (stepMs > LAB5_2_FAN_MAX_STEP_MS) { stepMs = LAB5_2_FAN_MAX_STEP_MS; }
+
+    s_lastEventTicks = nowTicks;
+    s_lastEventPosMs = posMs;
+    s_nextPosMs      = (uint16_t)(posMs + stepMs);
+    OCR3B            = (uint16_t)(nowTicks + stepMs * FAN_TICKS_PER_MS);
+}
+
+/**
+ * Re-run the slicer "now" from task context, so a new demand moves the
+ * edge of the window that is currently playing. Interrupts must be
+ * disabled. If the pending compare has already matched, the ISR will
+ * pick the new values up as soon as interrupts are re-enabled.
+ */
+static void rescheduleNow(void)
+{
+    const uint16_t elapsedTicks = (uint16_t)(TCNT3 - s_lastEventTicks);
+    const uint16_t elapsedMs    = elapsedTicks / FAN_TICKS_PER_MS;
+    const uint16_t posMs        = (uint16_t)(s_lastEventPosMs + elapsedMs);
+
+    if (posMs >= s_nextPosMs)
+    {
+        return;
+    }
+
+    serviceAt(posMs, (uint16_t)(s_lastEventTicks + elapsedMs * FAN_TICKS_PER_MS));
+    TIFR3 = (1 << OCF3B);   /* drop a match of the old compare value */
+}
+
+ISR(TIMER3_COMPB_vect)
+{
+    serviceAt(s_nextPosMs, OCR3B);
 }
 
 /* ============================================================================
@@ -55,97 +248,156 @@ void Fan52_Init(void)
 {
     pinMode(LAB5_2_RELAY_PIN, OUTPUT);
 
-    s_demandPct      = 0;
-    s_activeLow      = (LAB5_2_RELAY_ACTIVE_LOW != 0);
-    s_windowMs       = LAB5_2_DEFAULT_RELAY_WINDOW_MS;
-    s_windowStartMs  = millis();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        s_demandCenti      = 0u;
+        s_activeLow        = (LAB5_2_RELAY_ACTIVE_LOW != 0);
+        s_windowMs         = LAB5_2_DEFAULT_RELAY_WINDOW_MS;
+        s_pendingWindowMs  = LAB5_2_DEFAULT_RELAY_WINDOW_MS;
+        s_onMs             = 0u;
+        s_onTicksAccum     = 0UL;
+        s_modulation       = FAN52_MOD_TPC;
+        s_sdError          = 0L;
+        s_switchCount      = 0UL;
 
-    /* Open the contact explicitly — never leave the actuator in an
-     * undefined state at boot. */
-    writeRelay(false);
-}
+        /* Open the contact explicitly — never leave the actuator in an
+         * undefined state at boot. */
+        writeRelay(false);
 
-void Fan52_SetDemandPct(int demandPct)
-{
-    s_demandPct = clampInt(demandPct, 0, 100);
+        /* Timer3: normal mode, clk/64, only the compare-B interrupt. Seeding
+         * the slicer with a window roll at t = 0 arms the first compare. */
+        TCCR3A = 0;
+        TCCR3B = (1 << CS31) | (1 << CS30);
+        TCNT3  = 0;
+        s_lastEventTicks = 0u;
+        serviceAt(s_windowMs, 0u);
+        s_lastOnTicks      = 0UL;      /* no window has completed yet */
+        s_lastWindowTicks  = 0UL;
+        TIFR3  = (1 << OCF3B);
+        TIMSK3 = (1 << OCIE3B);
+    }
 }
 
-int Fan52_Loop(void)
+void Fan52_SetDemandPct(float demandPct)
 {
-    const unsigned long now = millis();
+    /* The actuator is unidirectional: negative pull is clamped to 0. */
+    if (demandPct < 0.0f)   { demandPct = 0.0f; }
+    if (demandPct > 100.0f) { demandPct = 100.0f; }
+    const uint16_t centi = (uint16_t)(demandPct * 100.0f + 0.5f);
 
-    /* Roll the TPC window when the current one elapses. millis() can wrap
-     * (every ~49.7 days on an ATmega2560 with a 1 ms tick) — using unsigned
-     * subtraction makes that wrap-safe. */
-    if ((now - s_windowStartMs) >= (unsigned long)s_windowMs)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
     {
-        s_windowStartMs = now;
+        if (centi != s_demandCenti)
+        {
+            s_demandCenti = centi;
+            s_onMs        = onMsFor(centi, s_windowMs);
+            /* Sigma-delta picks a new demand up at the next slot; only the
+             * hard 0 % / 100 % commands act on the spot there. */
+            if ((s_modulation == FAN52_MOD_TPC) ||
+                (centi == 0u) || (centi >= LAB5_2_SD_FULL_SCALE))
+            {
+                rescheduleNow();
+            }
+        }
     }
+}
+
+float Fan52_GetDemandPct(void)
+{
+    uint16_t centi;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { centi = s_demandCenti; }
+    return (float)centi / 100.0f;
+}
 
-    /* Pure ON/OFF shortcuts: skip the math and just hold the contact. This
-     * matches the ON-OFF controller's binary output and avoids any timing
-     * glitch at the window boundary when demand=0 or demand=100. */
-    if (s_demandPct <= 0)
+float Fan52_GetAchievedPct(void)
+{
+    uint32_t onTicks;
+    uint32_t windowTicks;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
     {
-        writeRelay(false);
-        return 0;
+        onTicks     = s_lastOnTicks;
+        windowTicks = s_lastWindowTicks;
     }
-    if (s_demandPct >= 100)
+
+    if (windowTicks == 0UL) { return 0.0f; }
+    return (float)onTicks * 100.0f / (float)windowTicks;
+}
+
+void Fan52_SetModulation(Fan52Modulation mode)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
     {
-        writeRelay(true);
-        return 100;
+        if ((uint8_t)mode != s_modulation)
+        {
+            /* Re-run the slicer at the current position under the new rule.
+             * The integrator of a previous sigma-delta run is stale. */
+            s_modulation    = (uint8_t)mode;
+            s_sdError       = 0L;
+            s_sdDemandCenti = s_demandCenti;
+            rescheduleNow();
+        }
     }
+}
 
-    /* Time-proportional slicing inside the window:
-     *
-     *   |---- ON ----|---------- OFF -----------|
-     *   0          onMs                       window
-     *
-     * Resolution is one task period (LAB5_2_FAN_TASK_MS = 100 ms). At the
-     * default 2000 ms window that gives 20 distinguishable duties, which
-     * is plenty for a fan whose mechanical time-constant is several
-     * hundred ms.
-     */
-    const unsigned long onMs    = ((unsigned long)s_demandPct * (unsigned long)s_windowMs) / 100UL;
-    const unsigned long elapsed = now - s_windowStartMs;
-    writeRelay(elapsed < onMs);
-
-    return s_demandPct;
+Fan52Modulation Fan52_GetModulation(void)
+{
+    return (Fan52Modulation)s_modulation;
 }
 
-int Fan52_GetActualPct(void)
+uint32_t Fan52_GetSwitchCount(void)
 {
-    return s_demandPct;
+    uint32_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { count = s_switchCount; }
+    return count;
 }
 
 void Fan52_HardOff(void)
 {
-    s_demandPct      = 0;
-    s_windowStartMs  = millis();
-    writeRelay(false);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        s_demandCenti = 0u;
+        s_onMs        = 0u;
+
+        /* Close the books on the interrupted window (it only ran for
+         * `played` ticks) and start a fresh one right now, so the next
+         * non-zero demand gets a full slice. */
+        const uint16_t nowTicks = TCNT3;
+        const uint32_t played   = (uint32_t)s_lastEventPosMs * FAN_TICKS_PER_MS
+                                + (uint16_t)(nowTicks - s_lastEventTicks);
+        serviceAt(s_windowMs, nowTicks);
+        s_lastWindowTicks = played;
+        TIFR3 = (1 << OCF3B);
+    }
 }
 
 void Fan52_SetWindowMs(uint16_t windowMs)
 {
     if (windowMs < LAB5_2_RELAY_WINDOW_MIN_MS) { windowMs = LAB5_2_RELAY_WINDOW_MIN_MS; }
     if (windowMs > LAB5_2_RELAY_WINDOW_MAX_MS) { windowMs = LAB5_2_RELAY_WINDOW_MAX_MS; }
-    s_windowMs = windowMs;
-    /* Don't reset s_windowStartMs — let the current slice finish naturally.
-     * The new length kicks in at the next window roll-over. */
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { s_pendingWindowMs = windowMs; }
+    /* The ISR latches it at the next window roll-over, so the current slice
+     * still plays out cleanly. */
 }
 
 uint16_t Fan52_GetWindowMs(void)
 {
-    return s_windowMs;
+    uint16_t windowMs;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { windowMs = s_pendingWindowMs; }
+    return windowMs;
 }
 
 void Fan52_SetPolarity(bool activeLow)
 {
-    if (activeLow == s_activeLow) { return; }
-    s_activeLow = activeLow;
-    /* Re-issue the current relay state so the polarity change is observed
-     * immediately, not on the next Loop() call. */
-    writeRelay(s_relayOn);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (activeLow != s_activeLow)
+        {
+            s_activeLow = activeLow;
+            /* Re-issue the current relay state so the polarity change is
+             * observed immediately, not at the next edge. */
+            writeRelay(s_relayOn);
+        }
+    }
 }
 
 bool Fan52_GetPolarity(void)
@@ -15,9 +15,17 @@
  *   demand = X%      → relay CLOSED for X% of the window, OPEN for (100−X)%
  *
  * The window length is configurable (`window <ms>` runtime command); the
- * default is LAB5_2_DEFAULT_RELAY_WINDOW_MS. Mechanical inertia of the fan
- * blade smooths the resulting on/off train into an average air-flow that
- * the PID loop perceives as continuous.
+ * default is LAB5_2_DEFAULT_RELAY_WINDOW_MS. The slicing runs in the
+ * Timer3 compare-B interrupt, which schedules each on→off edge to the
+ * millisecond — no polling task, and the duty resolution is 1 ms of
+ * window rather than one task period.
+ *
+ * An alternative first-order sigma-delta modulation (Fan52_SetModulation)
+ * spreads the ON time over short slots by diffusing the duty error, with a
+ * minimum dwell of half a window in either relay state, so it spends the
+ * same relay switch budget as TPC. Mechanical inertia of the fan blade
+ * smooths the resulting on/off train into an average air-flow that the
+ * PID loop perceives as continuous.
  *
  * ON-OFF mode is the degenerate case where the controller already commits
  * to 0 % or 100 % each cycle, so TPC collapses into pure latched behaviour
@@ -31,30 +39,52 @@
  * service is here to prevent.
  */
 
+/** Relay modulation scheme, selected with `modulation tpc|sd`. */
+typedef enum
+{
+    FAN52_MOD_TPC         = 0,  /* one ON pulse per window (default)       */
+    FAN52_MOD_SIGMA_DELTA = 1   /* error diffusion over LAB5_2_SD_SLOT_MS  */
+} Fan52Modulation;
+
+/** Configure the relay pin and start Timer3 (normal mode, clk/64) with
+ *  the compare-B interrupt. The relay starts open. */
 void Fan52_Init(void);
 
 /**
- * @brief Update the demanded duty (0..100%). Stored internally; the TPC
- *        slicer reads this every Fan52_Loop().
+ * @brief Update the demanded duty (0..100 %, fractional).
  *
- * Negative values are clamped to 0 (the actuator is unidirectional).
+ * Takes effect in the window that is currently playing: the off edge is
+ * moved (or the relay opened right away if the new on-time has already
+ * elapsed). Negative values are clamped to 0 (the actuator is
+ * unidirectional). Safe to call from any task.
  */
-void Fan52_SetDemandPct(int demandPct);
+void Fan52_SetDemandPct(float demandPct);
+
+/** Demand as stored by the slicer (%, 0.01 % steps). */
+float Fan52_GetDemandPct(void);
 
 /**
- * @brief Step the TPC slicer one tick.
+ * @brief Duty actually delivered over the last completed window (%).
  *
- * Recomputes the window phase from millis(), decides whether the relay
- * should be closed right now, and drives the GPIO with the appropriate
- * level for the configured polarity.
+ * Measured in the ISR from Timer3 ticks with the relay closed, so it shows
+ * rounding to the 1 ms grid, mid-window demand changes and hard-offs.
+ * 0 until the first window has completed.
+ */
+float Fan52_GetAchievedPct(void);
+
+/**
+ * @brief Select TPC or sigma-delta modulation.
  *
- * Returns the duty (%) currently being commanded — for telemetry / LCD.
- * The instantaneous relay state can be queried via Fan52_IsRelayOn().
+ * Switches on the spot, at the current window position; the sigma-delta
+ * error integrator starts from zero.
  */
-int  Fan52_Loop(void);
+void Fan52_SetModulation(Fan52Modulation mode);
+
+/** Active modulation scheme. */
+Fan52Modulation Fan52_GetModulation(void);
 
-/** Latest applied demand (%, 0..100). Same value Fan52_Loop() returned. */
-int  Fan52_GetActualPct(void);
+/** Relay transitions (open→closed and closed→open) since Fan52_Init(). */
+uint32_t Fan52_GetSwitchCount(void);
 
 /** Force the actuator output to zero immediately (used on sensor failure or
  *  on `force off`). Opens the relay and resets the TPC window so the next
@@ -64,8 +94,8 @@ void Fan52_HardOff(void);
 /**
  * @brief Set the TPC window length, in milliseconds. Clamped to the
  *        LAB5_2_RELAY_WINDOW_MIN_MS..LAB5_2_RELAY_WINDOW_MAX_MS range.
- *        Takes effect on the NEXT window boundary, not mid-window — so
- *        the current slice still plays out cleanly.
+ *        The ISR latches it on the NEXT window boundary, not mid-window —
+ *        so the current slice still plays out cleanly.
  */
 void Fan52_SetWindowMs(uint16_t windowMs);
 
@@ -79,8 +109,8 @@ uint16_t Fan52_GetWindowMs(void);
  *                  modules, Wokwi part). false ⇒ IN=HIGH closes the
  *                  contact (raw NPN driver boards).
  *
- * Reapplies the current relay level immediately so the change takes
- * effect on the next slice without waiting for a controller cycle.
+ * Reapplies the current relay level immediately, without waiting for the
+ * next edge.
  */
 void Fan52_SetPolarity(bool activeLow);
 
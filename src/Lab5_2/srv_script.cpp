@@ -0,0 +1,220 @@
+#include "srv_script.h"
+
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include <string.h>
+
+/* ============================================================================
+ * Module statics — command task only
+ * ==========================================================================*/
+
+#define SCRIPT52_MAGIC  0x5C21u
+
+typedef struct
+{
+    uint16_t     magic;
+    uint16_t     crc;
+    uint8_t      count;
+    Script52Step steps[LAB5_2_SCRIPT_STEPS];
+} Script52Image;
+
+static Script52Image s_image EEMEM;
+
+static Script52Step    s_steps[LAB5_2_SCRIPT_STEPS];
+static uint8_t         s_count;
+
+static bool            s_running;
+static uint8_t         s_next;          /* next step to hand out            */
+static uint32_t        s_startMs;
+static uint32_t        s_lateMs;        /* of the step handed out last      */
+static Script52Summary s_summary;
+
+/* ============================================================================
+ * Helpers
+ * ==========================================================================*/
+
+/** Count byte and the stored steps only: unused slots are never written,
+ *  so a short script is a short save. */
+static uint16_t crcOf(uint8_t count, const Script52Step* steps)
+{
+    uint16_t crc = _crc16_update(0xFFFFu, count);
+    const uint8_t* p = (const uint8_t*)steps;
+    const uint16_t len = (uint16_t)(count * sizeof(Script52Step));
+    for (uint16_t i = 0u; i < len; ++i)
+    {
+        crc = _crc16_update(crc, p[i]);
+    }
+    return crc;
+}
+
+/** crcOf() of the stored image, read byte by byte: no RAM copy needed to
+ *  verify it. */
+static uint16_t storedCrc(uint8_t count)
+{
+    uint16_t crc = _crc16_update(0xFFFFu, count);
+    const uint8_t* p = (const uint8_t*)s_image.steps;
+    const uint16_t len = (uint16_t)(count * sizeof(Script52Step));
+    for (uint16_t i = 0u; i < len; ++i)
+    {
+        crc = _crc16_update(crc, eeprom_read_byte(p + i));
+    }
+    return crc;
+}
+
+static uint16_t imageMagic(void)
+{
+    return (uint16_t)(SCRIPT52_MAGIC ^ (uint16_t)(sizeof(Script52Image) << 4));
+}
+
+static void finish(uint32_t nowMs, bool stopped)
+{
+    s_running            = false;
+    s_summary.stopped    = stopped;
+    s_summary.durationMs = nowMs - s_startMs;
+}
+
+/* ============================================================================
+ * Public API
+ * ==========================================================================*/
+
+void Script52_Init(void)
+{
+    s_count   = 0u;
+    s_running = false;
+    s_next    = 0u;
+    memset(&s_summary, 0, sizeof(s_summary));
+}
+
+Script52Status Script52_Add(uint32_t atMs, const char* cmd)
+{
+    if (s_running)                              { return SCRIPT52_BUSY; }
+    if (s_count >= LAB5_2_SCRIPT_STEPS)         { return SCRIPT52_FULL; }
+    if (strlen(cmd) >= LAB5_2_SCRIPT_CMD_LEN)   { return SCRIPT52_TOO_LONG; }
+
+    uint8_t pos = s_count;
+    while (pos > 0u && s_steps[pos - 1u].atMs > atMs)
+    {
+        s_steps[pos] = s_steps[pos - 1u];
+        --pos;
+    }
+    s_steps[pos].atMs = atMs;
+    strncpy(s_steps[pos].cmd, cmd, sizeof(s_steps[pos].cmd));
+    s_count = (uint8_t)(s_count + 1u);
+    return SCRIPT52_OK;
+}
+
+Script52Status Script52_Clear(void)
+{
+    if (s_running) { return SCRIPT52_BUSY; }
+    s_count = 0u;
+    return SCRIPT52_OK;
+}
+
+uint8_t Script52_Count(void)
+{
+    return s_count;
+}
+
+const Script52Step* Script52_Get(uint8_t index)
+{
+    return (index < s_count) ? &s_steps[index] : NULL;
+}
+
+Script52Status Script52_Save(void)
+{
+    if (s_running) { return SCRIPT52_BUSY; }
+
+    /* Invalidate first, validate last: a reset mid-save leaves no image
+     * rather than a half-written one. */
+    const uint16_t magic = imageMagic();
+    const uint16_t crc   = crcOf(s_count, s_steps);
+    eeprom_update_word(&s_image.magic, 0u);
+    eeprom_update_byte(&s_image.count, s_count);
+    eeprom_update_block(s_steps, s_image.steps, s_count * sizeof(Script52Step));
+    eeprom_update_word(&s_image.crc, crc);
+    eeprom_update_word(&s_image.magic, magic);
+    return SCRIPT52_OK;
+}
+
+Script52Status Script52_Load(void)
+{
+    if (s_running) { return SCRIPT52_BUSY; }
+    if (eeprom_read_word(&s_image.magic) != imageMagic()) { return SCRIPT52_NO_IMAGE; }
+
+    const uint8_t count = eeprom_read_byte(&s_image.count);
+    if (count > LAB5_2_SCRIPT_STEPS) { return SCRIPT52_NO_IMAGE; }
+
+    /* Verify in EEPROM; the live table is overwritten only on a match. */
+    if (eeprom_read_word(&s_image.crc) != storedCrc(count)) { return SCRIPT52_NO_IMAGE; }
+
+    eeprom_read_block(s_steps, s_image.steps, count * sizeof(Script52Step));
+    for (uint8_t i = 0u; i < count; ++i)
+    {
+        s_steps[i].cmd[LAB5_2_SCRIPT_CMD_LEN - 1u] = '\0';
+    }
+    s_count = count;
+    return SCRIPT52_OK;
+}
+
+Script52Status Script52_Start(uint32_t nowMs)
+{
+    if (s_running)     { return SCRIPT52_BUSY; }
+    if (s_count == 0u) { return SCRIPT52_EMPTY; }
+
+    memset(&s_summary, 0, sizeof(s_summary));
+    s_summary.steps = s_count;
+    s_startMs = nowMs;
+    s_next    = 0u;
+    s_running = true;
+    return SCRIPT52_OK;
+}
+
+void Script52_Stop(uint32_t nowMs)
+{
+    if (s_running) { finish(nowMs, true); }
+}
+
+bool Script52_Running(void)
+{
+    return s_running;
+}
+
+uint32_t Script52_MsUntilNext(uint32_t nowMs)
+{
+    if (!s_running) { return UINT32_MAX; }
+    const uint32_t elapsed = nowMs - s_startMs;
+    const uint32_t due     = s_steps[s_next].atMs;
+    return (elapsed >= due) ? 0u : due - elapsed;
+}
+
+bool Script52_TakeDue(uint32_t nowMs, char* out, size_t outSize, uint32_t* lateMs)
+{
+    if (Script52_MsUntilNext(nowMs) != 0u) { return false; }
+
+    const Script52Step* step = &s_steps[s_next];
+    strncpy(out, step->cmd, outSize);
+    out[outSize - 1u] = '\0';
+    s_lateMs = (nowMs - s_startMs) - step->atMs;
+    *lateMs  = s_lateMs;
+    return true;
+}
+
+bool Script52_Complete(bool accepted, uint32_t nowMs)
+{
+    if (!s_running) { return false; }
+
+    if (s_lateMs > s_summary.maxLateMs) { s_summary.maxLateMs = s_lateMs; }
+    s_summary.run = (uint8_t)(s_summary.run + 1u);
+    if (!accepted) { s_summary.failed = (uint8_t)(s_summary.failed + 1u); }
+
+    s_next = (uint8_t)(s_next + 1u);
+    if (s_next < s_count) { return false; }
+
+    finish(nowMs, false);
+    return true;
+}
+
+const Script52Summary* Script52_LastRun(void)
+{
+    return &s_summary;
+}
@@ -0,0 +1,114 @@
+#ifndef LAB5_2_SRV_SCRIPT_H
+#define LAB5_2_SRV_SCRIPT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Lab5_2_Shared.h"
+
+/**
+ * SRV layer — timed command script for repeatable step tests.
+ *
+ * A script is a short list of `at <ms> <command>` steps kept in SRAM,
+ * sorted by time. `run` starts the clock; the command task asks for each
+ * step as it falls due, executes the line through the CLI exactly as if
+ * it had been typed, and reports back whether it was accepted. When the
+ * last step has run (or `script stop`) the run ends and its summary —
+ * steps run, rejected, duration, worst lateness — stays readable.
+ *
+ * Lateness is how far after its nominal time a step actually ran; it is
+ * bounded by the command task's wake-up granularity (one RTOS tick when
+ * the task sleeps exactly until the next step).
+ *
+ * A set-point step test, settled at 23 °C then stepped to 25 °C:
+ *
+ *   at 0 set 23
+ *   at 300000 set 25
+ *   at 900000 perf
+ *   run
+ *
+ * A scripted `set` reaches the controller on its next sample, exactly
+ * like a typed one, so `perf` measures the loop and not the CLI.
+ *
+ * The list can be saved to and reloaded from EEPROM: one image with a
+ * magic word (bound to the layout, as in srv_warm_start) and a CRC-16.
+ * Saving rewrites only the bytes that changed, but still takes up to
+ * ~3.3 ms per byte, so it is never done while a run is in progress.
+ *
+ * Owned by the command task: no locks, not safe from any other task.
+ */
+
+typedef struct
+{
+    uint32_t atMs;                          /* offset from `run`            */
+    char     cmd[LAB5_2_SCRIPT_CMD_LEN];    /* NUL-terminated command line  */
+} Script52Step;
+
+typedef enum
+{
+    SCRIPT52_OK       = 0,
+    SCRIPT52_FULL     = 1,      /* LAB5_2_SCRIPT_STEPS already stored       */
+    SCRIPT52_TOO_LONG = 2,      /* command does not fit in cmd[]            */
+    SCRIPT52_BUSY     = 3,      /* a run is in progress                     */
+    SCRIPT52_EMPTY    = 4,      /* nothing stored (run)                     */
+    SCRIPT52_NO_IMAGE = 5       /* EEPROM holds no valid script (load)      */
+} Script52Status;
+
+typedef struct
+{
+    uint8_t  steps;             /* steps in the script                      */
+    uint8_t  run;               /* steps executed                           */
+    uint8_t  failed;            /* ... of which the CLI rejected            */
+    bool     stopped;           /* ended by Script52_Stop()                 */
+    uint32_t durationMs;        /* `run` -> end                             */
+    uint32_t maxLateMs;         /* worst lateness of an executed step       */
+} Script52Summary;
+
+/** Empty script, no run. */
+void Script52_Init(void);
+
+/** Insert a step, after any step with the same time. */
+Script52Status Script52_Add(uint32_t atMs, const char* cmd);
+
+Script52Status Script52_Clear(void);
+
+uint8_t Script52_Count(void);
+
+/** @return Step `index` in time order, or NULL past the end. */
+const Script52Step* Script52_Get(uint8_t index);
+
+Script52Status Script52_Save(void);
+Script52Status Script52_Load(void);
+
+/** Start a run at `nowMs`. */
+Script52Status Script52_Start(uint32_t nowMs);
+
+/** End the current run early; no-op when idle. */
+void Script52_Stop(uint32_t nowMs);
+
+bool Script52_Running(void);
+
+/** @return ms until the next step is due (0 = due now), or UINT32_MAX
+ *          when no run is in progress. */
+uint32_t Script52_MsUntilNext(uint32_t nowMs);
+
+/**
+ * @brief Hand out the next due step
+ *
+ * @param out    Receives a copy of the line (the CLI tokenises in place)
+ * @param lateMs Receives how late the step is
+ * @return false when no step is due
+ */
+bool Script52_TakeDue(uint32_t nowMs, char* out, size_t outSize, uint32_t* lateMs);
+
+/**
+ * @brief Record the outcome of the step from Script52_TakeDue()
+ *
+ * @return true when that was the last step and the run has ended
+ */
+bool Script52_Complete(bool accepted, uint32_t nowMs);
+
+/** Result of the current or most recent run. */
+const Script52Summary* Script52_LastRun(void);
+
+#endif
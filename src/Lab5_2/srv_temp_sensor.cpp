@@ -57,7 +57,7 @@ static void fifoPushInt(int *fifo, int size, int value)
 
 /** Median of an int FIFO. Mirrors `lib_cond_median_filter`: we work on a
  *  sorted COPY so the FIFO retains chronological order for the next push. */
-static int medianFromFifo(const int *fifo, int *scratch, int size)
+int TempSensor52_MedianFromFifo(const int *fifo, int *scratch, int size)
 {
     for (int i = 0; i < size; ++i) { scratch[i] = fifo[i]; }
 
@@ -154,7 +154,7 @@ bool TempSensor52_Loop(void)
     }
     else
     {
-        medianInt = medianFromFifo(s_medianFifo, s_medianSorted, LAB5_2_MEDIAN_WINDOW);
+        medianInt = TempSensor52_MedianFromFifo(s_medianFifo, s_medianSorted, LAB5_2_MEDIAN_WINDOW);
     }
 
     /* --- Stage 3: weighted average ------------------------------------- */
@@ -190,3 +190,24 @@ bool TempSensor52_IsValid(void)
 {
     return s_isValid;
 }
+
+void TempSensor52_SaveWarm(TempSensor52Warm* out)
+{
+    memcpy(out->medianFifo, s_medianFifo, sizeof(out->medianFifo));
+    memcpy(out->wavgFifo,   s_wavgFifo,   sizeof(out->wavgFifo));
+    out->medianFill    = s_medianFill;
+    out->wavgFill      = s_wavgFill;
+    out->lastFilteredC = s_lastFilteredC;
+}
+
+void TempSensor52_RestoreWarm(const TempSensor52Warm* in)
+{
+    memcpy(s_medianFifo, in->medianFifo, sizeof(s_medianFifo));
+    memcpy(s_wavgFifo,   in->wavgFifo,   sizeof(s_wavgFifo));
+
+    /* Fill levels come from another boot: never trust them past the
+     * window length. */
+    s_medianFill    = (in->medianFill <= LAB5_2_MEDIAN_WINDOW) ? in->medianFill : 0u;
+    s_wavgFill      = (in->wavgFill   <= LAB5_2_WAVG_WINDOW)   ? in->wavgFill   : 0u;
+    s_lastFilteredC = in->lastFilteredC;
+}
@@ -3,6 +3,8 @@
 
 #include <Arduino.h>
 
+#include "Lab5_2_Shared.h"
+
 /**
  * SRV layer — DS18B20 temperature sensor service.
  *
@@ -42,4 +44,28 @@ float TempSensor52_GetRawTempC(void);
  *  bus glitched. The caller must treat the temperature getters as stale. */
 bool  TempSensor52_IsValid(void);
 
+/** Median of the first `size` entries of `fifo`, sorted in `scratch` so
+ *  the FIFO keeps its order. Pipeline stage; public for the bench lab. */
+int   TempSensor52_MedianFromFifo(const int *fifo, int *scratch, int size);
+
+/** Conditioning-pipeline state, as saved across a soft reset by
+ *  srv_warm_start. Plain data: the FIFOs, their fill levels and the last
+ *  filtered value. */
+typedef struct
+{
+    int     medianFifo[LAB5_2_MEDIAN_WINDOW];
+    int     wavgFifo[LAB5_2_WAVG_WINDOW];
+    uint8_t medianFill;
+    uint8_t wavgFill;
+    float   lastFilteredC;
+} TempSensor52Warm;
+
+/** Copy the pipeline state out. Call from the task that runs Loop(). */
+void  TempSensor52_SaveWarm(TempSensor52Warm* out);
+
+/** Reload a saved pipeline after Init(). The next Loop() then filters
+ *  against the restored windows instead of passing samples through while
+ *  the FIFOs refill. IsValid() stays false until that first read. */
+void  TempSensor52_RestoreWarm(const TempSensor52Warm* in);
+
 #endif
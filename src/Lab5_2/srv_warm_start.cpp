@@ -0,0 +1,130 @@
+#include "srv_warm_start.h"
+
+#include <avr/io.h>
+#include <util/crc16.h>
+#include <string.h>
+
+/* ============================================================================
+ * Module statics — .noinit: the C runtime neither zeroes nor copies them,
+ * so they keep whatever the previous boot left there.
+ * ==========================================================================*/
+
+#define WARM52_MAGIC_SENSOR   0x5E75u
+#define WARM52_MAGIC_CONTROL  0xC7A1u
+
+typedef struct
+{
+    uint16_t         magic;
+    uint16_t         crc;
+    TempSensor52Warm data;
+} WarmSensorSection;
+
+typedef struct
+{
+    uint16_t      magic;
+    uint16_t      crc;
+    Warm52Control data;
+} WarmControlSection;
+
+static WarmSensorSection  s_sensor  __attribute__((section(".noinit")));
+static WarmControlSection s_control __attribute__((section(".noinit")));
+
+/* Ordinary .bss: recomputed on every boot by Warm52_Init(). */
+static uint16_t s_buildId;
+
+/* ============================================================================
+ * Helpers
+ * ==========================================================================*/
+
+/** Keep the compiler from sinking the magic stores past the payload. */
+static inline void barrier(void) { __asm__ __volatile__("" ::: "memory"); }
+
+static uint16_t crcOf(const void* data, uint16_t len)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    uint16_t crc = 0xFFFFu;
+    for (uint16_t i = 0u; i < len; ++i)
+    {
+        crc = _crc16_update(crc, p[i]);
+    }
+    return crc;
+}
+
+/** CRC of the build timestamp: changes with every rebuild, even one that
+ *  keeps the payload size but reorders or reinterprets its fields. */
+static uint16_t buildIdOf(void)
+{
+    static const char stamp[] = __DATE__ " " __TIME__;
+    return crcOf(stamp, (uint16_t)(sizeof(stamp) - 1u));
+}
+
+/** Magic bound to the payload size and the build: a different firmware
+ *  never accepts the previous one's image. */
+static uint16_t magicFor(uint16_t base, uint16_t len)
+{
+    return (uint16_t)(base ^ (uint16_t)(len << 4) ^ s_buildId);
+}
+
+static bool sectionValid(uint16_t magic, uint16_t crc, uint16_t base,
+                         const void* data, uint16_t len)
+{
+    return (magic == magicFor(base, len)) && (crc == crcOf(data, len));
+}
+
+/* ============================================================================
+ * Public API
+ * ==========================================================================*/
+
+void Warm52_Init(uint8_t mcusrAtBoot)
+{
+    s_buildId = buildIdOf();
+
+    /* SRAM is garbage after power-on; a CRC match there would be luck. */
+    if ((mcusrAtBoot & (1 << PORF)) != 0u)
+    {
+        s_sensor.magic  = 0u;
+        s_control.magic = 0u;
+    }
+}
+
+bool Warm52_LoadSensor(TempSensor52Warm* out)
+{
+    if (!sectionValid(s_sensor.magic, s_sensor.crc, WARM52_MAGIC_SENSOR,
+                      &s_sensor.data, sizeof(s_sensor.data)))
+    {
+        return false;
+    }
+    *out = s_sensor.data;
+    return true;
+}
+
+bool Warm52_LoadControl(Warm52Control* out)
+{
+    if (!sectionValid(s_control.magic, s_control.crc, WARM52_MAGIC_CONTROL,
+                      &s_control.data, sizeof(s_control.data)))
+    {
+        return false;
+    }
+    *out = s_control.data;
+    return true;
+}
+
+void Warm52_SaveSensor(const TempSensor52Warm* in)
+{
+    s_sensor.magic = 0u;
+    barrier();
+    s_sensor.data  = *in;
+    s_sensor.crc   = crcOf(&s_sensor.data, sizeof(s_sensor.data));
+    barrier();
+    s_sensor.magic = magicFor(WARM52_MAGIC_SENSOR, sizeof(s_sensor.data));
+}
+
+void Warm52_SaveControl(const Warm52Control* in)
+{
+    s_control.magic = 0u;
+    barrier();
+    s_control.data  = *in;
+    s_control.crc   = crcOf(&s_control.data, sizeof(s_control.data));
+    barrier();
+    s_control.magic = magicFor(WARM52_MAGIC_CONTROL, sizeof(s_control.data));
+}
@@ -0,0 +1,53 @@
+#ifndef LAB5_2_SRV_WARM_START_H
+#define LAB5_2_SRV_WARM_START_H
+
+#include <stdint.h>
+
+#include "Lab5_2_Shared.h"
+#include "ctrl_pid.h"
+#include "srv_temp_sensor.h"
+
+/**
+ * SRV layer — warm start across soft resets.
+ *
+ * A WDT / EXT / BOR reset used to throw away the filter windows and the
+ * PID integrator, and the loop then took minutes to settle again. This
+ * service keeps both, plus the last applied config, in `.noinit` SRAM
+ * (the same trick as the boot counter in Lab5_2_main) and hands them
+ * back at boot so the first control cycle starts from steady state.
+ *
+ * Two sections, one writer each, so no task ever copies another task's
+ * private state:
+ *
+ *   sensor   TempSensor52Warm          saved by acquisition after Loop()
+ *   control  PID, ON-OFF latch, mode,  saved by control after each cycle
+ *            config
+ *
+ * Each section carries a magic word (bound to its size and to the build
+ * timestamp, so a reflashed firmware never adopts the previous one's
+ * image) and a CRC-16 over the payload. A save
+ * clears the magic first and sets it last, so a reset in the middle of a
+ * save leaves an invalid section rather than a half-written valid one.
+ * A power-on reset drops both sections even if they happen to verify.
+ */
+
+typedef struct
+{
+    PidState52  pid;
+    Lab52Config config;
+    uint8_t     mode;           /* Lab52Mode                                */
+    uint8_t     onoffFanOn;     /* ON-OFF controller latch                  */
+} Warm52Control;
+
+/** Call once at boot with the captured MCUSR, before any Load. */
+void Warm52_Init(uint8_t mcusrAtBoot);
+
+/** @return true and fill *out if the section survived the reset intact. */
+bool Warm52_LoadSensor(TempSensor52Warm* out);
+bool Warm52_LoadControl(Warm52Control* out);
+
+/** Overwrite the section. Each has exactly one calling task. */
+void Warm52_SaveSensor(const TempSensor52Warm* in);
+void Warm52_SaveControl(const Warm52Control* in);
+
+#endif
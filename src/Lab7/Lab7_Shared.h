@@ -22,7 +22,7 @@
 
 // FSM Configuration
 #define LAB7_FSM_STATE_DELAY_MS     100    // State machine evaluation period
-#define LAB7_DEBOUNCE_MS            50     // Button debounce window
+#define LAB7_BUTTON_SAMPLE_MS       12     // ButtonBank sample period (debounce = 4 samples)
 
 // Serial Configuration
 #define LAB7_SERIAL_BAUD            115200 // Serial communication speed
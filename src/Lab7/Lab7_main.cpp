@@ -14,7 +14,7 @@
  * 3. Read debounced input
  * 4. Update state based on input
  *
- * Debounce: Software-based, 50ms window
+ * Debounce: ButtonBank, 4 samples x LAB7_BUTTON_SAMPLE_MS
  * Display: Serial output with state and timestamp
  * Latency: < 100ms guaranteed by design
  */
@@ -22,56 +22,48 @@
 #include "Lab7_main.h"
 #include "ButtonLedFSM.h"
 #include "Lab7_Shared.h"
+#include "button/ButtonBank.h"
 #include "drivers/SerialStdioDriver.h"
+#include "cli/CommandLine.h"
 #include <Arduino.h>
 #include <stdio.h>
-#include <string.h>
-#include <ctype.h>
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
 
 // ============================================================================
-// Button Debounce State Machine
+// Button input (ButtonBank: 4 samples, LAB7_BUTTON_SAMPLE_MS apart)
 // ============================================================================
 
-typedef struct {
-    uint8_t last_reading;
-    uint32_t last_change_time_ms;
-    uint8_t stable_reading;
-} ButtonDebounceState;
+static const uint8_t g_button_pins[] = { LAB7_BUTTON_PIN };
+static ButtonBank g_buttons;
 
-static ButtonDebounceState g_button_state = {
-    .last_reading = 1,
-    .last_change_time_ms = 0,
-    .stable_reading = 1
-};
-
-static uint8_t g_last_stable_reading = 1;
-
-static uint8_t read_debounced_button(void)
+/**
+ * Step 2 of the cycle: wait out the evaluation period, sampling the button
+ * all along so the debounce runs at its own rate rather than once per
+ * FSM step.
+ */
+static void wait_and_sample_button(void)
 {
-    uint8_t current = digitalRead(LAB7_BUTTON_PIN);
-    uint32_t now_ms = millis();
-
-    if (current != g_button_state.last_reading)
-    {
-        g_button_state.last_reading = current;
-        g_button_state.last_change_time_ms = now_ms;
-    }
-
-    if ((now_ms - g_button_state.last_change_time_ms) >= LAB7_DEBOUNCE_MS)
+    const uint32_t start_ms = millis();
+    while ((millis() - start_ms) < LAB7_FSM_STATE_DELAY_MS)
     {
-        g_button_state.stable_reading = current;
+        ButtonBank_Update(&g_buttons, millis());
+        delay(LAB7_BUTTON_SAMPLE_MS);
     }
-
-    return g_button_state.stable_reading;
 }
 
+/** Step 3: 1 if a debounced press was accepted since the last call. */
 static uint8_t read_button_press_event(void)
 {
-    uint8_t stable = read_debounced_button();
-    uint8_t pressed_event = (g_last_stable_reading == 1u && stable == 0u) ? 1u : 0u;
-    g_last_stable_reading = stable;
+    uint8_t pressed_event = 0u;
+    ButtonEvent ev;
+    while (ButtonBank_Pop(&g_buttons, &ev))
+    {
+        if (ev.type == BUTTON_EV_PRESS)
+        {
+            pressed_event = 1u;
+        }
+    }
     return pressed_event;
 }
 
@@ -79,92 +71,50 @@ static uint8_t read_button_press_event(void)
 // Serial commands (LED on / off, sync with FSM)
 // ============================================================================
 
-static char     s_cmdBuf[40];
-static uint8_t  s_cmdIdx = 0;
-
-static void trim_inplace(char* s)
+static void report_led(uint8_t on)
 {
-    if (s == NULL || *s == '\0') {
-        return;
-    }
-    char* end;
-    while (*s == ' ' || *s == '\t') {
-        memmove(s, s + 1, strlen(s));
-    }
-    end = s + strlen(s);
-    while (end > s && (end[-1] == ' ' || end[-1] == '\t')) {
-        *--end = '\0';
+    ButtonLedFSM_SetState(on ? LED_ON_STATE : LED_OFF_STATE);
+    if (on) {
+        printf("OK: LED ON (FSM = LED_ON)\r\n");
+    } else {
+        printf("OK: LED OFF (FSM = LED_OFF)\r\n");
     }
 }
 
-static bool streq_ci(const char* a, const char* b)
+static uint8_t cmd_led(const CliArg* arg)
 {
-    while (*a != '\0' && *b != '\0') {
-        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) {
-            return false;
-        }
-        ++a;
-        ++b;
-    }
-    return (*a == '\0') && (*b == '\0');
+    report_led(arg->choice);  /* "off|on": 0 = off, 1 = on */
+    return 0u;
 }
 
-static void print_help_serial(void)
+static uint8_t cmd_off(const CliArg* arg)
 {
-    printf("Commands: led on | led off | on | off | help\r\n");
+    (void)arg;
+    report_led(0u);
+    return 0u;
 }
 
-static void process_serial_line(char* line)
+static uint8_t cmd_on(const CliArg* arg)
 {
-    trim_inplace(line);
-    if (*line == '\0') {
-        return;
-    }
-
-    if (streq_ci(line, "help") || streq_ci(line, "?")) {
-        print_help_serial();
-        return;
-    }
-
-    if (streq_ci(line, "led on") || streq_ci(line, "on")) {
-        ButtonLedFSM_SetState(LED_ON_STATE);
-        printf("OK: LED ON (FSM = LED_ON)\r\n");
-        return;
-    }
-
-    if (streq_ci(line, "led off") || streq_ci(line, "off")) {
-        ButtonLedFSM_SetState(LED_OFF_STATE);
-        printf("OK: LED OFF (FSM = LED_OFF)\r\n");
-        return;
-    }
-
-    printf("Unknown: '%s' — type help\r\n", line);
+    (void)arg;
+    report_led(1u);
+    return 0u;
 }
 
-static void poll_serial_commands(void)
-{
-    while (Serial.available() > 0) {
-        const int c = Serial.read();
-        if (c < 0) {
-            break;
-        }
-        if (c == '\r' || c == '\n') {
-            if (s_cmdIdx > 0) {
-                s_cmdBuf[s_cmdIdx] = '\0';
-                printf("> %s\r\n", s_cmdBuf);
-                process_serial_line(s_cmdBuf);
-                s_cmdIdx = 0;
-            }
-        } else if ((unsigned char)c < 0x20) {
-            /* drop other control chars */
-        } else if (s_cmdIdx < (sizeof(s_cmdBuf) - 1)) {
-            s_cmdBuf[s_cmdIdx++] = (char)c;
-        } else {
-            s_cmdIdx = 0; /* line too long */
-            printf("[lab7] line too long — dropped\r\n");
-        }
-    }
-}
+/* Sorted by name; `help` / `?` come from the CLI itself. */
+static const CliCommand LAB7_COMMANDS[] PROGMEM = {
+    { "led", CLI_ARG_WORD, 0.0f, 0.0f, "off|on", cmd_led, "set the FSM state" },
+    { "off", CLI_ARG_NONE, 0.0f, 0.0f, "",       cmd_off, "same as `led off`" },
+    { "on",  CLI_ARG_NONE, 0.0f, 0.0f, "",       cmd_on,  "same as `led on`" }
+};
+
+static const CliConfig LAB7_CLI = {
+    LAB7_COMMANDS,
+    sizeof(LAB7_COMMANDS) / sizeof(LAB7_COMMANDS[0]),
+    CLI_FLAG_ECHO_LINE,
+    NULL,
+    NULL, NULL, NULL, NULL, NULL, NULL
+};
 
 // ============================================================================
 // Display and Timing State
@@ -228,15 +178,14 @@ void lab7_setup(void)
     printf("========================================\r\n");
     printf("Button Pin: %d (INPUT_PULLUP)\r\n", LAB7_BUTTON_PIN);
     printf("LED Pin: %d (OUTPUT)\r\n", LAB7_LED_PIN);
-    printf("Debounce Window: %d ms\r\n", LAB7_DEBOUNCE_MS);
+    printf("Debounce Window: %u ms\r\n", (unsigned)(BUTTON_BANK_SAMPLES * LAB7_BUTTON_SAMPLE_MS));
     printf("FSM Evaluation: %d ms\r\n", LAB7_FSM_STATE_DELAY_MS);
     printf("Serial: led on | led off | on | off | help\r\n");
     printf("========================================\r\n\r\n");
 
-    pinMode(LAB7_BUTTON_PIN, INPUT_PULLUP);
-    g_button_state.last_reading = digitalRead(LAB7_BUTTON_PIN);
-    g_button_state.stable_reading = g_button_state.last_reading;
-    g_last_stable_reading = g_button_state.stable_reading;
+    Cli_Register(&LAB7_CLI);
+
+    ButtonBank_Init(&g_buttons, g_button_pins, 1, 1, 1, 0);
 
     pinMode(LAB7_LED_PIN, OUTPUT);
     digitalWrite(LAB7_LED_PIN, LOW);
@@ -252,12 +201,12 @@ void lab7_setup(void)
 
 void lab7_loop(void)
 {
-    poll_serial_commands();
+    Cli_Poll();
 
     uint8_t led_output = ButtonLedFSM_GetOutput();
     digitalWrite(LAB7_LED_PIN, led_output ? HIGH : LOW);
 
-    delay(LAB7_FSM_STATE_DELAY_MS);
+    wait_and_sample_button();
 
     uint8_t button_input = read_button_press_event();
 
@@ -40,7 +40,7 @@
 #define LAB7_2_STATE_RED_MS       4000   // Red light duration (includes wait)
 
 // Debounce and timing
-#define LAB7_2_DEBOUNCE_MS        50     // Button debounce window
+#define LAB7_2_BUTTON_SAMPLE_MS   15     // ButtonBank sample period (debounce = 4 samples)
 #define LAB7_2_FSM_UPDATE_MS      100    // FSM evaluation period
 #define LAB7_2_DISPLAY_UPDATE_MS  500    // Status display refresh rate
 
@@ -23,6 +23,7 @@
 #include "Lab7_2_main.h"
 #include "TrafficLightFSM.h"
 #include "Lab7_2_Shared.h"
+#include "button/ButtonBank.h"
 #include <Arduino.h>
 #include <Arduino_FreeRTOS.h>
 #include <task.h>
@@ -46,13 +47,8 @@ static LiquidCrystal_I2C g_lcd(LAB7_2_LCD_I2C_ADDR, 16, 2);
 static uint32_t g_last_lcd_update_ms = 0;
 static bool g_lcd_ready = false;
 
-typedef struct {
-    uint8_t last_reading;
-    uint32_t last_change_time_ms;
-    uint8_t stable_reading;
-} ButtonDebounceState;
-
-static ButtonDebounceState g_button_state;
+static const uint8_t g_button_pins[] = { LAB7_2_BUTTON_NS_REQUEST };
+static ButtonBank g_buttons;
 
 // ----------------------------------------------------------------------------
 // Locked serial helpers
@@ -130,29 +126,22 @@ static void button_task(void* pvParameters) {
     }
 
     while (1) {
-        const uint8_t current = digitalRead(LAB7_2_BUTTON_NS_REQUEST);
-        const uint32_t now_ms = millis();
-
-        if (current != g_button_state.last_reading) {
-            g_button_state.last_reading = current;
-            g_button_state.last_change_time_ms = now_ms;
-        }
-
-        if ((now_ms - g_button_state.last_change_time_ms) >= LAB7_2_DEBOUNCE_MS) {
-            if (current != g_button_state.stable_reading) {
-                g_button_state.stable_reading = current;
-                g_last_button_press_ms = now_ms;
+        ButtonEvent ev;
+        ButtonBank_Update(&g_buttons, millis());
 
-                if (current == 0) {
-                    g_ns_request_active = true;
-                } else {
-                    g_ns_request_active = false;
-                }
+        while (ButtonBank_Pop(&g_buttons, &ev)) {
+            if (ev.type == BUTTON_EV_PRESS) {
+                g_ns_request_active = true;
+                g_last_button_press_ms = ev.tMs;
+                xSemaphoreGive(g_button_semaphore);
+            } else if (ev.type == BUTTON_EV_RELEASE) {
+                g_ns_request_active = false;
+                g_last_button_press_ms = ev.tMs;
                 xSemaphoreGive(g_button_semaphore);
             }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(LAB7_2_DEBOUNCE_MS));
+        vTaskDelay(pdMS_TO_TICKS(LAB7_2_BUTTON_SAMPLE_MS));
     }
 }
 
@@ -364,13 +353,10 @@ void lab7_2_setup(void) {
     digitalWrite(LAB7_2_LED_NS_YELLOW, LOW);
     digitalWrite(LAB7_2_LED_NS_RED,    LOW);
 
-    // Seed the debounce state from the actual pin reading so we don't fire a
-    // bogus "released" event a few ms after boot.
-    const uint8_t initial = digitalRead(LAB7_2_BUTTON_NS_REQUEST);
-    g_button_state.last_reading        = initial;
-    g_button_state.stable_reading      = initial;
-    g_button_state.last_change_time_ms = millis();
-    g_ns_request_active = (initial == 0);
+    // The bank seeds its state from the actual pin reading so we don't fire
+    // a bogus "released" event a few ms after boot.
+    ButtonBank_Init(&g_buttons, g_button_pins, 1, 1, 1, 0);
+    g_ns_request_active = (ButtonBank_IsPressed(&g_buttons, 0) != 0);
 
 #if LAB7_2_ENABLE_LCD
     Serial.println(F("[lab7_2] lcd init"));
@@ -0,0 +1,156 @@
+/**
+ * @file ButtonBank.cpp
+ * @brief ECAL Layer - Parallel debouncer for up to 8 buttons (implementation)
+ *
+ * Vertical counter, per bit: a sample equal to the accepted state resets
+ * the counter to 3; a differing one counts it down 3 -> 2 -> 1 -> 0, and
+ * the fourth wraps it back to 3 and flips the accepted state. The quiet
+ * path (no bit changing, no button held) is a port read and six byte ops.
+ */
+
+#include "ButtonBank.h"
+#include <Arduino.h>
+
+static void pushEvent(ButtonBank *bank, uint8_t bit, uint8_t type,
+                      uint32_t nowMs, uint32_t heldMs)
+{
+    const uint8_t head = bank->head;
+    const uint8_t next = (uint8_t)((head + 1u) & (BUTTON_BANK_QUEUE_LEN - 1u));
+    if (next == bank->tail)
+    {
+        if (bank->dropped < 0xFFu) { bank->dropped++; }
+        return;
+    }
+
+    ButtonEvent *ev = &bank->queue[head];
+    ev->id     = bank->idOfBit[bit];
+    ev->type   = type;
+    ev->tMs    = nowMs;
+    ev->heldMs = heldMs;
+    bank->head = next;                  /* publish after the slot is filled */
+}
+
+uint8_t ButtonBank_Init(ButtonBank *bank, const uint8_t *pins, uint8_t count,
+                        uint8_t activeLow, uint8_t pullup, uint16_t longPressMs)
+{
+    if (count == 0u || count > BUTTON_BANK_MAX)
+    {
+        return 0u;
+    }
+
+    const uint8_t port = digitalPinToPort(pins[0]);
+    uint8_t mask = 0u;
+
+    for (uint8_t i = 0u; i < count; ++i)
+    {
+        if (digitalPinToPort(pins[i]) != port)
+        {
+            return 0u;
+        }
+        const uint8_t bitMask = digitalPinToBitMask(pins[i]);
+        uint8_t bit = 0u;
+        while ((bitMask >> bit) != 1u) { ++bit; }
+
+        bank->idOfBit[bit] = i;
+        bank->pressMs[bit] = millis();  /* a button held now releases from here */
+        mask |= bitMask;
+        pinMode(pins[i], pullup ? INPUT_PULLUP : INPUT);
+    }
+
+    bank->pinReg      = portInputRegister(port);
+    bank->mask        = mask;
+    bank->invert      = activeLow ? mask : 0u;
+    bank->ct0         = 0xFFu;
+    bank->ct1         = 0xFFu;
+    bank->longDone    = 0xFFu;          /* no LONG for a button held at boot */
+    bank->longPressMs = longPressMs;
+    bank->head        = 0u;
+    bank->tail        = 0u;
+    bank->dropped     = 0u;
+
+    delayMicroseconds(10);              /* let the pull-ups charge the lines */
+    bank->state = (uint8_t)((*bank->pinReg ^ bank->invert) & mask);
+    return 1u;
+}
+
+void ButtonBank_Update(ButtonBank *bank, uint32_t nowMs)
+{
+    const uint8_t raw  = (uint8_t)((*bank->pinReg ^ bank->invert) & bank->mask);
+    const uint8_t diff = (uint8_t)(bank->state ^ raw);
+
+    bank->ct0 = (uint8_t)~(bank->ct0 & diff);
+    bank->ct1 = (uint8_t)(bank->ct0 ^ (bank->ct1 & diff));
+
+    const uint8_t flipped = (uint8_t)(diff & bank->ct0 & bank->ct1);
+    bank->state ^= flipped;
+
+    if (flipped != 0u)
+    {
+        for (uint8_t bit = 0u; bit < 8u; ++bit)
+        {
+            const uint8_t m = (uint8_t)(1u << bit);
+            if ((flipped & m) == 0u)
+            {
+                continue;
+            }
+            if ((bank->state & m) != 0u)
+            {
+                bank->pressMs[bit] = nowMs;
+                bank->longDone &= (uint8_t)~m;
+                pushEvent(bank, bit, BUTTON_EV_PRESS, nowMs, 0UL);
+            }
+            else
+            {
+                pushEvent(bank, bit, BUTTON_EV_RELEASE, nowMs, nowMs - bank->pressMs[bit]);
+            }
+        }
+    }
+
+    uint8_t waiting = (uint8_t)(bank->state & ~bank->longDone);
+    if (bank->longPressMs != 0u && waiting != 0u)
+    {
+        for (uint8_t bit = 0u; waiting != 0u; ++bit, waiting >>= 1)
+        {
+            if ((waiting & 1u) == 0u)
+            {
+                continue;
+            }
+            const uint32_t held = nowMs - bank->pressMs[bit];
+            if (held >= bank->longPressMs)
+            {
+                bank->longDone |= (uint8_t)(1u << bit);
+                pushEvent(bank, bit, BUTTON_EV_LONG, nowMs, held);
+            }
+        }
+    }
+}
+
+uint8_t ButtonBank_Pop(ButtonBank *bank, ButtonEvent *ev)
+{
+    const uint8_t tail = bank->tail;
+    if (tail == bank->head)
+    {
+        return 0u;
+    }
+    *ev = bank->queue[tail];
+    bank->tail = (uint8_t)((tail + 1u) & (BUTTON_BANK_QUEUE_LEN - 1u));
+    return 1u;
+}
+
+uint8_t ButtonBank_IsPressed(const ButtonBank *bank, uint8_t id)
+{
+    for (uint8_t bit = 0u; bit < 8u; ++bit)
+    {
+        const uint8_t m = (uint8_t)(1u << bit);
+        if ((bank->mask & m) != 0u && bank->idOfBit[bit] == id)
+        {
+            return (bank->state & m) ? 1u : 0u;
+        }
+    }
+    return 0u;
+}
+
+uint8_t ButtonBank_Dropped(const ButtonBank *bank)
+{
+    return bank->dropped;
+}
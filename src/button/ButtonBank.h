@@ -0,0 +1,112 @@
+/**
+ * @file ButtonBank.h
+ * @brief ECAL Layer - Parallel debouncer for up to 8 buttons on one port
+ *
+ * ButtonDriver debounces one pin per Update() with its own sample
+ * counter, so the input cost grows with every button added. A bank reads
+ * the whole PINx register once and debounces all of its bits together
+ * with a 2-bit vertical counter: bit n of ct0 / ct1 is the counter of
+ * bit n of the port, and one pass of byte-wide AND / XOR steps all eight
+ * counters at once. A bit must differ from the accepted state on
+ * BUTTON_BANK_SAMPLES consecutive Update() calls before it flips.
+ *
+ * Accepted edges become events (press / release / long press, with the
+ * millisecond they were accepted) in a small per-bank ring. Update() and
+ * Pop() may run in different contexts (e.g. a timer ISR and a task):
+ * there is one writer and one reader per index.
+ *
+ * The header is C-compatible so the pure-C Lab 2.2 tasks can use it.
+ *
+ * Usage:
+ *   static const uint8_t pins[] = { 2, 3, 5 };     // all on PORTE
+ *   static ButtonBank bank;
+ *   ButtonBank_Init(&bank, pins, 3, 1, 1, 800);
+ *   // --- every 5..15 ms ---
+ *   ButtonBank_Update(&bank, millis());
+ *   ButtonEvent ev;
+ *   while (ButtonBank_Pop(&bank, &ev)) { ... ev.id, ev.type ... }
+ *
+ * Architecture: Lab -> ButtonBank -> PINx register
+ */
+
+#ifndef BUTTON_BANK_H
+#define BUTTON_BANK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Buttons per bank: one port, eight bits. */
+#define BUTTON_BANK_MAX         8u
+
+/** Consecutive differing samples to accept an edge (2-bit counter). */
+#define BUTTON_BANK_SAMPLES     4u
+
+/** Event ring per bank; power of two. */
+#define BUTTON_BANK_QUEUE_LEN   8u
+
+typedef enum {
+    BUTTON_EV_PRESS = 0,
+    BUTTON_EV_RELEASE,
+    BUTTON_EV_LONG          /* still held after longPressMs, once per press */
+} ButtonEventType;
+
+typedef struct {
+    uint8_t  id;            /* index into the pin list given to Init        */
+    uint8_t  type;          /* ButtonEventType                              */
+    uint32_t tMs;           /* Update() time the edge was accepted          */
+    uint32_t heldMs;        /* RELEASE / LONG: time since the press; else 0 */
+} ButtonEvent;
+
+typedef struct {
+    volatile uint8_t *pinReg;
+    uint8_t  mask;                          /* port bits in this bank       */
+    uint8_t  invert;                        /* active-low bits              */
+    uint8_t  ct0;                           /* vertical counter, low bit    */
+    uint8_t  ct1;                           /* vertical counter, high bit   */
+    uint8_t  state;                         /* debounced, 1 = pressed       */
+    uint8_t  longDone;                      /* LONG already sent this press */
+    uint16_t longPressMs;                   /* 0 = no LONG events           */
+    uint8_t  idOfBit[8];
+    uint32_t pressMs[8];                    /* by port bit                  */
+
+    ButtonEvent      queue[BUTTON_BANK_QUEUE_LEN];
+    volatile uint8_t head;                  /* written by Update()          */
+    volatile uint8_t tail;                  /* written by Pop()             */
+    uint8_t          dropped;               /* events lost, saturating      */
+} ButtonBank;
+
+/**
+ * @brief Configure the pins and seed the state from the current levels
+ *
+ * Buttons already held at Init produce no press event.
+ *
+ * @param pins        Arduino pin numbers, all on the same port
+ * @param count       1..BUTTON_BANK_MAX; event ids are indices into pins
+ * @param activeLow   1: pressed reads LOW (button to GND)
+ * @param pullup      1: enable the internal pull-ups
+ * @param longPressMs hold time for BUTTON_EV_LONG, 0 to disable
+ * @return 1 on success, 0 on a bad count or pins on different ports
+ */
+uint8_t ButtonBank_Init(ButtonBank *bank, const uint8_t *pins, uint8_t count,
+                        uint8_t activeLow, uint8_t pullup, uint16_t longPressMs);
+
+/** One sample of the whole bank: a port read and a few byte operations. */
+void ButtonBank_Update(ButtonBank *bank, uint32_t nowMs);
+
+/** @return 1 and the oldest event, or 0 when the ring is empty */
+uint8_t ButtonBank_Pop(ButtonBank *bank, ButtonEvent *ev);
+
+/** @return 1 while button `id` is (debounced) pressed */
+uint8_t ButtonBank_IsPressed(const ButtonBank *bank, uint8_t id);
+
+/** @return events lost to a full ring since Init (saturates at 255) */
+uint8_t ButtonBank_Dropped(const ButtonBank *bank);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BUTTON_BANK_H */
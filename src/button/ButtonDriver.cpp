@@ -5,7 +5,7 @@
  * Implements the non-blocking debounce state machine for a push-button.
  *
  * Debounce logic summary:
- *   • Raw pin read interpreted by configured polarity:
+ *   • Raw pin read (straight from PINx) interpreted by configured polarity:
  *       - active-low  => LOW = pressed
  *       - active-high => HIGH = pressed
  *   • While the raw reading matches the accepted state → reset sample counter.
@@ -14,10 +14,16 @@
  *       - Press  edge: record start time via millis().
  *       - Release edge: compute duration, set release flag.
  *
+ * Edge-capture mode replaces the sample counter with an INTn CHANGE ISR
+ * and a quiet-time rule on micros() timestamps (see ButtonDriver.h).
+ *
  * Architecture: Lab2 -> ButtonDriver -> GPIO MCAL -> Arduino GPIO Hardware
  */
 
 #include "ButtonDriver.h"
+#include <util/atomic.h>
+
+ButtonDriver* ButtonDriver::s_edgeOwner[ButtonDriver::EDGE_SLOTS] = { NULL };
 
 ButtonDriver::ButtonDriver(uint8_t pin,
                                                      bool activeLow,
@@ -29,8 +35,16 @@ ButtonDriver::ButtonDriver(uint8_t pin,
       _sampleCount(0),
       _releaseFlag(false),
       _pressStartMs(0),
-      _lastDurationMs(0)
+      _lastDurationMs(0),
+      _edgeMode(false),
+      _edgePending(false),
+      _edgeLevelPressed(false),
+      _edgeFirstUs(0),
+      _edgeLastUs(0),
+      _pressStartUs(0),
+      _lastDurationUs(0)
 {
+    _io.Bind(pin);
 }
 
 void ButtonDriver::Init()
@@ -45,10 +59,127 @@ void ButtonDriver::Init()
 }
 
 
+// ============================================================================
+// Edge-capture mode
+// ============================================================================
+
+template <uint8_t N>
+void ButtonDriver::edgeTrampoline()
+{
+    ButtonDriver* owner = s_edgeOwner[N];
+    if (owner != NULL)
+    {
+        owner->onEdge();
+    }
+}
+
+bool ButtonDriver::BeginEdgeCapture()
+{
+    static void (* const trampolines[EDGE_SLOTS])(void) = {
+        edgeTrampoline<0>, edgeTrampoline<1>, edgeTrampoline<2>,
+        edgeTrampoline<3>, edgeTrampoline<4>, edgeTrampoline<5>
+    };
+
+    const int irq = digitalPinToInterrupt(_pin);
+    if (irq < 0 || irq >= (int)EDGE_SLOTS || s_edgeOwner[irq] != NULL)
+    {
+        return false;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        const bool raw = _io.Read();
+        _debouncedState   = _activeLow ? !raw : raw;
+        _edgeLevelPressed = _debouncedState;
+        _edgePending      = false;
+        _pressStartUs     = micros();
+        _edgeMode         = true;
+        s_edgeOwner[irq]  = this;
+    }
+    attachInterrupt((uint8_t)irq, trampolines[irq], CHANGE);
+    return true;
+}
+
+/** INTn ISR context. */
+void ButtonDriver::onEdge()
+{
+    const uint32_t nowUs = micros();
+    const bool     raw   = _io.Read();
+    const bool     level = _activeLow ? !raw : raw;
+
+    settleEdges(nowUs);             // the previous burst may have ended quietly
+
+    if (!_edgePending && level != _debouncedState)
+    {
+        _edgePending = true;
+        _edgeFirstUs = nowUs;
+    }
+    _edgeLastUs       = nowUs;
+    _edgeLevelPressed = level;
+}
+
+/** Interrupts disabled (ISR or ATOMIC_BLOCK). */
+void ButtonDriver::settleEdges(uint32_t nowUs)
+{
+    if (_edgePending && (nowUs - _edgeLastUs) >= EDGE_DEBOUNCE_US)
+    {
+        _edgePending = false;
+        if (_edgeLevelPressed != _debouncedState)
+        {
+            acceptEdge(_edgeLevelPressed, _edgeFirstUs);
+        }
+        // else: a glitch that ended where it started
+    }
+}
+
+void ButtonDriver::acceptEdge(bool pressed, uint32_t edgeUs)
+{
+    _debouncedState = pressed;
+    if (pressed)
+    {
+        _pressStartUs = edgeUs;
+        _pressStartMs = millis();
+    }
+    else
+    {
+        _lastDurationUs = edgeUs - _pressStartUs;
+        _lastDurationMs = (_lastDurationUs + 500UL) / 1000UL;
+        _releaseFlag    = true;
+    }
+}
+
+/** State as of now, without committing a burst that has just gone quiet. */
+bool ButtonDriver::settledPressed() const
+{
+    bool pressed;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pressed = _debouncedState;
+        if (_edgePending && (micros() - _edgeLastUs) >= EDGE_DEBOUNCE_US)
+        {
+            pressed = _edgeLevelPressed;
+        }
+    }
+    return pressed;
+}
+
+// ============================================================================
+// Polling mode
+// ============================================================================
+
 void ButtonDriver::Update()
 {
-    int rawValue = digitalRead(_pin);               // MCAL: digitalRead
-    bool rawPressed = _activeLow ? (rawValue == LOW) : (rawValue == HIGH);
+    if (_edgeMode)
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            settleEdges(micros());
+        }
+        return;
+    }
+
+    bool rawHigh    = _io.Read();                  // PINx, port cached at construction
+    bool rawPressed = _activeLow ? !rawHigh : rawHigh;
 
     if (rawPressed == _debouncedState)
     {
@@ -83,21 +214,38 @@ void ButtonDriver::Update()
 
 bool ButtonDriver::IsPressed() const
 {
-    return _debouncedState;
+    return _edgeMode ? settledPressed() : _debouncedState;
 }
 
 
 bool ButtonDriver::WasJustReleased()
 {
-    if (_releaseFlag)
+    bool released = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
     {
+        if (_edgeMode)
+        {
+            settleEdges(micros());
+        }
+        released     = _releaseFlag;
         _releaseFlag = false;
-        return true;
     }
-    return false;
+    return released;
 }
 
 uint32_t ButtonDriver::GetLastPressDuration() const
 {
-    return _lastDurationMs;
+    uint32_t ms;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { ms = _lastDurationMs; }
+    return ms;
+}
+
+uint32_t ButtonDriver::GetLastPressDurationUs() const
+{
+    uint32_t us;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        us = _edgeMode ? _lastDurationUs : _lastDurationMs * 1000UL;
+    }
+    return us;
 }
@@ -13,6 +13,15 @@
  *   At 20 ms period this gives 5 × 20 ms = 100 ms debounce window,
  *   which is well within the ~200 ms minimum button press interval.
  *
+ * Edge-capture mode (BeginEdgeCapture(), pins with an INTn line only):
+ *   A CHANGE interrupt stamps every edge with micros(). The first edge of
+ *   a burst is the candidate transition; it is accepted once the line has
+ *   been quiet for EDGE_DEBOUNCE_US, checked on the next edge or when the
+ *   application queries the driver. Press durations are therefore
+ *   edge-to-edge (4 us resolution) instead of quantised to the Update()
+ *   period and shifted by the debounce window, and nobody has to call
+ *   Update() any more.
+ *
  * Pin convention:
  *   Configurable at construction time:
  *   - active-low  + INPUT_PULLUP (button to GND)
@@ -34,6 +43,7 @@
 #define BUTTON_DRIVER_H
 
 #include <Arduino.h>
+#include "../drivers/FastGpio.h"
 
 class ButtonDriver
 {
@@ -45,6 +55,14 @@ public:
 
     void Init();
 
+    /**
+     * @brief Switch to interrupt-driven edge capture (call after Init)
+     * @return false if the pin has no external interrupt or its slot is taken;
+     *         the driver then stays in polling mode
+     */
+    bool BeginEdgeCapture();
+
+    /** Polling mode: one debounce sample. Edge mode: only settles pending edges. */
     void Update();
 
     bool IsPressed() const;
@@ -53,8 +71,13 @@ public:
 
     uint32_t GetLastPressDuration() const;
 
+    /** Duration of the last completed press in microseconds (edge mode;
+     *  polling mode reports the millisecond value × 1000). */
+    uint32_t GetLastPressDurationUs() const;
+
 private:
     uint8_t  _pin;                    ///< GPIO pin index
+    FastGpio _io;                     ///< Port/mask of _pin, resolved once
     bool     _activeLow;              ///< true: pressed=LOW, false: pressed=HIGH
     bool     _useInternalPullup;      ///< true: pinMode INPUT_PULLUP, false: INPUT
     bool     _debouncedState;         ///< Accepted (debounced) button state
@@ -63,10 +86,32 @@ private:
     uint32_t _pressStartMs;           ///< millis() timestamp of last press start
     uint32_t _lastDurationMs;         ///< Duration of the last completed press
 
+    /* --- Edge-capture mode: written by the INTn ISR --------------------- */
+    bool              _edgeMode;          ///< true after BeginEdgeCapture()
+    volatile bool     _edgePending;       ///< a burst is waiting to be accepted
+    volatile bool     _edgeLevelPressed;  ///< level read at the latest edge
+    volatile uint32_t _edgeFirstUs;       ///< first edge of the pending burst
+    volatile uint32_t _edgeLastUs;        ///< latest edge
+    uint32_t          _pressStartUs;      ///< accepted press edge
+    uint32_t          _lastDurationUs;    ///< release edge − press edge
+
+    void onEdge();
+    void settleEdges(uint32_t nowUs);
+    void acceptEdge(bool pressed, uint32_t edgeUs);
+    bool settledPressed() const;
+
+    /** One trampoline per INTn, since attachInterrupt() passes no context. */
+    template <uint8_t N> static void edgeTrampoline();
+    static const uint8_t EDGE_SLOTS = 6;  ///< INT0..INT5 (D2, D3, D18..D21)
+    static ButtonDriver* s_edgeOwner[EDGE_SLOTS];
+
     /** Number of consecutive matching samples required to accept a state change.
      *  With WDT-based FreeRTOS tick (~16 ms), 3 samples ≈ 48 ms debounce window.
      */
     static const uint8_t DEBOUNCE_SAMPLES = 3;
+
+    /** Edge mode: quiet time that ends a bounce burst. */
+    static const uint32_t EDGE_DEBOUNCE_US = 20000UL;
 };
 
 #endif // BUTTON_DRIVER_H
@@ -0,0 +1,644 @@
+/**
+ * @file CommandLine.cpp
+ * @brief SRV Layer - Shared non-blocking Serial command line (implementation)
+ *
+ * Bytes are taken from the Arduino core's RX ring (filled by the USART RX
+ * interrupt) one at a time and fed through a small state machine:
+ *
+ *   printable        -> appended to the edit buffer
+ *   BS / DEL         -> erase one character
+ *   CR, LF, CRLF     -> end of line: trim, history, dispatch
+ *   ESC [ ... final  -> CSI sequence swallowed; final 'A' / 'B' = history
+ *   ESC O x          -> SS3 sequence swallowed; 'A' / 'B' = history
+ *
+ * Dispatch splits the line in place, binary-searches the registered
+ * PROGMEM table, validates / clamps the argument from the table row and
+ * calls the handler between the lab's lockState / unlockState hooks.
+ *
+ * The USART0 RX vector itself belongs to HardwareSerial, so the CLI sits on
+ * top of its ring buffer instead of installing a second handler.
+ */
+
+#include "CommandLine.h"
+#include <Arduino.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// State
+// ============================================================================
+
+typedef enum
+{
+    CLI_ESC_NONE = 0,
+    CLI_ESC_START,          /* got ESC                                     */
+    CLI_ESC_CSI,            /* got ESC [ ; waiting for the final byte      */
+    CLI_ESC_SS3             /* got ESC O ; next byte is the final byte     */
+} CliEscState;
+
+static const CliConfig* s_cfg = NULL;
+
+static char    s_line[CLI_LINE_MAX];
+static uint8_t s_len = 0u;
+static bool    s_overflow = false;
+static uint8_t s_esc = CLI_ESC_NONE;
+static char    s_lastTerminator = '\0';
+static uint8_t s_lastRow = CLI_NO_COMMAND;  /* table row of the last dispatch */
+
+static char    s_history[CLI_HISTORY_DEPTH][CLI_LINE_MAX];
+static uint8_t s_histCount = 0u;    /* valid entries                       */
+static uint8_t s_histHead = 0u;     /* next slot to write                  */
+static uint8_t s_histCursor = 0u;   /* 0 = new line, n = n-th most recent  */
+
+// ============================================================================
+// Output helpers
+// ============================================================================
+
+static bool ioTake(void)
+{
+    return (s_cfg->lockIo == NULL) || s_cfg->lockIo();
+}
+
+static void ioGive(void)
+{
+    if (s_cfg->unlockIo != NULL) { s_cfg->unlockIo(); }
+}
+
+/** One reply line under the lab's I/O lock. */
+static void say(const char* fmt, ...)
+{
+    if (ioTake())
+    {
+        va_list args;
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+        ioGive();
+    }
+}
+
+static void echoChars(const char* text)
+{
+    if ((s_cfg->flags & CLI_FLAG_ECHO_CHARS) == 0u) { return; }
+    if (ioTake())
+    {
+        printf("%s", text);
+        ioGive();
+    }
+}
+
+void Cli_FormatValue(char* out, size_t outSize, float value)
+{
+    const bool negative = (value < 0.0f);
+    if (negative) { value = -value; }
+    const unsigned long scaled = (unsigned long)(value * 100.0f + 0.5f);
+    const unsigned long whole  = scaled / 100UL;
+    const unsigned int  frac   = (unsigned int)(scaled % 100UL);
+    const char* sign = negative ? "-" : "";
+
+    if (frac == 0u)
+    {
+        snprintf(out, outSize, "%s%lu", sign, whole);
+    }
+    else if ((frac % 10u) == 0u)
+    {
+        snprintf(out, outSize, "%s%lu.%u", sign, whole, frac / 10u);
+    }
+    else
+    {
+        snprintf(out, outSize, "%s%lu.%02u", sign, whole, frac);
+    }
+}
+
+// ============================================================================
+// Table access
+// ============================================================================
+
+/** Binary search on the registered table. Returns the row index or -1. */
+static int8_t lookupCommand(const char* name)
+{
+    int8_t lo = 0;
+    int8_t hi = (int8_t)(s_cfg->count - 1u);
+
+    while (lo <= hi)
+    {
+        const int8_t mid = (int8_t)((lo + hi) / 2);
+        const int cmp = strcasecmp_P(name, s_cfg->commands[mid].name);
+        if (cmp == 0) { return mid; }
+        if (cmp < 0)  { hi = (int8_t)(mid - 1); }
+        else          { lo = (int8_t)(mid + 1); }
+    }
+    return -1;
+}
+
+static bool tableIsSorted(void)
+{
+    char prev[sizeof(s_cfg->commands[0].name)];
+    strncpy_P(prev, s_cfg->commands[0].name, sizeof(prev));
+    for (uint8_t i = 1u; i < s_cfg->count; ++i)
+    {
+        if (strcasecmp_P(prev, s_cfg->commands[i].name) >= 0) { return false; }
+        strncpy_P(prev, s_cfg->commands[i].name, sizeof(prev));
+    }
+    return true;
+}
+
+/** Match `word` against a "a|b|c" list in flash. Returns the index or -1. */
+static int8_t matchChoice(const char* word, const char* choicesP)
+{
+    int8_t index = 0;
+    const char* w = word;
+    bool matching = true;
+
+    if (pgm_read_byte(choicesP) == '\0') { return -1; }
+
+    for (;; ++choicesP)
+    {
+        const char c = (char)pgm_read_byte(choicesP);
+        if (c == '|' || c == '\0')
+        {
+            if (matching && *w == '\0') { return index; }
+            if (c == '\0') { return -1; }
+            ++index;
+            w = word;
+            matching = true;
+            continue;
+        }
+        if (matching && tolower((unsigned char)*w) == c) { ++w; }
+        else { matching = false; }
+    }
+}
+
+/** Copy keyword number `index` of a flash "a|b|c" list into `out`. */
+static void copyChoice(char* out, size_t outSize, const char* choicesP, uint8_t index)
+{
+    size_t n = 0u;
+    for (;; ++choicesP)
+    {
+        const char c = (char)pgm_read_byte(choicesP);
+        if (c == '\0') { break; }
+        if (c == '|')
+        {
+            if (index == 0u) { break; }
+            --index;
+            continue;
+        }
+        if (index == 0u && n + 1u < outSize) { out[n++] = c; }
+    }
+    out[n] = '\0';
+}
+
+/** "kp <0..200>", "mode <onoff|pid>", "servo <-1000..1000|min|max>". */
+static void formatSyntax(char* out, size_t outSize, uint8_t row)
+{
+    const CliCommand* cmd = &s_cfg->commands[row];
+    const uint8_t type = pgm_read_byte(&cmd->argType);
+    const bool hasChoices = (pgm_read_byte(cmd->choices) != '\0');
+
+    strncpy_P(out, cmd->name, outSize);
+    out[outSize - 1u] = '\0';
+    if (type == CLI_ARG_NONE) { return; }
+
+    size_t len = strlen(out);
+    if (type == CLI_ARG_TEXT)
+    {
+        snprintf(out + len, outSize - len, " ");
+        len = strlen(out);
+        strncpy_P(out + len, cmd->choices, outSize - len);
+        out[outSize - 1u] = '\0';
+        return;
+    }
+    snprintf(out + len, outSize - len, " <");
+
+    if (type != CLI_ARG_WORD)
+    {
+        char lo[12];
+        char hi[12];
+        Cli_FormatValue(lo, sizeof(lo), pgm_read_float(&cmd->minVal));
+        Cli_FormatValue(hi, sizeof(hi), pgm_read_float(&cmd->maxVal));
+        len = strlen(out);
+        snprintf(out + len, outSize - len, "%s..%s%s", lo, hi, hasChoices ? "|" : "");
+    }
+    if (hasChoices)
+    {
+        len = strlen(out);
+        strncpy_P(out + len, cmd->choices, outSize - len);
+        out[outSize - 1u] = '\0';
+    }
+
+    len = strlen(out);
+    snprintf(out + len, outSize - len, ">");
+}
+
+void Cli_PrintCommands(void)
+{
+    if (s_cfg == NULL) { return; }
+
+    char syntax[48];
+    char help[sizeof(s_cfg->commands[0].help)];
+
+    if (s_cfg->bareNumber != NULL)
+    {
+        snprintf(help, sizeof(help), "shortcut: same as `%s <number>`", s_cfg->bareNumber);
+        printf("  %-36s %s\n", "<number>", help);
+    }
+    for (uint8_t i = 0u; i < s_cfg->count; ++i)
+    {
+        formatSyntax(syntax, sizeof(syntax), i);
+        strncpy_P(help, s_cfg->commands[i].help, sizeof(help));
+        help[sizeof(help) - 1u] = '\0';
+        printf("  %-36s %s\n", syntax, help);
+    }
+}
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+/** Split `line` in place on blanks. Returns the token count; maxTokens + 1
+ *  means "too many tokens" (the rest is left unsplit). */
+static uint8_t tokenize(char* line, char* argv[], uint8_t maxTokens)
+{
+    uint8_t argc = 0u;
+    char* p = line;
+
+    for (;;)
+    {
+        while (*p == ' ' || *p == '\t') { ++p; }
+        if (*p == '\0') { break; }
+        if (argc == maxTokens) { return (uint8_t)(maxTokens + 1u); }
+
+        argv[argc++] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t') { ++p; }
+        if (*p == '\0') { break; }
+        *p++ = '\0';
+    }
+    return argc;
+}
+
+static bool parseNumber(const char* text, float* out)
+{
+    char* end = NULL;
+    const float v = (float)strtod(text, &end);
+    if (end == text || *end != '\0') { return false; }
+    /* strtod takes "nan" / "inf", and 1e39 overflows the float: neither
+     * survives the range clamp, so treat them as not a number at all. */
+    if (!isfinite(v)) { return false; }
+    *out = v;
+    return true;
+}
+
+static void rejectArgument(const char* name, uint8_t row)
+{
+    char syntax[48];
+    formatSyntax(syntax, sizeof(syntax), row);
+    say("(%s?) usage: %s\n", name, syntax);
+    if (s_cfg->onError != NULL) { s_cfg->onError(); }
+}
+
+static void builtinHelp(void)
+{
+    if (ioTake())
+    {
+        printf("Commands:\n");
+        Cli_PrintCommands();
+        printf("  %-36s %s\n", "help | ?", "this list");
+        ioGive();
+    }
+}
+
+bool Cli_Execute(char* line)
+{
+    if (s_cfg == NULL) { return false; }
+
+    char* argv[CLI_MAX_TOKENS];
+    const uint8_t argc = tokenize(line, argv, CLI_MAX_TOKENS);
+    if (argc == 0u) { return false; }
+
+    const char* name   = argv[0];
+    const char* argTok = (argc >= 2u) ? argv[1] : NULL;
+    float number = 0.0f;
+
+    /* A lone number is routed to the lab's bareNumber row (`25` == `set 25`). */
+    if (argc == 1u && s_cfg->bareNumber != NULL && parseNumber(argv[0], &number))
+    {
+        name   = s_cfg->bareNumber;
+        argTok = argv[0];
+    }
+
+    int8_t row = lookupCommand(name);
+    if (row < 0 && strcmp(name, "?") == 0)
+    {
+        row = lookupCommand("help");
+    }
+    if (row < 0)
+    {
+        if (strcasecmp(name, "help") == 0 || strcmp(name, "?") == 0)
+        {
+            builtinHelp();
+            return true;
+        }
+        /* Show exactly what was parsed, so stray bytes are obvious. */
+        say("(unknown) cmd='%s' — type `help`\n", name);
+        if (s_cfg->onError != NULL) { s_cfg->onError(); }
+        return false;
+    }
+
+    const CliCommand* cmd = &s_cfg->commands[row];
+
+    /* Replies use the table spelling, not what was typed. */
+    char canonical[sizeof(cmd->name)];
+    strncpy_P(canonical, cmd->name, sizeof(canonical));
+
+    const uint8_t type = pgm_read_byte(&cmd->argType);
+
+    /* TEXT takes the rest of the line: undo the split after the first
+     * argument token (tokenize() stops there when there are more). */
+    bool textRejoined = false;
+    if (type == CLI_ARG_TEXT && argc > CLI_MAX_TOKENS && argTok != NULL)
+    {
+        char* end = (char*)argTok + strlen(argTok);
+        *end = ' ';
+        end += strlen(end);
+        while (end > argTok && (end[-1] == ' ' || end[-1] == '\t')) { *--end = '\0'; }
+        textRejoined = true;
+    }
+
+    const bool argMissing = (type != CLI_ARG_NONE) && (argTok == NULL);
+    const bool argExtra   = (argc > CLI_MAX_TOKENS && !textRejoined) ||
+                            ((type == CLI_ARG_NONE) && (argTok != NULL));
+    if (argMissing || argExtra)
+    {
+        rejectArgument(canonical, (uint8_t)row);
+        return false;
+    }
+
+    /* --- Validate + clamp (no lock held) --- */
+    CliArg arg;
+    arg.value    = 0.0f;
+    arg.choice   = 0u;
+    arg.isChoice = false;
+    arg.clamped  = false;
+    arg.text     = NULL;
+
+    if (type == CLI_ARG_TEXT)
+    {
+        arg.text = argTok;
+    }
+    else if (type != CLI_ARG_NONE)
+    {
+        const bool numeric = (type != CLI_ARG_WORD) && parseNumber(argTok, &number);
+        if (numeric)
+        {
+            /* Clamp before truncating: a float past LONG_MAX (`1e20`)
+             * does not convert to long. */
+            const float lo = pgm_read_float(&cmd->minVal);
+            const float hi = pgm_read_float(&cmd->maxVal);
+            arg.clamped = (number < lo) || (number > hi);
+            arg.value   = (number < lo) ? lo : ((number > hi) ? hi : number);
+            if (type == CLI_ARG_INT) { arg.value = (float)(long)arg.value; }
+        }
+        else
+        {
+            const int8_t choice = matchChoice(argTok, cmd->choices);
+            if (choice < 0)
+            {
+                rejectArgument(canonical, (uint8_t)row);
+                return false;
+            }
+            arg.choice   = (uint8_t)choice;
+            arg.isChoice = true;
+        }
+    }
+
+    /* --- Apply: one state-lock acquisition per command --- */
+    const CliHandler handler = (CliHandler)pgm_read_ptr(&cmd->handler);
+    s_lastRow = (uint8_t)row;
+    if (s_cfg->lockState != NULL && !s_cfg->lockState())
+    {
+        say("(%s) busy, try again\n", canonical);
+        return false;
+    }
+    const uint8_t effects = handler(&arg);
+    if (s_cfg->unlockState != NULL) { s_cfg->unlockState(); }
+
+    if (s_cfg->apply != NULL) { s_cfg->apply(effects, &arg); }
+
+    /* --- Uniform acknowledgement --- */
+    if ((s_cfg->flags & CLI_FLAG_ACK_VALUES) == 0u || type == CLI_ARG_NONE ||
+        type == CLI_ARG_TEXT)
+    {
+        return true;
+    }
+
+    char valueText[28];
+    if (arg.isChoice)
+    {
+        copyChoice(valueText, sizeof(valueText), cmd->choices, arg.choice);
+        say("%s = %s\n", canonical, valueText);
+    }
+    else if (!arg.clamped)
+    {
+        Cli_FormatValue(valueText, sizeof(valueText), arg.value);
+        say("%s = %s\n", canonical, valueText);
+    }
+    else
+    {
+        char syntax[48];
+        Cli_FormatValue(valueText, sizeof(valueText), arg.value);
+        formatSyntax(syntax, sizeof(syntax), (uint8_t)row);
+        say("%s clamped to %s (%s)\n", canonical, valueText, syntax);
+    }
+    return true;
+}
+
+// ============================================================================
+// Line editor
+// ============================================================================
+
+static void historyPush(const char* line)
+{
+    if (s_histCount > 0u)
+    {
+        const uint8_t last = (uint8_t)((s_histHead + CLI_HISTORY_DEPTH - 1u) % CLI_HISTORY_DEPTH);
+        if (strcmp(s_history[last], line) == 0) { return; }
+    }
+    strncpy(s_history[s_histHead], line, CLI_LINE_MAX - 1u);
+    s_history[s_histHead][CLI_LINE_MAX - 1u] = '\0';
+    s_histHead = (uint8_t)((s_histHead + 1u) % CLI_HISTORY_DEPTH);
+    if (s_histCount < CLI_HISTORY_DEPTH) { ++s_histCount; }
+}
+
+/** Arrow up (older = true) / arrow down: replace the edit buffer. */
+static void historyRecall(bool older)
+{
+    if (older && s_histCursor < s_histCount)      { ++s_histCursor; }
+    else if (!older && s_histCursor > 0u)         { --s_histCursor; }
+    else                                          { return; }
+
+    if (s_histCursor == 0u)
+    {
+        s_line[0] = '\0';
+    }
+    else
+    {
+        const uint8_t slot = (uint8_t)((s_histHead + CLI_HISTORY_DEPTH - s_histCursor) % CLI_HISTORY_DEPTH);
+        strcpy(s_line, s_history[slot]);
+    }
+    s_len = (uint8_t)strlen(s_line);
+    s_overflow = false;
+
+    /* Redraw: CR, erase to end of line, new content. */
+    echoChars("\r\x1b[K");
+    echoChars(s_line);
+}
+
+static void resetLine(void)
+{
+    s_len = 0u;
+    s_line[0] = '\0';
+    s_overflow = false;
+    s_histCursor = 0u;
+}
+
+static void endOfLine(void)
+{
+    echoChars("\n");
+
+    if (s_overflow)
+    {
+        say("(line too long, max %u chars) — dropped\n", (unsigned)(CLI_LINE_MAX - 1));
+        resetLine();
+        return;
+    }
+
+    s_line[s_len] = '\0';
+
+    /* Trim both ends; blank lines are ignored silently. */
+    char* start = s_line;
+    while (*start == ' ' || *start == '\t') { ++start; }
+    char* end = start + strlen(start);
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t')) { *--end = '\0'; }
+    if (*start == '\0')
+    {
+        resetLine();
+        return;
+    }
+
+    if ((s_cfg->flags & CLI_FLAG_ECHO_LINE) != 0u)
+    {
+        say("> %s\n", start);
+    }
+    historyPush(start);
+    (void)Cli_Execute(start);
+    resetLine();
+}
+
+static void feed(char c)
+{
+    switch (s_esc)
+    {
+    case CLI_ESC_START:
+        if (c == '[')      { s_esc = CLI_ESC_CSI; }
+        else if (c == 'O') { s_esc = CLI_ESC_SS3; }
+        else               { s_esc = CLI_ESC_NONE; }
+        return;
+
+    case CLI_ESC_CSI:
+        /* Parameter / intermediate bytes until a final byte 0x40..0x7E. */
+        if (c < 0x40 || c > 0x7E) { return; }
+        s_esc = CLI_ESC_NONE;
+        if (c == 'A') { historyRecall(true);  }
+        if (c == 'B') { historyRecall(false); }
+        return;
+
+    case CLI_ESC_SS3:
+        s_esc = CLI_ESC_NONE;
+        if (c == 'A') { historyRecall(true);  }
+        if (c == 'B') { historyRecall(false); }
+        return;
+
+    default:
+        break;
+    }
+
+    if (c == 0x1B)
+    {
+        s_esc = CLI_ESC_START;
+        return;
+    }
+
+    if (c == '\r' || c == '\n')
+    {
+        /* CRLF counts as one terminator. */
+        const bool secondHalf = (c == '\n' && s_lastTerminator == '\r');
+        s_lastTerminator = c;
+        if (!secondHalf) { endOfLine(); }
+        return;
+    }
+    s_lastTerminator = '\0';
+
+    if (c == 0x08 || c == 0x7F)
+    {
+        if (s_len > 0u)
+        {
+            --s_len;
+            echoChars("\b \b");
+        }
+        return;
+    }
+
+    if (c < 0x20 || c > 0x7E) { return; }
+
+    if (s_len < CLI_LINE_MAX - 1u)
+    {
+        s_line[s_len++] = c;
+        const char echo[2] = { c, '\0' };
+        echoChars(echo);
+    }
+    else
+    {
+        s_overflow = true;
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void Cli_Register(const CliConfig* config)
+{
+    s_cfg = config;
+    resetLine();
+    s_esc = CLI_ESC_NONE;
+    s_lastTerminator = '\0';
+    s_histCount = 0u;
+    s_histHead = 0u;
+    s_lastRow = CLI_NO_COMMAND;
+
+    if (s_cfg != NULL && s_cfg->count > 1u && !tableIsSorted())
+    {
+        say("[cli][WARN] command table not sorted — lookups will miss\n");
+    }
+}
+
+uint8_t Cli_LastCommand(void)
+{
+    return s_lastRow;
+}
+
+void Cli_Poll(void)
+{
+    if (s_cfg == NULL) { return; }
+
+    while (Serial.available() > 0)
+    {
+        const int c = Serial.read();
+        if (c < 0) { break; }
+        feed((char)c);
+    }
+}
@@ -0,0 +1,182 @@
+/**
+ * @file CommandLine.h
+ * @brief SRV Layer - Shared non-blocking Serial command line
+ *
+ * One command-line component for every lab that takes Serial commands.
+ * The USART RX interrupt of the Arduino core fills its receive ring; the
+ * CLI drains that ring without blocking from Cli_Poll(), edits the line
+ * in place and dispatches it through the command table the lab registered.
+ *
+ * Features:
+ * - Line editor: backspace, CR / LF / CRLF, over-long lines dropped
+ * - ANSI escape sequences stripped as they arrive (no post-pass)
+ * - History: the last CLI_HISTORY_DEPTH lines, recalled with arrow up/down
+ * - Tokenised once in place; binary search in a sorted PROGMEM table
+ * - Typed arguments: number (float / int) saturated to a range, keyword
+ *   from a "a|b|c" list, a number that also accepts keywords, or the raw
+ *   rest of the line
+ * - `help` / `?` rendered from the table unless the lab overrides `help`
+ *
+ * Usage:
+ *   static const CliCommand LAB_COMMANDS[] PROGMEM = {
+ *       { "led", CLI_ARG_WORD, 0.0f, 0.0f, "off|on", cmdLed, "switch the LED" },
+ *   };
+ *   static const CliConfig LAB_CLI = { LAB_COMMANDS, 1, ... };
+ *   Cli_Register(&LAB_CLI);
+ *   for (;;) { Cli_Poll(); ... }
+ *
+ * Architecture: Lab -> CommandLine -> Arduino Serial (RX ISR ring) -> UART
+ */
+
+#ifndef CommandLine_H
+#define CommandLine_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+// ============================================================================
+// Limits
+// ============================================================================
+
+/** Longest accepted line, including the terminating NUL. */
+#define CLI_LINE_MAX        48
+
+/** Number of previous lines kept for arrow-up / arrow-down recall. */
+#define CLI_HISTORY_DEPTH   4
+
+/** Tokens per line: the command name plus one argument. */
+#define CLI_MAX_TOKENS      2
+
+/** Cli_LastCommand() before any command has been dispatched. */
+#define CLI_NO_COMMAND      0xFFu
+
+// ============================================================================
+// Command table
+// ============================================================================
+
+typedef enum
+{
+    CLI_ARG_NONE  = 0,      /* command takes no argument                    */
+    CLI_ARG_FLOAT = 1,      /* number, saturated to [minVal, maxVal]        */
+    CLI_ARG_INT   = 2,      /* number truncated to an integer, saturated    */
+    CLI_ARG_WORD  = 3,      /* one keyword from `choices`                   */
+    CLI_ARG_TEXT  = 4       /* rest of the line, unparsed; `choices` is the
+                               placeholder shown by help ("<ms> <command>") */
+} CliArgType;
+
+/** Validated argument handed to a handler. For FLOAT / INT rows with a
+ *  non-empty `choices` list a keyword is accepted as well (isChoice). */
+typedef struct
+{
+    float   value;          /* FLOAT / INT: already clamped to the range    */
+    uint8_t choice;         /* keyword index into `choices`                 */
+    bool    isChoice;       /* the argument was a keyword, not a number     */
+    bool    clamped;        /* the requested number was outside the range   */
+    const char* text;       /* TEXT: rest of the line, blanks trimmed; points
+                               into the line buffer, valid until apply returns */
+} CliArg;
+
+/** Handler: returns lab-defined effect bits passed to CliConfig::apply. */
+typedef uint8_t (*CliHandler)(const CliArg* arg);
+
+/** One command row. Lives in flash, strings included. Rows must be sorted
+ *  by name (case-insensitive). */
+typedef struct
+{
+    char       name[12];
+    uint8_t    argType;         /* CliArgType                               */
+    float      minVal;
+    float      maxVal;
+    char       choices[28];     /* "a|b|c", or "" when no keywords          */
+    CliHandler handler;
+    char       help[36];
+} CliCommand;
+
+// ============================================================================
+// Registration
+// ============================================================================
+
+#define CLI_FLAG_ECHO_LINE   0x01u  /* print "> line" for every accepted line  */
+#define CLI_FLAG_ECHO_CHARS  0x02u  /* echo keystrokes (interactive terminals) */
+#define CLI_FLAG_ACK_VALUES  0x04u  /* print "name = value" after a command    */
+
+/**
+ * Per-lab registration. Every hook is optional (NULL).
+ *
+ * lockState / unlockState bracket the handler call, so a lab can apply a
+ * whole command under one acquisition of its state mutex. apply() runs
+ * after unlockState() with the handler's effect bits, for work that must
+ * not happen under the state lock. lockIo / unlockIo serialise the CLI's
+ * own output with the lab's other printers. onError() runs after an
+ * unknown command or a rejected argument.
+ */
+typedef struct
+{
+    const CliCommand* commands;     /* PROGMEM table, sorted by name        */
+    uint8_t           count;
+    uint8_t           flags;        /* CLI_FLAG_*                           */
+    const char*       bareNumber;   /* row that takes a lone number, or NULL */
+
+    bool (*lockState)(void);
+    void (*unlockState)(void);
+    bool (*lockIo)(void);
+    void (*unlockIo)(void);
+    void (*apply)(uint8_t effects, const CliArg* arg);
+    void (*onError)(void);
+} CliConfig;
+
+/**
+ * @brief Register the command table of the active lab
+ *
+ * Serial must already be open (SerialStdioInit). Replaces any previous
+ * registration and clears the line buffer and history.
+ *
+ * @param config Registration record; must outlive the CLI (static)
+ */
+void Cli_Register(const CliConfig* config);
+
+/**
+ * @brief Drain pending RX bytes and dispatch complete lines
+ *
+ * Never blocks; returns as soon as the RX ring is empty. Call it from the
+ * Arduino loop() or from a periodic task.
+ */
+void Cli_Poll(void);
+
+/**
+ * @brief Run one line as if it had been typed
+ *
+ * The line is tokenised in place. Does not echo and does not enter the
+ * history.
+ *
+ * @param line Mutable, NUL-terminated command line
+ * @return true if a command row was found and its handler ran
+ */
+bool Cli_Execute(char* line);
+
+/**
+ * @brief Table row of the most recently dispatched command
+ *
+ * Set just before the handler runs, so it is valid from inside the
+ * handler and the lab's hooks. Cheap enough for a trace record.
+ *
+ * @return Row index into the registered table, or CLI_NO_COMMAND
+ */
+uint8_t Cli_LastCommand(void);
+
+/**
+ * @brief Print the command list rendered from the registered table
+ *
+ * Takes no lock; call it with the lab's I/O lock held (e.g. from a `help`
+ * handler's deferred effect).
+ */
+void Cli_PrintCommands(void);
+
+/**
+ * @brief Render a value with up to two decimals ("25", "0.5", "1.25")
+ *
+ * avr-libc's printf has no %f; labs use this for their own replies too.
+ */
+void Cli_FormatValue(char* out, size_t outSize, float value);
+
+#endif
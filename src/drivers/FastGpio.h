@@ -0,0 +1,210 @@
+/**
+ * @file FastGpio.h
+ * @brief MCAL Layer - Direct port access for the Arduino Mega pinout
+ *
+ * digitalWrite() / digitalRead() look the pin up in three PROGMEM tables,
+ * turn off any PWM timer on it and save/restore SREG on every call, which
+ * costs 50-100 cycles for what is one bit in one register. Two faster
+ * paths are offered here:
+ *
+ * - FastPin<N>: the pin is a template argument, so port and bit are
+ *   resolved by the compiler from the table below. On ports A-G a set or
+ *   clear becomes a single SBI / CBI; on the extended ports H, J, K, L
+ *   (no SBI / CBI there) the read-modify-write is wrapped in a short
+ *   interrupt lock. Toggle writes the bit to PINx, which flips it in one
+ *   store on every port.
+ * - FastGpio: for drivers whose pin is a constructor argument. The port
+ *   is looked up once by Bind(); every access after that is a pointer
+ *   store under a short interrupt lock (a single store for Toggle).
+ *
+ * Neither path disables PWM on the pin: call pinMode() / digitalWrite()
+ * once during Init (as the drivers do) before switching to these.
+ *
+ * Usage:
+ *   typedef FastPin<13> BoardLed;
+ *   BoardLed::Output();
+ *   BoardLed::Toggle();
+ *
+ *   FastGpio io;
+ *   io.Bind(pin);
+ *   io.Set();
+ *
+ * Architecture: ECAL drivers -> FastGpio -> AVR port registers
+ */
+
+#ifndef FastGpio_H
+#define FastGpio_H
+
+#include <Arduino.h>
+#include <avr/io.h>
+
+// ============================================================================
+// Mega 2560 pin map (same order as the core's pins_arduino.h)
+// ============================================================================
+
+namespace fastgpio
+{
+
+enum Port
+{
+    PORT_A = 0, PORT_B, PORT_C, PORT_D, PORT_E, PORT_F,
+    PORT_G, PORT_H, PORT_J, PORT_K, PORT_L
+};
+
+/** One entry per Arduino pin: (Port << 3) | bit. */
+#define FASTGPIO_P(port, bit)  (uint8_t)(((port) << 3) | (bit))
+
+constexpr uint8_t kPinMap[] =
+{
+    /*  0.. 7 */ FASTGPIO_P(PORT_E, 0), FASTGPIO_P(PORT_E, 1), FASTGPIO_P(PORT_E, 4), FASTGPIO_P(PORT_E, 5),
+                 FASTGPIO_P(PORT_G, 5), FASTGPIO_P(PORT_E, 3), FASTGPIO_P(PORT_H, 3), FASTGPIO_P(PORT_H, 4),
+    /*  8..15 */ FASTGPIO_P(PORT_H, 5), FASTGPIO_P(PORT_H, 6), FASTGPIO_P(PORT_B, 4), FASTGPIO_P(PORT_B, 5),
+                 FASTGPIO_P(PORT_B, 6), FASTGPIO_P(PORT_B, 7), FASTGPIO_P(PORT_J, 1), FASTGPIO_P(PORT_J, 0),
+    /* 16..23 */ FASTGPIO_P(PORT_H, 1), FASTGPIO_P(PORT_H, 0), FASTGPIO_P(PORT_D, 3), FASTGPIO_P(PORT_D, 2),
+                 FASTGPIO_P(PORT_D, 1), FASTGPIO_P(PORT_D, 0), FASTGPIO_P(PORT_A, 0), FASTGPIO_P(PORT_A, 1),
+    /* 24..31 */ FASTGPIO_P(PORT_A, 2), FASTGPIO_P(PORT_A, 3), FASTGPIO_P(PORT_A, 4), FASTGPIO_P(PORT_A, 5),
+                 FASTGPIO_P(PORT_A, 6), FASTGPIO_P(PORT_A, 7), FASTGPIO_P(PORT_C, 7), FASTGPIO_P(PORT_C, 6),
+    /* 32..39 */ FASTGPIO_P(PORT_C, 5), FASTGPIO_P(PORT_C, 4), FASTGPIO_P(PORT_C, 3), FASTGPIO_P(PORT_C, 2),
+                 FASTGPIO_P(PORT_C, 1), FASTGPIO_P(PORT_C, 0), FASTGPIO_P(PORT_D, 7), FASTGPIO_P(PORT_G, 2),
+    /* 40..47 */ FASTGPIO_P(PORT_G, 1), FASTGPIO_P(PORT_G, 0), FASTGPIO_P(PORT_L, 7), FASTGPIO_P(PORT_L, 6),
+                 FASTGPIO_P(PORT_L, 5), FASTGPIO_P(PORT_L, 4), FASTGPIO_P(PORT_L, 3), FASTGPIO_P(PORT_L, 2),
+    /* 48..55 */ FASTGPIO_P(PORT_L, 1), FASTGPIO_P(PORT_L, 0), FASTGPIO_P(PORT_B, 3), FASTGPIO_P(PORT_B, 2),
+                 FASTGPIO_P(PORT_B, 1), FASTGPIO_P(PORT_B, 0), FASTGPIO_P(PORT_F, 0), FASTGPIO_P(PORT_F, 1),
+    /* 56..63 */ FASTGPIO_P(PORT_F, 2), FASTGPIO_P(PORT_F, 3), FASTGPIO_P(PORT_F, 4), FASTGPIO_P(PORT_F, 5),
+                 FASTGPIO_P(PORT_F, 6), FASTGPIO_P(PORT_F, 7), FASTGPIO_P(PORT_K, 0), FASTGPIO_P(PORT_K, 1),
+    /* 64..69 */ FASTGPIO_P(PORT_K, 2), FASTGPIO_P(PORT_K, 3), FASTGPIO_P(PORT_K, 4), FASTGPIO_P(PORT_K, 5),
+                 FASTGPIO_P(PORT_K, 6), FASTGPIO_P(PORT_K, 7)
+};
+
+#undef FASTGPIO_P
+
+constexpr uint8_t kPinCount = (uint8_t)(sizeof(kPinMap) / sizeof(kPinMap[0]));
+
+/** Data-space address of PINx; DDRx and PORTx follow at +1 and +2. */
+constexpr uint16_t pinRegOf(uint8_t port)
+{
+    return (port <= PORT_G) ? (uint16_t)(0x20u + 3u * port)
+                            : (uint16_t)(0x100u + 3u * (port - PORT_H));
+}
+
+/** SBI / CBI reach data addresses 0x20..0x3F only (ports A-G). */
+constexpr bool hasBitOps(uint8_t port)
+{
+    return port <= PORT_G;
+}
+
+} // namespace fastgpio
+
+// ============================================================================
+// Compile-time pin
+// ============================================================================
+
+template <uint8_t N>
+class FastPin
+{
+    static_assert(N < fastgpio::kPinCount, "FastPin: no such pin on the Mega");
+
+    static constexpr uint8_t  PORT_ID  = (uint8_t)(fastgpio::kPinMap[N] >> 3);
+    static constexpr uint16_t PIN_REG  = fastgpio::pinRegOf(PORT_ID);
+    static constexpr uint16_t DDR_REG  = (uint16_t)(PIN_REG + 1u);
+    static constexpr uint16_t OUT_REG  = (uint16_t)(PIN_REG + 2u);
+    static constexpr uint8_t  MASK     = (uint8_t)(1u << (fastgpio::kPinMap[N] & 7u));
+    static constexpr bool     BIT_OPS  = fastgpio::hasBitOps(PORT_ID);
+
+    template <uint16_t REG>
+    static inline void setBit()
+    {
+        if (BIT_OPS)
+        {
+            _SFR_MEM8(REG) |= MASK;
+        }
+        else
+        {
+            const uint8_t sreg = SREG;
+            cli();
+            _SFR_MEM8(REG) |= MASK;
+            SREG = sreg;
+        }
+    }
+
+    template <uint16_t REG>
+    static inline void clearBit()
+    {
+        if (BIT_OPS)
+        {
+            _SFR_MEM8(REG) &= (uint8_t)~MASK;
+        }
+        else
+        {
+            const uint8_t sreg = SREG;
+            cli();
+            _SFR_MEM8(REG) &= (uint8_t)~MASK;
+            SREG = sreg;
+        }
+    }
+
+public:
+    static inline void Output()      { setBit<DDR_REG>(); }
+    static inline void Input()       { clearBit<DDR_REG>(); clearBit<OUT_REG>(); }
+    static inline void InputPullup() { clearBit<DDR_REG>(); setBit<OUT_REG>(); }
+
+    static inline void High()        { setBit<OUT_REG>(); }
+    static inline void Low()         { clearBit<OUT_REG>(); }
+    static inline void Write(bool high) { if (high) { High(); } else { Low(); } }
+
+    /** Writing a one to PINx flips PORTx: one store, atomic on every port. */
+    static inline void Toggle()      { _SFR_MEM8(PIN_REG) = MASK; }
+
+    static inline bool Read()        { return (_SFR_MEM8(PIN_REG) & MASK) != 0u; }
+
+    /** Level last written to PORTx (on an input: pull-up enabled). */
+    static inline bool IsHigh()      { return (_SFR_MEM8(OUT_REG) & MASK) != 0u; }
+};
+
+// ============================================================================
+// Run-time pin
+// ============================================================================
+
+class FastGpio
+{
+public:
+    FastGpio() : pinReg(NULL), outReg(NULL), mask(0u) {}
+
+    /** Resolve the port once. Safe in static constructors (PROGMEM only). */
+    void Bind(uint8_t pin)
+    {
+        const uint8_t port = digitalPinToPort(pin);
+        pinReg = portInputRegister(port);
+        outReg = portOutputRegister(port);
+        mask   = digitalPinToBitMask(pin);
+    }
+
+    inline void Set()
+    {
+        const uint8_t sreg = SREG;
+        cli();
+        *outReg |= mask;
+        SREG = sreg;
+    }
+
+    inline void Clear()
+    {
+        const uint8_t sreg = SREG;
+        cli();
+        *outReg &= (uint8_t)~mask;
+        SREG = sreg;
+    }
+
+    inline void Write(bool high) { if (high) { Set(); } else { Clear(); } }
+
+    inline void Toggle()         { *pinReg = mask; }
+
+    inline bool Read() const     { return (*pinReg & mask) != 0u; }
+
+private:
+    volatile uint8_t* pinReg;
+    volatile uint8_t* outReg;
+    uint8_t           mask;
+};
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file FastGpioBench.cpp
+ * @brief Diagnostics - Cycle counts of the GPIO access paths (implementation)
+ */
+
+#include "FastGpioBench.h"
+#include "FastGpio.h"
+#include "../led/LedDriver.h"
+#include <avr/io.h>
+#include <stdio.h>
+
+/** Cycles spent by `stmt`, net of the two TCNT1 reads around it. */
+#define BENCH_CYCLES(out, stmt)                                  \
+    do                                                           \
+    {                                                            \
+        const uint16_t t0 = TCNT1;                               \
+        stmt;                                                    \
+        const uint16_t t1 = TCNT1;                               \
+        (out) = (uint16_t)(t1 - t0);                             \
+    } while (0)
+
+typedef struct
+{
+    uint16_t arduinoWrite;
+    uint16_t arduinoRead;
+    uint16_t driverSet;
+    uint16_t driverToggle;
+    uint16_t fastHigh;
+    uint16_t fastToggle;
+    uint16_t fastRead;
+} BenchRow;
+
+static uint16_t s_overhead = 0u;
+
+static uint16_t net(uint16_t cycles)
+{
+    return (cycles > s_overhead) ? (uint16_t)(cycles - s_overhead) : 0u;
+}
+
+/** Interrupts are off and Timer1 runs at clk/1. */
+template <uint8_t PIN>
+static void measure(BenchRow* row)
+{
+    typedef FastPin<PIN> Pin;
+
+    volatile uint8_t sink;
+    LedDriver driver(PIN);
+    const bool wasHigh = Pin::IsHigh();
+
+    BENCH_CYCLES(row->arduinoWrite, digitalWrite(PIN, HIGH));
+    BENCH_CYCLES(row->arduinoRead,  sink = (uint8_t)digitalRead(PIN));
+    BENCH_CYCLES(row->driverSet,    driver.On());
+    BENCH_CYCLES(row->driverToggle, driver.Toggle());
+    BENCH_CYCLES(row->fastHigh,     Pin::High());
+    BENCH_CYCLES(row->fastToggle,   Pin::Toggle());
+    BENCH_CYCLES(row->fastRead,     sink = (uint8_t)Pin::Read());
+    (void)sink;
+
+    Pin::Write(wasHigh);
+
+    row->arduinoWrite = net(row->arduinoWrite);
+    row->arduinoRead  = net(row->arduinoRead);
+    row->driverSet    = net(row->driverSet);
+    row->driverToggle = net(row->driverToggle);
+    row->fastHigh     = net(row->fastHigh);
+    row->fastToggle   = net(row->fastToggle);
+    row->fastRead     = net(row->fastRead);
+}
+
+static void printRow(uint8_t pin, const char* port, const BenchRow* r)
+{
+    printf("[GPIO] D%-2u %-5s %9u %8u %9u %9u %8u %8u %6u\n",
+           (unsigned)pin, port,
+           (unsigned)r->arduinoWrite, (unsigned)r->arduinoRead,
+           (unsigned)r->driverSet, (unsigned)r->driverToggle,
+           (unsigned)r->fastHigh, (unsigned)r->fastToggle, (unsigned)r->fastRead);
+}
+
+void FastGpio_RunBenchmark(void)
+{
+    BenchRow low;
+    BenchRow ext;
+
+    const uint8_t sreg = SREG;
+    cli();
+
+    const uint8_t  savedA   = TCCR1A;
+    const uint8_t  savedB   = TCCR1B;
+    const uint16_t savedCnt = TCNT1;
+    TCCR1A = 0u;
+    TCCR1B = (1 << CS10);                           /* normal mode, clk / 1 */
+
+    BENCH_CYCLES(s_overhead, (void)0);
+    measure<FASTGPIO_BENCH_PIN_LOW>(&low);
+    measure<FASTGPIO_BENCH_PIN_EXT>(&ext);
+
+    TCCR1B = 0u;
+    TCNT1  = savedCnt;
+    TCCR1A = savedA;
+    TCCR1B = savedB;
+    SREG   = sreg;
+
+    printf("[GPIO] cycles per call (TCNT1 read overhead %u removed)\n", (unsigned)s_overhead);
+    printf("[GPIO] pin port  digWrite  digRead  Drv::On  Drv::Tgl  FP::High  FP::Tgl  FP::Rd\n");
+    printRow(FASTGPIO_BENCH_PIN_LOW, "PORTB", &low);
+    printRow(FASTGPIO_BENCH_PIN_EXT, "PORTL", &ext);
+}
@@ -0,0 +1,31 @@
+/**
+ * @file FastGpioBench.h
+ * @brief Diagnostics - Cycle counts of the GPIO access paths
+ *
+ * Times digitalWrite() / digitalRead() against FastGpio and FastPin<N>
+ * on one pin of a bit-addressable port and one on an extended port, and
+ * prints a table through printf (open the serial port first).
+ *
+ * Timer1 is borrowed at clk/1, so one count is one CPU cycle. Its
+ * registers are restored afterwards; interrupts are off for the ~1 ms the
+ * run takes. Both pins are written and put back to their previous level,
+ * so keep FASTGPIO_BENCH_PIN_* off anything that reacts within
+ * microseconds.
+ *
+ * Enabled from main.cpp with FASTGPIO_BENCHMARK.
+ */
+
+#ifndef FastGpioBench_H
+#define FastGpioBench_H
+
+#include <Arduino.h>
+
+/** On-board LED, PORTB (SBI / CBI). */
+#define FASTGPIO_BENCH_PIN_LOW   13
+
+/** Unused header pin on PORTL (no SBI / CBI: locked read-modify-write). */
+#define FASTGPIO_BENCH_PIN_EXT   49
+
+void FastGpio_RunBenchmark(void);
+
+#endif
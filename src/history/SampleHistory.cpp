@@ -0,0 +1,253 @@
+/**
+ * @file SampleHistory.cpp
+ * @brief SRV Layer - Delta-compressed in-RAM time series (implementation)
+ */
+
+#include "SampleHistory.h"
+#include <util/atomic.h>
+
+// ============================================================================
+// Varint / zigzag helpers
+// ============================================================================
+
+/** Signed -> unsigned so small magnitudes of either sign stay small. */
+static uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t z)
+{
+    return (int32_t)(z >> 1) ^ -(int32_t)(z & 1u);
+}
+
+static uint8_t varintLen(uint32_t v)
+{
+    uint8_t n = 1u;
+    while (v >= 0x80u)
+    {
+        v >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+SampleHistory::SampleHistory(HistoryBlock* blockStorage, uint8_t count, uint16_t period)
+    : blocks(blockStorage),
+      blockCount(count),
+      head(0u),
+      used(0u),
+      periodMs(period),
+      lastMs(0UL),
+      last(0)
+{
+}
+
+void SampleHistory::Clear()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        head = 0u;
+        used = 0u;
+    }
+}
+
+/** Caller holds the atomic section. */
+void SampleHistory::startBlock(uint32_t nowMs, int16_t value)
+{
+    if (used > 0u)
+    {
+        head = (uint8_t)((head + 1u) % blockCount);
+    }
+    if (used < blockCount)
+    {
+        ++used;
+    }
+
+    HistoryBlock* b = &blocks[head];
+    b->startMs = nowMs;
+    b->first   = value;
+    b->samples = 1u;
+    b->used    = 0u;
+    b->zeroRun = 0u;
+}
+
+/** Append one varint if it fits with `reserve` bytes to spare. */
+bool SampleHistory::putToken(HistoryBlock* b, uint32_t token, uint8_t reserve)
+{
+    if ((uint16_t)(b->used + varintLen(token) + reserve) > HISTORY_PAYLOAD_BYTES)
+    {
+        return false;
+    }
+    while (token >= 0x80u)
+    {
+        b->payload[b->used++] = (uint8_t)(token | 0x80u);
+        token >>= 7;
+    }
+    b->payload[b->used++] = (uint8_t)token;
+    return true;
+}
+
+void SampleHistory::Append(uint32_t nowMs, int16_t value)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        const uint32_t lateMs = (uint32_t)periodMs + (periodMs / 2u);
+        HistoryBlock*  b      = &blocks[head];
+        bool           stored = false;
+
+        if (used > 0u && (nowMs - lastMs) <= lateMs)
+        {
+            const int32_t  delta    = (int32_t)value - (int32_t)last;
+            const uint32_t runToken = (b->zeroRun == 0u) ? 0UL
+                                    : (((uint32_t)b->zeroRun - 1UL) << 1) | 1UL;
+
+            if (delta == 0)
+            {
+                if (b->zeroRun < HISTORY_MAX_RUN)
+                {
+                    ++b->zeroRun;
+                    stored = true;
+                }
+                else if (putToken(b, runToken, 0u))
+                {
+                    b->zeroRun = 1u;
+                    stored = true;
+                }
+            }
+            else
+            {
+                const uint32_t token = zigzag(delta) << 1;
+                if (b->zeroRun == 0u)
+                {
+                    stored = putToken(b, token, 0u);
+                }
+                else if (putToken(b, runToken, varintLen(token)))
+                {
+                    b->zeroRun = 0u;
+                    stored = putToken(b, token, 0u);
+                }
+            }
+        }
+
+        if (stored)
+        {
+            ++b->samples;
+        }
+        else
+        {
+            /* First sample, a gap, or the block is full. */
+            startBlock(nowMs, value);
+        }
+        lastMs = nowMs;
+        last   = value;
+    }
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+uint8_t SampleHistory::BlockCount() const
+{
+    return used;
+}
+
+uint32_t SampleHistory::SampleCount() const
+{
+    uint32_t total = 0UL;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (uint8_t i = 0u; i < used; ++i)
+        {
+            total += blocks[i].samples;
+        }
+    }
+    return total;
+}
+
+uint16_t SampleHistory::PayloadBytes() const
+{
+    uint16_t total = 0u;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (uint8_t i = 0u; i < used; ++i)
+        {
+            total = (uint16_t)(total + blocks[i].used);
+        }
+    }
+    return total;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+bool SampleHistory::Open(uint8_t age, HistoryCursor* cursor) const
+{
+    bool ok = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (age < used)
+        {
+            const uint8_t idx = (uint8_t)((head + blockCount - age) % blockCount);
+            cursor->block = blocks[idx];
+            ok = true;
+        }
+    }
+    cursor->periodMs = periodMs;
+    cursor->index    = 0u;
+    cursor->pos      = 0u;
+    cursor->repeat   = 0u;
+    cursor->value    = 0;
+    return ok;
+}
+
+bool SampleHistory::Next(HistoryCursor* c, uint32_t* tMs, int16_t* value)
+{
+    const HistoryBlock* b = &c->block;
+    if (c->index >= b->samples)
+    {
+        return false;
+    }
+
+    if (c->index == 0u)
+    {
+        c->value = b->first;
+    }
+    else if (c->repeat > 0u)
+    {
+        --c->repeat;
+    }
+    else if (c->pos < b->used)
+    {
+        uint32_t token = 0UL;
+        uint8_t  shift = 0u;
+        uint8_t  byte;
+        do
+        {
+            byte   = b->payload[c->pos++];
+            token |= (uint32_t)(byte & 0x7Fu) << shift;
+            shift  = (uint8_t)(shift + 7u);
+        } while ((byte & 0x80u) != 0u && c->pos < b->used);
+
+        if ((token & 1u) != 0u)
+        {
+            c->repeat = (uint8_t)(token >> 1);  /* this sample is the run's first */
+        }
+        else
+        {
+            c->value = (int16_t)(c->value + unzigzag(token >> 1));
+        }
+    }
+    /* else: inside the block's trailing zeroRun, value repeats */
+
+    *tMs   = b->startMs + (uint32_t)c->index * c->periodMs;
+    *value = c->value;
+    ++c->index;
+    return true;
+}
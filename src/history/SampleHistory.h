@@ -0,0 +1,128 @@
+/**
+ * @file SampleHistory.h
+ * @brief SRV Layer - Delta-compressed in-RAM time series
+ *
+ * Keeps the trend of one slowly varying signal (a temperature, a level)
+ * on the device, so a lab can answer "what happened over the last hour"
+ * without a logger attached to the serial port.
+ *
+ * Samples are equally spaced integers in a unit the lab chooses (e.g.
+ * 1/16 degC for a DS18B20). They are stored as deltas in a ring of
+ * fixed-size blocks; each block starts with an absolute sample and its
+ * timestamp, so the oldest block can be dropped without touching the rest.
+ *
+ * Encoding of the payload, one varint (7 bits per byte, LSB group first)
+ * per token:
+ *   (zigzag(delta) << 1) | 0     one sample, delta != 0
+ *   ((n - 1) << 1)       | 1     n samples equal to the previous one
+ *
+ * A steady signal costs one byte per HISTORY_MAX_RUN samples, small
+ * changes one byte each. A sample that arrives more than 1.5 periods after
+ * the previous one (sensor outage) opens a new block, so gaps stay gaps.
+ *
+ * Concurrency: one writer (Append) and any number of readers (Open /
+ * Next). Append and the block copy in Open run with interrupts disabled
+ * for a few microseconds; decoding works on the reader's private copy.
+ *
+ * Usage:
+ *   static HistoryBlock  s_blocks[16];
+ *   static SampleHistory s_hist(s_blocks, 16, 1000);
+ *   s_hist.Append(millis(), (int16_t)lroundf(tempC * 16.0f));
+ *
+ *   HistoryCursor c;
+ *   for (uint8_t age = s_hist.BlockCount(); age-- > 0u; ) {
+ *       if (!s_hist.Open(age, &c)) { continue; }
+ *       uint32_t t; int16_t v;
+ *       while (SampleHistory::Next(&c, &t, &v)) { ... }
+ *   }
+ */
+
+#ifndef SampleHistory_H
+#define SampleHistory_H
+
+#include <Arduino.h>
+
+/** Size of one block in RAM, header included. */
+#define HISTORY_BLOCK_BYTES     64u
+
+/** Longest zero-delta run one token carries (fits a single varint byte). */
+#define HISTORY_MAX_RUN         64u
+
+#define HISTORY_HEADER_BYTES    10u
+#define HISTORY_PAYLOAD_BYTES   (HISTORY_BLOCK_BYTES - HISTORY_HEADER_BYTES)
+
+typedef struct
+{
+    uint32_t startMs;       /* timestamp of `first`                         */
+    int16_t  first;         /* absolute value of sample 0                   */
+    uint16_t samples;       /* samples in this block, `first` included      */
+    uint8_t  used;          /* payload bytes written                        */
+    uint8_t  zeroRun;       /* trailing repeats not yet written as a token  */
+    uint8_t  payload[HISTORY_PAYLOAD_BYTES];
+} HistoryBlock;
+
+/** Reader state: a private copy of one block plus the decode position. */
+typedef struct
+{
+    HistoryBlock block;
+    uint16_t     periodMs;
+    uint16_t     index;     /* next sample to return                        */
+    uint8_t      pos;       /* next payload byte                            */
+    uint8_t      repeat;    /* repeats left from the current run token      */
+    int16_t      value;     /* last returned value                          */
+} HistoryCursor;
+
+class SampleHistory
+{
+public:
+    /**
+     * @param blocks     Caller-owned storage (static), blockCount entries
+     * @param blockCount Ring length, 1..255
+     * @param periodMs   Nominal spacing of Append() calls
+     */
+    SampleHistory(HistoryBlock* blocks, uint8_t blockCount, uint16_t periodMs);
+
+    /** Drop everything. */
+    void Clear();
+
+    /** Add one sample taken at nowMs. Overwrites the oldest block when full. */
+    void Append(uint32_t nowMs, int16_t value);
+
+    /** Blocks holding data (0..blockCount). */
+    uint8_t BlockCount() const;
+
+    /** Samples held across all blocks. */
+    uint32_t SampleCount() const;
+
+    /** Payload bytes in use across all blocks (headers excluded). */
+    uint16_t PayloadBytes() const;
+
+    uint16_t PeriodMs() const { return periodMs; }
+
+    /**
+     * Copy one block for decoding. age 0 is the block being written,
+     * BlockCount() - 1 the oldest.
+     * @return false if age is out of range
+     */
+    bool Open(uint8_t age, HistoryCursor* cursor) const;
+
+    /**
+     * Next sample of an opened block, oldest first.
+     * @return false when the block is exhausted
+     */
+    static bool Next(HistoryCursor* cursor, uint32_t* tMs, int16_t* value);
+
+private:
+    HistoryBlock* blocks;
+    uint8_t       blockCount;
+    uint8_t       head;         /* block being written                      */
+    uint8_t       used;         /* blocks holding data                      */
+    uint16_t      periodMs;
+    uint32_t      lastMs;
+    int16_t       last;
+
+    void startBlock(uint32_t nowMs, int16_t value);
+    bool putToken(HistoryBlock* b, uint32_t token, uint8_t reserve);
+};
+
+#endif
@@ -1,49 +1,166 @@
 /**
  * @file KeypadDriver.cpp
  * @brief ECAL Layer - Keypad Driver Implementation
+ *
+ * Scan cost is paid per key edge, not per loop iteration: ~4 columns x a
+ * few microseconds inside the PCINT handler, then the CPU is free again.
  */
 
 #include "KeypadDriver.h"
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
 
 // Global keypad driver instance for scanf callback
 KeypadDriver* g_keypadDriver = nullptr;
 
 KeypadDriver::KeypadDriver(char (*userKeymap)[4], const byte* rows, const byte* cols, byte nRows, byte nCols)
-    : rowPins(rows), colPins(cols), numRows(nRows), numCols(nCols), keymap(userKeymap), lastKey(0), lastKeyTime(0)
+    : rowPins(rows), colPins(cols), numRows(nRows), numCols(nCols), keymap(userKeymap),
+      downKey(0), pending(false), lastIdleMs(0), head(0), tail(0), dropped(0)
 {
-    keypad = nullptr;
 }
 
-void KeypadDriver::Init() {
-    keypad = new Keypad(makeKeymap(keymap), rowPins, colPins, numRows, numCols);
-    g_keypadDriver = this;  // Store global reference for scanf callback
+bool KeypadDriver::Init() {
+    if (numRows > MAX_LINES || numCols > MAX_LINES) return false;
+
+    for (byte r = 0; r < numRows; r++) {
+        if (digitalPinToPCICR(rowPins[r]) == 0 ||
+            digitalPinToPCICRbit(rowPins[r]) != KEYPAD_PCINT_GROUP) {
+            return false;
+        }
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (byte r = 0; r < numRows; r++) {
+            pinMode(rowPins[r], INPUT_PULLUP);
+            *digitalPinToPCMSK(rowPins[r]) |= (byte)(1 << digitalPinToPCMSKbit(rowPins[r]));
+        }
+        for (byte c = 0; c < numCols; c++) {
+            pinMode(colPins[c], OUTPUT);
+        }
+        Park();
+
+        downKey    = 0;
+        pending    = false;
+        lastIdleMs = millis();
+        head = tail = dropped = 0;
+        g_keypadDriver = this;  // Store global reference for scanf callback and the ISR
+
+        PCIFR = (byte)(1 << KEYPAD_PCINT_GROUP);
+        PCICR |= (byte)(1 << KEYPAD_PCINT_GROUP);
+    }
+    return true;
+}
+
+/** All columns LOW: any key pulls its row down and raises the PCINT. */
+void KeypadDriver::Park() const {
+    for (byte c = 0; c < numCols; c++) {
+        digitalWrite(colPins[c], LOW);
+    }
+}
+
+/** One pass over the matrix; first key found, or 0. Leaves columns HIGH. */
+char KeypadDriver::Scan() const {
+    for (byte c = 0; c < numCols; c++) {
+        digitalWrite(colPins[c], HIGH);
+    }
+
+    char key = 0;
+    for (byte c = 0; c < numCols && key == 0; c++) {
+        digitalWrite(colPins[c], LOW);
+        delayMicroseconds(3);           // let the row pull-ups settle
+        for (byte r = 0; r < numRows; r++) {
+            if (digitalRead(rowPins[r]) == LOW) {
+                key = keymap[r][c];
+                break;
+            }
+        }
+        digitalWrite(colPins[c], HIGH);
+    }
+    return key;
+}
+
+void KeypadDriver::Push(char key) {
+    const byte next = (byte)((head + 1) & (QUEUE_LEN - 1));
+    if (next == tail) {
+        if (dropped < 0xFF) dropped++;
+        return;
+    }
+    queue[head] = key;
+    head = next;
+}
+
+void KeypadDriver::OnPinChange() {
+    const unsigned long now = millis();
+    const char key = Scan();
+    Park();
+    PCIFR = (byte)(1 << KEYPAD_PCINT_GROUP);    // edges caused by the scan itself
+
+    pending = false;
+    if (key == 0) {
+        downKey    = 0;
+        lastIdleMs = now;                       // release (or bounce): restart quiet time
+    } else if (downKey == 0 && (now - lastIdleMs) >= DEBOUNCE_DELAY) {
+        downKey = key;
+        Push(key);
+    } else if (downKey == 0) {
+        pending = true;                         // down inside the quiet window: GetKey() rescans
+    }
+    // else: still held
 }
 
 char KeypadDriver::GetKey() {
-    if (!keypad) return 0;
-    
-    char key = keypad->getKey();
-    
-    if (key) {
-        unsigned long now = millis();
-        if (key != lastKey || (now - lastKeyTime >= DEBOUNCE_DELAY)) {
-            lastKey = key;
-            lastKeyTime = now;
-            return key;
+    // The last edge of a bounce may land inside the quiet window; with the
+    // contacts settled there is no further edge, so look again once the
+    // quiet time is over.
+    if (pending && (millis() - lastIdleMs) >= DEBOUNCE_DELAY) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (pending) {
+                OnPinChange();
+            }
         }
-    } else {
-        lastKey = 0;
     }
-    
-    return 0;
+
+    if (tail == head) return 0;
+    const char key = queue[tail];
+    tail = (byte)((tail + 1) & (QUEUE_LEN - 1));
+    return key;
+}
+
+void KeypadDriver::Sleep() {
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    if (tail == head) {
+        sleep_enable();
+        sei();                          // the instruction after SEI still runs: no lost wake-up
+        sleep_cpu();
+        sleep_disable();
+    }
+    sei();
 }
 
 char KeypadDriver::GetChar() {
-    // Blocking read - waits until a key is pressed
-    char key = 0;
-    while (key == 0) {
-        key = GetKey();
-        delay(10);  // Small delay to reduce CPU usage while waiting
+    // Blocking read - sleeps between interrupts until a key is queued
+    char key;
+    while ((key = GetKey()) == 0) {
+        Sleep();
     }
     return key;
 }
+
+// ============================================================================
+// Pin-change vector
+// ============================================================================
+
+#if KEYPAD_PCINT_GROUP == 0
+ISR(PCINT0_vect)
+#elif KEYPAD_PCINT_GROUP == 1
+ISR(PCINT1_vect)
+#else
+ISR(PCINT2_vect)
+#endif
+{
+    if (g_keypadDriver != nullptr) {
+        g_keypadDriver->OnPinChange();
+    }
+}
@@ -1,39 +1,91 @@
 /**
  * @file KeypadDriver.h
- * @brief ECAL Layer - Keypad Hardware Abstraction Driver with scanf support
+ * @brief ECAL Layer - Interrupt-driven 4x4 matrix keypad driver
  *
- * Provides a high-level interface for reading a 4x4 matrix keypad.
- * Also supports scanf redirection to keypad input.
+ * Idle state: every column is an output parked LOW, every row an input
+ * with pull-up, and the rows' pin-change interrupt is armed. Nothing runs
+ * until a key shorts a row to its column; the PCINT handler then scans
+ * the matrix once (one column LOW at a time), parks the columns again and
+ * turns the result into a key event.
+ *
+ * Debounce is by timestamp, inside the handler: a press is accepted only
+ * if no key has been seen for DEBOUNCE_DELAY ms, so contact bounce on
+ * press and release is absorbed without any periodic sampling. A key
+ * found down inside that window is marked pending; since the contacts
+ * may settle without another edge, GetKey() rescans it once the quiet
+ * time has run out (Sleep() wakes on the millis() tick, so a
+ * GetKey()/Sleep() loop gets there within a millisecond).
+ *
+ * Accepted keys go into a small static ring; GetKey() pops one, GetChar()
+ * sleeps (SLEEP_MODE_IDLE) until one arrives. No heap, no Keypad library.
+ *
+ * Wiring: row pins must be pin-change capable and in the group selected
+ * by KEYPAD_PCINT_GROUP (group 2 = A8..A15, PCINT16..23). Column pins can
+ * be any GPIO. Only one KeypadDriver can be active at a time.
  *
  * Usage:
- *   KeypadDriver keypad(rowPins, colPins);
+ *   KeypadDriver keypad(keys, rowPins, colPins, 4, 4);
  *   keypad.Init();
- *   char key = keypad.GetKey();
- *   scanf("%s", buffer);  // When stdin is redirected
+ *   char key = keypad.GetKey();     // 0 when nothing is queued
+ *   keypad.Sleep();                 // idle until the next interrupt
  */
 
 #ifndef KEYPADDRIVER_H
 #define KEYPADDRIVER_H
 
 #include <Arduino.h>
-#include <Keypad.h>
+
+/** PCINT vector owned by the driver: 0 = PORTB, 1 = PE0/PORTJ, 2 = PORTK. */
+#ifndef KEYPAD_PCINT_GROUP
+#define KEYPAD_PCINT_GROUP  2
+#endif
 
 class KeypadDriver {
 private:
-    Keypad* keypad;
     const byte* rowPins;
     const byte* colPins;
     byte numRows;
     byte numCols;
     char (*keymap)[4];
-    char lastKey;
-    unsigned long lastKeyTime;
+
+    /* --- PCINT handler state -------------------------------------------- */
+    volatile char          downKey;       // key accepted and not yet released
+    volatile bool          pending;       // key seen inside the quiet window
+    volatile unsigned long lastIdleMs;    // last time a scan found no key
+
+    static const byte QUEUE_LEN = 8;      // power of two
+    char          queue[QUEUE_LEN];
+    volatile byte head;                   // written by the handler
+    volatile byte tail;                   // written by GetKey()
+    volatile byte dropped;
+
     static const unsigned long DEBOUNCE_DELAY = 20;
+    static const byte MAX_LINES = 4;
+
+    char Scan() const;
+    void Park() const;
+    void Push(char key);
+
 public:
     KeypadDriver(char (*userKeymap)[4], const byte* rows, const byte* cols, byte nRows, byte nCols);
-    void Init();
+
+    /** @return false if a row pin is not in KEYPAD_PCINT_GROUP */
+    bool Init();
+
+    /** Oldest queued key, or 0. Never blocks; rescans a pending press. */
     char GetKey();
-    char GetChar();  // For scanf redirection - blocks until key is available
+
+    /** Blocking read for scanf redirection: sleeps until a key is queued. */
+    char GetChar();
+
+    /** Enter SLEEP_MODE_IDLE unless a key is queued; any interrupt wakes. */
+    void Sleep();
+
+    /** Keys lost to a full queue since Init. */
+    byte Dropped() const { return dropped; }
+
+    /** PCINT context, or GetKey() with interrupts disabled. */
+    void OnPinChange();
 };
 
 // Global keypad driver instance for scanf callback
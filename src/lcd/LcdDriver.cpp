@@ -1,50 +1,204 @@
 /**
  * @file LcdDriver.cpp
  * @brief ECAL Layer - LCD Driver Implementation
+ *
+ * Step() does one of three things per interrupt: send a "set DDRAM
+ * address" command when the next dirty cell is not where the controller's
+ * address counter points, send that cell's character (the counter then
+ * advances by itself, so runs of dirty cells need no addressing), or
+ * switch the interrupt off when every cell matches.
  */
 
 #include "LcdDriver.h"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <string.h>
 
 // Global LCD driver instance for printf callback
 LcdDriver* g_lcdDriver = nullptr;
 
+#define LCD_CELLS           (LCD_ROWS * LCD_COLS)
+#define LCD_CMD_CLEAR       0x01u
+#define LCD_CMD_ENTRY_INC   0x06u       // increment, no shift
+#define LCD_CMD_DISPLAY_ON  0x0Cu       // display on, cursor off, blink off
+#define LCD_CMD_FUNC_4BIT   0x28u       // 4-bit, 2 lines, 5x8
+#define LCD_CMD_DDRAM       0x80u
+#define LCD_ROW1_ADDR       0x40u
+
+/** Timer1 at clk/8: 2 ticks per microsecond at 16 MHz. */
+#define LCD_STEP_TICKS      ((uint16_t)((F_CPU / 8UL / 1000000UL) * LCD_STEP_US))
+
 LcdDriver::LcdDriver(uint8_t rs, uint8_t en, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7)
-    : rs(rs), en(en), d4(d4), d5(d5), d6(d6), d7(d7), bufferIndex(0), lastUpdateTime(0)
+    : rs(rs), en(en), d4(d4), d5(d5), d6(d6), d7(d7), bufferIndex(0), lastUpdateTime(0),
+      scanPos(0), ddramCell(0xFF), cursorCell(0), pumping(false)
 {
-    lcd = nullptr;
     memset(printBuffer, 0, sizeof(printBuffer));
 }
 
+// ============================================================================
+// Bus
+// ============================================================================
+
+void LcdDriver::WriteNibble(uint8_t nibble) {
+    pinData[0].Write(nibble & 0x01);
+    pinData[1].Write(nibble & 0x02);
+    pinData[2].Write(nibble & 0x04);
+    pinData[3].Write(nibble & 0x08);
+    pinEn.Set();
+    __asm__ __volatile__("nop\n\tnop\n\tnop\n\tnop\n\tnop\n\tnop\n\tnop\n\tnop");  // E high >= 450 ns
+    pinEn.Clear();                                  // latched on the falling edge
+}
+
+void LcdDriver::WriteByte(uint8_t value, bool isData) {
+    pinRs.Write(isData);
+    WriteNibble(value >> 4);
+    WriteNibble(value & 0x0F);
+}
+
+// ============================================================================
+// Setup (blocking, once)
+// ============================================================================
+
 void LcdDriver::Init() {
-    lcd = new LiquidCrystal(rs, en, d4, d5, d6, d7);
-    lcd->begin(16, 2);
-    g_lcdDriver = this;  // Store global reference for printf callback
+    const uint8_t dataPins[4] = { d4, d5, d6, d7 };
+
+    pinMode(rs, OUTPUT);
+    pinMode(en, OUTPUT);
+    digitalWrite(rs, LOW);
+    digitalWrite(en, LOW);
+    pinRs.Bind(rs);
+    pinEn.Bind(en);
+    for (uint8_t i = 0; i < 4; i++) {
+        pinMode(dataPins[i], OUTPUT);
+        digitalWrite(dataPins[i], LOW);
+        pinData[i].Bind(dataPins[i]);
+    }
+
+    // HD44780 "initialisation by instruction" into 4-bit mode
+    delay(50);
+    pinRs.Clear();
+    WriteNibble(0x03); delayMicroseconds(4500);
+    WriteNibble(0x03); delayMicroseconds(4500);
+    WriteNibble(0x03); delayMicroseconds(150);
+    WriteNibble(0x02); delayMicroseconds(150);
+    WriteByte(LCD_CMD_FUNC_4BIT,  false); delayMicroseconds(LCD_STEP_US);
+    WriteByte(LCD_CMD_DISPLAY_ON, false); delayMicroseconds(LCD_STEP_US);
+    WriteByte(LCD_CMD_ENTRY_INC,  false); delayMicroseconds(LCD_STEP_US);
+    WriteByte(LCD_CMD_CLEAR,      false); delay(2);
+
+    memset((void*)shadow, ' ', sizeof(shadow));
+    memset(glass, ' ', sizeof(glass));
+    ddramCell  = 0;                 // clear homes the address counter
+    scanPos    = 0;
+    cursorCell = 0;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR1A = 0;
+        TCCR1B = (1 << CS11);       // normal mode, clk / 8
+        TIMSK1 &= (uint8_t)~(1 << OCIE1B);
+        pumping = false;
+    }
+
+    g_lcdDriver = this;  // Store global reference for printf callback and the ISR
+}
+
+// ============================================================================
+// Shadow buffer (never blocks)
+// ============================================================================
+
+/** Make sure the compare-B interrupt is pumping. */
+void LcdDriver::Kick() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!pumping) {
+            OCR1B   = (uint16_t)(TCNT1 + LCD_STEP_TICKS);
+            TIFR1   = (1 << OCF1B);
+            TIMSK1 |= (1 << OCIE1B);
+            pumping = true;
+        }
+    }
 }
 
 void LcdDriver::Print(const char* l1, const char* l2) {
-    lcd->clear();
-    delay(2);  // HD44780 clear takes ~1.52ms; wait before writing or first chars are lost
-    lcd->setCursor(0, 0);
-    lcd->print(l1);
-    if (l2 && l2[0] != '\0') {
-        lcd->setCursor(0, 1);
-        lcd->print(l2);
+    for (uint8_t row = 0; row < LCD_ROWS; row++) {
+        const char* src = (row == 0) ? l1 : l2;
+        bool ended = (src == nullptr);
+        for (uint8_t col = 0; col < LCD_COLS; col++) {
+            if (!ended && src[col] == '\0') ended = true;
+            shadow[row * LCD_COLS + col] = ended ? ' ' : src[col];
+        }
     }
+    cursorCell = 0;
     bufferIndex = 0;
     memset(printBuffer, 0, sizeof(printBuffer));
+    Kick();
 }
 
 void LcdDriver::Clear() {
-    lcd->clear();
+    memset((void*)shadow, ' ', sizeof(shadow));
+    cursorCell = 0;
     bufferIndex = 0;
     memset(printBuffer, 0, sizeof(printBuffer));
+    Kick();
 }
 
 void LcdDriver::SetCursor(uint8_t col, uint8_t row) {
-    lcd->setCursor(col, row);
+    if (col >= LCD_COLS) col = LCD_COLS - 1;
+    if (row >= LCD_ROWS) row = LCD_ROWS - 1;
+    cursorCell = (uint8_t)(row * LCD_COLS + col);
 }
 
+void LcdDriver::Write(const char* text) {
+    const uint8_t rowEnd = (uint8_t)((cursorCell / LCD_COLS + 1) * LCD_COLS);
+    while (*text != '\0' && cursorCell < rowEnd) {
+        shadow[cursorCell++] = *text++;
+    }
+    if (cursorCell >= LCD_CELLS) cursorCell = LCD_CELLS - 1;
+    Kick();
+}
+
+// ============================================================================
+// Pump (Timer1 compare B)
+// ============================================================================
+
+void LcdDriver::Step() {
+    for (uint8_t n = 0; n < LCD_CELLS; n++) {
+        const uint8_t cell = scanPos;
+        const char    want = shadow[cell];
+        if (want != glass[cell]) {
+            if (ddramCell != cell) {
+                const uint8_t addr = (uint8_t)((cell >= LCD_COLS ? LCD_ROW1_ADDR : 0u) + cell % LCD_COLS);
+                WriteByte((uint8_t)(LCD_CMD_DDRAM | addr), false);
+                ddramCell = cell;
+                return;                     // the character goes out next step
+            }
+            WriteByte((uint8_t)want, true);
+            glass[cell] = want;
+            // The address counter runs 0x0F -> 0x10, not to row 1.
+            ddramCell = ((cell + 1) % LCD_COLS == 0) ? 0xFF : (uint8_t)(cell + 1);
+            scanPos   = (uint8_t)((cell + 1) % LCD_CELLS);
+            return;
+        }
+        scanPos = (uint8_t)((cell + 1) % LCD_CELLS);
+    }
+
+    TIMSK1 &= (uint8_t)~(1 << OCIE1B);  // glass == shadow: stop until the next Kick()
+    pumping = false;
+}
+
+#if defined(OCIE1B)
+ISR(TIMER1_COMPB_vect)
+{
+    OCR1B += LCD_STEP_TICKS;
+    if (g_lcdDriver != nullptr) {
+        g_lcdDriver->Step();
+    }
+}
+#endif
+
+// ============================================================================
+// printf support
+// ============================================================================
+
 int LcdDriver::PutChar(char c) {
     // Handle newline: add to buffer then flush so we can split on \n for correct line breaks
     if (c == '\r' || c == '\n') {
@@ -55,27 +209,27 @@ int LcdDriver::PutChar(char c) {
         FlushPrintBuffer();
         return 0;
     }
-    
+
     // Add character to buffer
     if (bufferIndex < sizeof(printBuffer) - 1) {
         printBuffer[bufferIndex++] = c;
         printBuffer[bufferIndex] = '\0';
-        
+
         // Flush when buffer fills (would truncate otherwise)
         if (bufferIndex >= sizeof(printBuffer) - 1) {
             FlushPrintBuffer();
         }
     }
-    
+
     return 0;
 }
 
 void LcdDriver::FlushPrintBuffer() {
     if (bufferIndex == 0) return;
-    
+
     char line1[17] = {0};
     char line2[17] = {0};
-    
+
     // Try to split on newline first (so "line1\nline2" displays correctly)
     char* nl = (char*)memchr(printBuffer, '\n', bufferIndex);
     if (nl) {
@@ -99,7 +253,7 @@ void LcdDriver::FlushPrintBuffer() {
             strncpy(line2, printBuffer + 16, 16);
         }
     }
-    
+
     Print(line1, line2);
     lastUpdateTime = millis();
     bufferIndex = 0;
@@ -1,10 +1,25 @@
 /**
  * @file LcdDriver.h
- * @brief ECAL Layer - LCD Hardware Abstraction Driver with printf support
+ * @brief ECAL Layer - HD44780 16x2 LCD driver (4-bit, direct port, timer paced)
  *
  * Provides a high-level interface for controlling a 16x2 LCD.
  * Also supports printf redirection to LCD display.
  *
+ * Nothing here waits on the display. Print / Clear / Write only change a
+ * 32-byte shadow buffer; a Timer1 compare-B interrupt then sends one byte
+ * (a DDRAM address or a character) every LCD_STEP_US, and only for cells
+ * that differ from what is already on the glass. A full redraw is ~34
+ * interrupts of a few microseconds each instead of the ~3 ms of blocking
+ * digitalWrite() / delayMicroseconds() that LiquidCrystal spends on it,
+ * and an unchanged screen costs nothing.
+ *
+ * The R/W line is not wired (tied to GND), so the busy flag cannot be
+ * read: the step period is the datasheet's worst-case execution time.
+ * Clear() writes spaces instead of issuing the 1.5 ms clear command.
+ *
+ * Hardware: Timer1 runs free at clk/8 and the work is done in
+ * TIMER1_COMPB_vect; not usable together with Lab 2's Timer1 scheduler.
+ *
  * Usage:
  *   LcdDriver lcd(rs, en, d4, d5, d6, d7);
  *   lcd.Init();
@@ -16,24 +31,51 @@
 #define LCDDRIVER_H
 
 #include <Arduino.h>
-#include <LiquidCrystal.h>
+#include "../drivers/FastGpio.h"
+
+#define LCD_COLS        16
+#define LCD_ROWS        2
+
+/** Per-byte pacing: HD44780 needs 37 us (+10 % oscillator tolerance). */
+#define LCD_STEP_US     50u
 
 class LcdDriver {
 private:
-    LiquidCrystal* lcd;
     uint8_t rs, en, d4, d5, d6, d7;
+    FastGpio pinRs, pinEn, pinData[4];
+
     char printBuffer[33];  // Buffer for printf output (32 chars + null terminator)
     uint8_t bufferIndex;
     unsigned long lastUpdateTime;
     static const unsigned long UPDATE_INTERVAL = 500;  // Update display every 500ms during printing
+
+    /* --- Shadow / glass: app writes `shadow`, the ISR owns the rest ------ */
+    volatile char shadow[LCD_ROWS * LCD_COLS];
+    char          glass[LCD_ROWS * LCD_COLS];   // what the controller shows
+    uint8_t       scanPos;                      // next cell the ISR looks at
+    uint8_t       ddramCell;                    // cell the address counter points to, 0xFF = unknown
+    uint8_t       cursorCell;                   // app cursor for Write()
+    volatile bool pumping;                      // compare-B interrupt enabled
+
+    void WriteNibble(uint8_t nibble);
+    void WriteByte(uint8_t value, bool isData);
+    void Kick();
+
 public:
     LcdDriver(uint8_t rs, uint8_t en, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7);
     void Init();
     void Print(const char* l1, const char* l2 = "");
     void Clear();
     void SetCursor(uint8_t col, uint8_t row);
+    void Write(const char* text);   // at the cursor, clipped to the row
     int PutChar(char c);  // For printf redirection
     void FlushPrintBuffer();  // Display accumulated printf output
+
+    /** true once the glass matches the shadow buffer. */
+    bool IsIdle() const { return !pumping; }
+
+    /** Timer1 compare-B context only: send at most one byte. */
+    void Step();
 };
 
 // Global LCD driver instance for printf callback
@@ -3,7 +3,8 @@
  * @brief ECAL Layer - LED Driver Implementation
  * 
  * Implements the LED hardware abstraction driver.
- * Uses Arduino MCAL (digitalWrite, pinMode, digitalRead) to control GPIO.
+ * Init goes through Arduino MCAL (pinMode, digitalWrite); On/Off/Toggle
+ * use the cached port register (FastGpio).
  * 
  * Architecture: Lab -> LedDriver -> GPIO MCAL -> Arduino GPIO Hardware
  */
@@ -11,11 +12,12 @@
 #include "LedDriver.h"
 
 /**
- * @brief Constructor - Store the GPIO pin number
+ * @brief Constructor - Store the GPIO pin number and resolve its port
  */
 LedDriver::LedDriver(uint8_t pin)
 {
     ledPin = pin;
+    io.Bind(pin);
 }
 
 /**
@@ -32,30 +34,30 @@ void LedDriver::Init()
 /**
  * @brief Turn LED ON (set pin HIGH)
  * 
- * Uses MCAL: digitalWrite()
+ * Single bit set on the cached port register
  */
 void LedDriver::On()
 {
-    digitalWrite(ledPin, HIGH);    // MCAL: Set high (LED on)
+    io.Set();
 }
 
 /**
  * @brief Turn LED OFF (set pin LOW)
  * 
- * Uses MCAL: digitalWrite()
+ * Single bit clear on the cached port register
  */
 void LedDriver::Off()
 {
-    digitalWrite(ledPin, LOW);     // MCAL: Set low (LED off)
+    io.Clear();
 }
 
 /**
  * @brief Toggle LED state
  * 
- * Reads current pin state and inverts it.
- * Uses MCAL: digitalWrite() and digitalRead()
+ * Writes the bit to PINx, which flips the output in one store
+ * (no read-modify-write, so it cannot race an ISR on the same port).
  */
 void LedDriver::Toggle()
 {
-    digitalWrite(ledPin, !digitalRead(ledPin));  // MCAL: Toggle pin
+    io.Toggle();
 }
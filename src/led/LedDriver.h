@@ -6,7 +6,9 @@
  * a GPIO pin on the Arduino microcontroller.
  * 
  * This driver abstracts away direct Arduino digitalWrite/pinMode calls,
- * allowing labs to control LEDs without knowing pin details.
+ * allowing labs to control LEDs without knowing pin details. The port is
+ * resolved once in the constructor (FastGpio), so On/Off/Toggle are a few
+ * cycles each instead of a digitalWrite() table walk.
  * 
  * Usage:
  *   LedDriver led(13);  // LED on pin 13
@@ -20,18 +22,20 @@
 #define LedDriver_H
 
 #include <Arduino.h>
+#include "../drivers/FastGpio.h"
 
 /**
  * @class LedDriver
  * @brief Digital output driver for controlling an LED
  * 
- * Wraps Arduino GPIO functions (digitalWrite, pinMode, digitalRead)
- * to provide a clean interface for LED control.
+ * Init uses Arduino pinMode/digitalWrite (which also detaches PWM);
+ * switching afterwards goes straight to the port register.
  */
 class LedDriver
 {
 private:
-    uint8_t ledPin;  // GPIO pin number for this LED
+    uint8_t  ledPin;  // GPIO pin number for this LED
+    FastGpio io;      // Port/mask of ledPin, resolved once
 
 public:
     /**
@@ -59,6 +63,11 @@ public:
      * @brief Toggle LED state (ON->OFF or OFF->ON)
      */
     void Toggle();
+
+    /**
+     * @brief GPIO pin number (for services that drive the pin directly)
+     */
+    uint8_t Pin() const { return ledPin; }
 };
 
 #endif
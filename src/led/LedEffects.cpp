@@ -0,0 +1,276 @@
+/**
+ * @file LedEffects.cpp
+ * @brief SRV Layer - Timer-driven LED patterns (implementation)
+ *
+ * Tasks only write a slot's pattern fields inside ATOMIC_BLOCK; the
+ * Timer4 compare-B interrupt owns the phase counters and the pin. Each
+ * tick costs a few cycles per attached LED: advance the phase once per
+ * millisecond, compare the PWM counter with the brightness, and touch
+ * the port only when the output changes.
+ */
+
+#include "LedEffects.h"
+#include <Arduino.h>
+#include <util/atomic.h>
+
+// ============================================================================
+// State
+// ============================================================================
+
+typedef enum
+{
+    LEDFX_MODE_OFF = 0,
+    LEDFX_MODE_ON,
+    LEDFX_MODE_BLINK,
+    LEDFX_MODE_PULSE
+} LedFxMode;
+
+typedef struct
+{
+    volatile uint8_t* port;
+    uint8_t  mask;
+
+    /* pattern: written by tasks under ATOMIC_BLOCK */
+    uint8_t  mode;          /* LedFxMode                                    */
+    uint8_t  level;         /* lit PWM steps, 0..LEDFX_PWM_LEVELS           */
+    uint16_t onMs;
+    uint16_t offMs;
+    uint8_t  pulsesLeft;
+
+    /* playback: ISR */
+    uint16_t phaseLeftMs;
+    bool     phaseLit;
+    bool     out;
+} LedFxSlot;
+
+static LedFxSlot         s_slots[LEDFX_MAX_LEDS];
+static volatile uint8_t  s_slotCount = 0u;
+static uint8_t           s_pwmStep = 0u;
+static bool              s_running = false;
+
+// ============================================================================
+// Timer4 tick
+// ============================================================================
+
+#if defined(OCIE4B)
+
+ISR(TIMER4_COMPB_vect)
+{
+    s_pwmStep = (uint8_t)((s_pwmStep + 1u) & (LEDFX_PWM_LEVELS - 1u));
+    const bool msTick = ((s_pwmStep & 1u) == 0u);
+
+    for (uint8_t i = 0u; i < s_slotCount; ++i)
+    {
+        LedFxSlot* s = &s_slots[i];
+
+        if (msTick && (s->mode == LEDFX_MODE_BLINK || s->mode == LEDFX_MODE_PULSE))
+        {
+            if (--s->phaseLeftMs == 0u)
+            {
+                if (s->phaseLit)
+                {
+                    s->phaseLit    = false;
+                    s->phaseLeftMs = s->offMs;
+                    if (s->mode == LEDFX_MODE_PULSE && --s->pulsesLeft == 0u)
+                    {
+                        s->mode = LEDFX_MODE_OFF;
+                    }
+                }
+                else
+                {
+                    s->phaseLit    = true;
+                    s->phaseLeftMs = s->onMs;
+                }
+            }
+        }
+
+        const bool patternLit = (s->mode == LEDFX_MODE_ON) ||
+                                ((s->mode != LEDFX_MODE_OFF) && s->phaseLit);
+        const bool lit = patternLit && (s_pwmStep < s->level);
+        if (lit != s->out)
+        {
+            if (lit) { *s->port |= s->mask; }
+            else     { *s->port &= (uint8_t)~s->mask; }
+            s->out = lit;
+        }
+    }
+}
+
+#endif
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static LedFxSlot* slotOf(LedFxHandle h)
+{
+    return (h < s_slotCount) ? &s_slots[h] : NULL;
+}
+
+/** Caller holds ATOMIC_BLOCK. Starts with the lit phase. */
+static void startPhases(LedFxSlot* s, uint8_t mode, uint16_t onMs, uint16_t offMs)
+{
+    s->mode        = mode;
+    s->onMs        = (onMs  == 0u) ? 1u : onMs;
+    s->offMs       = (offMs == 0u) ? 1u : offMs;
+    s->phaseLit    = true;
+    s->phaseLeftMs = s->onMs;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool LedFx_Init(void)
+{
+#if defined(OCIE4B)
+    if (s_running) { return true; }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        TCCR4A = 0u;
+        TCCR4B = (1 << WGM42) | (1 << CS41);            /* CTC, clk / 8 */
+        OCR4A  = (uint16_t)((F_CPU / 8UL / LEDFX_TICK_HZ) - 1UL);
+        OCR4B  = 0u;
+        TCNT4  = 0u;
+        TIFR4  = (1 << OCF4B);
+        TIMSK4 |= (1 << OCIE4B);
+    }
+    s_running = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+LedFxHandle LedFx_AttachPin(uint8_t pin)
+{
+    if (!s_running || s_slotCount >= LEDFX_MAX_LEDS) { return LEDFX_NONE; }
+
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+
+    LedFxSlot* s = &s_slots[s_slotCount];
+    s->port        = portOutputRegister(digitalPinToPort(pin));
+    s->mask        = digitalPinToBitMask(pin);
+    s->mode        = LEDFX_MODE_OFF;
+    s->level       = LEDFX_PWM_LEVELS;
+    s->onMs        = 1u;
+    s->offMs       = 1u;
+    s->pulsesLeft  = 0u;
+    s->phaseLeftMs = 1u;
+    s->phaseLit    = false;
+    s->out         = false;
+
+    /* Publish the slot only once it is complete. */
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        s_slotCount = (uint8_t)(s_slotCount + 1u);
+    }
+    return (LedFxHandle)(s_slotCount - 1u);
+}
+
+void LedFx_Off(LedFxHandle h)
+{
+    LedFxSlot* s = slotOf(h);
+    if (s == NULL) { return; }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { s->mode = LEDFX_MODE_OFF; }
+}
+
+void LedFx_On(LedFxHandle h)
+{
+    LedFxSlot* s = slotOf(h);
+    if (s == NULL) { return; }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { s->mode = LEDFX_MODE_ON; }
+}
+
+void LedFx_Blink(LedFxHandle h, uint16_t onMs, uint16_t offMs)
+{
+    LedFxSlot* s = slotOf(h);
+    if (s == NULL) { return; }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        const bool same = (s->mode == LEDFX_MODE_BLINK) &&
+                          (s->onMs == onMs) && (s->offMs == offMs);
+        if (!same)
+        {
+            startPhases(s, LEDFX_MODE_BLINK, onMs, offMs);
+        }
+    }
+}
+
+void LedFx_Pulse(LedFxHandle h, uint8_t count, uint16_t onMs, uint16_t offMs)
+{
+    LedFxSlot* s = slotOf(h);
+    if (s == NULL) { return; }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (count == 0u)
+        {
+            s->mode = LEDFX_MODE_OFF;
+        }
+        else
+        {
+            startPhases(s, LEDFX_MODE_PULSE, onMs, offMs);
+            s->pulsesLeft = count;
+        }
+    }
+}
+
+void LedFx_PulseMore(LedFxHandle h, uint8_t count, uint16_t onMs, uint16_t offMs,
+                     uint8_t maxCount)
+{
+    LedFxSlot* s = slotOf(h);
+    if (s == NULL || count == 0u) { return; }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        const bool same = (s->mode == LEDFX_MODE_PULSE) &&
+                          (s->onMs == onMs) && (s->offMs == offMs);
+        uint16_t total = count;
+        if (same)
+        {
+            total = (uint16_t)(total + s->pulsesLeft);
+        }
+        else
+        {
+            startPhases(s, LEDFX_MODE_PULSE, onMs, offMs);
+        }
+        s->pulsesLeft = (total > maxCount) ? maxCount : (uint8_t)total;
+        if (s->pulsesLeft == 0u) { s->mode = LEDFX_MODE_OFF; }
+    }
+}
+
+void LedFx_SetBrightness(LedFxHandle h, uint8_t brightness)
+{
+    LedFxSlot* s = slotOf(h);
+    if (s == NULL) { return; }
+    /* 0..255 -> 0..LEDFX_PWM_LEVELS, rounded; a single byte store. */
+    s->level = (uint8_t)(((uint16_t)brightness * LEDFX_PWM_LEVELS + 127u) / 255u);
+}
+
+bool LedFx_IsPulsing(LedFxHandle h)
+{
+    LedFxSlot* s = slotOf(h);
+    return (s != NULL) && (s->mode == LEDFX_MODE_PULSE);
+}
+
+uint32_t LedFx_PulseMsLeft(LedFxHandle h)
+{
+    LedFxSlot* s = slotOf(h);
+    if (s == NULL) { return 0u; }
+
+    uint32_t left = 0u;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (s->mode == LEDFX_MODE_PULSE)
+        {
+            /* pulsesLeft counts the blink playing until its lit phase ends;
+             * the sequence ends with the last lit phase. */
+            const uint32_t cycle = (uint32_t)s->onMs + s->offMs;
+            left = s->phaseLeftMs;
+            if (s->phaseLit) { left += (uint32_t)(s->pulsesLeft - 1u) * cycle; }
+            else             { left += (uint32_t)s->pulsesLeft * cycle - s->offMs; }
+        }
+    }
+    return left;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file LedEffects.h
+ * @brief SRV Layer - Timer-driven LED patterns on top of LedDriver
+ *
+ * Labs used to blink LEDs from their own tasks (toggle counters, "last
+ * blink tick" bookkeeping, delay loops), waking up just to flip a pin.
+ * This service gives every attached LED a pattern that a single Timer4
+ * interrupt plays back; a task sets the pattern once and goes back to
+ * sleep.
+ *
+ * Patterns:
+ * - Off / On
+ * - Blink: onMs lit, offMs dark, forever
+ * - Pulse: N blinks, then off
+ * - Brightness: 0..255, applied to every lit phase by software PWM
+ *   (LEDFX_PWM_LEVELS steps at LEDFX_TICK_HZ / LEDFX_PWM_LEVELS Hz)
+ *
+ * Re-setting the On / Off / Blink pattern that is already playing is a
+ * no-op, so a task can re-assert it every cycle without restarting the
+ * blink phase. Pulse always starts a fresh sequence; PulseMore adds blinks
+ * to one of the same shape that is still playing.
+ *
+ * Hardware: Timer4 runs in CTC mode at LEDFX_TICK_HZ and the work is done
+ * in TIMER4_COMPB_vect (the Servo library owns the COMPA vectors).
+ * analogWrite() on D6 / D7 / D8 is unavailable once LedFx_Init() ran.
+ * Boards without Timer4 get no effects: LedFx_Attach() returns
+ * LEDFX_NONE and callers drive the LED directly.
+ *
+ * The header is C-compatible so the pure-C Lab 2.2 tasks can use it:
+ * they attach by pin number, C++ callers may hand over a LedDriver.
+ *
+ * Usage:
+ *   static LedDriver s_led(13);
+ *   LedFx_Init();
+ *   const LedFxHandle h = LedFx_Attach(s_led);     // or LedFx_AttachPin(13)
+ *   LedFx_Blink(h, 300, 300);
+ *
+ * Architecture: Lab -> LedEffects -> LedDriver (pin) / Timer4 ISR -> GPIO
+ */
+
+#ifndef LedEffects_H
+#define LedEffects_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+#include "LedDriver.h"
+extern "C" {
+#endif
+
+/** LEDs the service can drive at the same time. */
+#define LEDFX_MAX_LEDS      6
+
+/** Interrupt rate. Pattern timing advances every other tick (1 ms). */
+#define LEDFX_TICK_HZ       2000u
+
+/** Software-PWM steps per period: 2000 / 16 = 125 Hz, flicker-free. */
+#define LEDFX_PWM_LEVELS    16u
+
+/** Returned by LedFx_Attach when no slot (or no Timer4) is available. */
+#define LEDFX_NONE          0xFFu
+
+typedef uint8_t LedFxHandle;
+
+/**
+ * @brief Start the Timer4 tick. Idempotent.
+ * @return false on a board without Timer4
+ */
+bool LedFx_Init(void);
+
+/**
+ * @brief Hand an LED over to the service (pin made an output, LED off)
+ *
+ * From then on drive the LED through LedFx_* only.
+ *
+ * @return Handle for the calls below, or LEDFX_NONE
+ */
+LedFxHandle LedFx_AttachPin(uint8_t pin);
+
+void LedFx_Off(LedFxHandle h);
+void LedFx_On(LedFxHandle h);
+
+/** Blink forever: onMs lit, offMs dark (each at least 1 ms). */
+void LedFx_Blink(LedFxHandle h, uint16_t onMs, uint16_t offMs);
+
+/** `count` blinks starting with the lit phase, then off. */
+void LedFx_Pulse(LedFxHandle h, uint8_t count, uint16_t onMs, uint16_t offMs);
+
+/** As Pulse, but a Pulse of the same shape that is still playing gets
+ *  `count` more blinks instead of restarting; at most `maxCount` are left. */
+void LedFx_PulseMore(LedFxHandle h, uint8_t count, uint16_t onMs, uint16_t offMs,
+                     uint8_t maxCount);
+
+/** Brightness of the lit phases, 0 (dark) .. 255 (full, the default). */
+void LedFx_SetBrightness(LedFxHandle h, uint8_t brightness);
+
+/** @return true while a Pulse pattern still has blinks to play */
+bool LedFx_IsPulsing(LedFxHandle h);
+
+/** @return ms until a Pulse pattern ends (0 when none is playing) */
+uint32_t LedFx_PulseMsLeft(LedFxHandle h);
+
+#ifdef __cplusplus
+}
+
+/**
+ * @brief Hand a LedDriver over to the service (see LedFx_AttachPin)
+ *
+ * LedDriver::On / Off would be overwritten on the next tick.
+ */
+inline LedFxHandle LedFx_Attach(LedDriver& led) { return LedFx_AttachPin(led.Pin()); }
+#endif
+
+#endif
@@ -14,6 +14,8 @@
 #include <util/delay.h>
 #include <stdio.h>
 #include "drivers/SerialStdioDriver.h"
+#include "drivers/FastGpio.h"
+#include "drivers/FastGpioBench.h"
 
 // ============================================================================
 // CONFIGURATION – change this value to select a lab
@@ -22,11 +24,16 @@
 //   3  = Lab 3     32 = Lab 3.2   41 = Lab 4.1   42 = Lab 4.2
 //   52 = Lab 5.2 (DS18B20 + L9110H fan, ON-OFF + PID combined)
 //   7  = Lab 7 (Button-LED FSM)   72 = Lab 7.2 (Traffic Light FSM)
+//   99 = SRV microbenchmarks (cycle counts as CSV on Serial, 115200)
 //
 // Note: standalone Lab 5 has been scrapped; src/Lab5/ now only holds a
 // frozen snapshot of the old relay-heater build under
 // `backup_lab5_2_relay_heater/` (not compiled).
 #define SELECTED_LAB 7
+
+// 1 = print GPIO cycle counts (digitalWrite vs FastGpio / FastPin) at boot.
+// Needs a lab that opens the serial port in setup() below.
+#define FASTGPIO_BENCHMARK 0
 // ============================================================================
 
 
@@ -40,14 +47,21 @@ void hw_pin_mode(uint8_t pin, uint8_t mode)
     pinMode(pin, mode);
 }
 
+/* The pin is only known at run time, so the port lookup stays; what goes
+   is digitalWrite()'s PWM-timer check; Lab 2.2 never calls analogWrite(),
+   so there is no PWM to detach. */
 void hw_digital_write(uint8_t pin, uint8_t val)
 {
-    digitalWrite(pin, val);
+    FastGpio io;
+    io.Bind(pin);
+    io.Write(val != 0u);
 }
 
 uint8_t hw_digital_read(uint8_t pin)
 {
-    return (uint8_t)digitalRead(pin);
+    FastGpio io;
+    io.Bind(pin);
+    return io.Read() ? 1u : 0u;
 }
 
 unsigned long hw_millis(void)
@@ -144,6 +158,10 @@ void dbg_flush(void)
     #include "Lab7_2/Lab7_2_main.h"
 #endif
 
+#if SELECTED_LAB == 99
+    #include "Bench/Bench_main.h"
+#endif
+
 // ============================================================================
 // Arduino entry points
 // ============================================================================
@@ -194,6 +212,15 @@ void setup()
     printf("[main] === Lab 7 Part 2 starting ===\n");
 #endif
 
+#if SELECTED_LAB == 99
+    SerialStdioInit(115200);
+    printf("[main] === SRV benchmark starting ===\n");
+#endif
+
+#if FASTGPIO_BENCHMARK
+    FastGpio_RunBenchmark();
+#endif
+
 #if SELECTED_LAB == 1
 
     Lab1_Setup();
@@ -217,6 +244,8 @@ void setup()
     lab7_setup();
 #elif SELECTED_LAB == 72
     lab7_2_setup();
+#elif SELECTED_LAB == 99
+    bench_setup();
 #endif
 }
 
@@ -244,5 +273,7 @@ void loop()
     lab7_loop();
 #elif SELECTED_LAB == 72
     lab7_2_loop();
+#elif SELECTED_LAB == 99
+    bench_loop();
 #endif
 }
@@ -0,0 +1,239 @@
+/**
+ * @file SimConsole.cpp
+ * @brief SIM - Serial console of the simulated Mega (implementation)
+ *
+ * Input is pulled from the descriptor on demand (FIONREAD, then read) into
+ * a small ring, the software equivalent of the core's RX buffer. The ring
+ * is touched with interrupts off so a task switch cannot split an update.
+ */
+
+#include "SimConsole.h"
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define SIM_RX_SIZE     64u     /* same as the core's SERIAL_RX_BUFFER_SIZE */
+#define SIM_PRINTF_MAX  256u
+
+static int s_inFd  = -1;
+static int s_outFd = -1;
+static int s_slaveFd = -1;      /* kept open so the master never sees EOF */
+
+static uint8_t s_rx[SIM_RX_SIZE];
+static uint8_t s_rxHead = 0u;
+static uint8_t s_rxTail = 0u;
+
+HardwareSerial Serial;
+
+// ============================================================================
+// Descriptors
+// ============================================================================
+
+bool SimConsole_Open(SimConsoleMode mode, char* name, size_t nameSize)
+{
+    if (mode == SIM_CONSOLE_STDIO)
+    {
+        s_inFd  = STDIN_FILENO;
+        s_outFd = STDOUT_FILENO;
+        snprintf(name, nameSize, "stdio");
+        return true;
+    }
+
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        return false;
+    }
+    if (ptsname_r(master, name, nameSize) != 0)
+    {
+        return false;
+    }
+
+    /* Raw on our side of the line: no echo, no line discipline, bytes in
+     * and out exactly as a UART would pass them. */
+    s_slaveFd = open(name, O_RDWR | O_NOCTTY);
+    if (s_slaveFd >= 0)
+    {
+        struct termios tio;
+        if (tcgetattr(s_slaveFd, &tio) == 0)
+        {
+            cfmakeraw(&tio);
+            tcsetattr(s_slaveFd, TCSANOW, &tio);
+        }
+    }
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    s_inFd  = master;
+    s_outFd = master;
+    return true;
+}
+
+void SimConsole_Write(const char* data, size_t len)
+{
+    while (len > 0u && s_outFd >= 0)
+    {
+        const ssize_t n = write(s_outFd, data, len);
+        if (n > 0)
+        {
+            data += n;
+            len  -= (size_t)n;
+        }
+        else if (n < 0 && errno == EINTR)
+        {
+            continue;           /* the tick signal */
+        }
+        else
+        {
+            return;             /* EAGAIN: nobody listening, drop it */
+        }
+    }
+}
+
+/** Top up the ring from the descriptor. Interrupts must be disabled. */
+static void pull(void)
+{
+    int pending = 0;
+    if (s_inFd < 0 || ioctl(s_inFd, FIONREAD, &pending) != 0 || pending <= 0)
+    {
+        return;
+    }
+
+    while (pending-- > 0)
+    {
+        const uint8_t next = (uint8_t)((s_rxHead + 1u) % SIM_RX_SIZE);
+        if (next == s_rxTail)
+        {
+            return;             /* ring full: the rest waits in the kernel */
+        }
+        uint8_t c;
+        const ssize_t n = read(s_inFd, &c, 1u);
+        if (n != 1)
+        {
+            return;
+        }
+        s_rx[s_rxHead] = c;
+        s_rxHead = next;
+    }
+}
+
+int SimConsole_Available(void)
+{
+    int count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pull();
+        count = (int)((s_rxHead + SIM_RX_SIZE - s_rxTail) % SIM_RX_SIZE);
+    }
+    return count;
+}
+
+int SimConsole_Read(void)
+{
+    int c = -1;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pull();
+        if (s_rxTail != s_rxHead)
+        {
+            c = s_rx[s_rxTail];
+            s_rxTail = (uint8_t)((s_rxTail + 1u) % SIM_RX_SIZE);
+        }
+    }
+    return c;
+}
+
+int SimConsole_Peek(void)
+{
+    int c = -1;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pull();
+        if (s_rxTail != s_rxHead)
+        {
+            c = s_rx[s_rxTail];
+        }
+    }
+    return c;
+}
+
+// ============================================================================
+// HardwareSerial / printf
+// ============================================================================
+
+int    HardwareSerial::available(void) { return SimConsole_Available(); }
+int    HardwareSerial::read(void)      { return SimConsole_Read(); }
+int    HardwareSerial::peek(void)      { return SimConsole_Peek(); }
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    SimConsole_Write((const char*)&c, 1u);
+    return 1u;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t len)
+{
+    SimConsole_Write((const char*)buf, len);
+    return len;
+}
+
+size_t HardwareSerial::print(const char* s)
+{
+    const size_t len = strlen(s);
+    SimConsole_Write(s, len);
+    return len;
+}
+
+size_t HardwareSerial::print(long n)
+{
+    char buf[16];
+    const int len = snprintf(buf, sizeof(buf), "%ld", n);
+    SimConsole_Write(buf, (size_t)len);
+    return (size_t)len;
+}
+
+size_t HardwareSerial::println(const char* s)
+{
+    const size_t len = print(s);
+    SimConsole_Write("\r\n", 2u);
+    return len + 2u;
+}
+
+size_t HardwareSerial::println(long n)
+{
+    const size_t len = print(n);
+    SimConsole_Write("\r\n", 2u);
+    return len + 2u;
+}
+
+/* One write() per call: lines from different tasks cannot interleave
+ * inside a printf, the same guarantee SerialStdioDriver's mutex gives. */
+extern "C" int sim_vprintf(const char* fmt, va_list args)
+{
+    char buf[SIM_PRINTF_MAX];
+    int len = vsnprintf(buf, sizeof(buf), fmt, args);
+    if (len < 0)
+    {
+        return len;
+    }
+    if ((size_t)len >= sizeof(buf))
+    {
+        len = (int)sizeof(buf) - 1;
+    }
+    SimConsole_Write(buf, (size_t)len);
+    return len;
+}
+
+extern "C" int sim_printf(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    const int len = sim_vprintf(fmt, args);
+    va_end(args);
+    return len;
+}
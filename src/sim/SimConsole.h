@@ -0,0 +1,45 @@
+/**
+ * @file SimConsole.h
+ * @brief SIM - Serial console of the simulated Mega
+ *
+ * Everything the firmware prints (printf and Serial) and reads (Serial)
+ * goes through one file descriptor pair:
+ *
+ * - SIM_CONSOLE_PTY: a pseudo-terminal. Its slave name is printed at
+ *   start-up; attach any serial terminal to it (picocom, screen, the
+ *   PlatformIO monitor with --port). Output is dropped while nobody
+ *   reads, like a UART with the cable pulled, so the firmware never
+ *   stalls on it.
+ * - SIM_CONSOLE_STDIO: the simulator's own stdin / stdout, for piping a
+ *   command script in and a log out.
+ *
+ * All functions are safe from any task; none of them blocks.
+ */
+
+#ifndef SimConsole_H
+#define SimConsole_H
+
+#include <stddef.h>
+
+typedef enum
+{
+    SIM_CONSOLE_PTY = 0,
+    SIM_CONSOLE_STDIO
+} SimConsoleMode;
+
+/**
+ * @param name  receives the pty slave path (PTY mode) or "stdio"
+ * @return false if the pty could not be created
+ */
+bool SimConsole_Open(SimConsoleMode mode, char* name, size_t nameSize);
+
+void SimConsole_Write(const char* data, size_t len);
+
+/** Received bytes not yet read. */
+int  SimConsole_Available(void);
+
+/** Next received byte, or -1. */
+int  SimConsole_Read(void);
+int  SimConsole_Peek(void);
+
+#endif
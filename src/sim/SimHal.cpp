@@ -0,0 +1,390 @@
+/**
+ * @file SimHal.cpp
+ * @brief SIM - Simulated Mega peripherals (implementation)
+ */
+
+#include "SimHal.h"
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include <Wire.h>
+#include <LiquidCrystal_I2C.h>
+#include <DallasTemperature.h>
+
+#include "../drivers/FastGpio.h"
+
+// ============================================================================
+// Registers
+// ============================================================================
+
+volatile uint8_t  g_simSfr[SIM_SFR_SIZE];
+SimSreg           SREG;
+volatile uint8_t  MCUSR;
+
+volatile uint8_t  TCCR3A;
+volatile uint8_t  TCCR3B;
+volatile uint8_t  TIMSK3;
+volatile uint8_t  TIFR3;
+volatile uint16_t TCNT3;
+volatile uint16_t OCR3B;
+
+TwoWire Wire;
+
+extern "C" void TIMER3_COMPB_vect(void) __attribute__((weak));
+
+/* Interrupt state is per task: each task is a thread, and the POSIX port
+ * masks the tick signal per thread. */
+static __thread bool t_irqOff = false;
+static __thread bool t_inIsr  = false;
+
+void sim_cli(void)
+{
+    if (t_inIsr) { return; }
+    SimPort_IrqOff();
+    t_irqOff = true;
+}
+
+void sim_sei(void)
+{
+    if (t_inIsr) { return; }
+    t_irqOff = false;
+    SimPort_IrqOn();
+}
+
+bool sim_irq_enabled(void)
+{
+    return !t_inIsr && !t_irqOff;
+}
+
+// ============================================================================
+// State
+// ============================================================================
+
+static volatile uint32_t s_ms = 0u;
+
+static SimPlant* s_plant         = NULL;
+static uint16_t  s_relayOutReg   = 0u;
+static uint8_t   s_relayMask     = 0u;
+static bool      s_relayActiveLow = false;
+static bool      s_relayWasClosed = false;
+static uint32_t  s_relaySwitches = 0u;
+static uint32_t  s_relayOnMs     = 0u;
+
+static char s_lcdGlass[SIM_LCD_ROWS][SIM_LCD_COLS + 1u];
+
+// ============================================================================
+// Heartbeat
+// ============================================================================
+
+static uint16_t timer3CountsPerMs(void)
+{
+    switch (TCCR3B & 0x07u)
+    {
+        case 1u: return (uint16_t)(F_CPU / 1000UL);
+        case 2u: return (uint16_t)(F_CPU / 8UL / 1000UL);
+        case 3u: return (uint16_t)(F_CPU / 64UL / 1000UL);
+        case 4u: return (uint16_t)(F_CPU / 256UL / 1000UL);
+        case 5u: return (uint16_t)(F_CPU / 1024UL / 1000UL);
+        default: return 0u;     /* stopped or external clock */
+    }
+}
+
+/** Advance Timer3 by one millisecond, firing compare B on the way. */
+static void timer3Tick(void)
+{
+    const uint16_t counts = timer3CountsPerMs();
+    if (counts == 0u)
+    {
+        return;
+    }
+
+    const uint16_t from = TCNT3;
+    /* The ISR may re-arm inside the same millisecond; bound the replays. */
+    for (uint8_t n = 0u; n < 8u; ++n)
+    {
+        const uint16_t ahead = (uint16_t)(OCR3B - from);
+        if (((TIMSK3 & (1u << OCIE3B)) == 0u) || ahead == 0u || ahead > counts ||
+            TIMER3_COMPB_vect == NULL)
+        {
+            break;
+        }
+        TCNT3 = OCR3B;
+        TIMER3_COMPB_vect();
+        if ((uint16_t)(OCR3B - from) <= ahead)
+        {
+            break;              /* not re-armed further along this step */
+        }
+    }
+    TCNT3 = (uint16_t)(from + counts);
+}
+
+void SimHal_Init(SimPlant* plant, uint8_t relayPin, bool relayActiveLow)
+{
+    const uint8_t entry = fastgpio::kPinMap[relayPin];
+    s_plant          = plant;
+    s_relayOutReg    = (uint16_t)(fastgpio::pinRegOf((uint8_t)(entry >> 3)) + 2u);
+    s_relayMask      = (uint8_t)(1u << (entry & 7u));
+    s_relayActiveLow = relayActiveLow;
+    s_relayWasClosed = false;
+    s_relaySwitches  = 0u;
+    s_relayOnMs      = 0u;
+    s_ms             = 0u;
+    memset(s_lcdGlass, ' ', sizeof(s_lcdGlass));
+    for (uint8_t r = 0u; r < SIM_LCD_ROWS; ++r)
+    {
+        s_lcdGlass[r][SIM_LCD_COLS] = '\0';
+    }
+}
+
+void SimHal_Tick(void)
+{
+    t_inIsr = true;
+
+    s_ms = s_ms + 1u;
+    timer3Tick();
+
+    const bool high   = (g_simSfr[s_relayOutReg] & s_relayMask) != 0u;
+    const bool closed = (high != s_relayActiveLow);
+    if (closed != s_relayWasClosed)
+    {
+        s_relaySwitches++;
+        s_relayWasClosed = closed;
+    }
+    if (closed)
+    {
+        s_relayOnMs++;
+    }
+    if (s_plant != NULL)
+    {
+        SimPlant_Step(s_plant, closed);
+    }
+
+    t_inIsr = false;
+}
+
+bool SimHal_RelayClosed(void)
+{
+    return s_relayWasClosed;
+}
+
+uint32_t SimHal_RelaySwitches(void)
+{
+    uint32_t n;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { n = s_relaySwitches; }
+    return n;
+}
+
+uint32_t SimHal_TakeRelayOnMs(void)
+{
+    uint32_t ms;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        ms = s_relayOnMs;
+        s_relayOnMs = 0u;
+    }
+    return ms;
+}
+
+float SimHal_PlantTempC(void)
+{
+    float t = 0.0f;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (s_plant != NULL) { t = SimPlant_TempC(s_plant); }
+    }
+    return t;
+}
+
+// ============================================================================
+// Arduino core
+// ============================================================================
+
+unsigned long millis(void)
+{
+    return s_ms;
+}
+
+/* Virtual time moves in whole ticks; sub-millisecond intervals read 0. */
+unsigned long micros(void)
+{
+    return s_ms * 1000UL;
+}
+
+void delay(unsigned long ms)
+{
+    if (!SimPort_SleepMs((uint32_t)ms))
+    {
+        s_ms = s_ms + (uint32_t)ms;     /* nothing else runs the clock */
+    }
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    (void)us;
+}
+
+uint8_t digitalPinToPort(uint8_t pin)
+{
+    return (uint8_t)(fastgpio::kPinMap[pin] >> 3);
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin)
+{
+    return (uint8_t)(1u << (fastgpio::kPinMap[pin] & 7u));
+}
+
+volatile uint8_t* portInputRegister(uint8_t port)
+{
+    return &g_simSfr[fastgpio::pinRegOf(port)];
+}
+
+volatile uint8_t* portOutputRegister(uint8_t port)
+{
+    return &g_simSfr[fastgpio::pinRegOf(port) + 2u];
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    const uint16_t pinReg = fastgpio::pinRegOf(digitalPinToPort(pin));
+    const uint8_t  mask   = digitalPinToBitMask(pin);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (mode == OUTPUT) { g_simSfr[pinReg + 1u] |= mask; }
+        else                { g_simSfr[pinReg + 1u] &= (uint8_t)~mask; }
+        if (mode == INPUT_PULLUP) { g_simSfr[pinReg + 2u] |= mask; }
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    volatile uint8_t* out = portOutputRegister(digitalPinToPort(pin));
+    const uint8_t mask = digitalPinToBitMask(pin);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (val != LOW) { *out |= mask; } else { *out &= (uint8_t)~mask; }
+    }
+}
+
+/* No external drivers: an input reads its pull-up, an output its latch. */
+int digitalRead(uint8_t pin)
+{
+    const uint16_t pinReg = fastgpio::pinRegOf(digitalPinToPort(pin));
+    return ((g_simSfr[pinReg + 2u] & digitalPinToBitMask(pin)) != 0u) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    (void)pin;
+    return 0;
+}
+
+// ============================================================================
+// DS18B20
+// ============================================================================
+
+DallasTemperature::DallasTemperature(OneWire* bus)
+    : resolution(12u), waitForConversion(true), latched(DEVICE_DISCONNECTED_C)
+{
+    (void)bus;
+}
+
+void DallasTemperature::setResolution(uint8_t bits)
+{
+    resolution = (bits < 9u) ? 9u : ((bits > 12u) ? 12u : bits);
+}
+
+void DallasTemperature::requestTemperatures(void)
+{
+    if (waitForConversion)
+    {
+        /* 93.75 ms at 9 bit, doubling per bit: 750 ms at 12 bit. Without
+         * a scheduler the reading is simply taken now. */
+        (void)SimPort_SleepMs(750u >> (12u - resolution));
+    }
+
+    float c = DEVICE_DISCONNECTED_C;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (s_plant != NULL) { c = SimPlant_SensorC(s_plant); }
+    }
+    if (c != DEVICE_DISCONNECTED_C)
+    {
+        const float lsb = 0.0625f * (float)(1u << (12u - resolution));
+        c = floorf(c / lsb) * lsb;
+    }
+    latched = c;
+}
+
+float DallasTemperature::getTempCByIndex(uint8_t index)
+{
+    return (index == 0u) ? latched : DEVICE_DISCONNECTED_C;
+}
+
+// ============================================================================
+// LCD
+// ============================================================================
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows)
+    : col(0u), row(0u)
+{
+    (void)addr;
+    (void)cols;
+    (void)rows;
+}
+
+void LiquidCrystal_I2C::init(void)
+{
+    clear();
+}
+
+void LiquidCrystal_I2C::clear(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (uint8_t r = 0u; r < SIM_LCD_ROWS; ++r)
+        {
+            memset(s_lcdGlass[r], ' ', SIM_LCD_COLS);
+        }
+    }
+    col = 0u;
+    row = 0u;
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t c, uint8_t r)
+{
+    col = (c < SIM_LCD_COLS) ? c : (uint8_t)(SIM_LCD_COLS - 1u);
+    row = (r < SIM_LCD_ROWS) ? r : (uint8_t)(SIM_LCD_ROWS - 1u);
+}
+
+/* Like the HD44780 in 16x2 mode: writing past column 15 is invisible. */
+size_t LiquidCrystal_I2C::print(const char* s)
+{
+    size_t n = 0u;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (; s[n] != '\0'; ++n)
+        {
+            if (col < SIM_LCD_COLS)
+            {
+                s_lcdGlass[row][col] = s[n];
+            }
+            col++;
+        }
+    }
+    return n;
+}
+
+size_t LiquidCrystal_I2C::print(long n)
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%ld", n);
+    return print(buf);
+}
+
+void SimHal_LcdSnapshot(char out[SIM_LCD_ROWS][SIM_LCD_COLS + 1u])
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        memcpy(out, s_lcdGlass, sizeof(s_lcdGlass));
+    }
+}
@@ -0,0 +1,51 @@
+/**
+ * @file SimHal.h
+ * @brief SIM - Simulated Mega peripherals behind the stand-in headers
+ *
+ * Owns the port registers, Timer3, the virtual millisecond clock, the
+ * DS18B20 and LCD stand-ins, and couples the relay pin to the plant.
+ * SimHal_Tick() is the 1 ms heartbeat, called from the FreeRTOS tick hook
+ * (so it runs like an ISR: it preempts tasks that have interrupts on and
+ * is held off by cli() / ATOMIC_BLOCK).
+ *
+ * The HAL itself does not depend on FreeRTOS. Whatever drives it supplies
+ * the SimPort_* hooks below: SimMain.cpp maps them onto the POSIX port,
+ * the single-threaded tuner (src/tune) makes them no-ops.
+ */
+
+#ifndef SimHal_H
+#define SimHal_H
+
+#include <stdint.h>
+
+#include "SimPlant.h"
+
+/** The fan runs while `relayPin` is at its active level. Starts the clock
+ *  and the relay counters from zero, so a run can be set up again. */
+void     SimHal_Init(SimPlant* plant, uint8_t relayPin, bool relayActiveLow);
+
+/** One millisecond: clock, Timer3 (and its compare-B ISR), plant. */
+void     SimHal_Tick(void);
+
+bool     SimHal_RelayClosed(void);
+
+/** Relay transitions seen at the pin since start. */
+uint32_t SimHal_RelaySwitches(void);
+
+/** Milliseconds the relay was closed since the previous call. */
+uint32_t SimHal_TakeRelayOnMs(void);
+
+/** True plant temperature (not what the sensor reports). */
+float    SimHal_PlantTempC(void);
+
+/* --- Supplied by the runtime --------------------------------------------- */
+
+/** Mask / unmask SimHal_Tick() for the calling thread (cli() / sei()). */
+void     SimPort_IrqOff(void);
+void     SimPort_IrqOn(void);
+
+/** Block the caller for `ms` ticks. Returns false, without waiting, when
+ *  no scheduler is running; delay() then moves the clock itself. */
+bool     SimPort_SleepMs(uint32_t ms);
+
+#endif
@@ -0,0 +1,305 @@
+/**
+ * @file SimMain.cpp
+ * @brief SIM - Lab 5.2 on Linux (FreeRTOS POSIX port) with a simulated plant
+ *
+ * Runs the unmodified Lab 5.2 sources (src/Lab5_2, src/cli, src/history)
+ * end to end on the host: lab5_2_setup() creates the same tasks, the
+ * command line and reports appear on a pseudo-terminal, the DS18B20 reads
+ * a first-order thermal plant (SimPlant.h) and the relay pin drives the
+ * plant's fan. Built by the `lab5_2_sim` environment in platformio.ini:
+ *
+ *   pio run -e lab5_2_sim
+ *   .pio/build/lab5_2_sim/program --speed max --duration 7200 --log run.csv
+ *
+ * Options:
+ *   --console pty|stdio   serial console (default pty; name printed at start)
+ *   --speed N|max         N x real time, or max: skip idle time (see below)
+ *   --duration S          stop after S virtual seconds (default: run forever)
+ *   --log FILE            one CSV row per virtual second:
+ *                         t_s,plant_c,relay_on_pct,relay_switches
+ *   --lcd                 print the LCD to stderr whenever it changes
+ *   --ambient C --heat C --fan C --tau S --dead S --t0 C --noise C --seed N
+ *                         plant parameters (SimPlant_Defaults for defaults)
+ *
+ * --- Time -------------------------------------------------------------------
+ * One FreeRTOS tick is one virtual millisecond; millis(), Timer3 and the
+ * plant all advance from the tick hook. The POSIX port makes ticks from a
+ * thread that sleeps with usleep() between them; that call is wrapped
+ * (-Wl,--wrap=usleep). `--speed N` divides the sleep. `--speed max`
+ * replaces it with "wait until every task has blocked", so a tick follows
+ * as soon as the firmware has nothing left to do: idle time costs nothing
+ * and an hour of closed-loop operation takes seconds. Work inside a tick
+ * is free in virtual time in that mode; a task that never blocks lets the
+ * clock fall back to real time instead of stopping it.
+ */
+
+#include <Arduino.h>
+#include <Arduino_FreeRTOS.h>
+#include <LiquidCrystal_I2C.h>
+
+#include <atomic>
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "SimConsole.h"
+#include "SimHal.h"
+#include "SimPlant.h"
+#include "../Lab5_2/Lab5_2_main.h"
+#include "../Lab5_2/Lab5_2_Shared.h"
+
+#define SIM_LOG_PERIOD_MS   1000u
+#define SIM_LCD_POLL_MS     250u
+
+typedef struct
+{
+    SimConsoleMode console;
+    double         speed;           /* 0 = max */
+    uint32_t       durationS;       /* 0 = forever */
+    const char*    logPath;
+    bool           showLcd;
+    uint32_t       seed;
+    SimPlantParams plant;
+} SimOptions;
+
+static SimOptions s_opt;
+static SimPlant   s_plant;
+
+static std::atomic<uint32_t> s_tick(0u);
+static std::atomic<uint32_t> s_idleTick(0u);
+
+// ============================================================================
+// Clock
+// ============================================================================
+
+extern "C" void vApplicationTickHook(void)
+{
+    SimHal_Tick();
+    s_tick.store(s_tick.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+}
+
+/** The idle task only runs once every other task has blocked. */
+extern "C" void vApplicationIdleHook(void)
+{
+    s_idleTick.store(s_tick.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+static uint64_t monotonicUs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+extern "C" int __real_usleep(useconds_t us);
+
+extern "C" int __wrap_usleep(useconds_t us)
+{
+    if (s_opt.speed > 0.0)
+    {
+        return __real_usleep((useconds_t)((double)us / s_opt.speed));
+    }
+
+    /* Max speed: release the next tick once the last one has been taken
+     * and the system went idle after it, or after `us` of real time. */
+    static uint32_t released = UINT32_MAX;
+    const uint64_t deadline = monotonicUs() + us;
+    for (;;)
+    {
+        const uint32_t tick = s_tick.load(std::memory_order_acquire);
+        if ((tick != released && s_idleTick.load(std::memory_order_acquire) == tick) ||
+            monotonicUs() >= deadline)
+        {
+            released = tick;
+            return 0;
+        }
+        sched_yield();
+    }
+}
+
+// ============================================================================
+// SimHal runtime hooks
+// ============================================================================
+
+void SimPort_IrqOff(void)
+{
+    portDISABLE_INTERRUPTS();
+}
+
+void SimPort_IrqOn(void)
+{
+    portENABLE_INTERRUPTS();
+}
+
+bool SimPort_SleepMs(uint32_t ms)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+    {
+        return false;           /* setup(): nothing else is running */
+    }
+    vTaskDelay(pdMS_TO_TICKS(ms));
+    return true;
+}
+
+// ============================================================================
+// Supervisor task: log, LCD mirror, end of run
+// ============================================================================
+
+static void finish(uint64_t startUs)
+{
+    const double realS    = (double)(monotonicUs() - startUs) / 1e6;
+    const double virtualS = (double)millis() / 1000.0;
+    dprintf(STDERR_FILENO,
+            "[sim] %.1f s virtual in %.2f s real (x%.0f), plant %.2f C, %lu relay switches\n",
+            virtualS, realS, (realS > 0.0) ? virtualS / realS : 0.0,
+            (double)SimHal_PlantTempC(), (unsigned long)SimHal_RelaySwitches());
+    _exit(0);
+}
+
+static void taskSupervisor(void* pv)
+{
+    (void)pv;
+
+    const uint64_t startUs = monotonicUs();
+    FILE* log = NULL;
+    if (s_opt.logPath != NULL)
+    {
+        log = fopen(s_opt.logPath, "w");
+        if (log == NULL)
+        {
+            dprintf(STDERR_FILENO, "[sim] cannot write %s: %s\n", s_opt.logPath, strerror(errno));
+        }
+        else
+        {
+            fprintf(log, "t_s,plant_c,relay_on_pct,relay_switches\n");
+        }
+    }
+
+    char shown[SIM_LCD_ROWS][SIM_LCD_COLS + 1u];
+    memset(shown, 0, sizeof(shown));
+    uint32_t sinceLogMs = 0u;
+
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SIM_LCD_POLL_MS));
+        sinceLogMs += SIM_LCD_POLL_MS;
+
+        if (s_opt.showLcd)
+        {
+            char glass[SIM_LCD_ROWS][SIM_LCD_COLS + 1u];
+            SimHal_LcdSnapshot(glass);
+            if (memcmp(glass, shown, sizeof(glass)) != 0)
+            {
+                memcpy(shown, glass, sizeof(glass));
+                dprintf(STDERR_FILENO, "[lcd %8.2f] |%s|%s|\n",
+                        (double)millis() / 1000.0, glass[0], glass[1]);
+            }
+        }
+
+        if (sinceLogMs >= SIM_LOG_PERIOD_MS)
+        {
+            const uint32_t onMs = SimHal_TakeRelayOnMs();
+            if (log != NULL)
+            {
+                fprintf(log, "%lu,%.3f,%.1f,%lu\n",
+                        (unsigned long)(millis() / 1000UL), (double)SimHal_PlantTempC(),
+                        100.0 * (double)onMs / (double)sinceLogMs,
+                        (unsigned long)SimHal_RelaySwitches());
+            }
+            sinceLogMs = 0u;
+        }
+
+        if (s_opt.durationS != 0u && millis() >= s_opt.durationS * 1000UL)
+        {
+            if (log != NULL) { fclose(log); }
+            finish(startUs);
+        }
+    }
+}
+
+// ============================================================================
+// Entry point
+// ============================================================================
+
+static void usage(const char* argv0)
+{
+    dprintf(STDERR_FILENO,
+            "usage: %s [--console pty|stdio] [--speed N|max] [--duration S] [--log FILE]\n"
+            "          [--lcd] [--ambient C] [--heat C] [--fan C] [--tau S] [--dead S]\n"
+            "          [--t0 C] [--noise C] [--seed N]\n", argv0);
+    exit(2);
+}
+
+static void parseArgs(int argc, char** argv)
+{
+    s_opt.console   = SIM_CONSOLE_PTY;
+    s_opt.speed     = 1.0;
+    s_opt.durationS = 0u;
+    s_opt.logPath   = NULL;
+    s_opt.showLcd   = false;
+    s_opt.seed      = 1u;
+    SimPlant_Defaults(&s_opt.plant);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* opt = argv[i];
+        if (strcmp(opt, "--lcd") == 0) { s_opt.showLcd = true; continue; }
+        if (i + 1 >= argc) { usage(argv[0]); }
+        const char* val = argv[++i];
+
+        if      (strcmp(opt, "--console") == 0)
+        {
+            if      (strcmp(val, "pty") == 0)   { s_opt.console = SIM_CONSOLE_PTY; }
+            else if (strcmp(val, "stdio") == 0) { s_opt.console = SIM_CONSOLE_STDIO; }
+            else                                { usage(argv[0]); }
+        }
+        else if (strcmp(opt, "--speed") == 0)
+        {
+            s_opt.speed = (strcmp(val, "max") == 0) ? 0.0 : atof(val);
+            if (s_opt.speed < 0.0) { usage(argv[0]); }
+        }
+        else if (strcmp(opt, "--duration") == 0) { s_opt.durationS        = (uint32_t)strtoul(val, NULL, 10); }
+        else if (strcmp(opt, "--log") == 0)      { s_opt.logPath          = val; }
+        else if (strcmp(opt, "--seed") == 0)     { s_opt.seed             = (uint32_t)strtoul(val, NULL, 10); }
+        else if (strcmp(opt, "--ambient") == 0)  { s_opt.plant.ambientC   = (float)atof(val); }
+        else if (strcmp(opt, "--heat") == 0)     { s_opt.plant.heatRiseC  = (float)atof(val); }
+        else if (strcmp(opt, "--fan") == 0)      { s_opt.plant.fanDropC   = (float)atof(val); }
+        else if (strcmp(opt, "--tau") == 0)      { s_opt.plant.tauS       = (float)atof(val); }
+        else if (strcmp(opt, "--dead") == 0)     { s_opt.plant.deadS      = (float)atof(val); }
+        else if (strcmp(opt, "--t0") == 0)       { s_opt.plant.initialC   = (float)atof(val); }
+        else if (strcmp(opt, "--noise") == 0)    { s_opt.plant.noiseC     = (float)atof(val); }
+        else                                     { usage(argv[0]); }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    parseArgs(argc, argv);
+
+    char consoleName[64];
+    if (!SimConsole_Open(s_opt.console, consoleName, sizeof(consoleName)))
+    {
+        dprintf(STDERR_FILENO, "[sim] cannot open a pseudo-terminal: %s\n", strerror(errno));
+        return 1;
+    }
+    dprintf(STDERR_FILENO, "[sim] Lab 5.2 console on %s, speed %s\n",
+            consoleName, (s_opt.speed > 0.0) ? "real-time multiple" : "max");
+
+    SimPlant_Init(&s_plant, &s_opt.plant, 0.001f, s_opt.seed);
+    SimHal_Init(&s_plant, LAB5_2_RELAY_PIN, LAB5_2_RELAY_ACTIVE_LOW != 0);
+
+    MCUSR = (uint8_t)(1u << PORF);      /* every run is a cold power-on */
+    lab5_2_setup();
+
+    if (xTaskCreate(taskSupervisor, "SIM", 0, NULL, configMAX_PRIORITIES - 1, NULL) != pdPASS)
+    {
+        dprintf(STDERR_FILENO, "[sim] cannot create the supervisor task\n");
+        return 1;
+    }
+
+    vTaskStartScheduler();
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file SimPlant.cpp
+ * @brief SIM - First-order thermal plant (implementation)
+ */
+
+#include "SimPlant.h"
+
+#include <math.h>
+#include <string.h>
+
+void SimPlant_Defaults(SimPlantParams* p)
+{
+    p->ambientC  = 22.0f;
+    p->heatRiseC = 8.0f;        /* 30 degC with the fan stopped */
+    p->fanDropC  = 10.0f;       /* 20 degC with the fan running */
+    p->tauS      = 90.0f;
+    p->deadS     = 0.0f;
+    p->initialC  = 28.0f;
+    p->noiseC    = 0.05f;
+}
+
+void SimPlant_Init(SimPlant* plant, const SimPlantParams* p, float dtS, uint32_t seed)
+{
+    plant->p     = *p;
+    plant->tempC = p->initialC;
+    plant->decay = (p->tauS > 0.0f) ? expf(-dtS / p->tauS) : 0.0f;
+    plant->rng   = (seed != 0u) ? seed : 0x2545F491u;
+
+    float steps = (dtS > 0.0f && p->deadS > 0.0f) ? p->deadS / dtS + 0.5f : 0.0f;
+    if (steps > (float)SIM_PLANT_MAX_DEAD_STEPS) { steps = (float)SIM_PLANT_MAX_DEAD_STEPS; }
+    plant->deadSteps = (uint32_t)steps;
+    plant->deadPos   = 0u;
+    memset(plant->deadLine, 0, sizeof(plant->deadLine));
+}
+
+void SimPlant_Step(SimPlant* plant, bool fanOn)
+{
+    if (plant->deadSteps != 0u)
+    {
+        /* Swap the new state in for the one written deadSteps ago. */
+        uint8_t* const byte = &plant->deadLine[plant->deadPos >> 3];
+        const uint8_t  mask = (uint8_t)(1u << (plant->deadPos & 7u));
+        const bool delayed = (*byte & mask) != 0u;
+        if (fanOn) { *byte |= mask; } else { *byte &= (uint8_t)~mask; }
+        plant->deadPos = (plant->deadPos + 1u < plant->deadSteps) ? plant->deadPos + 1u : 0u;
+        fanOn = delayed;
+    }
+
+    const float steadyC = plant->p.ambientC + plant->p.heatRiseC
+                        - (fanOn ? plant->p.fanDropC : 0.0f);
+    plant->tempC = steadyC + (plant->tempC - steadyC) * plant->decay;
+}
+
+float SimPlant_TempC(const SimPlant* plant)
+{
+    return plant->tempC;
+}
+
+/** xorshift32, mapped to (0, 1]. */
+static float uniform(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return ((float)(x >> 8) + 1.0f) / 16777216.0f;
+}
+
+float SimPlant_SensorC(SimPlant* plant)
+{
+    if (plant->p.noiseC <= 0.0f)
+    {
+        return plant->tempC;
+    }
+
+    /* Box-Muller; the second variate is thrown away, readings are rare. */
+    const float u1 = uniform(&plant->rng);
+    const float u2 = uniform(&plant->rng);
+    const float gauss = sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+    return plant->tempC + plant->p.noiseC * gauss;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file SimPlant.h
+ * @brief SIM - First-order thermal plant for the Lab 5.2 cooling loop
+ *
+ * One lumped air temperature T. A constant heat load holds it heatRiseC
+ * above ambient with the fan stopped; the running fan pulls the steady
+ * state down by fanDropC. Between relay edges T relaxes exponentially
+ * towards the steady state of the current fan state with time constant
+ * tauS:
+ *
+ *   Tss = ambientC + heatRiseC - (fanOn ? fanDropC : 0)
+ *   T(t + dt) = Tss + (T(t) - Tss) * exp(-dt / tauS)
+ *
+ * The step is exact for a constant input, so the result does not depend
+ * on how often Step() is called as long as the fan state is sampled at
+ * least once per relay edge (the simulator steps every 1 ms tick).
+ *
+ * deadS delays the fan's effect (air transport from fan to probe): Step()
+ * acts on the fan state it was given deadS earlier, kept in a one-bit-per-
+ * step delay line. Before that much history exists the fan counts as off.
+ *
+ * Sensor readings add Gaussian noise (noiseC, one sigma) from a private
+ * xorshift generator, so a run is reproducible from its seed.
+ */
+
+#ifndef SimPlant_H
+#define SimPlant_H
+
+#include <stdint.h>
+
+/** Longest dead time, in plant steps (65.5 s at the 1 ms step). */
+#define SIM_PLANT_MAX_DEAD_STEPS    65536u
+
+typedef struct
+{
+    float ambientC;     /* room temperature without the heat load           */
+    float heatRiseC;    /* steady-state rise above ambient, fan stopped      */
+    float fanDropC;     /* steady-state drop the running fan adds            */
+    float tauS;         /* thermal time constant                             */
+    float deadS;        /* transport delay between fan and probe             */
+    float initialC;     /* temperature at t = 0                              */
+    float noiseC;       /* sensor noise, one standard deviation              */
+} SimPlantParams;
+
+typedef struct
+{
+    SimPlantParams p;
+    float    tempC;
+    float    decay;     /* exp(-dt / tauS) for the fixed step                */
+    uint32_t rng;
+    uint32_t deadSteps; /* deadS in steps, 0 = no delay line                 */
+    uint32_t deadPos;
+    uint8_t  deadLine[SIM_PLANT_MAX_DEAD_STEPS / 8u];
+} SimPlant;
+
+/** Defaults that put the 25 degC set-point mid-way between fan on and off. */
+void  SimPlant_Defaults(SimPlantParams* p);
+
+/** @param dtS fixed step used by SimPlant_Step */
+void  SimPlant_Init(SimPlant* plant, const SimPlantParams* p, float dtS, uint32_t seed);
+
+void  SimPlant_Step(SimPlant* plant, bool fanOn);
+
+/** True air temperature. */
+float SimPlant_TempC(const SimPlant* plant);
+
+/** What a probe would read: temperature plus one noise sample. */
+float SimPlant_SensorC(SimPlant* plant);
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file Arduino.h
+ * @brief SIM - Arduino core stand-in for the Linux build of Lab 5.2
+ *
+ * Only what the Lab 5.2 sources, the CLI and SampleHistory use. Pins live
+ * in the simulated port registers of avr/io.h, so digitalWrite() and
+ * FastPin<N> see the same levels; millis() / micros() are FreeRTOS ticks
+ * (1 tick = 1 ms of virtual time, see SimMain.cpp).
+ *
+ * printf / vprintf are routed to SimConsole: glibc's stdout lock would
+ * deadlock the POSIX port if a task were preempted while holding it.
+ */
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+
+#define A0  54
+#define A1  55
+#define A2  56
+#define A3  57
+
+/* --- Core ---------------------------------------------------------------- */
+void          pinMode(uint8_t pin, uint8_t mode);
+void          digitalWrite(uint8_t pin, uint8_t val);
+int           digitalRead(uint8_t pin);
+int           analogRead(uint8_t pin);
+unsigned long millis(void);
+unsigned long micros(void);
+void          delay(unsigned long ms);
+void          delayMicroseconds(unsigned int us);
+
+/* Port lookup used by FastGpio::Bind(); ports are fastgpio::Port ids. */
+uint8_t           digitalPinToPort(uint8_t pin);
+uint8_t           digitalPinToBitMask(uint8_t pin);
+volatile uint8_t* portInputRegister(uint8_t port);
+volatile uint8_t* portOutputRegister(uint8_t port);
+
+/* --- Serial -------------------------------------------------------------- */
+class HardwareSerial
+{
+public:
+    void   begin(unsigned long baud) { (void)baud; }
+    int    available(void);
+    int    read(void);
+    int    peek(void);
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buf, size_t len);
+    size_t print(const char* s);
+    size_t print(long n);
+    size_t println(const char* s = "");
+    size_t println(long n);
+    void   flush(void) {}
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+/* --- stdio --------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C" {
+#endif
+int sim_printf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+int sim_vprintf(const char* fmt, va_list args);
+#ifdef __cplusplus
+}
+#endif
+
+#define printf  sim_printf
+#define vprintf sim_vprintf
+
+#endif
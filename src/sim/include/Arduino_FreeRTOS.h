@@ -0,0 +1,23 @@
+/**
+ * @file Arduino_FreeRTOS.h
+ * @brief SIM - feilipu/FreeRTOS entry header, mapped onto the POSIX port
+ *
+ * Task stack depths in the lab sources are AVR bytes. A pthread needs far
+ * more than that (glibc's vsnprintf alone uses a few KiB), so every
+ * xTaskCreate() is given at least configMINIMAL_STACK_SIZE words.
+ */
+
+#ifndef SIM_ARDUINO_FREERTOS_H
+#define SIM_ARDUINO_FREERTOS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SIM_STACK_DEPTH(depth) \
+    (((depth) > configMINIMAL_STACK_SIZE) ? (configSTACK_DEPTH_TYPE)(depth) \
+                                          : (configSTACK_DEPTH_TYPE)configMINIMAL_STACK_SIZE)
+
+#define xTaskCreate(code, name, depth, params, prio, handle) \
+    xTaskCreate((code), (name), SIM_STACK_DEPTH(depth), (params), (prio), (handle))
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * @file DallasTemperature.h
+ * @brief SIM - DS18B20 stand-in reading the simulated plant
+ *
+ * requestTemperatures() blocks for the datasheet conversion time of the
+ * configured resolution (750 ms at 12 bit) when wait-for-conversion is
+ * on, as the real library does, so the acquisition task keeps its timing.
+ * The reading is the plant temperature plus sensor noise, quantised to the
+ * resolution.
+ */
+
+#ifndef SIM_DALLASTEMPERATURE_H
+#define SIM_DALLASTEMPERATURE_H
+
+#include <stdint.h>
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C   (-127.0f)
+
+class DallasTemperature
+{
+public:
+    explicit DallasTemperature(OneWire* bus);
+
+    void  begin(void) {}
+    void  setResolution(uint8_t bits);
+    void  setWaitForConversion(bool wait) { waitForConversion = wait; }
+    void  requestTemperatures(void);
+    float getTempCByIndex(uint8_t index);
+
+private:
+    uint8_t resolution;
+    bool    waitForConversion;
+    float   latched;
+};
+
+#endif
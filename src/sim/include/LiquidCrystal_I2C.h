@@ -0,0 +1,39 @@
+/**
+ * @file LiquidCrystal_I2C.h
+ * @brief SIM - 16x2 I2C LCD stand-in
+ *
+ * Keeps the characters in RAM. SimHal_LcdSnapshot() copies them out; the
+ * simulator prints the screen to stderr whenever it changes (--lcd).
+ */
+
+#ifndef SIM_LIQUIDCRYSTAL_I2C_H
+#define SIM_LIQUIDCRYSTAL_I2C_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SIM_LCD_COLS    16u
+#define SIM_LCD_ROWS    2u
+
+class LiquidCrystal_I2C
+{
+public:
+    LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows);
+
+    void   init(void);
+    void   backlight(void) {}
+    void   noBacklight(void) {}
+    void   clear(void);
+    void   setCursor(uint8_t col, uint8_t row);
+    size_t print(const char* s);
+    size_t print(long n);
+
+private:
+    uint8_t col;
+    uint8_t row;
+};
+
+/** Copy of the glass, rows NUL-terminated. Safe from any task. */
+void SimHal_LcdSnapshot(char out[SIM_LCD_ROWS][SIM_LCD_COLS + 1u]);
+
+#endif
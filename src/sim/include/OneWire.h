@@ -0,0 +1,20 @@
+/**
+ * @file OneWire.h
+ * @brief SIM - 1-Wire bus stand-in (carries no traffic; see DallasTemperature.h)
+ */
+
+#ifndef SIM_ONEWIRE_H
+#define SIM_ONEWIRE_H
+
+#include <stdint.h>
+
+class OneWire
+{
+public:
+    explicit OneWire(uint8_t pin) : pin(pin) {}
+
+private:
+    uint8_t pin;
+};
+
+#endif
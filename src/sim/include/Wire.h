@@ -0,0 +1,17 @@
+/**
+ * @file Wire.h
+ * @brief SIM - I2C stand-in (the only I2C device, the LCD, is simulated whole)
+ */
+
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+class TwoWire
+{
+public:
+    void begin(void) {}
+};
+
+extern TwoWire Wire;
+
+#endif
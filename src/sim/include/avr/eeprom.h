@@ -0,0 +1,35 @@
+/**
+ * @file eeprom.h
+ * @brief SIM - EEPROM stand-in
+ *
+ * EEMEM is empty, so an "EEPROM" variable is an ordinary zero-initialised
+ * global and the accessors are plain copies: contents last for one run of
+ * the simulator and start out holding no valid image.
+ */
+
+#ifndef SIM_AVR_EEPROM_H
+#define SIM_AVR_EEPROM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define EEMEM
+
+static inline uint8_t eeprom_read_byte(const uint8_t* p)   { return *p; }
+static inline uint16_t eeprom_read_word(const uint16_t* p) { return *p; }
+
+static inline void eeprom_read_block(void* dst, const void* src, size_t n)
+{
+    memcpy(dst, src, n);
+}
+
+static inline void eeprom_update_byte(uint8_t* p, uint8_t v)   { *p = v; }
+static inline void eeprom_update_word(uint16_t* p, uint16_t v) { *p = v; }
+
+static inline void eeprom_update_block(const void* src, void* dst, size_t n)
+{
+    memcpy(dst, src, n);
+}
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @file interrupt.h
+ * @brief SIM - Interrupt control stand-in
+ *
+ * cli() / sei() block and unblock the POSIX port's tick signal for the
+ * calling task (portDISABLE_INTERRUPTS / portENABLE_INTERRUPTS), which is
+ * what keeps the emulated Timer3 ISR out. ISR(vector) defines a plain
+ * extern "C" function that SimHal calls by name.
+ */
+
+#ifndef SIM_AVR_INTERRUPT_H
+#define SIM_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define cli()   sim_cli()
+#define sei()   sim_sei()
+
+#define ISR(vector, ...) \
+    extern "C" void vector(void); \
+    extern "C" void vector(void)
+
+#endif
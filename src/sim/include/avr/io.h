@@ -0,0 +1,75 @@
+/**
+ * @file io.h
+ * @brief SIM - ATmega2560 register stand-in
+ *
+ * GPIO registers are a byte array indexed by data-space address, so
+ * FastPin<N> (which goes through _SFR_MEM8) and the run-time pin API
+ * share one set of port latches. Timer3 is the only timer the Lab 5.2
+ * sources program; SimHal advances TCNT3 from the tick hook and calls
+ * TIMER3_COMPB_vect on a compare match. Interrupt flags are not modelled:
+ * the emulated ISR only runs while the interrupted task has interrupts
+ * enabled, so a match can never be left pending.
+ *
+ * SREG is an object: reading it reports the I bit, writing it enables or
+ * disables interrupts, which is all `sreg = SREG; cli(); ... SREG = sreg;`
+ * and ATOMIC_BLOCK need.
+ */
+
+#ifndef SIM_AVR_IO_H
+#define SIM_AVR_IO_H
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#define SIM_SFR_SIZE    0x200u
+
+extern volatile uint8_t g_simSfr[SIM_SFR_SIZE];
+
+#define _SFR_MEM8(addr) (g_simSfr[(addr)])
+
+/* --- Status register ----------------------------------------------------- */
+#define SREG_I  7
+
+void sim_cli(void);
+void sim_sei(void);
+bool sim_irq_enabled(void);
+
+struct SimSreg
+{
+    operator uint8_t() const { return sim_irq_enabled() ? (uint8_t)(1u << SREG_I) : 0u; }
+    SimSreg& operator=(uint8_t v)
+    {
+        if ((v & (1u << SREG_I)) != 0u) { sim_sei(); } else { sim_cli(); }
+        return *this;
+    }
+};
+
+extern SimSreg SREG;
+
+/* --- Reset cause --------------------------------------------------------- */
+extern volatile uint8_t MCUSR;
+
+#define PORF    0
+#define EXTRF   1
+#define BORF    2
+#define WDRF    3
+#define JTRF    4
+
+/* --- Timer3 (normal mode, compare B) ------------------------------------- */
+extern volatile uint8_t  TCCR3A;
+extern volatile uint8_t  TCCR3B;
+extern volatile uint8_t  TIMSK3;
+extern volatile uint8_t  TIFR3;
+extern volatile uint16_t TCNT3;
+extern volatile uint16_t OCR3B;
+
+#define CS30    0
+#define CS31    1
+#define CS32    2
+#define OCIE3B  2
+#define OCF3B   2
+
+#endif
@@ -0,0 +1,26 @@
+/**
+ * @file pgmspace.h
+ * @brief SIM - Flash access stand-in (one address space on the host)
+ */
+
+#ifndef SIM_AVR_PGMSPACE_H
+#define SIM_AVR_PGMSPACE_H
+
+#include <string.h>
+#include <strings.h>
+
+#define PROGMEM
+#define PSTR(s)                 (s)
+#define F(s)                    (s)
+
+#define pgm_read_byte(addr)     (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)     (*(const uint16_t*)(addr))
+#define pgm_read_float(addr)    (*(const float*)(addr))
+#define pgm_read_ptr(addr)      (*(void* const*)(addr))
+
+#define strncpy_P               strncpy
+#define strcasecmp_P            strcasecmp
+#define strcmp_P                strcmp
+#define memcpy_P                memcpy
+
+#endif
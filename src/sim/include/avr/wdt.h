@@ -0,0 +1,17 @@
+/**
+ * @file wdt.h
+ * @brief SIM - Watchdog stand-in (there is nothing to reset on the host)
+ */
+
+#ifndef SIM_AVR_WDT_H
+#define SIM_AVR_WDT_H
+
+#define WDTO_15MS   0
+#define WDTO_1S     6
+#define WDTO_2S     7
+
+#define wdt_enable(timeout)     ((void)(timeout))
+#define wdt_disable()           ((void)0)
+#define wdt_reset()             ((void)0)
+
+#endif
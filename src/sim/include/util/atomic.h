@@ -0,0 +1,36 @@
+/**
+ * @file atomic.h
+ * @brief SIM - ATOMIC_BLOCK stand-in
+ *
+ * Same shape as avr-libc's: SREG is saved and interrupts disabled on
+ * entry, and a cleanup handler writes SREG back however the block is
+ * left (end of scope, break or return).
+ */
+
+#ifndef SIM_UTIL_ATOMIC_H
+#define SIM_UTIL_ATOMIC_H
+
+#include <avr/io.h>
+
+static inline uint8_t sim_atomic_enter(void)
+{
+    const uint8_t sreg = SREG;
+    sim_cli();
+    return sreg;
+}
+
+static inline void sim_atomic_leave(const uint8_t* sreg)
+{
+    SREG = *sreg;
+}
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+
+#define ATOMIC_BLOCK(type)                                                      \
+    for (uint8_t sim_sreg_save __attribute__((cleanup(sim_atomic_leave))) =     \
+             sim_atomic_enter(), sim_atomic_todo = 1u;                          \
+         sim_atomic_todo != 0u;                                                 \
+         sim_atomic_todo = 0u)
+
+#endif
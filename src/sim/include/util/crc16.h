@@ -0,0 +1,21 @@
+/**
+ * @file crc16.h
+ * @brief SIM - avr-libc _crc16_update (CRC-16/IBM, polynomial 0xA001)
+ */
+
+#ifndef SIM_UTIL_CRC16_H
+#define SIM_UTIL_CRC16_H
+
+#include <stdint.h>
+
+static inline uint16_t _crc16_update(uint16_t crc, uint8_t data)
+{
+    crc ^= data;
+    for (uint8_t i = 0; i < 8u; ++i)
+    {
+        crc = (crc & 1u) ? (uint16_t)((crc >> 1) ^ 0xA001u) : (uint16_t)(crc >> 1);
+    }
+    return crc;
+}
+
+#endif
@@ -0,0 +1,52 @@
+# PlatformIO pre-script for the `lab5_2_sim` and `lab5_2_tune` environments.
+#
+# Adds the FreeRTOS kernel and its POSIX (Linux) port to the native build.
+# With `custom_freertos_headers_only = yes` only the include paths are
+# added: the tuner compiles Lab 5.2 modules whose headers name FreeRTOS
+# types, but runs no kernel code.
+# The kernel is taken from $FREERTOS_KERNEL_PATH, or cloned once into
+# .pio/FreeRTOS-Kernel at the tag below. The port's tick thread sleeps with
+# usleep(); SimMain.cpp wraps that call for --speed, which is why the tag
+# is pinned: older ports tick from setitimer() instead.
+
+import os
+import subprocess
+
+Import("env")
+
+KERNEL_TAG = "V11.1.0"
+KERNEL_URL = "https://github.com/FreeRTOS/FreeRTOS-Kernel.git"
+
+project_dir = env.subst("$PROJECT_DIR")
+kernel = os.environ.get("FREERTOS_KERNEL_PATH") or os.path.join(
+    project_dir, ".pio", "FreeRTOS-Kernel")
+
+if not os.path.isfile(os.path.join(kernel, "tasks.c")):
+    print("lab5_2_sim: fetching FreeRTOS-Kernel %s into %s" % (KERNEL_TAG, kernel))
+    subprocess.check_call(["git", "clone", "--depth", "1", "--branch", KERNEL_TAG,
+                           KERNEL_URL, kernel])
+
+port = os.path.join(kernel, "portable", "ThirdParty", "GCC", "Posix")
+
+env.Append(CPPPATH=[
+    os.path.join(kernel, "include"),
+    port,
+    os.path.join(port, "utils"),
+])
+
+if env.GetProjectOption("custom_freertos_headers_only", "no") == "yes":
+    Return()
+
+env.BuildSources(
+    os.path.join("$BUILD_DIR", "FreeRTOS-Kernel"),
+    kernel,
+    src_filter=[
+        "-<*>",
+        "+<tasks.c>",
+        "+<queue.c>",
+        "+<list.c>",
+        "+<portable/MemMang/heap_3.c>",
+        "+<portable/ThirdParty/GCC/Posix/port.c>",
+        "+<portable/ThirdParty/GCC/Posix/utils/wait_for_event.c>",
+    ],
+)
@@ -0,0 +1,644 @@
+/**
+ * @file TuneMain.cpp
+ * @brief TUNE - Parallel PID / ON-OFF tuning sweep for Lab 5.2 on the host
+ *
+ * Runs one closed-loop step response (TuneRun.h) per point of a Kp x Ki x
+ * Kd x window grid for the PID, plus one per hysteresis value for ON/OFF,
+ * spread over all CPU cores, and ranks the results. Built by the
+ * `lab5_2_tune` environment in platformio.ini:
+ *
+ *   pio run -e lab5_2_tune
+ *   .pio/build/lab5_2_tune/program --dead 5 --csv sweep.csv
+ *
+ * Grids are `V` (one value) or `FROM:TO:STEP`:
+ *   --kp G --ki G --kd G --window G(ms)   PID grid  (10:100:10, 0:1.5:0.25, 0:10:5, 1000:4000:1000)
+ *   --hyst G                              ON/OFF grid (0.5:2:0.5)
+ *   --no-pid | --no-onoff                 leave a family out
+ * Scenario:
+ *   --sp C --limit PCT --duration S --band C --hold S
+ *   --ambient C --heat C --fan C --tau S --dead S --t0 C --noise C --seed N
+ * Output:
+ *   --jobs N      worker processes (default: online CPUs)
+ *   --top N       rows in the ranking table (default 20)
+ *   --sort KEY    settle|overshoot|iae|switches, order within a front (iae)
+ *   --csv FILE    every result, one row per candidate
+ *
+ * --- Ranking ----------------------------------------------------------------
+ * No weights: candidates are sorted into Pareto fronts over (settle,
+ * overshoot, IAE, switches), all minimised, "never settled" counting as
+ * worst. Front 1 holds every candidate that no other one beats on all four
+ * at once; front 2 is front 1 of the rest, and so on. --sort orders the
+ * rows inside a front.
+ *
+ * The tool then proposes a PID_PRESETS table for Lab5_2_main.cpp:
+ * balanced = lowest IAE; soft = fewest relay switches without overshooting
+ * the band, switching less than balanced at no higher Kp; aggressive =
+ * fastest settling, sooner than balanced at no lower Kp; p = lowest IAE
+ * with Ki = Kd = 0. The PV reaches the controller in whole degrees, so
+ * many candidates tie on every metric: ties go to the lower gains, and a
+ * soft or aggressive row that would only repeat balanced is left empty.
+ * Each needs a candidate that settled (p excepted: droop is its nature).
+ * The window is not part of a preset; it is printed alongside.
+ *
+ * --- Parallelism ------------------------------------------------------------
+ * The firmware modules under test keep file-scope state, so workers are
+ * processes (fork), not threads. Worker w runs candidates w, w + N, ...
+ * and writes one fixed-size record per result into a shared pipe (each
+ * write is below PIPE_BUF, hence atomic). Every candidate sees the same
+ * noise seed, so differences come from the gains, not from luck.
+ */
+
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "TuneRun.h"
+
+typedef struct
+{
+    float from;
+    float to;
+    float step;
+} TuneGrid;
+
+typedef enum
+{
+    SORT_SETTLE = 0,
+    SORT_OVERSHOOT,
+    SORT_IAE,
+    SORT_SWITCHES
+} SortKey;
+
+typedef struct
+{
+    TuneScenario scenario;
+    TuneGrid     kp;
+    TuneGrid     ki;
+    TuneGrid     kd;
+    TuneGrid     window;
+    TuneGrid     hyst;
+    bool         pid;
+    bool         onoff;
+    int          jobs;
+    int          top;
+    SortKey      sort;
+    const char*  csvPath;
+} TuneOptions;
+
+typedef struct
+{
+    uint32_t    index;
+    TuneMetrics m;
+} TuneRecord;
+
+typedef struct
+{
+    TuneCandidate c;
+    TuneMetrics   m;
+    uint32_t      front;
+} TuneResult;
+
+static TuneOptions s_opt;
+
+// ============================================================================
+// Grid
+// ============================================================================
+
+static bool parseGrid(const char* text, TuneGrid* g)
+{
+    char* end;
+    g->from = strtof(text, &end);
+    if (end == text) { return false; }
+    if (*end == '\0')
+    {
+        g->to   = g->from;
+        g->step = 1.0f;
+        return true;
+    }
+
+    const char* p = end + 1;
+    g->to = strtof(p, &end);
+    if (end == p || *end != ':') { return false; }
+    p = end + 1;
+    g->step = strtof(p, &end);
+    return end != p && *end == '\0' && g->step > 0.0f && g->to >= g->from;
+}
+
+static uint32_t gridCount(const TuneGrid* g)
+{
+    return (uint32_t)floorf((g->to - g->from) / g->step + 1e-3f) + 1u;
+}
+
+/* Computed from the index, not accumulated, so 0.1 steps land on 0.1s. */
+static float gridValue(const TuneGrid* g, uint32_t i)
+{
+    return g->from + g->step * (float)i;
+}
+
+static void buildCandidates(std::vector<TuneResult>* out)
+{
+    TuneResult r;
+    memset(&r, 0, sizeof(r));
+
+    if (s_opt.pid)
+    {
+        r.c.ctrl = TUNE_CTRL_PID;
+        for (uint32_t a = 0; a < gridCount(&s_opt.kp); ++a)
+        for (uint32_t b = 0; b < gridCount(&s_opt.ki); ++b)
+        for (uint32_t d = 0; d < gridCount(&s_opt.kd); ++d)
+        for (uint32_t w = 0; w < gridCount(&s_opt.window); ++w)
+        {
+            r.c.kp       = gridValue(&s_opt.kp, a);
+            r.c.ki       = gridValue(&s_opt.ki, b);
+            r.c.kd       = gridValue(&s_opt.kd, d);
+            r.c.windowMs = (uint16_t)(gridValue(&s_opt.window, w) + 0.5f);
+            out->push_back(r);
+        }
+    }
+
+    if (s_opt.onoff)
+    {
+        memset(&r.c, 0, sizeof(r.c));
+        r.c.ctrl = TUNE_CTRL_ONOFF;
+        for (uint32_t h = 0; h < gridCount(&s_opt.hyst); ++h)
+        {
+            r.c.hysteresisC = gridValue(&s_opt.hyst, h);
+            out->push_back(r);
+        }
+    }
+}
+
+// ============================================================================
+// Workers
+// ============================================================================
+
+static void worker(int fd, int w, int jobs, const std::vector<TuneResult>& all)
+{
+    for (size_t i = (size_t)w; i < all.size(); i += (size_t)jobs)
+    {
+        TuneRecord rec;
+        rec.index = (uint32_t)i;
+        TuneRun(&s_opt.scenario, &all[i].c, &rec.m);
+        if (write(fd, &rec, sizeof(rec)) != (ssize_t)sizeof(rec))
+        {
+            _exit(1);
+        }
+    }
+    _exit(0);
+}
+
+static bool runAll(std::vector<TuneResult>* all)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        perror("pipe");
+        return false;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    std::vector<pid_t> pids;
+    for (int w = 0; w < s_opt.jobs; ++w)
+    {
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            worker(fds[1], w, s_opt.jobs, *all);
+        }
+        if (pid < 0)
+        {
+            perror("fork");
+            break;
+        }
+        pids.push_back(pid);
+    }
+    close(fds[1]);
+
+    size_t got = 0u;
+    size_t nextReport = all->size() / 10u;
+    TuneRecord rec;
+    for (;;)
+    {
+        const ssize_t n = read(fds[0], &rec, sizeof(rec));
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n != (ssize_t)sizeof(rec)) { break; }
+        if (rec.index < all->size())
+        {
+            (*all)[rec.index].m = rec.m;
+            got++;
+        }
+        if (got >= nextReport && got < all->size())
+        {
+            fprintf(stderr, "[tune] %zu / %zu\n", got, all->size());
+            nextReport += all->size() / 10u;
+        }
+    }
+    close(fds[0]);
+
+    bool ok = (pids.size() == (size_t)s_opt.jobs);
+    for (size_t k = 0; k < pids.size(); ++k)
+    {
+        int status = 0;
+        waitpid(pids[k], &status, 0);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    if (got != all->size())
+    {
+        fprintf(stderr, "[tune] only %zu of %zu results came back\n", got, all->size());
+        ok = false;
+    }
+    return ok;
+}
+
+// ============================================================================
+// Ranking
+// ============================================================================
+
+static float settleKey(const TuneMetrics& m)
+{
+    return (m.settleS < 0.0f) ? FLT_MAX : m.settleS;
+}
+
+static bool dominates(const TuneMetrics& a, const TuneMetrics& b)
+{
+    const float sa = settleKey(a);
+    const float sb = settleKey(b);
+    if (sa > sb || a.overshootC > b.overshootC || a.iaeCs > b.iaeCs || a.switches > b.switches)
+    {
+        return false;
+    }
+    return sa < sb || a.overshootC < b.overshootC || a.iaeCs < b.iaeCs || a.switches < b.switches;
+}
+
+static void assignFronts(std::vector<TuneResult>* all)
+{
+    const size_t n = all->size();
+    for (size_t i = 0; i < n; ++i) { (*all)[i].front = 0u; }
+
+    size_t left = n;
+    for (uint32_t front = 1u; left > 0u; ++front)
+    {
+        std::vector<size_t> members;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if ((*all)[i].front != 0u) { continue; }
+            bool beaten = false;
+            for (size_t j = 0; j < n && !beaten; ++j)
+            {
+                beaten = (j != i) && ((*all)[j].front == 0u) &&
+                         dominates((*all)[j].m, (*all)[i].m);
+            }
+            if (!beaten) { members.push_back(i); }
+        }
+        /* Set after the scan: members of one front do not hide each other. */
+        for (size_t k = 0; k < members.size(); ++k) { (*all)[members[k]].front = front; }
+        left -= members.size();
+    }
+}
+
+static float sortValue(const TuneMetrics& m, SortKey key)
+{
+    switch (key)
+    {
+        case SORT_SETTLE:    return settleKey(m);
+        case SORT_OVERSHOOT: return m.overshootC;
+        case SORT_SWITCHES:  return (float)m.switches;
+        default:             return m.iaeCs;
+    }
+}
+
+static bool rankLess(const TuneResult& a, const TuneResult& b)
+{
+    if (a.front != b.front) { return a.front < b.front; }
+    const float va = sortValue(a.m, s_opt.sort);
+    const float vb = sortValue(b.m, s_opt.sort);
+    if (va != vb) { return va < vb; }
+    return a.m.iaeCs < b.m.iaeCs;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+static void printHeader(FILE* f, bool csv)
+{
+    if (csv)
+    {
+        fprintf(f, "front,mode,kp,ki,kd,window_ms,hyst_c,"
+                   "rise_s,settle_s,overshoot_c,iae_cs,switches,offset_c\n");
+    }
+    else
+    {
+        fprintf(f, "front mode     kp     ki     kd window  hyst |   rise settle   over"
+                   "      IAE  sw  offset\n");
+    }
+}
+
+static void printRow(FILE* f, const TuneResult& r, bool csv)
+{
+    const bool pid = (r.c.ctrl == TUNE_CTRL_PID);
+    const char* mode = pid ? "pid" : "onoff";
+    if (csv)
+    {
+        fprintf(f, "%u,%s,%g,%g,%g,%u,%g,%.1f,%.1f,%.3f,%.1f,%lu,%.3f\n",
+                (unsigned)r.front, mode, (double)r.c.kp, (double)r.c.ki, (double)r.c.kd,
+                (unsigned)r.c.windowMs, (double)r.c.hysteresisC,
+                (double)r.m.riseS, (double)r.m.settleS, (double)r.m.overshootC,
+                (double)r.m.iaeCs, (unsigned long)r.m.switches, (double)r.m.offsetC);
+        return;
+    }
+
+    char settle[16];
+    char rise[16];
+    if (r.m.settleS < 0.0f) { snprintf(settle, sizeof(settle), "never"); }
+    else                    { snprintf(settle, sizeof(settle), "%.0f", (double)r.m.settleS); }
+    if (r.m.riseS < 0.0f)   { snprintf(rise, sizeof(rise), "-"); }
+    else                    { snprintf(rise, sizeof(rise), "%.0f", (double)r.m.riseS); }
+
+    if (pid)
+    {
+        fprintf(f, "%5u %-5s %6.1f %6.2f %6.1f %6u     - |",
+                (unsigned)r.front, mode, (double)r.c.kp, (double)r.c.ki, (double)r.c.kd,
+                (unsigned)r.c.windowMs);
+    }
+    else
+    {
+        fprintf(f, "%5u %-5s      -      -      -      - %5.2f |",
+                (unsigned)r.front, mode, (double)r.c.hysteresisC);
+    }
+    fprintf(f, " %6s %6s %6.2f %8.1f %4lu %+7.2f\n", rise, settle, (double)r.m.overshootC,
+            (double)r.m.iaeCs, (unsigned long)r.m.switches, (double)r.m.offsetC);
+}
+
+typedef bool (*PresetFilter)(const TuneResult& r);
+typedef bool (*PresetBetter)(const TuneResult& a, const TuneResult& b);
+
+static bool settledPid(const TuneResult& r)
+{
+    return r.c.ctrl == TUNE_CTRL_PID && r.m.settleS >= 0.0f;
+}
+
+static bool softFilter(const TuneResult& r)
+{
+    return settledPid(r) && r.m.overshootC <= s_opt.scenario.bandC;
+}
+
+static bool pOnlyFilter(const TuneResult& r)
+{
+    return r.c.ctrl == TUNE_CTRL_PID && r.c.ki == 0.0f && r.c.kd == 0.0f;
+}
+
+/** Last resort of every ordering: with the PV in whole degrees many
+ *  candidates tie on every metric, and the gentler gains should win. */
+static bool lowerGains(const TuneResult& a, const TuneResult& b)
+{
+    if (a.c.kp != b.c.kp) { return a.c.kp < b.c.kp; }
+    if (a.c.ki != b.c.ki) { return a.c.ki < b.c.ki; }
+    if (a.c.kd != b.c.kd) { return a.c.kd < b.c.kd; }
+    return a.c.windowMs < b.c.windowMs;
+}
+
+static bool fewerSwitches(const TuneResult& a, const TuneResult& b)
+{
+    if (a.m.switches != b.m.switches) { return a.m.switches < b.m.switches; }
+    if (a.m.iaeCs != b.m.iaeCs)       { return a.m.iaeCs < b.m.iaeCs; }
+    return lowerGains(a, b);
+}
+
+static bool lowerIae(const TuneResult& a, const TuneResult& b)
+{
+    return (a.m.iaeCs != b.m.iaeCs) ? a.m.iaeCs < b.m.iaeCs : lowerGains(a, b);
+}
+
+static bool fasterSettle(const TuneResult& a, const TuneResult& b)
+{
+    if (a.m.settleS != b.m.settleS) { return a.m.settleS < b.m.settleS; }
+    if (a.m.iaeCs != b.m.iaeCs)     { return a.m.iaeCs < b.m.iaeCs; }
+    return lowerGains(a, b);
+}
+
+static bool switchesLess(const TuneResult& a, const TuneResult& b)
+{
+    return a.m.switches < b.m.switches;
+}
+
+static bool settlesSooner(const TuneResult& a, const TuneResult& b)
+{
+    return a.m.settleS < b.m.settleS;
+}
+
+/** Best candidate that passes `keep` and has kpMin <= Kp <= kpMax; with a
+ *  `ref`, it must also beat `ref` by `beats`, so it is a real alternative
+ *  rather than the same behaviour under other gains. */
+static const TuneResult* pickPreset(const std::vector<TuneResult>& all, PresetFilter keep,
+                                    PresetBetter better, float kpMin, float kpMax,
+                                    const TuneResult* ref, PresetBetter beats)
+{
+    const TuneResult* best = NULL;
+    for (size_t i = 0; i < all.size(); ++i)
+    {
+        const TuneResult& r = all[i];
+        if (!keep(r) || r.c.kp < kpMin || r.c.kp > kpMax) { continue; }
+        if (ref != NULL && !beats(r, *ref))               { continue; }
+        if (best == NULL || better(r, *best))             { best = &r; }
+    }
+    return best;
+}
+
+static void printPreset(const TuneResult* best, const char* name, const char* none)
+{
+    if (best == NULL)
+    {
+        printf("    /* %-10s %s */\n", name, none);
+        return;
+    }
+
+    char kp[16], ki[16], kd[16], settle[16];
+    snprintf(kp, sizeof(kp), "%.1ff,", (double)best->c.kp);
+    snprintf(ki, sizeof(ki), "%.2ff,", (double)best->c.ki);
+    snprintf(kd, sizeof(kd), "%.1ff", (double)best->c.kd);
+    if (best->m.settleS < 0.0f) { snprintf(settle, sizeof(settle), "never"); }
+    else                        { snprintf(settle, sizeof(settle), "%.0f s", (double)best->m.settleS); }
+    printf("    { %-7s %-6s %5s },    /* %-10s window %u ms: settle %s, over %.2f C,"
+           " IAE %.0f, %lu sw */\n",
+           kp, ki, kd, name, (unsigned)best->c.windowMs, settle,
+           (double)best->m.overshootC, (double)best->m.iaeCs, (unsigned long)best->m.switches);
+}
+
+/** Balanced is picked first. Soft must switch less than it at no higher
+ *  Kp, aggressive settle sooner at no lower Kp; when nothing does, the
+ *  sweep cannot tell them apart and the row says so instead of repeating
+ *  balanced under other gains. */
+static void printPresets(const std::vector<TuneResult>& all)
+{
+    const TuneScenario& sc = s_opt.scenario;
+    printf("\nProposed PID_PRESETS (plant: ambient %.1f, heat %.1f, fan %.1f, tau %.0f s,"
+           " dead %.1f s; %.1f -> %.1f C):\n",
+           (double)sc.plant.ambientC, (double)sc.plant.heatRiseC, (double)sc.plant.fanDropC,
+           (double)sc.plant.tauS, (double)sc.plant.deadS,
+           (double)sc.plant.initialC, (double)sc.setpointC);
+
+    const TuneResult* balanced = pickPreset(all, settledPid, lowerIae, -FLT_MAX, FLT_MAX,
+                                            NULL, NULL);
+    const TuneResult* soft = NULL;
+    const TuneResult* aggr = NULL;
+    if (balanced != NULL)
+    {
+        soft = pickPreset(all, softFilter, fewerSwitches, -FLT_MAX, balanced->c.kp,
+                          balanced, switchesLess);
+        aggr = pickPreset(all, settledPid, fasterSettle, balanced->c.kp, FLT_MAX,
+                          balanced, settlesSooner);
+    }
+
+    printPreset(soft,     "soft",       "none switches less than balanced: use a lower Kp by hand");
+    printPreset(balanced, "balanced",   "no candidate qualifies");
+    printPreset(aggr,     "aggressive", "none settles sooner than balanced: keep balanced");
+    printPreset(pickPreset(all, pOnlyFilter, lowerIae, -FLT_MAX, FLT_MAX, NULL, NULL), "p",
+                "no candidate qualifies");
+}
+
+// ============================================================================
+// Options
+// ============================================================================
+
+static void usage(const char* argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--kp G] [--ki G] [--kd G] [--window G] [--hyst G] [--no-pid]\n"
+            "          [--no-onoff] [--sp C] [--limit PCT] [--duration S] [--band C]\n"
+            "          [--hold S] [--ambient C] [--heat C] [--fan C] [--tau S] [--dead S]\n"
+            "          [--t0 C] [--noise C] [--seed N] [--jobs N] [--top N]\n"
+            "          [--sort settle|overshoot|iae|switches] [--csv FILE]\n"
+            "       G is V or FROM:TO:STEP\n", argv0);
+}
+
+static TuneGrid grid(float from, float to, float step)
+{
+    TuneGrid g = { from, to, step };
+    return g;
+}
+
+static bool parseArgs(int argc, char** argv)
+{
+    TuneRun_Defaults(&s_opt.scenario);
+    s_opt.kp     = grid(10.0f,   100.0f,  10.0f);
+    s_opt.ki     = grid(0.0f,    1.5f,    0.25f);
+    s_opt.kd     = grid(0.0f,    10.0f,   5.0f);
+    s_opt.window = grid(1000.0f, 4000.0f, 1000.0f);
+    s_opt.hyst   = grid(0.5f,    2.0f,    0.5f);
+    s_opt.pid    = true;
+    s_opt.onoff  = true;
+    s_opt.jobs   = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    s_opt.top    = 20;
+    s_opt.sort   = SORT_IAE;
+
+    TuneScenario& sc = s_opt.scenario;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* opt = argv[i];
+        if (strcmp(opt, "--no-pid") == 0)   { s_opt.pid = false;   continue; }
+        if (strcmp(opt, "--no-onoff") == 0) { s_opt.onoff = false; continue; }
+        if (i + 1 >= argc) { return false; }
+        const char* val = argv[++i];
+
+        bool ok = true;
+        if      (strcmp(opt, "--kp") == 0)       { ok = parseGrid(val, &s_opt.kp); }
+        else if (strcmp(opt, "--ki") == 0)       { ok = parseGrid(val, &s_opt.ki); }
+        else if (strcmp(opt, "--kd") == 0)       { ok = parseGrid(val, &s_opt.kd); }
+        else if (strcmp(opt, "--window") == 0)   { ok = parseGrid(val, &s_opt.window); }
+        else if (strcmp(opt, "--hyst") == 0)     { ok = parseGrid(val, &s_opt.hyst); }
+        else if (strcmp(opt, "--sp") == 0)       { sc.setpointC        = (float)atof(val); }
+        else if (strcmp(opt, "--limit") == 0)    { sc.outputLimit      = (float)atof(val); }
+        else if (strcmp(opt, "--duration") == 0) { sc.durationS        = (uint32_t)strtoul(val, NULL, 10); }
+        else if (strcmp(opt, "--band") == 0)     { sc.bandC            = (float)atof(val); }
+        else if (strcmp(opt, "--hold") == 0)     { sc.holdS            = (uint32_t)strtoul(val, NULL, 10); }
+        else if (strcmp(opt, "--ambient") == 0)  { sc.plant.ambientC   = (float)atof(val); }
+        else if (strcmp(opt, "--heat") == 0)     { sc.plant.heatRiseC  = (float)atof(val); }
+        else if (strcmp(opt, "--fan") == 0)      { sc.plant.fanDropC   = (float)atof(val); }
+        else if (strcmp(opt, "--tau") == 0)      { sc.plant.tauS       = (float)atof(val); }
+        else if (strcmp(opt, "--dead") == 0)     { sc.plant.deadS      = (float)atof(val); }
+        else if (strcmp(opt, "--t0") == 0)       { sc.plant.initialC   = (float)atof(val); }
+        else if (strcmp(opt, "--noise") == 0)    { sc.plant.noiseC     = (float)atof(val); }
+        else if (strcmp(opt, "--seed") == 0)     { sc.seed             = (uint32_t)strtoul(val, NULL, 0); }
+        else if (strcmp(opt, "--jobs") == 0)     { s_opt.jobs          = atoi(val); }
+        else if (strcmp(opt, "--top") == 0)      { s_opt.top           = atoi(val); }
+        else if (strcmp(opt, "--csv") == 0)      { s_opt.csvPath       = val; }
+        else if (strcmp(opt, "--sort") == 0)
+        {
+            if      (strcmp(val, "settle") == 0)    { s_opt.sort = SORT_SETTLE; }
+            else if (strcmp(val, "overshoot") == 0) { s_opt.sort = SORT_OVERSHOOT; }
+            else if (strcmp(val, "iae") == 0)       { s_opt.sort = SORT_IAE; }
+            else if (strcmp(val, "switches") == 0)  { s_opt.sort = SORT_SWITCHES; }
+            else                                    { ok = false; }
+        }
+        else { ok = false; }
+
+        if (!ok)
+        {
+            fprintf(stderr, "bad option: %s %s\n", opt, val);
+            return false;
+        }
+    }
+
+    if (s_opt.jobs < 1) { s_opt.jobs = 1; }
+    return sc.durationS > 0u && (s_opt.pid || s_opt.onoff);
+}
+
+int main(int argc, char** argv)
+{
+    if (!parseArgs(argc, argv))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<TuneResult> all;
+    buildCandidates(&all);
+    if ((size_t)s_opt.jobs > all.size()) { s_opt.jobs = (int)all.size(); }
+    fprintf(stderr, "[tune] %zu candidates, %u s each, %d workers\n",
+            all.size(), (unsigned)s_opt.scenario.durationS, s_opt.jobs);
+
+    if (!runAll(&all))
+    {
+        return 1;
+    }
+
+    assignFronts(&all);
+    std::sort(all.begin(), all.end(), rankLess);
+
+    if (s_opt.csvPath != NULL)
+    {
+        FILE* csv = fopen(s_opt.csvPath, "w");
+        if (csv == NULL)
+        {
+            perror(s_opt.csvPath);
+            return 1;
+        }
+        printHeader(csv, true);
+        for (size_t i = 0; i < all.size(); ++i) { printRow(csv, all[i], true); }
+        fclose(csv);
+    }
+
+    printf("Step %.1f -> %.1f C, band +/-%.2f C held %u s, %u s per run\n",
+           (double)s_opt.scenario.plant.initialC, (double)s_opt.scenario.setpointC,
+           (double)s_opt.scenario.bandC, (unsigned)s_opt.scenario.holdS,
+           (unsigned)s_opt.scenario.durationS);
+    printHeader(stdout, false);
+    for (size_t i = 0; i < all.size() && (int)i < s_opt.top; ++i)
+    {
+        printRow(stdout, all[i], false);
+    }
+    printPresets(all);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file TuneRun.cpp
+ * @brief TUNE - One closed-loop step response of the Lab 5.2 controller (implementation)
+ */
+
+#include "TuneRun.h"
+
+#include <math.h>
+
+#include "../sim/SimHal.h"
+#include "../Lab5_2/Lab5_2_Shared.h"
+#include "../Lab5_2/ctrl_onoff_hyst.h"
+#include "../Lab5_2/ctrl_pid.h"
+#include "../Lab5_2/srv_fan.h"
+#include "../Lab5_2/srv_temp_sensor.h"
+
+static SimPlant                    s_plant;
+static PidController52             s_pid;
+static OnOffHysteresisController52 s_onoff;
+
+// ============================================================================
+// SimHal runtime hooks: one thread, nothing to mask, nobody to wait for
+// ============================================================================
+
+void SimPort_IrqOff(void)
+{
+}
+
+void SimPort_IrqOn(void)
+{
+}
+
+bool SimPort_SleepMs(uint32_t ms)
+{
+    (void)ms;
+    return false;
+}
+
+// ============================================================================
+// Run
+// ============================================================================
+
+void TuneRun_Defaults(TuneScenario* sc)
+{
+    SimPlant_Defaults(&sc->plant);
+    sc->seed        = 1u;
+    sc->setpointC   = LAB5_2_DEFAULT_SETPOINT_C;
+    sc->outputLimit = LAB5_2_DEFAULT_OUTPUT_LIMIT;
+    sc->durationS   = 1800u;
+    sc->bandC       = 0.5f;
+    sc->holdS       = 300u;
+}
+
+/** The PID / ON-OFF branch of taskControl, with a valid sensor and no force. */
+static float controlStep(const TuneScenario* sc, const TuneCandidate* c, float tempC)
+{
+    if (c->ctrl == TUNE_CTRL_ONOFF)
+    {
+        return s_onoff.Step(tempC, sc->setpointC, c->hysteresisC) ? 100.0f : 0.0f;
+    }
+
+    const float raw = s_pid.Step(tempC - sc->setpointC, (float)LAB5_2_ACQ_TASK_MS / 1000.0f);
+    if (raw < 0.0f)             { return 0.0f; }
+    if (raw > sc->outputLimit)  { return sc->outputLimit; }
+    return raw;
+}
+
+void TuneRun(const TuneScenario* sc, const TuneCandidate* c, TuneMetrics* out)
+{
+    SimPlant_Init(&s_plant, &sc->plant, 0.001f, sc->seed);
+    SimHal_Init(&s_plant, LAB5_2_RELAY_PIN, LAB5_2_RELAY_ACTIVE_LOW != 0);
+
+    Fan52_Init();
+    if (c->ctrl == TUNE_CTRL_PID)
+    {
+        Fan52_SetWindowMs(c->windowMs);
+    }
+    TempSensor52_Init();
+    s_pid.Init(c->kp, c->ki, c->kd, sc->outputLimit, 0.0f);
+    s_onoff.Init(false);
+    const uint32_t switchesAtStart = Fan52_GetSwitchCount();
+
+    /* Step geometry: `dir` points from the start towards the set-point. */
+    const float startC = sc->plant.initialC;
+    const float stepC  = sc->setpointC - startC;
+    const float dir    = (stepC >= 0.0f) ? 1.0f : -1.0f;
+    const float lo     = startC + 0.1f * stepC;
+    const float hi     = startC + 0.9f * stepC;
+
+    const uint32_t endMs  = sc->durationS * 1000u;
+    const uint32_t holdMs = (sc->holdS < sc->durationS) ? sc->holdS * 1000u : endMs;
+
+    uint32_t tLoMs      = 0u;
+    uint32_t tHiMs      = 0u;
+    uint32_t outsideMs  = 0u;       /* last ms outside the band */
+    double   iae        = 0.0;
+    double   tailSum    = 0.0;
+    float    overshootC = 0.0f;
+
+    for (uint32_t ms = 1u; ms <= endMs; ++ms)
+    {
+        SimHal_Tick();
+
+        if (ms % LAB5_2_ACQ_TASK_MS == 0u && TempSensor52_Loop())
+        {
+            Fan52_SetDemandPct(controlStep(sc, c, TempSensor52_GetTempC()));
+        }
+
+        const float t   = SimPlant_TempC(&s_plant);
+        const float err = t - sc->setpointC;
+        const float progress = dir * (t - startC);
+
+        if (tLoMs == 0u && progress >= dir * (lo - startC)) { tLoMs = ms; }
+        if (tHiMs == 0u && progress >= dir * (hi - startC)) { tHiMs = ms; }
+
+        const float past = dir * err;
+        if (past > overshootC) { overshootC = past; }
+
+        if (fabsf(err) > sc->bandC) { outsideMs = ms; }
+
+        iae += fabs((double)err);
+        if (ms > endMs - holdMs) { tailSum += (double)err; }
+    }
+
+    out->riseS      = (tHiMs != 0u) ? (float)(tHiMs - tLoMs) / 1000.0f : -1.0f;
+    out->settleS    = (endMs - outsideMs >= holdMs) ? (float)outsideMs / 1000.0f : -1.0f;
+    out->overshootC = overshootC;
+    out->iaeCs      = (float)(iae / 1000.0);
+    out->switches   = Fan52_GetSwitchCount() - switchesAtStart;
+    out->offsetC    = (float)(tailSum / (double)holdMs);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file TuneRun.h
+ * @brief TUNE - One closed-loop step response of the Lab 5.2 controller
+ *
+ * Links the firmware's own control path, unmodified: the sensor pipeline
+ * (srv_temp_sensor: saturate, median, weighted average, whole degrees),
+ * PidController52 or OnOffHysteresisController52, and the Timer3 relay
+ * slicer (srv_fan), driven by SimHal against a SimPlant with dead time.
+ * The loop body is the PID / ON-OFF branch of taskControl, run once per
+ * acquisition period. No RTOS: one thread steps the 1 ms HAL tick.
+ *
+ * The run starts with the plant at its initial temperature and the
+ * set-point elsewhere, so the whole run is one set-point step. Metrics
+ * come from the true plant temperature T (not the sensor), every 1 ms:
+ *
+ *   rise      10 % -> 90 % of the step
+ *   settle    time after which |T - SP| <= band for the rest of the run,
+ *             provided that is at least `holdS`; otherwise "never"
+ *   overshoot furthest excursion of T past SP, against the step, in C
+ *   IAE       integral of |T - SP| dt, in C*s
+ *   switches  relay transitions counted by srv_fan
+ *   offset    mean T - SP over the last `holdS` (P-only droop, limit cycles)
+ *
+ * srv_fan, srv_temp_sensor and SimHal keep module state, so runs in one
+ * process are sequential; TuneMain.cpp runs one process per core.
+ */
+
+#ifndef TuneRun_H
+#define TuneRun_H
+
+#include <stdint.h>
+
+#include "../sim/SimPlant.h"
+
+typedef enum
+{
+    TUNE_CTRL_PID   = 0,
+    TUNE_CTRL_ONOFF = 1
+} TuneCtrl;
+
+typedef struct
+{
+    TuneCtrl ctrl;
+    float    kp;
+    float    ki;
+    float    kd;
+    uint16_t windowMs;      /* TPC window (PID only)                        */
+    float    hysteresisC;   /* half-band (ON/OFF only)                      */
+} TuneCandidate;
+
+typedef struct
+{
+    SimPlantParams plant;
+    uint32_t       seed;        /* same seed for every candidate: same noise */
+    float          setpointC;
+    float          outputLimit; /* % */
+    uint32_t       durationS;
+    float          bandC;
+    uint32_t       holdS;
+} TuneScenario;
+
+typedef struct
+{
+    float    riseS;         /* < 0: never reached 90 %                      */
+    float    settleS;       /* < 0: never settled                           */
+    float    overshootC;
+    float    iaeCs;
+    uint32_t switches;
+    float    offsetC;
+} TuneMetrics;
+
+/** Default plant (SimPlant_Defaults), default set-point, 30 min, +/-0.5 C. */
+void TuneRun_Defaults(TuneScenario* sc);
+
+/** Simulate one candidate from a cold start. */
+void TuneRun(const TuneScenario* sc, const TuneCandidate* c, TuneMetrics* out);
+
+#endif